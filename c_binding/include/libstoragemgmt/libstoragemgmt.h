@@ -101,21 +101,35 @@ int LSM_DLL_EXPORT lsm_connect_password(const char *uri,
 int LSM_DLL_EXPORT lsm_connect_close(lsm_connect *conn, lsm_flag flags);
 
 /**
- * lsm_plugin_info_get - Retrieves information about the plug-in
+ * lsm_connect_pool_create - Create a pool of connections to a storage
+ * provider.
  *
  * Version:
- *      1.0
+ *      1.6
  *
  * Description:
- *      Retrieves information about the plug-in.
+ *      Create a pool holding up to 'size' registered connections to the
+ *      same URI, for applications which issue many short requests from
+ *      one or more threads. Connections are taken with
+ *      lsm_connect_pool_get() and given back with lsm_connect_pool_put()
+ *      rather than paying for a new plug-in connection each time.
+ *      One connection is made before returning so that a bad URI or
+ *      password is reported here, the others are made on demand.
+ *      The password is kept in memory by the pool until it is freed.
  *
- * @conn:
- *      Valid lsm_connect pointer.
- * @desc:
- *      Plug-in version. Returned string should be freed manually with free()
- *      library call.
- * @version:
- *      Plug-in version. Returned string should be freed manually.
+ * @uri:
+ *      Uniform Resource Identifier (see URI documentation)
+ * @password:
+ *      Password for the storage array (optional, can be NULL)
+ * @size:
+ *      Maximum number of connections, must be greater than 0.
+ * @pool:
+ *      The connection pool. When done using it, it must be freed with a
+ *      call to lsm_connect_pool_free().
+ * @timeout:
+ *      Time-out in milliseconds, (initial value) of each connection.
+ * @e:
+ *      Error data if connection failed.
  * @flags:
  *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
  *
@@ -124,28 +138,42 @@ int LSM_DLL_EXPORT lsm_connect_close(lsm_connect *conn, lsm_flag flags);
  *          * LSM_ERR_OK
  *              On success.
  *          * LSM_ERR_INVALID_ARGUMENT
- *              When any argument is NULL or not a valid lsm_connect pointer or
- *              invalid flags.
+ *              When any argument is NULL or invalid flags.
+ *          * LSM_ERR_NO_MEMORY
+ *              When no memory.
+ *          * Any error lsm_connect_password() returns.
  */
-int LSM_DLL_EXPORT lsm_plugin_info_get(lsm_connect *conn, char **desc,
-                                       char **version, lsm_flag flags);
+int LSM_DLL_EXPORT lsm_connect_pool_create(const char *uri,
+                                           const char *password,
+                                           uint32_t size,
+                                           lsm_connect_pool **pool,
+                                           uint32_t timeout,
+                                           lsm_error_ptr *e, lsm_flag flags);
 
 /**
- * lsm_available_plugins_list - Retrieves a list of available plug-ins.
+ * lsm_connect_pool_get - Take a connection from the pool.
  *
  * Version:
- *      1.0
+ *      1.6
  *
  * Description:
- *      Retrieve a list of available plug-ins.
+ *      Hand out an idle connection of the pool, making a new one if all are
+ *      in use and the pool has not reached its size, otherwise wait for one
+ *      to be returned. Idle connections whose plug-in went away are torn
+ *      down and replaced. Thread safe.
+ *      The connection can be used with all the other library calls, it
+ *      should be returned with lsm_connect_pool_put(). Closing it with
+ *      lsm_connect_close() instead removes it from the pool.
  *
- * @sep:
- *      Data separator used for string of plugin. Check document of 'plugins'
- *      argument for detail.
- * @plugins:
- *      String list of plug-ins with the form 'desc<sep>version'.
- *      Returned plugins memory should be freed by calling
- *      lsm_string_list_free().
+ * @pool:
+ *      Pool from lsm_connect_pool_create().
+ * @conn:
+ *      Connection.
+ * @timeout:
+ *      Time-out in milliseconds to wait for a connection when all of them
+ *      are in use, 0 to not wait.
+ * @e:
+ *      Error data if making a new connection failed.
  * @flags:
  *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
  *
@@ -154,26 +182,33 @@ int LSM_DLL_EXPORT lsm_plugin_info_get(lsm_connect *conn, char **desc,
  *          * LSM_ERR_OK
  *              On success.
  *          * LSM_ERR_INVALID_ARGUMENT
- *              When any argument is NULL or invalid flags.
- *
+ *              When any argument is NULL or not a valid lsm_connect_pool
+ *              pointer or invalid flags.
+ *          * LSM_ERR_TIMEOUT
+ *              When no connection was returned to the pool in time.
+ *          * Any error lsm_connect_password() returns.
  */
-int LSM_DLL_EXPORT lsm_available_plugins_list(const char *sep,
-                                              lsm_string_list ** plugins,
-                                              lsm_flag flags);
+int LSM_DLL_EXPORT lsm_connect_pool_get(lsm_connect_pool *pool,
+                                        lsm_connect **conn,
+                                        uint32_t timeout,
+                                        lsm_error_ptr *e, lsm_flag flags);
 
 /**
- * lsm_connect_timeout_set - Sets the time-out for this connection.
+ * lsm_connect_pool_put - Return a connection to the pool.
  *
  * Version:
- *      1.0
+ *      1.6
  *
  * Description:
- *      Sets the time-out for this connection.
+ *      Give back a connection taken with lsm_connect_pool_get(). A
+ *      connection whose transport failed (the call using it returned
+ *      LSM_ERR_TRANSPORT_COMMUNICATION) is torn down instead of being kept.
+ *      Thread safe.
  *
+ * @pool:
+ *      Pool the connection was taken from.
  * @conn:
- *      Valid lsm_connect pointer.
- * @timeout:
- *      Time-out in ms.
+ *      Connection, not to be used by the caller afterwards.
  * @flags:
  *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
  *
@@ -182,26 +217,24 @@ int LSM_DLL_EXPORT lsm_available_plugins_list(const char *sep,
  *          * LSM_ERR_OK
  *              On success.
  *          * LSM_ERR_INVALID_ARGUMENT
- *              When any argument is NULL or invalid lsm_connect or invalid
- *              flags.
+ *              When any argument is not valid, the connection does not
+ *              belong to the pool or invalid flags.
  */
-int LSM_DLL_EXPORT lsm_connect_timeout_set(lsm_connect *conn,
-                                           uint32_t timeout,
-                                           lsm_flag flags);
+int LSM_DLL_EXPORT lsm_connect_pool_put(lsm_connect_pool *pool,
+                                        lsm_connect *conn, lsm_flag flags);
 
 /**
- * lsm_connect_timeout_get - Gets the time-out for this connection.
+ * lsm_connect_pool_free - Close the connections of a pool and free it.
  *
  * Version:
- *      1.0
+ *      1.6
  *
  * Description:
- *      Gets the time-out for this connection.
+ *      Close all the connections of the pool and free it. Every connection
+ *      taken from the pool must have been returned first.
  *
- * @conn:
- *      Valid lsm_connect pointer.
- * @timeout:
- *      Output pointer of uint32_t. Time-out in ms.
+ * @pool:
+ *      Pool to free.
  * @flags:
  *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
  *
@@ -210,132 +243,115 @@ int LSM_DLL_EXPORT lsm_connect_timeout_set(lsm_connect *conn,
  *          * LSM_ERR_OK
  *              On success.
  *          * LSM_ERR_INVALID_ARGUMENT
- *              When any argument is NULL or not a valid lsm_connect pointer
- *              or invalid flags.
+ *              When not a valid lsm_connect_pool pointer, connections are
+ *              still handed out or invalid flags.
  */
-int LSM_DLL_EXPORT lsm_connect_timeout_get(lsm_connect *conn,
-                                           uint32_t *timeout,
-                                           lsm_flag flags);
+int LSM_DLL_EXPORT lsm_connect_pool_free(lsm_connect_pool *pool,
+                                         lsm_flag flags);
 
 /**
- * lsm_job_status_get - Check on the status of a job with no data returned.
+ * lsm_batch_alloc - Allocate an empty batch of requests.
  *
  * Version:
- *      1.0
+ *      1.6
  *
  * Description:
- *      Check on the status of a job, no data or ignore the data returned on
- *      completion.
+ *      Allocate a batch to which requests are added with the
+ *      lsm_batch_volume_create(), lsm_batch_volume_mask(),
+ *      lsm_batch_volume_unmask() and lsm_batch_access_group_initiator_add()
+ *      functions. lsm_batch_run() then sends all of them to the plug-in in
+ *      one round trip.
  *
- * @conn:
- *      Valid connection.
- * @job_id:
- *      String. Job id
- * @status:
- *      Output pointer of lsm_job_status. Possible values are:
- *          * LSM_JOB_COMPLETE
- *              Job complete with no error.
- *          * LSM_JOB_ERROR
- *              Job complete with error.
- *          * LSM_JOB_INPROGRESS
- *              Job is still in progress.
- * @percent_complete:
- *      Output pointer of uint8_t. Percent job complete. Domain 0..100.
- * @flags:
- *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ * Return:
+ *      Pointer to lsm_batch, NULL on memory allocation failure. When done,
+ *      it must be freed with a call to lsm_batch_free().
+ */
+lsm_batch LSM_DLL_EXPORT *lsm_batch_alloc(void);
+
+/**
+ * lsm_batch_free - Free a batch and its results.
+ *
+ * Version:
+ *      1.6
+ *
+ * @batch:
+ *      Batch to free.
  *
  * Return:
  *      Error code as enumerated by 'lsm_error_number'.
  *          * LSM_ERR_OK
  *              On success.
  *          * LSM_ERR_INVALID_ARGUMENT
- *              When any argument is NULL or not a valid lsm_connect pointer
- *              or invalid flags.
- *          * LSM_ERR_NOT_FOUND_JOB
- *              When job not found.
+ *              When not a valid lsm_batch pointer.
  */
-int LSM_DLL_EXPORT lsm_job_status_get(lsm_connect *conn,
-                                      const char *job_id,
-                                      lsm_job_status *status,
-                                      uint8_t *percent_complete,
-                                      lsm_flag flags);
+int LSM_DLL_EXPORT lsm_batch_free(lsm_batch *batch);
 
 /**
- * lsm_job_status_pool_get - Check on the status of a job with lsm_pool
- * returned.
+ * lsm_batch_size - Number of requests in a batch.
  *
  * Version:
- *      1.0
+ *      1.6
+ *
+ * @batch:
+ *      Batch to query.
+ *
+ * Return:
+ *      Number of requests added so far, 0 for an invalid lsm_batch pointer.
+ */
+uint32_t LSM_DLL_EXPORT lsm_batch_size(lsm_batch *batch);
+
+/**
+ * lsm_batch_volume_create - Add a volume creation to a batch.
+ *
+ * Version:
+ *      1.6
  *
  * Description:
- *      Check on the status of a job with lsm_pool returned.
+ *      Queue the equivalent of lsm_volume_create(). Once the batch ran, use
+ *      lsm_batch_volume_get() to retrieve the new volume.
  *
- * @conn:
- *      Valid connection pointer
- * @job_id:
- *      String. Job to check status on.
- * @status:
- *      Output pointer of lsm_job_status. Possible values are:
- *          * LSM_JOB_COMPLETE
- *              Job complete with no error.
- *          * LSM_JOB_ERROR
- *              Job complete with error.
- *          * LSM_JOB_INPROGRESS
- *              Job is still in progress.
- * @percent_complete:
- *      Output pointer of uint8_t. Percent job complete. Domain 0..100.
+ * @batch:
+ *      Batch to add the request to.
  * @pool:
- *      Output pointer of lsm_pool for completed operation.
- *      Returned value must be freed with a call to lsm_pool_record_free().
+ *      Pool to allocate the volume from.
+ * @volume_name:
+ *      Human recognizable name, not all arrays support.
+ * @size:
+ *      Size of new volume in bytes, actual size will be based on array
+ *      rounding to block size.
+ * @provisioning:
+ *      Type of volume provisioning to use.
  * @flags:
- *      Reserved for future use, must be zero
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
  *
  * Return:
  *      Error code as enumerated by 'lsm_error_number'.
  *          * LSM_ERR_OK
  *              On success.
  *          * LSM_ERR_INVALID_ARGUMENT
- *              When any argument is NULL or not a valid lsm_connect pointer
- *              or invalid flags.
- *          * LSM_ERR_NOT_FOUND_JOB
- *              When job not found.
+ *              When any argument is not valid or invalid flags.
  */
-int LSM_DLL_EXPORT lsm_job_status_pool_get(lsm_connect *conn,
-                                           const char *job_id,
-                                           lsm_job_status *status,
-                                           uint8_t *percent_complete,
-                                           lsm_pool **pool,
-                                           lsm_flag flags);
+int LSM_DLL_EXPORT lsm_batch_volume_create(lsm_batch *batch, lsm_pool *pool,
+                                           const char *volume_name,
+                                           uint64_t size,
+                                           lsm_volume_provision_type
+                                           provisioning, lsm_flag flags);
 
 /**
- * lsm_job_status_volume_get - Check on the status of a job with lsm_volume
- * returned.
+ * lsm_batch_volume_mask - Add a volume masking to a batch.
  *
  * Version:
- *      1.0
+ *      1.6
  *
  * Description:
- *      Check on the status of a job and returns the volume information when
- *      complete.
+ *      Queue the equivalent of lsm_volume_mask().
  *
- * @conn:
- *      Valid connection pointer.
- * @job_id:
- *      String. Job to check status on
- * @status:
- *      Output pointer of lsm_job_status. Possible values are:
- *          * LSM_JOB_COMPLETE
- *              Job complete with no error.
- *          * LSM_JOB_ERROR
- *              Job complete with error.
- *          * LSM_JOB_INPROGRESS
- *              Job is still in progress.
- * @percent_complete:
- *      Output pointer of uint8_t. Percent job complete. Domain 0..100.
- * @vol:
- *      Output pointer of lsm_volume for completed operation.
- *      Returned value needs to be freed with a call to
- *      lsm_volume_record_free().
+ * @batch:
+ *      Batch to add the request to.
+ * @access_group:
+ *      Access group to grant access to.
+ * @volume:
+ *      Volume to be granted access.
  * @flags:
  *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
  *
@@ -344,44 +360,27 @@ int LSM_DLL_EXPORT lsm_job_status_pool_get(lsm_connect *conn,
  *          * LSM_ERR_OK
  *              On success.
  *          * LSM_ERR_INVALID_ARGUMENT
- *              When any argument is NULL or not a valid lsm_connect pointer
- *              or invalid flags.
- *          * LSM_ERR_NOT_FOUND_JOB
- *              When job not found.
+ *              When any argument is not valid or invalid flags.
  */
-int LSM_DLL_EXPORT lsm_job_status_volume_get(lsm_connect *conn,
-                                             const char *job_id,
-                                             lsm_job_status *status,
-                                             uint8_t *percent_complete,
-                                             lsm_volume **vol,
-                                             lsm_flag flags);
+int LSM_DLL_EXPORT lsm_batch_volume_mask(lsm_batch *batch,
+                                         lsm_access_group *access_group,
+                                         lsm_volume *volume, lsm_flag flags);
 
 /**
- * lsm_job_status_fs_get - Check on the status of a job with lsm_fs returned.
+ * lsm_batch_volume_unmask - Add a volume unmasking to a batch.
  *
  * Version:
- *      1.0
+ *      1.6
  *
  * Description:
- *      Check on the status of a job and return the fs information when
- *      complete.
- * @conn:
- *      Valid connection pointer
- * @job_id:
- *      String. Job to check
- * @status:
- *      Output pointer of lsm_job_status. Possible values are:
- *          * LSM_JOB_COMPLETE
- *              Job complete with no error.
- *          * LSM_JOB_ERROR
- *              Job complete with error.
- *          * LSM_JOB_INPROGRESS
- *              Job is still in progress.
- * @percent_complete:
- *      Output pointer of uint8_t. Percent job complete. Domain 0..100.
- * @fs:
- *      Output pointer of lsm_fs for completed operation.
- *      Returned value must be freed with a call to lsm_fs_record_free().
+ *      Queue the equivalent of lsm_volume_unmask().
+ *
+ * @batch:
+ *      Batch to add the request to.
+ * @access_group:
+ *      Access group to revoke access from.
+ * @volume:
+ *      Volume to have its access revoked.
  * @flags:
  *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
  *
@@ -390,45 +389,31 @@ int LSM_DLL_EXPORT lsm_job_status_volume_get(lsm_connect *conn,
  *          * LSM_ERR_OK
  *              On success.
  *          * LSM_ERR_INVALID_ARGUMENT
- *              When any argument is NULL or not a valid lsm_connect pointer
- *              or invalid flags.
- *          * LSM_ERR_NOT_FOUND_JOB
- *              When job not found.
+ *              When any argument is not valid or invalid flags.
  */
-int LSM_DLL_EXPORT lsm_job_status_fs_get(lsm_connect *conn,
-                                         const char *job_id,
-                                         lsm_job_status *status,
-                                         uint8_t *percent_complete,
-                                         lsm_fs **fs, lsm_flag flags);
+int LSM_DLL_EXPORT lsm_batch_volume_unmask(lsm_batch *batch,
+                                           lsm_access_group *access_group,
+                                           lsm_volume *volume,
+                                           lsm_flag flags);
 
 /**
- * lsm_job_status_ss_get - Check on the status of a job with lsm_fs_ss
- * returned.
+ * lsm_batch_access_group_initiator_add - Add an initiator addition to a
+ * batch.
  *
  * Version:
- *      1.0
+ *      1.6
  *
  * Description:
- *      Check on the status of a job and return the snapshot information when
- *      compete.
+ *      Queue the equivalent of lsm_access_group_initiator_add().
  *
- * @conn:
- *      Valid connection pointer
- * @job:
- *      String. Job id to check
- * @status:
- *      Output pointer of lsm_job_status. Possible values are:
- *          * LSM_JOB_COMPLETE
- *              Job complete with no error.
- *          * LSM_JOB_ERROR
- *              Job complete with error.
- *          * LSM_JOB_INPROGRESS
- *              Job is still in progress.
- * @percent_complete:
- *      Output pointer of uint8_t. Percent job complete. Domain 0..100.
- * @ss:
- *      Output pointer of lsm_fs_ss for completed operation.
- *      Returned value must be freed with a call to lsm_fs_ss_record_free().
+ * @batch:
+ *      Batch to add the request to.
+ * @access_group:
+ *      Access group to add the initiator to.
+ * @init_id:
+ *      Initiator id.
+ * @init_type:
+ *      Type of initiator, enumerated by lsm_access_group_init_type.
  * @flags:
  *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
  *
@@ -437,16 +422,989 @@ int LSM_DLL_EXPORT lsm_job_status_fs_get(lsm_connect *conn,
  *          * LSM_ERR_OK
  *              On success.
  *          * LSM_ERR_INVALID_ARGUMENT
- *              When any argument is NULL or not a valid lsm_connect pointer
- *              or invalid flags.
- *          * LSM_ERR_NOT_FOUND_JOB
- *              When job not found.
+ *              When any argument is not valid, the initiator id does not
+ *              match its type or invalid flags.
  */
-int LSM_DLL_EXPORT lsm_job_status_ss_get(lsm_connect *conn,
-                                         const char *job,
-                                         lsm_job_status * status,
-                                         uint8_t * percent_complete,
-                                         lsm_fs_ss ** ss, lsm_flag flags);
+int LSM_DLL_EXPORT
+    lsm_batch_access_group_initiator_add(lsm_batch *batch,
+                                         lsm_access_group *access_group,
+                                         const char *init_id,
+                                         lsm_access_group_init_type init_type,
+                                         lsm_flag flags);
+
+/**
+ * lsm_batch_run - Send the requests of a batch in one round trip.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Send every request of the batch to the plug-in at once and wait for
+ *      all of their results. Requests are handled in the order they were
+ *      added, one which fails does not stop the ones after it; check each
+ *      of them with lsm_batch_result_get(). Plug-ins may run the whole
+ *      batch in one transaction. With plug-ins that predate batches the
+ *      requests are sent one at a time instead. Running a batch again
+ *      replaces the previous results.
+ *
+ * @conn:
+ *      Valid connection.
+ * @batch:
+ *      Batch to run.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              When the batch ran, the individual requests may still have
+ *              failed.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is not valid or invalid flags.
+ *          * Any transport error, no result is then available.
+ */
+int LSM_DLL_EXPORT lsm_batch_run(lsm_connect *conn, lsm_batch *batch,
+                                 lsm_flag flags);
+
+/**
+ * lsm_batch_result_get - Outcome of one request of a batch.
+ *
+ * Version:
+ *      1.6
+ *
+ * @batch:
+ *      Batch which ran.
+ * @index:
+ *      Index of the request, in the order it was added starting at 0.
+ * @job:
+ *      Output pointer to the job id when the request started an
+ *      asynchronous job, NULL otherwise. Free with free(). May be NULL when
+ *      not of interest.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              When the request succeeded.
+ *          * LSM_ERR_JOB_STARTED
+ *              When the request started a job, check it with the job id.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When the batch did not run, index is out of range, job is
+ *              not pointing to NULL or invalid flags.
+ *          * Any error the request failed with, lsm_batch_error_get()
+ *            provides the details.
+ */
+int LSM_DLL_EXPORT lsm_batch_result_get(lsm_batch *batch, uint32_t index,
+                                        char **job, lsm_flag flags);
+
+/**
+ * lsm_batch_error_get - Error details of one failed request of a batch.
+ *
+ * Version:
+ *      1.6
+ *
+ * @batch:
+ *      Batch which ran.
+ * @index:
+ *      Index of the request, in the order it was added starting at 0.
+ *
+ * Return:
+ *      lsm_error_ptr, NULL if the request did not fail. Free with
+ *      lsm_error_free().
+ */
+lsm_error_ptr LSM_DLL_EXPORT lsm_batch_error_get(lsm_batch *batch,
+                                                 uint32_t index);
+
+/**
+ * lsm_batch_volume_get - New volume of a volume creation request of a batch.
+ *
+ * Version:
+ *      1.6
+ *
+ * @batch:
+ *      Batch which ran.
+ * @index:
+ *      Index of a request added with lsm_batch_volume_create().
+ * @volume:
+ *      Output pointer to the new volume, NULL when the request failed or
+ *      started a job. Free with lsm_volume_record_free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number', the same as
+ *      lsm_batch_result_get() returns for the request. LSM_ERR_INVALID_ARGUMENT
+ *      also when the request is not a volume creation.
+ */
+int LSM_DLL_EXPORT lsm_batch_volume_get(lsm_batch *batch, uint32_t index,
+                                        lsm_volume **volume, lsm_flag flags);
+
+/*
+ * Completion callbacks of the asynchronous list calls.
+ * @conn is the connection the request was submitted on, @rc the error code
+ * the blocking call would have returned, lsm_error_last_get() has the
+ * details while in the callback. On success the callback owns the array
+ * and frees it with the matching *_record_array_free() call. Callbacks must
+ * not close the connection.
+ */
+typedef void (*lsm_system_list_cb)(lsm_connect *conn, int rc,
+                                   lsm_system *systems[], uint32_t count,
+                                   void *user_data);
+typedef void (*lsm_pool_list_cb)(lsm_connect *conn, int rc,
+                                 lsm_pool *pools[], uint32_t count,
+                                 void *user_data);
+typedef void (*lsm_volume_list_cb)(lsm_connect *conn, int rc,
+                                   lsm_volume *volumes[], uint32_t count,
+                                   void *user_data);
+typedef void (*lsm_disk_list_cb)(lsm_connect *conn, int rc,
+                                 lsm_disk *disks[], uint32_t count,
+                                 void *user_data);
+
+/**
+ * lsm_connect_fd_get - File descriptor of a connection for event loops.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Get the descriptor responses to asynchronous requests arrive on, to
+ *      be watched for readability with poll(), epoll or an event library.
+ *      Whenever it is readable, call lsm_connect_process(). The descriptor
+ *      belongs to the connection, it must not be read from or closed.
+ *
+ * @conn:
+ *      Valid connection.
+ * @fd:
+ *      Output pointer to the descriptor.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags.
+ *          * LSM_ERR_TRANSPORT_COMMUNICATION
+ *              When the connection is not connected to its plug-in.
+ */
+int LSM_DLL_EXPORT lsm_connect_fd_get(lsm_connect *conn, int *fd,
+                                      lsm_flag flags);
+
+/**
+ * lsm_connect_process - Complete the asynchronous requests which got their
+ * response.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Read the responses which arrived on the connection without blocking
+ *      and call the callback of every asynchronous request which is done,
+ *      from the calling thread. Meant to be called when the descriptor from
+ *      lsm_connect_fd_get() is readable; everything available is read, so
+ *      edge triggered notification works too. Responses read by a
+ *      blocking call made on the same connection meanwhile are kept and
+ *      completed on the next call. When the plug-in goes away, all the
+ *      outstanding requests complete with LSM_ERR_TRANSPORT_COMMUNICATION.
+ *      The asynchronous calls and lsm_connect_process() of a connection are
+ *      to be used from one thread at a time.
+ *
+ * @conn:
+ *      Valid connection.
+ * @outstanding:
+ *      Output pointer to the number of requests still waiting for their
+ *      response. May be NULL when not of interest.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success, including when nothing had arrived.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When not a valid lsm_connect pointer or invalid flags.
+ *          * LSM_ERR_TRANSPORT_COMMUNICATION
+ *              When the plug-in went away.
+ */
+int LSM_DLL_EXPORT lsm_connect_process(lsm_connect *conn,
+                                       uint32_t *outstanding,
+                                       lsm_flag flags);
+
+/**
+ * lsm_system_list_async - Submit a system list request.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Non-blocking lsm_system_list(). The request is sent and the call
+ *      returns at once, the callback is called from lsm_connect_process()
+ *      once the response arrived. Any number of requests can be
+ *      outstanding on a connection. Requests still outstanding when the
+ *      connection is closed are dropped without calling their callbacks.
+ *
+ * @conn:
+ *      Valid connection.
+ * @cb:
+ *      Callback receiving the systems.
+ * @user_data:
+ *      Passed to the callback.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              When the request was sent, the callback gets its outcome.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags.
+ *          * LSM_ERR_NO_SUPPORT
+ *              When the plug-in predates protocol version 2, which the
+ *              asynchronous calls need.
+ *          * LSM_ERR_TRANSPORT_COMMUNICATION
+ *              When the request could not be sent.
+ */
+int LSM_DLL_EXPORT lsm_system_list_async(lsm_connect *conn,
+                                         lsm_system_list_cb cb,
+                                         void *user_data, lsm_flag flags);
+
+/**
+ * lsm_pool_list_async - Submit a pool list request.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Non-blocking lsm_pool_list(), see lsm_system_list_async().
+ *
+ * @conn:
+ *      Valid connection.
+ * @search_key:
+ *      Search key (NULL for all). The same keys as lsm_pool_list().
+ * @search_value:
+ *      Search value.
+ * @cb:
+ *      Callback receiving the pools.
+ * @user_data:
+ *      Passed to the callback.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              When the request was sent, the callback gets its outcome.
+ *          * LSM_ERR_UNSUPPORTED_SEARCH_KEY
+ *              When provided search key is not supported.
+ *          * Any error lsm_system_list_async() returns.
+ */
+int LSM_DLL_EXPORT lsm_pool_list_async(lsm_connect *conn,
+                                       const char *search_key,
+                                       const char *search_value,
+                                       lsm_pool_list_cb cb,
+                                       void *user_data, lsm_flag flags);
+
+/**
+ * lsm_volume_list_async - Submit a volume list request.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Non-blocking lsm_volume_list(), see lsm_system_list_async().
+ *
+ * @conn:
+ *      Valid connection.
+ * @search_key:
+ *      Search key (NULL for all). The same keys as lsm_volume_list().
+ * @search_value:
+ *      Search value.
+ * @cb:
+ *      Callback receiving the volumes.
+ * @user_data:
+ *      Passed to the callback.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              When the request was sent, the callback gets its outcome.
+ *          * LSM_ERR_UNSUPPORTED_SEARCH_KEY
+ *              When provided search key is not supported.
+ *          * Any error lsm_system_list_async() returns.
+ */
+int LSM_DLL_EXPORT lsm_volume_list_async(lsm_connect *conn,
+                                         const char *search_key,
+                                         const char *search_value,
+                                         lsm_volume_list_cb cb,
+                                         void *user_data, lsm_flag flags);
+
+/**
+ * lsm_disk_list_async - Submit a disk list request.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Non-blocking lsm_disk_list(), see lsm_system_list_async().
+ *
+ * @conn:
+ *      Valid connection.
+ * @search_key:
+ *      Search key (NULL for all). The same keys as lsm_disk_list().
+ * @search_value:
+ *      Search value.
+ * @cb:
+ *      Callback receiving the disks.
+ * @user_data:
+ *      Passed to the callback.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              When the request was sent, the callback gets its outcome.
+ *          * LSM_ERR_UNSUPPORTED_SEARCH_KEY
+ *              When provided search key is not supported.
+ *          * Any error lsm_system_list_async() returns.
+ */
+int LSM_DLL_EXPORT lsm_disk_list_async(lsm_connect *conn,
+                                       const char *search_key,
+                                       const char *search_value,
+                                       lsm_disk_list_cb cb,
+                                       void *user_data, lsm_flag flags);
+
+/**
+ * lsm_plugin_info_get - Retrieves information about the plug-in
+ *
+ * Version:
+ *      1.0
+ *
+ * Description:
+ *      Retrieves information about the plug-in.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @desc:
+ *      Plug-in version. Returned string should be freed manually with free()
+ *      library call.
+ * @version:
+ *      Plug-in version. Returned string should be freed manually.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer or
+ *              invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_plugin_info_get(lsm_connect *conn, char **desc,
+                                       char **version, lsm_flag flags);
+
+/**
+ * lsm_available_plugins_list - Retrieves a list of available plug-ins.
+ *
+ * Version:
+ *      1.0
+ *
+ * Description:
+ *      Retrieve a list of available plug-ins.
+ *
+ * @sep:
+ *      Data separator used for string of plugin. Check document of 'plugins'
+ *      argument for detail.
+ * @plugins:
+ *      String list of plug-ins with the form 'desc<sep>version'.
+ *      Returned plugins memory should be freed by calling
+ *      lsm_string_list_free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid flags.
+ *
+ */
+int LSM_DLL_EXPORT lsm_available_plugins_list(const char *sep,
+                                              lsm_string_list ** plugins,
+                                              lsm_flag flags);
+
+/**
+ * lsm_connect_timeout_set - Sets the time-out for this connection.
+ *
+ * Version:
+ *      1.0
+ *
+ * Description:
+ *      Sets the time-out for this connection.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @timeout:
+ *      Time-out in ms.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid lsm_connect or invalid
+ *              flags.
+ */
+int LSM_DLL_EXPORT lsm_connect_timeout_set(lsm_connect *conn,
+                                           uint32_t timeout,
+                                           lsm_flag flags);
+
+/**
+ * lsm_connect_timeout_get - Gets the time-out for this connection.
+ *
+ * Version:
+ *      1.0
+ *
+ * Description:
+ *      Gets the time-out for this connection.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @timeout:
+ *      Output pointer of uint32_t. Time-out in ms.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_connect_timeout_get(lsm_connect *conn,
+                                           uint32_t *timeout,
+                                           lsm_flag flags);
+
+/**
+ * lsm_connect_io_timeout_set - Sets how long calls wait for the plug-in.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Unlike lsm_connect_timeout_set(), which asks the plug-in to give up
+ *      on the storage array in time, this bounds how long the library waits
+ *      for the plug-in itself, so a hung plug-in can not hang the caller.
+ *      Calls not answered in time fail with LSM_ERR_TIMEOUT.  With a
+ *      plug-in which handles one request at a time the connection can not
+ *      be used after that, other calls fail with
+ *      LSM_ERR_TRANSPORT_COMMUNICATION and it has to be closed.  The wait
+ *      should be longer than the plug-in time-out.  lsm_job_wait() and
+ *      lsm_job_wait_any() wait for their timeout on top.  The default, 0,
+ *      waits for ever.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @timeout:
+ *      Time-out in ms, 0 to wait for ever.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When not a valid lsm_connect pointer or invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_connect_io_timeout_set(lsm_connect *conn,
+                                              uint32_t timeout,
+                                              lsm_flag flags);
+
+/**
+ * lsm_connect_io_timeout_get - Gets how long calls wait for the plug-in.
+ *
+ * Version:
+ *      1.6
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @timeout:
+ *      Output pointer of uint32_t. Time-out in ms, 0 for none.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_connect_io_timeout_get(lsm_connect *conn,
+                                              uint32_t *timeout,
+                                              lsm_flag flags);
+
+/**
+ * lsm_connect_call_timeout_set - Overrides how long the next call waits
+ * for the plug-in.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Applies to the next request the calling thread sends through conn
+ *      instead of the time-out set by lsm_connect_io_timeout_set(), other
+ *      threads are not affected.  Calls answered without asking the
+ *      plug-in (see lsm_connect_cache_ttl_set()) leave it for the next
+ *      one.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @timeout:
+ *      Time-out in ms, 0 to wait for ever.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When not a valid lsm_connect pointer or invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_connect_call_timeout_set(lsm_connect *conn,
+                                                uint32_t timeout,
+                                                lsm_flag flags);
+
+/**
+ * lsm_connect_cache_ttl_set - Cache slowly changing results of a
+ * connection.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Keep the results of one class of calls for up to ttl milliseconds,
+ *      calls made again with the same arguments in that time are answered
+ *      without asking the plug-in. The cache is off for every class until
+ *      enabled. All results are dropped whenever a call which may change
+ *      the storage (anything but list and query calls, including job status
+ *      checks) is made through the same connection, and when a time to live
+ *      is changed. Changes made by other connections or on the array itself
+ *      show up once the time to live passed. Thread safe once enabled,
+ *      enable it before sharing the connection between threads.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @cache_class:
+ *      Class of calls, enumerated by 'lsm_cache_class'.
+ * @ttl:
+ *      Time to live in ms, 0 to stop caching the class.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When not a valid lsm_connect pointer, unknown cache_class or
+ *              invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_connect_cache_ttl_set(lsm_connect *conn,
+                                             lsm_cache_class cache_class,
+                                             uint32_t ttl, lsm_flag flags);
+
+/**
+ * lsm_connect_cache_clear - Drop the cached results of a connection.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Drop everything the cache holds, for when the caller knows the
+ *      storage changed behind its back. Time to live settings are kept.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When not a valid lsm_connect pointer or invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_connect_cache_clear(lsm_connect *conn, lsm_flag flags);
+
+/**
+ * lsm_connect_cache_stats_get - Hit and miss counters of the cache of a
+ * connection.
+ *
+ * Version:
+ *      1.6
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @hits:
+ *      Output pointer to the number of calls answered from the cache.
+ * @misses:
+ *      Output pointer to the number of calls of cached classes which went
+ *      to the plug-in.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_connect_cache_stats_get(lsm_connect *conn,
+                                               uint64_t *hits,
+                                               uint64_t *misses,
+                                               lsm_flag flags);
+
+/**
+ * lsm_job_status_get - Check on the status of a job with no data returned.
+ *
+ * Version:
+ *      1.0
+ *
+ * Description:
+ *      Check on the status of a job, no data or ignore the data returned on
+ *      completion.
+ *
+ * @conn:
+ *      Valid connection.
+ * @job_id:
+ *      String. Job id
+ * @status:
+ *      Output pointer of lsm_job_status. Possible values are:
+ *          * LSM_JOB_COMPLETE
+ *              Job complete with no error.
+ *          * LSM_JOB_ERROR
+ *              Job complete with error.
+ *          * LSM_JOB_INPROGRESS
+ *              Job is still in progress.
+ * @percent_complete:
+ *      Output pointer of uint8_t. Percent job complete. Domain 0..100.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags.
+ *          * LSM_ERR_NOT_FOUND_JOB
+ *              When job not found.
+ */
+int LSM_DLL_EXPORT lsm_job_status_get(lsm_connect *conn,
+                                      const char *job_id,
+                                      lsm_job_status *status,
+                                      uint8_t *percent_complete,
+                                      lsm_flag flags);
+
+/**
+ * lsm_job_status_pool_get - Check on the status of a job with lsm_pool
+ * returned.
+ *
+ * Version:
+ *      1.0
+ *
+ * Description:
+ *      Check on the status of a job with lsm_pool returned.
+ *
+ * @conn:
+ *      Valid connection pointer
+ * @job_id:
+ *      String. Job to check status on.
+ * @status:
+ *      Output pointer of lsm_job_status. Possible values are:
+ *          * LSM_JOB_COMPLETE
+ *              Job complete with no error.
+ *          * LSM_JOB_ERROR
+ *              Job complete with error.
+ *          * LSM_JOB_INPROGRESS
+ *              Job is still in progress.
+ * @percent_complete:
+ *      Output pointer of uint8_t. Percent job complete. Domain 0..100.
+ * @pool:
+ *      Output pointer of lsm_pool for completed operation.
+ *      Returned value must be freed with a call to lsm_pool_record_free().
+ * @flags:
+ *      Reserved for future use, must be zero
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags.
+ *          * LSM_ERR_NOT_FOUND_JOB
+ *              When job not found.
+ */
+int LSM_DLL_EXPORT lsm_job_status_pool_get(lsm_connect *conn,
+                                           const char *job_id,
+                                           lsm_job_status *status,
+                                           uint8_t *percent_complete,
+                                           lsm_pool **pool,
+                                           lsm_flag flags);
+
+/**
+ * lsm_job_status_volume_get - Check on the status of a job with lsm_volume
+ * returned.
+ *
+ * Version:
+ *      1.0
+ *
+ * Description:
+ *      Check on the status of a job and returns the volume information when
+ *      complete.
+ *
+ * @conn:
+ *      Valid connection pointer.
+ * @job_id:
+ *      String. Job to check status on
+ * @status:
+ *      Output pointer of lsm_job_status. Possible values are:
+ *          * LSM_JOB_COMPLETE
+ *              Job complete with no error.
+ *          * LSM_JOB_ERROR
+ *              Job complete with error.
+ *          * LSM_JOB_INPROGRESS
+ *              Job is still in progress.
+ * @percent_complete:
+ *      Output pointer of uint8_t. Percent job complete. Domain 0..100.
+ * @vol:
+ *      Output pointer of lsm_volume for completed operation.
+ *      Returned value needs to be freed with a call to
+ *      lsm_volume_record_free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags.
+ *          * LSM_ERR_NOT_FOUND_JOB
+ *              When job not found.
+ */
+int LSM_DLL_EXPORT lsm_job_status_volume_get(lsm_connect *conn,
+                                             const char *job_id,
+                                             lsm_job_status *status,
+                                             uint8_t *percent_complete,
+                                             lsm_volume **vol,
+                                             lsm_flag flags);
+
+/**
+ * lsm_job_status_fs_get - Check on the status of a job with lsm_fs returned.
+ *
+ * Version:
+ *      1.0
+ *
+ * Description:
+ *      Check on the status of a job and return the fs information when
+ *      complete.
+ * @conn:
+ *      Valid connection pointer
+ * @job_id:
+ *      String. Job to check
+ * @status:
+ *      Output pointer of lsm_job_status. Possible values are:
+ *          * LSM_JOB_COMPLETE
+ *              Job complete with no error.
+ *          * LSM_JOB_ERROR
+ *              Job complete with error.
+ *          * LSM_JOB_INPROGRESS
+ *              Job is still in progress.
+ * @percent_complete:
+ *      Output pointer of uint8_t. Percent job complete. Domain 0..100.
+ * @fs:
+ *      Output pointer of lsm_fs for completed operation.
+ *      Returned value must be freed with a call to lsm_fs_record_free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags.
+ *          * LSM_ERR_NOT_FOUND_JOB
+ *              When job not found.
+ */
+int LSM_DLL_EXPORT lsm_job_status_fs_get(lsm_connect *conn,
+                                         const char *job_id,
+                                         lsm_job_status *status,
+                                         uint8_t *percent_complete,
+                                         lsm_fs **fs, lsm_flag flags);
+
+/**
+ * lsm_job_status_ss_get - Check on the status of a job with lsm_fs_ss
+ * returned.
+ *
+ * Version:
+ *      1.0
+ *
+ * Description:
+ *      Check on the status of a job and return the snapshot information when
+ *      compete.
+ *
+ * @conn:
+ *      Valid connection pointer
+ * @job:
+ *      String. Job id to check
+ * @status:
+ *      Output pointer of lsm_job_status. Possible values are:
+ *          * LSM_JOB_COMPLETE
+ *              Job complete with no error.
+ *          * LSM_JOB_ERROR
+ *              Job complete with error.
+ *          * LSM_JOB_INPROGRESS
+ *              Job is still in progress.
+ * @percent_complete:
+ *      Output pointer of uint8_t. Percent job complete. Domain 0..100.
+ * @ss:
+ *      Output pointer of lsm_fs_ss for completed operation.
+ *      Returned value must be freed with a call to lsm_fs_ss_record_free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags.
+ *          * LSM_ERR_NOT_FOUND_JOB
+ *              When job not found.
+ */
+int LSM_DLL_EXPORT lsm_job_status_ss_get(lsm_connect *conn,
+                                         const char *job,
+                                         lsm_job_status * status,
+                                         uint8_t * percent_complete,
+                                         lsm_fs_ss ** ss, lsm_flag flags);
+
+/**
+ * lsm_job_wait - Wait for a job to finish.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Block until the job is no longer in progress or the time-out passed,
+ *      instead of calling lsm_job_status_get() in a loop. The plug-in
+ *      side does the waiting, checking on the job with a growing interval,
+ *      so it costs one round trip. With plug-ins that predate it the
+ *      library does the checking instead. The data of a finished job is
+ *      retrieved with the matching lsm_job_status_*_get() call afterwards.
+ *
+ * @conn:
+ *      Valid connection.
+ * @job_id:
+ *      String. Job id
+ * @timeout:
+ *      Time-out in milliseconds, 0 checks on the job once.
+ * @status:
+ *      Output pointer of lsm_job_status, LSM_JOB_COMPLETE or LSM_JOB_ERROR.
+ * @percent_complete:
+ *      Output pointer of uint8_t. Percent job complete. Domain 0..100.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              When the job finished.
+ *          * LSM_ERR_TIMEOUT
+ *              When the job is still in progress, status and
+ *              percent_complete are not set.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags.
+ *          * LSM_ERR_NOT_FOUND_JOB
+ *              When job not found.
+ */
+int LSM_DLL_EXPORT lsm_job_wait(lsm_connect *conn, const char *job_id,
+                                uint32_t timeout, lsm_job_status *status,
+                                uint8_t *percent_complete, lsm_flag flags);
+
+/**
+ * lsm_job_wait_any - Wait for the first of several jobs to finish.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Like lsm_job_wait(), for several jobs at once. Returns as soon as
+ *      one of them is no longer in progress, call again with the others to
+ *      wait for the rest.
+ *
+ * @conn:
+ *      Valid connection.
+ * @job_ids:
+ *      Job ids, at least one.
+ * @timeout:
+ *      Time-out in milliseconds, 0 checks on the jobs once.
+ * @index:
+ *      Output pointer to the index in job_ids of the job which finished.
+ *      When more than one did, the lowest.
+ * @status:
+ *      Output pointer of lsm_job_status of that job, LSM_JOB_COMPLETE or
+ *      LSM_JOB_ERROR.
+ * @percent_complete:
+ *      Output pointer of uint8_t. Percent complete of that job.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              When a job finished.
+ *          * LSM_ERR_TIMEOUT
+ *              When all the jobs are still in progress, the outputs are not
+ *              set.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer,
+ *              job_ids is empty or invalid flags.
+ *          * LSM_ERR_NOT_FOUND_JOB
+ *              When a job is not found.
+ */
+int LSM_DLL_EXPORT lsm_job_wait_any(lsm_connect *conn,
+                                    lsm_string_list *job_ids,
+                                    uint32_t timeout, uint32_t *index,
+                                    lsm_job_status *status,
+                                    uint8_t *percent_complete,
+                                    lsm_flag flags);
 
 /**
  * lsm_job_free - Frees the resources used by a job.
@@ -565,44 +1523,375 @@ int LSM_DLL_EXPORT lsm_capabilities(lsm_connect *conn,
  *              When any argument is NULL or invalid flags or invalid search
  *              key.
  */
-int LSM_DLL_EXPORT lsm_pool_list(lsm_connect *conn, char *search_key,
-                                 char *search_value,
-                                 lsm_pool **pool_array[],
-                                 uint32_t *count, lsm_flag flags);
+int LSM_DLL_EXPORT lsm_pool_list(lsm_connect *conn, char *search_key,
+                                 char *search_value,
+                                 lsm_pool **pool_array[],
+                                 uint32_t *count, lsm_flag flags);
+
+/**
+ * lsm_volume_list - Gets a list of volumes on this connection.
+ *
+ * Version:
+ *      1.0
+ *
+ * Description:
+ *      Gets a list of volumes on this connection.
+ *      Volume properties could be retrieved by these functions:
+ *          * lsm_volume_id_get()
+ *          * lsm_volume_name_get()
+ *          * lsm_volume_system_id_get()
+ *          * lsm_volume_vpd83_get()
+ *          * lsm_volume_number_of_blocks_get()
+ *          * lsm_volume_block_size_get()
+ *          * lsm_volume_admin_state_get()
+ *          * lsm_volume_pool_id_get()
+ *
+ * Capability:
+ *      LSM_CAP_VOLUMES
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id", "system_id" and "pool_id".
+ * @search_value:
+ *      Search value.
+ * @volumes:
+ *      Output pointer of lsm_volume array. It should be manually freed by
+ *      lsm_volume_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of volumes.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or searched value not found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid flags or invalid search
+ *              key.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_volume_list(lsm_connect *conn,
+                                   const char *search_key,
+                                   const char *search_value,
+                                   lsm_volume ** volumes[],
+                                   uint32_t *count, lsm_flag flags);
+
+/**
+ * lsm_volume_list_fields - Gets a list of volumes with only some fields filled.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Same as lsm_volume_list(), but the plugin only sends back the requested
+ *      fields, which saves building, sending and parsing the rest when only
+ *      a few of them are needed, like for an inventory view.  The id is
+ *      always returned.  Fields which were not requested are left unset in
+ *      the returned records: strings read as NULL and numbers as 0.  Such
+ *      records should only be used for display, not handed back to other
+ *      calls.
+ *
+ * Capability:
+ *      LSM_CAP_VOLUMES
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id", "system_id" and "pool_id".
+ * @search_value:
+ *      Search value.
+ * @fields:
+ *      Names of the fields to return, NULL for all of them.
+ *      Valid fields are: "id", "name", "vpd83", "block_size",
+ *      "num_of_blocks", "admin_state", "system_id", "pool_id" and
+ *      "plugin_data".
+ * @volumes:
+ *      Output pointer of lsm_volume array. It should be manually freed by
+ *      lsm_volume_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of volumes.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or searched value not found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL, unknown field, invalid flags or
+ *              invalid search key.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_volume_list_fields(lsm_connect *conn,
+                                          const char *search_key,
+                                          const char *search_value,
+                                          lsm_string_list *fields,
+                                          lsm_volume ** volumes[],
+                                          uint32_t *count, lsm_flag flags);
+
+/**
+ * lsm_volume_list_page - Gets one page of the volume list.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Same as lsm_volume_list(), but returns at most 'limit'
+ *      records at a time so that very large inventories can be walked
+ *      without holding the whole list in memory.  Pass a NULL cursor to get
+ *      the first page, then pass back the returned 'next_cursor' to get the
+ *      following one.  The cursor is an opaque string, do not parse or
+ *      build it.  Objects created or deleted while paging may or may not
+ *      show up.
+ *
+ * Capability:
+ *      LSM_CAP_VOLUMES
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id", "system_id" and "pool_id".
+ * @search_value:
+ *      Search value.
+ * @cursor:
+ *      NULL for the first page, otherwise a 'next_cursor' returned by a
+ *      previous call with the same search key and value.
+ * @limit:
+ *      Maximum number of records to return, must be greater than 0.
+ * @volumes:
+ *      Output pointer of lsm_volume array. It should be manually freed by
+ *      lsm_volume_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of records in this page.
+ * @next_cursor:
+ *      Output pointer of char *. Cursor of the next page, or NULL when this
+ *      was the last page. It should be manually freed by free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or searched value not found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL, limit is 0, cursor is invalid,
+ *              invalid flags or invalid search key.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_volume_list_page(lsm_connect *conn,
+                                        const char *search_key,
+                                        const char *search_value,
+                                        const char *cursor,
+                                        uint32_t limit,
+                                        lsm_volume ** volumes[],
+                                        uint32_t *count,
+                                        char **next_cursor,
+                                        lsm_flag flags);
+
+/**
+ * lsm_volume_list_in - Gets the volumes matching a list of values.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Same as lsm_volume_list(), but returns every volume whose
+ *      search_key property is one of search_values, in a single request.
+ *      Use it instead of one lsm_volume_list() call per value, or a full
+ *      listing filtered on the client side.
+ *      Plug-ins which predate it are sent one request per value instead.
+ *
+ * Capability:
+ *      LSM_CAP_VOLUMES
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key.
+ *      Valid search keys are: "id", "system_id" and "pool_id".
+ * @search_values:
+ *      Search values.
+ * @volumes:
+ *      Output pointer of lsm_volume array. It should be manually freed by
+ *      lsm_volume_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of volumes.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or no searched value found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid flags.
+ *          * LSM_ERR_UNSUPPORTED_SEARCH_KEY
+ *              When search_key is not supported.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_volume_list_in(lsm_connect *conn,
+                                      const char *search_key,
+                                      lsm_string_list *search_values,
+                                      lsm_volume ** volumes[],
+                                      uint32_t *count, lsm_flag flags);
+
+/**
+ * lsm_disk_list - Gets a list of disks on this connection.
+ *
+ * Version:
+ *      1.0
+ *
+ * Description:
+ *      Gets a list of disks on this connection.
+ *      Disk properties could be retrieved by these functions:
+ *          * lsm_disk_id_get()
+ *          * lsm_disk_name_get()
+ *          * lsm_disk_system_id_get()
+ *          * lsm_disk_type_get()
+ *          * lsm_disk_number_of_blocks_get()
+ *          * lsm_disk_block_size_get()
+ *          * lsm_disk_status_get()
+ *          * lsm_disk_location_get()
+ *          * lsm_disk_rpm_get()
+ *          * lsm_disk_link_type_get()
+ *          * lsm_disk_vpd83_get()
+ *
+ * Capability:
+ *      LSM_CAP_DISKS
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id", "system_id".
+ * @search_value:
+ *      Search value.
+ * @disks:
+ *      Output pointer of lsm_disk array. It should be manually freed by
+ *      lsm_disk_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of disks.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or searched value not found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid flags or invalid search
+ *              key.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_disk_list(lsm_connect *conn,
+                                 const char *search_key,
+                                 const char *search_value,
+                                 lsm_disk **disks[], uint32_t *count,
+                                 lsm_flag flags);
+
+/**
+ * lsm_disk_list_fields - Gets a list of disks with only some fields filled.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Same as lsm_disk_list(), but the plugin only sends back the requested
+ *      fields, which saves building, sending and parsing the rest when only
+ *      a few of them are needed, like for an inventory view.  The id is
+ *      always returned.  Fields which were not requested are left unset in
+ *      the returned records: strings read as NULL and numbers as 0.  Such
+ *      records should only be used for display, not handed back to other
+ *      calls.
+ *
+ * Capability:
+ *      LSM_CAP_DISKS
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id", "system_id".
+ * @search_value:
+ *      Search value.
+ * @fields:
+ *      Names of the fields to return, NULL for all of them.
+ *      Valid fields are: "id", "name", "disk_type", "block_size",
+ *      "num_of_blocks", "status", "system_id", "location", "rpm",
+ *      "link_type" and "vpd83".
+ * @disks:
+ *      Output pointer of lsm_disk array. It should be manually freed by
+ *      lsm_disk_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of disks.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or searched value not found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL, unknown field, invalid flags or
+ *              invalid search key.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_disk_list_fields(lsm_connect *conn,
+                                        const char *search_key,
+                                        const char *search_value,
+                                        lsm_string_list *fields,
+                                        lsm_disk ** disks[],
+                                        uint32_t *count, lsm_flag flags);
 
 /**
- * lsm_volume_list - Gets a list of volumes on this connection.
+ * lsm_disk_list_page - Gets one page of the disk list.
  *
  * Version:
- *      1.0
+ *      1.6
  *
  * Description:
- *      Gets a list of volumes on this connection.
- *      Volume properties could be retrieved by these functions:
- *          * lsm_volume_id_get()
- *          * lsm_volume_name_get()
- *          * lsm_volume_system_id_get()
- *          * lsm_volume_vpd83_get()
- *          * lsm_volume_number_of_blocks_get()
- *          * lsm_volume_block_size_get()
- *          * lsm_volume_admin_state_get()
- *          * lsm_volume_pool_id_get()
+ *      Same as lsm_disk_list(), but returns at most 'limit'
+ *      records at a time so that very large inventories can be walked
+ *      without holding the whole list in memory.  Pass a NULL cursor to get
+ *      the first page, then pass back the returned 'next_cursor' to get the
+ *      following one.  The cursor is an opaque string, do not parse or
+ *      build it.  Objects created or deleted while paging may or may not
+ *      show up.
  *
  * Capability:
- *      LSM_CAP_VOLUMES
+ *      LSM_CAP_DISKS
  *
  * @conn:
  *      Valid lsm_connect pointer.
  * @search_key:
  *      Search key(NULL for all).
- *      Valid search keys are: "id", "system_id" and "pool_id".
+ *      Valid search keys are: "id", "system_id".
  * @search_value:
  *      Search value.
- * @volumes:
- *      Output pointer of lsm_volume array. It should be manually freed by
- *      lsm_volume_record_array_free().
+ * @cursor:
+ *      NULL for the first page, otherwise a 'next_cursor' returned by a
+ *      previous call with the same search key and value.
+ * @limit:
+ *      Maximum number of records to return, must be greater than 0.
+ * @disks:
+ *      Output pointer of lsm_disk array. It should be manually freed by
+ *      lsm_disk_record_array_free().
  * @count:
- *      Output pointer of uint32_t. Number of volumes.
+ *      Output pointer of uint32_t. Number of records in this page.
+ * @next_cursor:
+ *      Output pointer of char *. Cursor of the next page, or NULL when this
+ *      was the last page. It should be manually freed by free().
  * @flags:
  *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
  *
@@ -611,37 +1900,33 @@ int LSM_DLL_EXPORT lsm_pool_list(lsm_connect *conn, char *search_key,
  *          * LSM_ERR_OK
  *              On success or searched value not found.
  *          * LSM_ERR_INVALID_ARGUMENT
- *              When any argument is NULL or invalid flags or invalid search
- *              key.
+ *              When any argument is NULL, limit is 0, cursor is invalid,
+ *              invalid flags or invalid search key.
  *          * LSM_ERR_NO_SUPPORT
  *              Not supported.
  */
-int LSM_DLL_EXPORT lsm_volume_list(lsm_connect *conn,
-                                   const char *search_key,
-                                   const char *search_value,
-                                   lsm_volume ** volumes[],
-                                   uint32_t *count, lsm_flag flags);
+int LSM_DLL_EXPORT lsm_disk_list_page(lsm_connect *conn,
+                                      const char *search_key,
+                                      const char *search_value,
+                                      const char *cursor,
+                                      uint32_t limit,
+                                      lsm_disk ** disks[],
+                                      uint32_t *count,
+                                      char **next_cursor,
+                                      lsm_flag flags);
 
 /**
- * lsm_disk_list - Gets a list of disks on this connection.
+ * lsm_disk_list_in - Gets the disks matching a list of values.
  *
  * Version:
- *      1.0
+ *      1.6
  *
  * Description:
- *      Gets a list of disks on this connection.
- *      Disk properties could be retrieved by these functions:
- *          * lsm_disk_id_get()
- *          * lsm_disk_name_get()
- *          * lsm_disk_system_id_get()
- *          * lsm_disk_type_get()
- *          * lsm_disk_number_of_blocks_get()
- *          * lsm_disk_block_size_get()
- *          * lsm_disk_status_get()
- *          * lsm_disk_location_get()
- *          * lsm_disk_rpm_get()
- *          * lsm_disk_link_type_get()
- *          * lsm_disk_vpd83_get()
+ *      Same as lsm_disk_list(), but returns every disk whose
+ *      search_key property is one of search_values, in a single request.
+ *      Use it instead of one lsm_disk_list() call per value, or a full
+ *      listing filtered on the client side.
+ *      Plug-ins which predate it are sent one request per value instead.
  *
  * Capability:
  *      LSM_CAP_DISKS
@@ -649,10 +1934,10 @@ int LSM_DLL_EXPORT lsm_volume_list(lsm_connect *conn,
  * @conn:
  *      Valid lsm_connect pointer.
  * @search_key:
- *      Search key(NULL for all).
+ *      Search key.
  *      Valid search keys are: "id", "system_id".
- * @search_value:
- *      Search value.
+ * @search_values:
+ *      Search values.
  * @disks:
  *      Output pointer of lsm_disk array. It should be manually freed by
  *      lsm_disk_record_array_free().
@@ -664,18 +1949,19 @@ int LSM_DLL_EXPORT lsm_volume_list(lsm_connect *conn,
  * Return:
  *      Error code as enumerated by 'lsm_error_number'.
  *          * LSM_ERR_OK
- *              On success or searched value not found.
+ *              On success or no searched value found.
  *          * LSM_ERR_INVALID_ARGUMENT
- *              When any argument is NULL or invalid flags or invalid search
- *              key.
+ *              When any argument is NULL or invalid flags.
+ *          * LSM_ERR_UNSUPPORTED_SEARCH_KEY
+ *              When search_key is not supported.
  *          * LSM_ERR_NO_SUPPORT
  *              Not supported.
  */
-int LSM_DLL_EXPORT lsm_disk_list(lsm_connect *conn,
-                                 const char *search_key,
-                                 const char *search_value,
-                                 lsm_disk **disks[], uint32_t *count,
-                                 lsm_flag flags);
+int LSM_DLL_EXPORT lsm_disk_list_in(lsm_connect *conn,
+                                    const char *search_key,
+                                    lsm_string_list *search_values,
+                                    lsm_disk ** disks[],
+                                    uint32_t *count, lsm_flag flags);
 
 /**
  * lsm_volume_create - Creates a new volume
@@ -1211,6 +2497,115 @@ int LSM_DLL_EXPORT lsm_access_group_list(lsm_connect *conn,
                                          uint32_t *group_count,
                                          lsm_flag flags);
 
+/**
+ * lsm_access_group_list_page - Gets one page of the access group list.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Same as lsm_access_group_list(), but returns at most 'limit'
+ *      records at a time so that very large inventories can be walked
+ *      without holding the whole list in memory.  Pass a NULL cursor to get
+ *      the first page, then pass back the returned 'next_cursor' to get the
+ *      following one.  The cursor is an opaque string, do not parse or
+ *      build it.  Objects created or deleted while paging may or may not
+ *      show up.
+ *
+ * Capability:
+ *      LSM_CAP_ACCESS_GROUPS
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id", "system_id".
+ * @search_value:
+ *      Search value.
+ * @cursor:
+ *      NULL for the first page, otherwise a 'next_cursor' returned by a
+ *      previous call with the same search key and value.
+ * @limit:
+ *      Maximum number of records to return, must be greater than 0.
+ * @groups:
+ *      Output pointer of lsm_access_group array. It should be manually freed by
+ *      lsm_access_group_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of records in this page.
+ * @next_cursor:
+ *      Output pointer of char *. Cursor of the next page, or NULL when this
+ *      was the last page. It should be manually freed by free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or searched value not found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL, limit is 0, cursor is invalid,
+ *              invalid flags or invalid search key.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_access_group_list_page(lsm_connect *conn,
+                                              const char *search_key,
+                                              const char *search_value,
+                                              const char *cursor,
+                                              uint32_t limit,
+                                              lsm_access_group ** groups[],
+                                              uint32_t *count,
+                                              char **next_cursor,
+                                              lsm_flag flags);
+
+/**
+ * lsm_access_group_list_in - Gets the access groups matching a list of values.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Same as lsm_access_group_list(), but returns every access group
+ *      whose search_key property is one of search_values, in a single request.
+ *      Use it instead of one lsm_access_group_list() call per value, or a full
+ *      listing filtered on the client side.
+ *      Plug-ins which predate it are sent one request per value instead.
+ *
+ * Capability:
+ *      LSM_CAP_ACCESS_GROUPS
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key.
+ *      Valid search keys are: "id", "system_id".
+ * @search_values:
+ *      Search values.
+ * @groups:
+ *      Output pointer of lsm_access_group array. It should be manually freed by
+ *      lsm_access_group_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of access groups.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or no searched value found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid flags.
+ *          * LSM_ERR_UNSUPPORTED_SEARCH_KEY
+ *              When search_key is not supported.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_access_group_list_in(lsm_connect *conn,
+                                            const char *search_key,
+                                            lsm_string_list *search_values,
+                                            lsm_access_group ** groups[],
+                                            uint32_t *count, lsm_flag flags);
+
 /**
  * lsm_access_group_create - Create a new access group.
  *
@@ -1774,6 +3169,115 @@ int LSM_DLL_EXPORT lsm_fs_list(lsm_connect *conn, const char *search_key,
                                const char *search_value, lsm_fs **fs[],
                                uint32_t *fs_count, lsm_flag flags);
 
+/**
+ * lsm_fs_list_page - Gets one page of the file system list.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Same as lsm_fs_list(), but returns at most 'limit'
+ *      records at a time so that very large inventories can be walked
+ *      without holding the whole list in memory.  Pass a NULL cursor to get
+ *      the first page, then pass back the returned 'next_cursor' to get the
+ *      following one.  The cursor is an opaque string, do not parse or
+ *      build it.  Objects created or deleted while paging may or may not
+ *      show up.
+ *
+ * Capability:
+ *      LSM_CAP_FS
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id", "system_id" and "pool_id".
+ * @search_value:
+ *      Search value.
+ * @cursor:
+ *      NULL for the first page, otherwise a 'next_cursor' returned by a
+ *      previous call with the same search key and value.
+ * @limit:
+ *      Maximum number of records to return, must be greater than 0.
+ * @fs:
+ *      Output pointer of lsm_fs array. It should be manually freed by
+ *      lsm_fs_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of records in this page.
+ * @next_cursor:
+ *      Output pointer of char *. Cursor of the next page, or NULL when this
+ *      was the last page. It should be manually freed by free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or searched value not found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL, limit is 0, cursor is invalid,
+ *              invalid flags or invalid search key.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_fs_list_page(lsm_connect *conn,
+                                    const char *search_key,
+                                    const char *search_value,
+                                    const char *cursor,
+                                    uint32_t limit,
+                                    lsm_fs ** fs[],
+                                    uint32_t *count,
+                                    char **next_cursor,
+                                    lsm_flag flags);
+
+/**
+ * lsm_fs_list_in - Gets the file systems matching a list of values.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Same as lsm_fs_list(), but returns every file system whose
+ *      search_key property is one of search_values, in a single request.
+ *      Use it instead of one lsm_fs_list() call per value, or a full
+ *      listing filtered on the client side.
+ *      Plug-ins which predate it are sent one request per value instead.
+ *
+ * Capability:
+ *      LSM_CAP_FS
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key.
+ *      Valid search keys are: "id", "system_id" and "pool_id".
+ * @search_values:
+ *      Search values.
+ * @fs:
+ *      Output pointer of lsm_fs array. It should be manually freed by
+ *      lsm_fs_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of file systems.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or no searched value found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid flags.
+ *          * LSM_ERR_UNSUPPORTED_SEARCH_KEY
+ *              When search_key is not supported.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_fs_list_in(lsm_connect *conn,
+                                  const char *search_key,
+                                  lsm_string_list *search_values,
+                                  lsm_fs ** fs[],
+                                  uint32_t *count, lsm_flag flags);
+
 /**
  * lsm_fs_create - Creates a new file system
  *
@@ -2408,6 +3912,115 @@ int LSM_DLL_EXPORT lsm_nfs_list(lsm_connect *conn,
                                 lsm_nfs_export **exports[],
                                 uint32_t *count, lsm_flag flags);
 
+/**
+ * lsm_nfs_list_page - Gets one page of the NFS export list.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Same as lsm_nfs_list(), but returns at most 'limit'
+ *      records at a time so that very large inventories can be walked
+ *      without holding the whole list in memory.  Pass a NULL cursor to get
+ *      the first page, then pass back the returned 'next_cursor' to get the
+ *      following one.  The cursor is an opaque string, do not parse or
+ *      build it.  Objects created or deleted while paging may or may not
+ *      show up.
+ *
+ * Capability:
+ *      LSM_CAP_EXPORTS
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id", "fs_id".
+ * @search_value:
+ *      Search value.
+ * @cursor:
+ *      NULL for the first page, otherwise a 'next_cursor' returned by a
+ *      previous call with the same search key and value.
+ * @limit:
+ *      Maximum number of records to return, must be greater than 0.
+ * @exports:
+ *      Output pointer of lsm_nfs_export array. It should be manually freed by
+ *      lsm_nfs_export_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of records in this page.
+ * @next_cursor:
+ *      Output pointer of char *. Cursor of the next page, or NULL when this
+ *      was the last page. It should be manually freed by free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or searched value not found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL, limit is 0, cursor is invalid,
+ *              invalid flags or invalid search key.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_nfs_list_page(lsm_connect *conn,
+                                     const char *search_key,
+                                     const char *search_value,
+                                     const char *cursor,
+                                     uint32_t limit,
+                                     lsm_nfs_export ** exports[],
+                                     uint32_t *count,
+                                     char **next_cursor,
+                                     lsm_flag flags);
+
+/**
+ * lsm_nfs_list_in - Gets the NFS exports matching a list of values.
+ *
+ * Version:
+ *      1.6
+ *
+ * Description:
+ *      Same as lsm_nfs_list(), but returns every NFS export whose
+ *      search_key property is one of search_values, in a single request.
+ *      Use it instead of one lsm_nfs_list() call per value, or a full
+ *      listing filtered on the client side.
+ *      Plug-ins which predate it are sent one request per value instead.
+ *
+ * Capability:
+ *      LSM_CAP_EXPORTS
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key.
+ *      Valid search keys are: "id", "fs_id".
+ * @search_values:
+ *      Search values.
+ * @exports:
+ *      Output pointer of lsm_nfs_export array. It should be manually freed by
+ *      lsm_nfs_export_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of NFS exports.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or no searched value found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid flags.
+ *          * LSM_ERR_UNSUPPORTED_SEARCH_KEY
+ *              When search_key is not supported.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_nfs_list_in(lsm_connect *conn,
+                                   const char *search_key,
+                                   lsm_string_list *search_values,
+                                   lsm_nfs_export ** exports[],
+                                   uint32_t *count, lsm_flag flags);
+
 /**
  * lsm_nfs_export_fs - Creates or modifies an NFS export.
  *
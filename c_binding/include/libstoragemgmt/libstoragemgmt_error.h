@@ -151,6 +151,9 @@ typedef lsm_error *lsm_error_ptr;
  *      Retrieves the last error of the lsm connection.
  *      Note: Address returned is valid until lsm_connect gets freed, copy
  *      return value if you need longer scope. Do not free returned pointer.
+ *      Thread safe. When threads share the connection this is the error
+ *      last logged by a call from any of them, which may not be the call
+ *      of the calling thread.
  *
  * @conn:
  *      lsm_connect pointer.
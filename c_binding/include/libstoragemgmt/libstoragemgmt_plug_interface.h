@@ -93,6 +93,26 @@ typedef int (*lsm_plugin_register) (lsm_plugin_ptr c, const char *uri,
  */
 typedef int (*lsm_plugin_unregister) (lsm_plugin_ptr c, lsm_flag flags);
 
+/**
+ * Batch begin callback function signature, called before the requests of a
+ * batch are handled.
+ * @param   c           Valid lsm plugin pointer
+ * @param   flags       Reserved
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success, anything else fails the whole batch.
+ */
+typedef int (*lsm_plug_batch_begin) (lsm_plugin_ptr c, lsm_flag flags);
+
+/**
+ * Batch end callback function signature, called once every request of a
+ * batch was handled, whether or not they succeeded.
+ * @param   c           Valid lsm plugin pointer
+ * @param   flags       Reserved
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success, anything else fails the whole batch.
+ */
+typedef int (*lsm_plug_batch_end) (lsm_plugin_ptr c, lsm_flag flags);
+
 /**
  * Set plug-in time-out value callback function signature
  * @param   c           Valid lsm plug-in pointer
@@ -1225,6 +1245,244 @@ struct lsm_ops_v1_3 {
     lsm_plug_volume_read_cache_policy_update vol_rcp_update;
 };
 
+/**
+ * Retrieve one page of volumes, callback function signature.  Pages are
+ * requested in order, each with the cursor the previous one returned.
+ * @param[in]   c               Valid lsm plug-in pointer
+ * @param[in]   search_key      Search key, NULL for all
+ * @param[in]   search_value    Search value
+ * @param[in]   cursor          NULL for the first page, else the
+ *                              next_cursor of the previous page
+ * @param[in]   limit           Maximum number of matching items to return,
+ *                              > 0.  Only the last page may be short.
+ * @param[out]  vol_array       Array of volumes
+ * @param[out]  count           Number of items in the page
+ * @param[out]  next_cursor     Opaque cursor of the next page, NULL when
+ *                              this was the last one.  Freed with free().
+ * @param[in]   flags           Reserved
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success.
+ */
+typedef int (*lsm_plug_volume_list_page) (lsm_plugin_ptr c,
+                                          const char *search_key,
+                                          const char *search_value,
+                                          const char *cursor, uint32_t limit,
+                                          lsm_volume **vol_array[],
+                                          uint32_t *count, char **next_cursor,
+                                          lsm_flag flags);
+
+/**
+ * Retrieve one page of disks, callback function signature.  Pages are
+ * requested in order, each with the cursor the previous one returned.
+ * @param[in]   c               Valid lsm plug-in pointer
+ * @param[in]   search_key      Search key, NULL for all
+ * @param[in]   search_value    Search value
+ * @param[in]   cursor          NULL for the first page, else the
+ *                              next_cursor of the previous page
+ * @param[in]   limit           Maximum number of matching items to return,
+ *                              > 0.  Only the last page may be short.
+ * @param[out]  disk_array      Array of disks
+ * @param[out]  count           Number of items in the page
+ * @param[out]  next_cursor     Opaque cursor of the next page, NULL when
+ *                              this was the last one.  Freed with free().
+ * @param[in]   flags           Reserved
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success.
+ */
+typedef int (*lsm_plug_disk_list_page) (lsm_plugin_ptr c,
+                                        const char *search_key,
+                                        const char *search_value,
+                                        const char *cursor, uint32_t limit,
+                                        lsm_disk **disk_array[],
+                                        uint32_t *count, char **next_cursor,
+                                        lsm_flag flags);
+
+/**
+ * Retrieve one page of access groups, callback function signature.  Pages are
+ * requested in order, each with the cursor the previous one returned.
+ * @param[in]   c               Valid lsm plug-in pointer
+ * @param[in]   search_key      Search key, NULL for all
+ * @param[in]   search_value    Search value
+ * @param[in]   cursor          NULL for the first page, else the
+ *                              next_cursor of the previous page
+ * @param[in]   limit           Maximum number of matching items to return,
+ *                              > 0.  Only the last page may be short.
+ * @param[out]  groups          Array of access groups
+ * @param[out]  count           Number of items in the page
+ * @param[out]  next_cursor     Opaque cursor of the next page, NULL when
+ *                              this was the last one.  Freed with free().
+ * @param[in]   flags           Reserved
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success.
+ */
+typedef int (*lsm_plug_access_group_list_page) (lsm_plugin_ptr c,
+                                                const char *search_key,
+                                                const char *search_value,
+                                                const char *cursor,
+                                                uint32_t limit,
+                                                lsm_access_group **groups[],
+                                                uint32_t *count,
+                                                char **next_cursor,
+                                                lsm_flag flags);
+
+/**
+ * Retrieve one page of file systems, callback function signature.  Pages are
+ * requested in order, each with the cursor the previous one returned.
+ * @param[in]   c               Valid lsm plug-in pointer
+ * @param[in]   search_key      Search key, NULL for all
+ * @param[in]   search_value    Search value
+ * @param[in]   cursor          NULL for the first page, else the
+ *                              next_cursor of the previous page
+ * @param[in]   limit           Maximum number of matching items to return,
+ *                              > 0.  Only the last page may be short.
+ * @param[out]  fs              Array of file systems
+ * @param[out]  count           Number of items in the page
+ * @param[out]  next_cursor     Opaque cursor of the next page, NULL when
+ *                              this was the last one.  Freed with free().
+ * @param[in]   flags           Reserved
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success.
+ */
+typedef int (*lsm_plug_fs_list_page) (lsm_plugin_ptr c,
+                                      const char *search_key,
+                                      const char *search_value,
+                                      const char *cursor, uint32_t limit,
+                                      lsm_fs **fs[],
+                                      uint32_t *count, char **next_cursor,
+                                      lsm_flag flags);
+
+/**
+ * Retrieve one page of NFS exports, callback function signature.  Pages are
+ * requested in order, each with the cursor the previous one returned.
+ * @param[in]   c               Valid lsm plug-in pointer
+ * @param[in]   search_key      Search key, NULL for all
+ * @param[in]   search_value    Search value
+ * @param[in]   cursor          NULL for the first page, else the
+ *                              next_cursor of the previous page
+ * @param[in]   limit           Maximum number of matching items to return,
+ *                              > 0.  Only the last page may be short.
+ * @param[out]  exports         Array of NFS exports
+ * @param[out]  count           Number of items in the page
+ * @param[out]  next_cursor     Opaque cursor of the next page, NULL when
+ *                              this was the last one.  Freed with free().
+ * @param[in]   flags           Reserved
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success.
+ */
+typedef int (*lsm_plug_nfs_list_page) (lsm_plugin_ptr c,
+                                       const char *search_key,
+                                       const char *search_value,
+                                       const char *cursor, uint32_t limit,
+                                       lsm_nfs_export **exports[],
+                                       uint32_t *count, char **next_cursor,
+                                       lsm_flag flags);
+
+/**
+ * Retrieve the volumes whose search_key field is any of search_values,
+ * callback function signature.
+ * @param[in]   c               Valid lsm plug-in pointer
+ * @param[in]   search_key      Search key
+ * @param[in]   search_values   Values to match
+ * @param[out]  vol_array       Array of volumes
+ * @param[out]  count           Number of items returned
+ * @param[in]   flags           Reserved
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success.
+ */
+typedef int (*lsm_plug_volume_list_in) (lsm_plugin_ptr c,
+                                        const char *search_key,
+                                        lsm_string_list *search_values,
+                                        lsm_volume **vol_array[],
+                                        uint32_t *count, lsm_flag flags);
+
+/**
+ * Retrieve the disks whose search_key field is any of search_values,
+ * callback function signature.
+ * @param[in]   c               Valid lsm plug-in pointer
+ * @param[in]   search_key      Search key
+ * @param[in]   search_values   Values to match
+ * @param[out]  disk_array      Array of disks
+ * @param[out]  count           Number of items returned
+ * @param[in]   flags           Reserved
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success.
+ */
+typedef int (*lsm_plug_disk_list_in) (lsm_plugin_ptr c,
+                                      const char *search_key,
+                                      lsm_string_list *search_values,
+                                      lsm_disk **disk_array[],
+                                      uint32_t *count, lsm_flag flags);
+
+/**
+ * Retrieve the access groups whose search_key field is any of search_values,
+ * callback function signature.
+ * @param[in]   c               Valid lsm plug-in pointer
+ * @param[in]   search_key      Search key
+ * @param[in]   search_values   Values to match
+ * @param[out]  groups          Array of access groups
+ * @param[out]  count           Number of items returned
+ * @param[in]   flags           Reserved
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success.
+ */
+typedef int (*lsm_plug_access_group_list_in) (lsm_plugin_ptr c,
+                                              const char *search_key,
+                                              lsm_string_list *search_values,
+                                              lsm_access_group **groups[],
+                                              uint32_t *count, lsm_flag flags);
+
+/**
+ * Retrieve the file systems whose search_key field is any of search_values,
+ * callback function signature.
+ * @param[in]   c               Valid lsm plug-in pointer
+ * @param[in]   search_key      Search key
+ * @param[in]   search_values   Values to match
+ * @param[out]  fs              Array of file systems
+ * @param[out]  count           Number of items returned
+ * @param[in]   flags           Reserved
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success.
+ */
+typedef int (*lsm_plug_fs_list_in) (lsm_plugin_ptr c,
+                                    const char *search_key,
+                                    lsm_string_list *search_values,
+                                    lsm_fs **fs[],
+                                    uint32_t *count, lsm_flag flags);
+
+/**
+ * Retrieve the NFS exports whose search_key field is any of search_values,
+ * callback function signature.
+ * @param[in]   c               Valid lsm plug-in pointer
+ * @param[in]   search_key      Search key
+ * @param[in]   search_values   Values to match
+ * @param[out]  exports         Array of NFS exports
+ * @param[out]  count           Number of items returned
+ * @param[in]   flags           Reserved
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success.
+ */
+typedef int (*lsm_plug_nfs_list_in) (lsm_plugin_ptr c,
+                                     const char *search_key,
+                                     lsm_string_list *search_values,
+                                     lsm_nfs_export **exports[],
+                                     uint32_t *count, lsm_flag flags);
+
+/** \struct lsm_ops_v1_6
+ * \brief Functions added in version 1.6
+ */
+struct lsm_ops_v1_6 {
+    lsm_plug_volume_list_page vol_list_page;
+    lsm_plug_disk_list_page disk_list_page;
+    lsm_plug_access_group_list_page ag_list_page;
+    lsm_plug_fs_list_page fs_list_page;
+    lsm_plug_nfs_list_page nfs_list_page;
+    lsm_plug_volume_list_in vol_list_in;
+    lsm_plug_disk_list_in disk_list_in;
+    lsm_plug_access_group_list_in ag_list_in;
+    lsm_plug_fs_list_in fs_list_in;
+    lsm_plug_nfs_list_in nfs_list_in;
+};
+
 /**
  * Copies the memory pointed to by item with given type t.
  * @param t         Type of item to copy
@@ -1312,12 +1570,73 @@ int LSM_DLL_EXPORT lsm_register_plugin_v1_3(lsm_plugin_ptr plug,
                                             struct lsm_ops_v1_2 *ops_v1_2,
                                             struct lsm_ops_v1_3 *ops_v1_3);
 
+/**
+ * Used to register all the data needed for the plug-in operation.
+ * @param plug              Pointer provided by the framework
+ * @param private_data      Private data to be used for whatever the plug-in
+ *                          needs
+ * @param mgm_ops           Function pointers for struct lsm_mgmt_ops_v1
+ * @param san_ops           Function pointers for struct lsm_san_ops_v1
+ * @param fs_ops            Function pointers for struct lsm_fs_ops_v1
+ * @param nas_ops           Function pointers for struct lsm_nas_ops_v1
+ * @param ops_v1_2          Function pointers for struct lsm_ops_v1_2
+ * @param ops_v1_3          Function pointers for struct lsm_ops_v1_3
+ * @param ops_v1_6          Function pointers for struct lsm_ops_v1_6
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success.
+ */
+int LSM_DLL_EXPORT lsm_register_plugin_v1_6(lsm_plugin_ptr plug,
+                                            void *private_data,
+                                            struct lsm_mgmt_ops_v1 *mgm_ops,
+                                            struct lsm_san_ops_v1 *san_ops,
+                                            struct lsm_fs_ops_v1 *fs_ops,
+                                            struct lsm_nas_ops_v1 *nas_ops,
+                                            struct lsm_ops_v1_2 *ops_v1_2,
+                                            struct lsm_ops_v1_3 *ops_v1_3,
+                                            struct lsm_ops_v1_6 *ops_v1_6);
+
 /**
  * Used to retrieve private data for plug-in operation.
  * @param plug  Opaque plug-in pointer.
  */
 void LSM_DLL_EXPORT *lsm_private_data_get(lsm_plugin_ptr plug);
 
+/**
+ * Opts in to requests being handled by a pool of threads, so a slow request
+ * does not hold up the ones behind it.  Responses are sent as requests
+ * complete, clients which negotiated protocol version 2 match them up by id.
+ * Call from the plug-in register callback, all the plug-in callbacks must be
+ * thread safe.  Errors logged with lsm_log_error_basic() and
+ * lsm_plugin_error_log() stay with the request being handled.
+ * @param plug          Pointer provided by the framework
+ * @param count         Number of handler threads, 0 (default) handles one
+ *                      request at a time on the main thread
+ * @param flags         Reserved, set to LSM_CLIENT_FLAG_RSVD
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success.
+ */
+int LSM_DLL_EXPORT lsm_plugin_thread_count_set(lsm_plugin_ptr plug,
+                                               uint32_t count,
+                                               lsm_flag flags);
+
+/**
+ * Registers callbacks wrapped around the handling of a "batch" request, for
+ * example to run all of its requests in one transaction.  The framework
+ * handles the requests of a batch one at a time through the regular
+ * callbacks in between, a request which fails does not stop the ones after
+ * it.  Call from the plug-in register callback.
+ * @param plug          Pointer provided by the framework
+ * @param begin         Called before the first request, may be NULL
+ * @param end           Called after the last request, may be NULL
+ * @param flags         Reserved, set to LSM_CLIENT_FLAG_RSVD
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success.
+ */
+int LSM_DLL_EXPORT lsm_plugin_batch_hooks_set(lsm_plugin_ptr plug,
+                                              lsm_plug_batch_begin begin,
+                                              lsm_plug_batch_end end,
+                                              lsm_flag flags);
+
 
 /**
  * Logs an error with the plug-in
@@ -1787,6 +2106,80 @@ void LSM_DLL_EXPORT
                                       lsm_nfs_export *exports[],
                                       uint32_t *count);
 
+/**
+ * Same as lsm_plug_volume_search_filter(), but keeps the volumes whose
+ * search_key field is any of search_values.
+ * Note: Filters in place removing and freeing those that don't match.
+ * @param search_key        Search field
+ * @param search_values     Search values
+ * @param[in,out] vols      Array to filter
+ * @param[in,out] count     Number of volumes to filter, number remain
+ */
+void LSM_DLL_EXPORT
+    lsm_plug_volume_search_filter_in(const char *search_key,
+                                     lsm_string_list *search_values,
+                                     lsm_volume *vols[],
+                                     uint32_t *count);
+
+/**
+ * Same as lsm_plug_disk_search_filter(), but keeps the disks whose
+ * search_key field is any of search_values.
+ * Note: Filters in place removing and freeing those that don't match.
+ * @param search_key        Search field
+ * @param search_values     Search values
+ * @param[in,out] disks     Array to filter
+ * @param[in,out] count     Number of disks to filter, number remain
+ */
+void LSM_DLL_EXPORT
+    lsm_plug_disk_search_filter_in(const char *search_key,
+                                   lsm_string_list *search_values,
+                                   lsm_disk *disks[],
+                                   uint32_t *count);
+
+/**
+ * Same as lsm_plug_access_group_search_filter(), but keeps the access
+ * groups whose search_key field is any of search_values.
+ * Note: Filters in place removing and freeing those that don't match.
+ * @param search_key        Search field
+ * @param search_values     Search values
+ * @param[in,out] ag        Array to filter
+ * @param[in,out] count     Number of access groups to filter, number remain
+ */
+void LSM_DLL_EXPORT
+    lsm_plug_access_group_search_filter_in(const char *search_key,
+                                           lsm_string_list *search_values,
+                                           lsm_access_group *ag[],
+                                           uint32_t *count);
+
+/**
+ * Same as lsm_plug_fs_search_filter(), but keeps the file systems whose
+ * search_key field is any of search_values.
+ * Note: Filters in place removing and freeing those that don't match.
+ * @param search_key        Search field
+ * @param search_values     Search values
+ * @param[in,out] fs        Array to filter
+ * @param[in,out] count     Number of file systems to filter, number remain
+ */
+void LSM_DLL_EXPORT lsm_plug_fs_search_filter_in(const char *search_key,
+                                                 lsm_string_list *search_values,
+                                                 lsm_fs *fs[],
+                                                 uint32_t *count);
+
+/**
+ * Same as lsm_plug_nfs_export_search_filter(), but keeps the nfs exports whose
+ * search_key field is any of search_values.
+ * Note: Filters in place removing and freeing those that don't match.
+ * @param search_key        Search field
+ * @param search_values     Search values
+ * @param[in,out] exports   Array to filter
+ * @param[in,out] count     Number of nfs exports to filter, number remain
+ */
+void LSM_DLL_EXPORT
+    lsm_plug_nfs_export_search_filter_in(const char *search_key,
+                                         lsm_string_list *search_values,
+                                         lsm_nfs_export *exports[],
+                                         uint32_t *count);
+
 /**
  * Retrieve private data from nfs export record.
  * @param exp       Valid nfs export record
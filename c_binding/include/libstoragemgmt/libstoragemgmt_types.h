@@ -53,6 +53,16 @@ typedef uint64_t lsm_flag;
  */
 typedef struct _lsm_connect lsm_connect;
 
+/**
+ * Opaque data type for a pool of connections.
+ */
+typedef struct _lsm_connect_pool lsm_connect_pool;
+
+/**
+ * Opaque data type for a batch of requests sent in one round trip.
+ */
+typedef struct _lsm_batch lsm_batch;
+
 /**
  * Opaque data type for a block based storage unit
  */
@@ -129,6 +139,19 @@ typedef struct _lsm_target_port lsm_target_port;
  */
 typedef struct _lsm_battery lsm_battery;
 
+/** \enum lsm_cache_class Results the cache of a connection can hold, see
+ * lsm_connect_cache_ttl_set() */
+typedef enum {
+    /** Results of lsm_system_list() */
+    LSM_CACHE_SYSTEMS = 0,
+    /** Results of lsm_pool_list() */
+    LSM_CACHE_POOLS = 1,
+    /** Results of lsm_capabilities() */
+    LSM_CACHE_CAPABILITIES = 2,
+    /** Results of lsm_target_port_list() */
+    LSM_CACHE_TARGET_PORTS = 3
+} lsm_cache_class;
+
 /** \enum lsm_replication_type Different types of replications that can be
  * created */
 typedef enum {
@@ -27,16 +27,62 @@
 #include "libstoragemgmt/libstoragemgmt_battery.h"
 
 
-bool std_map_has_key(const std::map < std::string, Value > &x, const char *key)
+bool std_map_has_key(const ValueObject & x, const char *key)
 {
     return x.find(key) != x.end();
 }
 
-bool is_expected_object(Value & obj, std::string class_name)
+/*
+ * Fields of a record may be left out of a list reply when the client asked
+ * for only some of them, these read an absent field as unset.
+ */
+static const char *opt_str(const ValueObject & x, const char *key)
+{
+    ValueObject::const_iterator iter = x.find(key);
+    if (iter == x.end()) {
+        return NULL;
+    }
+    if (Value::null_t == iter->second.valueType()) {
+        return "";
+    }
+    return iter->second.asC_str();
+}
+
+static const Value null_field;
+
+/*
+ * Reads a field without adding it when absent, as operator[] does, which
+ * may move the other fields and leave pointers into them dangling.
+ */
+static const Value & field(const ValueObject & x, const char *key)
+{
+    ValueObject::const_iterator iter = x.find(key);
+    if (iter == x.end()) {
+        return null_field;
+    }
+    return iter->second;
+}
+
+static uint64_t opt_uint64(const ValueObject & x, const char *key)
+{
+    ValueObject::const_iterator iter = x.find(key);
+    if (iter == x.end()) {
+        return 0;
+    }
+    return iter->second.asUint64_t();
+}
+
+static bool field_wanted(const std::set < std::string > *fields,
+                         const char *field)
+{
+    return fields == NULL || fields->count(field) != 0;
+}
+
+bool is_expected_object(Value & obj, const std::string & class_name)
 {
     if (obj.valueType() == Value::object_t) {
-        std::map < std::string, Value > i = obj.asObject();
-        std::map < std::string, Value >::iterator iter = i.find("class");
+        const ValueObject & i = obj.asObject();
+        ValueObject::const_iterator iter = i.find("class");
         if (iter != i.end() && iter->second.asString() == class_name) {
             return true;
         }
@@ -49,17 +95,17 @@ lsm_volume *value_to_volume(Value & vol)
     lsm_volume *rc = NULL;
 
     if (is_expected_object(vol, CLASS_NAME_VOLUME)) {
-        std::map < std::string, Value > v = vol.asObject();
-
-        rc = lsm_volume_record_alloc(v["id"].asString().c_str(),
-                                     v["name"].asString().c_str(),
-                                     v["vpd83"].asString().c_str(),
-                                     v["block_size"].asUint64_t(),
-                                     v["num_of_blocks"].asUint64_t(),
-                                     v["admin_state"].asUint32_t(),
-                                     v["system_id"].asString().c_str(),
-                                     v["pool_id"].asString().c_str(),
-                                     v["plugin_data"].asC_str());
+        const ValueObject & v = vol.asObject();
+
+        rc = lsm_volume_record_alloc(field(v, "id").asString().c_str(),
+                                     opt_str(v, "name"),
+                                     opt_str(v, "vpd83"),
+                                     opt_uint64(v, "block_size"),
+                                     opt_uint64(v, "num_of_blocks"),
+                                     (uint32_t) opt_uint64(v, "admin_state"),
+                                     opt_str(v, "system_id"),
+                                     opt_str(v, "pool_id"),
+                                     field(v, "plugin_data").asC_str());
     } else {
         throw ValueException("value_to_volume: Not correct type");
     }
@@ -69,21 +115,37 @@ lsm_volume *value_to_volume(Value & vol)
 
 Value volume_to_value(lsm_volume * vol)
 {
+    return volume_to_value(vol, NULL);
+}
+
+Value volume_to_value(lsm_volume * vol,
+                      const std::set < std::string > *fields)
+{
+    Value rc;
+
     if (LSM_IS_VOL(vol)) {
-        std::map < std::string, Value > v;
+        rc = Value(Value::object_t);
+        ValueObject & v = rc.asObject();
         v["class"] = Value(CLASS_NAME_VOLUME);
         v["id"] = Value(vol->id);
-        v["name"] = Value(vol->name);
-        v["vpd83"] = Value(vol->vpd83);
-        v["block_size"] = Value(vol->block_size);
-        v["num_of_blocks"] = Value(vol->number_of_blocks);
-        v["admin_state"] = Value(vol->admin_state);
-        v["system_id"] = Value(vol->system_id);
-        v["pool_id"] = Value(vol->pool_id);
-        v["plugin_data"] = Value(vol->plugin_data);
-        return Value(v);
+        if (field_wanted(fields, "name"))
+            v["name"] = Value(vol->name);
+        if (field_wanted(fields, "vpd83"))
+            v["vpd83"] = Value(vol->vpd83);
+        if (field_wanted(fields, "block_size"))
+            v["block_size"] = Value(vol->block_size);
+        if (field_wanted(fields, "num_of_blocks"))
+            v["num_of_blocks"] = Value(vol->number_of_blocks);
+        if (field_wanted(fields, "admin_state"))
+            v["admin_state"] = Value(vol->admin_state);
+        if (field_wanted(fields, "system_id"))
+            v["system_id"] = Value(vol->system_id);
+        if (field_wanted(fields, "pool_id"))
+            v["pool_id"] = Value(vol->pool_id);
+        if (field_wanted(fields, "plugin_data"))
+            v["plugin_data"] = Value(vol->plugin_data);
     }
-    return Value();
+    return rc;
 }
 
 int value_array_to_volumes(Value & volume_values, lsm_volume ** volumes[],
@@ -94,7 +156,7 @@ int value_array_to_volumes(Value & volume_values, lsm_volume ** volumes[],
         *count = 0;
 
         if (Value::array_t == volume_values.valueType()) {
-            std::vector < Value > vol = volume_values.asArray();
+            std::vector < Value > &vol = volume_values.asArray();
 
             *count = vol.size();
 
@@ -136,19 +198,20 @@ lsm_disk *value_to_disk(Value & disk)
 {
     lsm_disk *rc = NULL;
     if (is_expected_object(disk, CLASS_NAME_DISK)) {
-        std::map < std::string, Value > d = disk.asObject();
-
-        rc = lsm_disk_record_alloc(d["id"].asString().c_str(),
-                                   d["name"].asString().c_str(),
-                                   (lsm_disk_type) d["disk_type"].asInt32_t(),
-                                   d["block_size"].asUint64_t(),
-                                   d["num_of_blocks"].asUint64_t(),
-                                   d["status"].asUint64_t(),
-                                   d["system_id"].asString().c_str()
+        const ValueObject & d = disk.asObject();
+
+        rc = lsm_disk_record_alloc(field(d, "id").asString().c_str(),
+                                   opt_str(d, "name"),
+                                   (lsm_disk_type) opt_uint64(d, "disk_type"),
+                                   opt_uint64(d, "block_size"),
+                                   opt_uint64(d, "num_of_blocks"),
+                                   opt_uint64(d, "status"),
+                                   opt_str(d, "system_id")
             );
         if ((rc != NULL) && std_map_has_key(d, "vpd83") &&
-            (d["vpd83"].asC_str()[0] != '\0' ) &&
-            (lsm_disk_vpd83_set(rc, d["vpd83"].asC_str()) != LSM_ERR_OK)) {
+            (field(d, "vpd83").asC_str()[0] != '\0' ) &&
+            (lsm_disk_vpd83_set(rc, field(d, "vpd83").asC_str()) !=
+             LSM_ERR_OK)) {
 
             lsm_disk_record_free(rc);
             rc= NULL;
@@ -156,9 +219,9 @@ lsm_disk *value_to_disk(Value & disk)
         }
 
         if ((rc != NULL) && std_map_has_key(d, "location") &&
-            (d["location"].asC_str()[0] != '\0')) {
+            (field(d, "location").asC_str()[0] != '\0')) {
 
-            if (lsm_disk_location_set(rc, d["location"].asC_str()) !=
+            if (lsm_disk_location_set(rc, field(d, "location").asC_str()) !=
                 LSM_ERR_OK) {
                 lsm_disk_record_free(rc);
                 rc = NULL;
@@ -167,17 +230,19 @@ lsm_disk *value_to_disk(Value & disk)
             }
         }
         if ((rc != NULL) && std_map_has_key(d, "rpm") &&
-            (d["rpm"].asInt32_t() != LSM_DISK_RPM_NO_SUPPORT)) {
-            if (lsm_disk_rpm_set(rc, d["rpm"].asInt32_t()) != LSM_ERR_OK) {
+            (field(d, "rpm").asInt32_t() != LSM_DISK_RPM_NO_SUPPORT)) {
+            if (lsm_disk_rpm_set(rc, field(d, "rpm").asInt32_t()) !=
+                LSM_ERR_OK) {
                 lsm_disk_record_free(rc);
                 rc = NULL;
                 throw ValueException("value_to_disk: failed to update rpm");
             }
         }
         if ((rc != NULL) && std_map_has_key(d, "link_type") &&
-            (d["link_type"].asInt32_t() != LSM_DISK_LINK_TYPE_NO_SUPPORT)) {
+            (field(d, "link_type").asInt32_t() !=
+             LSM_DISK_LINK_TYPE_NO_SUPPORT)) {
             if (lsm_disk_link_type_set(rc, (lsm_disk_link_type)
-                                       d["link_type"].asInt32_t()) !=
+                                       field(d, "link_type").asInt32_t()) !=
                 LSM_ERR_OK) {
                 lsm_disk_record_free(rc);
                 rc = NULL;
@@ -194,28 +259,42 @@ lsm_disk *value_to_disk(Value & disk)
 
 Value disk_to_value(lsm_disk * disk)
 {
+    return disk_to_value(disk, NULL);
+}
+
+Value disk_to_value(lsm_disk * disk, const std::set < std::string > *fields)
+{
+    Value rc;
+
     if (LSM_IS_DISK(disk)) {
-        std::map < std::string, Value > d;
+        rc = Value(Value::object_t);
+        ValueObject & d = rc.asObject();
         d["class"] = Value(CLASS_NAME_DISK);
         d["id"] = Value(disk->id);
-        d["name"] = Value(disk->name);
-        d["disk_type"] = Value(disk->type);
-        d["block_size"] = Value(disk->block_size);
-        d["num_of_blocks"] = Value(disk->number_of_blocks);
-        d["status"] = Value(disk->status);
-        d["system_id"] = Value(disk->system_id);
-        if (disk->location != NULL)
+        if (field_wanted(fields, "name"))
+            d["name"] = Value(disk->name);
+        if (field_wanted(fields, "disk_type"))
+            d["disk_type"] = Value(disk->type);
+        if (field_wanted(fields, "block_size"))
+            d["block_size"] = Value(disk->block_size);
+        if (field_wanted(fields, "num_of_blocks"))
+            d["num_of_blocks"] = Value(disk->number_of_blocks);
+        if (field_wanted(fields, "status"))
+            d["status"] = Value(disk->status);
+        if (field_wanted(fields, "system_id"))
+            d["system_id"] = Value(disk->system_id);
+        if (disk->location != NULL && field_wanted(fields, "location"))
             d["location"] = Value(disk->location);
-        if (disk->rpm != LSM_DISK_RPM_NO_SUPPORT)
+        if (disk->rpm != LSM_DISK_RPM_NO_SUPPORT &&
+            field_wanted(fields, "rpm"))
             d["rpm"] = Value(disk->rpm);
-        if (disk->link_type != LSM_DISK_LINK_TYPE_NO_SUPPORT)
+        if (disk->link_type != LSM_DISK_LINK_TYPE_NO_SUPPORT &&
+            field_wanted(fields, "link_type"))
             d["link_type"] = Value(disk->link_type);
-        if (disk->vpd83 != NULL)
+        if (disk->vpd83 != NULL && field_wanted(fields, "vpd83"))
             d["vpd83"] = Value(disk->vpd83);
-
-        return Value(d);
     }
-    return Value();
+    return rc;
 }
 
 int value_array_to_disks(Value & disk_values, lsm_disk ** disks[],
@@ -226,7 +305,7 @@ int value_array_to_disks(Value & disk_values, lsm_disk ** disks[],
         *count = 0;
 
         if (Value::array_t == disk_values.valueType()) {
-            std::vector < Value > d = disk_values.asArray();
+            std::vector < Value > &d = disk_values.asArray();
 
             *count = d.size();
 
@@ -269,18 +348,18 @@ lsm_pool *value_to_pool(Value & pool)
     lsm_pool *rc = NULL;
 
     if (is_expected_object(pool, CLASS_NAME_POOL)) {
-        std::map < std::string, Value > i = pool.asObject();
-
-        rc = lsm_pool_record_alloc(i["id"].asString().c_str(),
-                                   i["name"].asString().c_str(),
-                                   i["element_type"].asUint64_t(),
-                                   i["unsupported_actions"].asUint64_t(),
-                                   i["total_space"].asUint64_t(),
-                                   i["free_space"].asUint64_t(),
-                                   i["status"].asUint64_t(),
-                                   i["status_info"].asString().c_str(),
-                                   i["system_id"].asString().c_str(),
-                                   i["plugin_data"].asC_str());
+        const ValueObject & i = pool.asObject();
+
+        rc = lsm_pool_record_alloc(field(i, "id").asString().c_str(),
+                                   field(i, "name").asString().c_str(),
+                                   field(i, "element_type").asUint64_t(),
+                                   field(i, "unsupported_actions").asUint64_t(),
+                                   field(i, "total_space").asUint64_t(),
+                                   field(i, "free_space").asUint64_t(),
+                                   field(i, "status").asUint64_t(),
+                                   field(i, "status_info").asString().c_str(),
+                                   field(i, "system_id").asString().c_str(),
+                                   field(i, "plugin_data").asC_str());
     } else {
         throw ValueException("value_to_pool: Not correct type");
     }
@@ -289,8 +368,11 @@ lsm_pool *value_to_pool(Value & pool)
 
 Value pool_to_value(lsm_pool * pool)
 {
+    Value rc;
+
     if (LSM_IS_POOL(pool)) {
-        std::map < std::string, Value > p;
+        rc = Value(Value::object_t);
+        ValueObject & p = rc.asObject();
         p["class"] = Value(CLASS_NAME_POOL);
         p["id"] = Value(pool->id);
         p["name"] = Value(pool->name);
@@ -302,26 +384,26 @@ Value pool_to_value(lsm_pool * pool)
         p["status_info"] = Value(pool->status_info);
         p["system_id"] = Value(pool->system_id);
         p["plugin_data"] = Value(pool->plugin_data);
-        return Value(p);
     }
-    return Value();
+    return rc;
 }
 
 lsm_system *value_to_system(Value & system)
 {
     lsm_system *rc = NULL;
     if (is_expected_object(system, CLASS_NAME_SYSTEM)) {
-        std::map < std::string, Value > i = system.asObject();
+        const ValueObject & i = system.asObject();
 
-        rc = lsm_system_record_alloc(i["id"].asString().c_str(),
-                                     i["name"].asString().c_str(),
-                                     i["status"].asUint32_t(),
-                                     i["status_info"].asString().c_str(),
-                                     i["plugin_data"].asC_str());
+        rc = lsm_system_record_alloc(field(i, "id").asString().c_str(),
+                                     field(i, "name").asString().c_str(),
+                                     field(i, "status").asUint32_t(),
+                                     field(i, "status_info").asString().c_str(),
+                                     field(i, "plugin_data").asC_str());
         if ((rc != NULL) && std_map_has_key(i, "fw_version") &&
-            (i["fw_version"].asC_str()[0] != '\0')) {
+            (field(i, "fw_version").asC_str()[0] != '\0')) {
 
-            if (lsm_system_fw_version_set(rc, i["fw_version"].asC_str()) !=
+            if (lsm_system_fw_version_set(rc,
+                                          field(i, "fw_version").asC_str()) !=
                 LSM_ERR_OK) {
                 lsm_system_record_free(rc);
                 rc= NULL;
@@ -330,20 +412,20 @@ lsm_system *value_to_system(Value & system)
             }
         }
         if ((rc != NULL) && std_map_has_key(i, "mode") &&
-            (i["mode"].asInt32_t() != LSM_SYSTEM_MODE_NO_SUPPORT) &&
+            (field(i, "mode").asInt32_t() != LSM_SYSTEM_MODE_NO_SUPPORT) &&
             (lsm_system_mode_set(rc, (lsm_system_mode_type)
-                                 i["mode"].asInt32_t()))) {
+                                 field(i, "mode").asInt32_t()))) {
 
             lsm_system_record_free(rc);
             rc= NULL;
             throw ValueException("value_to_system: failed to update 'mode'");
         }
         if ((rc != NULL) && std_map_has_key(i, "read_cache_pct") &&
-            (i["read_cache_pct"].asInt32_t() !=
+            (field(i, "read_cache_pct").asInt32_t() !=
             LSM_SYSTEM_READ_CACHE_PCT_NO_SUPPORT)) {
 
             if (lsm_system_read_cache_pct_set(rc,
-                i["read_cache_pct"].asInt32_t()) != LSM_ERR_OK) {
+                field(i, "read_cache_pct").asInt32_t()) != LSM_ERR_OK) {
                 lsm_system_record_free(rc);
                 rc= NULL;
                 throw ValueException("value_to_system: failed to update "
@@ -358,8 +440,11 @@ lsm_system *value_to_system(Value & system)
 
 Value system_to_value(lsm_system * system)
 {
+    Value rc;
+
     if (LSM_IS_SYSTEM(system)) {
-        std::map < std::string, Value > s;
+        rc = Value(Value::object_t);
+        ValueObject & s = rc.asObject();
         s["class"] = Value(CLASS_NAME_SYSTEM);
         s["id"] = Value(system->id);
         s["name"] = Value(system->name);
@@ -372,17 +457,16 @@ Value system_to_value(lsm_system * system)
             s["mode"] = Value(system->mode);
         if (system->read_cache_pct != LSM_SYSTEM_READ_CACHE_PCT_NO_SUPPORT)
             s["read_cache_pct"] = Value(system->read_cache_pct);
-        return Value(s);
     }
-    return Value();
+    return rc;
 }
 
-lsm_string_list *value_to_string_list(Value & v)
+lsm_string_list *value_to_string_list(const Value & v)
 {
     lsm_string_list *il = NULL;
 
     if (Value::array_t == v.valueType()) {
-        std::vector < Value > vl = v.asArray();
+        const std::vector < Value > &vl = v.asArray();
         uint32_t size = vl.size();
         il = lsm_string_list_alloc(size);
 
@@ -404,16 +488,18 @@ lsm_string_list *value_to_string_list(Value & v)
 
 Value string_list_to_value(lsm_string_list * sl)
 {
-    std::vector < Value > rc;
+    Value rc(Value::array_t);
+    std::vector < Value > &array = rc.asArray();
+
     if (LSM_IS_STRING_LIST(sl)) {
         uint32_t size = lsm_string_list_size(sl);
-        rc.reserve(size);
+        array.reserve(size);
 
         for (uint32_t i = 0; i < size; ++i) {
-            rc.push_back(Value(lsm_string_list_elem_get(sl, i)));
+            array.push_back(Value(lsm_string_list_elem_get(sl, i)));
         }
     }
-    return Value(rc);
+    return rc;
 }
 
 lsm_access_group *value_to_access_group(Value & group)
@@ -422,17 +508,22 @@ lsm_access_group *value_to_access_group(Value & group)
     lsm_access_group *ag = NULL;
 
     if (is_expected_object(group, CLASS_NAME_ACCESS_GROUP)) {
-        std::map < std::string, Value > vAg = group.asObject();
-        il = value_to_string_list(vAg["init_ids"]);
+        const ValueObject & vAg = group.asObject();
+        il = value_to_string_list(field(vAg, "init_ids"));
 
         if (il) {
-            ag = lsm_access_group_record_alloc(vAg["id"].asString().c_str(),
-                                               vAg["name"].asString().c_str(),
+            const Value & id = field(vAg, "id");
+            const Value & name = field(vAg, "name");
+            const Value & init_type = field(vAg, "init_type");
+            const Value & system_id = field(vAg, "system_id");
+            const Value & plugin_data = field(vAg, "plugin_data");
+
+            ag = lsm_access_group_record_alloc(id.asString().c_str(),
+                                               name.asString().c_str(),
                                                il, (lsm_access_group_init_type)
-                                               vAg["init_type"].asInt32_t(),
-                                               vAg["system_id"].
-                                               asString().c_str(),
-                                               vAg["plugin_data"].asC_str());
+                                               init_type.asInt32_t(),
+                                               system_id.asString().c_str(),
+                                               plugin_data.asC_str());
         }
         /* This stuff is copied in lsm_access_group_record_alloc */
         lsm_string_list_free(il);
@@ -444,8 +535,11 @@ lsm_access_group *value_to_access_group(Value & group)
 
 Value access_group_to_value(lsm_access_group * group)
 {
+    Value rc;
+
     if (LSM_IS_ACCESS_GROUP(group)) {
-        std::map < std::string, Value > ag;
+        rc = Value(Value::object_t);
+        ValueObject & ag = rc.asObject();
         ag["class"] = Value(CLASS_NAME_ACCESS_GROUP);
         ag["id"] = Value(group->id);
         ag["name"] = Value(group->name);
@@ -453,9 +547,8 @@ Value access_group_to_value(lsm_access_group * group)
         ag["init_type"] = Value(group->init_type);
         ag["system_id"] = Value(group->system_id);
         ag["plugin_data"] = Value(group->plugin_data);
-        return Value(ag);
     }
-    return Value();
+    return rc;
 }
 
 int value_array_to_access_groups(Value & group,
@@ -465,7 +558,7 @@ int value_array_to_access_groups(Value & group,
     int rc = LSM_ERR_OK;
 
     try {
-        std::vector < Value > ag = group.asArray();
+        std::vector < Value > &ag = group.asArray();
         *count = ag.size();
 
         if (*count) {
@@ -503,27 +596,32 @@ int value_array_to_access_groups(Value & group,
 
 Value access_group_list_to_value(lsm_access_group ** group, uint32_t count)
 {
-    std::vector < Value > rc;
+    Value rc(Value::array_t);
+    std::vector < Value > &array = rc.asArray();
+
 
     if (group && count) {
         uint32_t i;
-        rc.reserve(count);
+        array.reserve(count);
         for (i = 0; i < count; ++i) {
-            rc.push_back(access_group_to_value(group[i]));
+            array.push_back(access_group_to_value(group[i]));
         }
     }
-    return Value(rc);
+    return rc;
 }
 
 lsm_block_range *value_to_block_range(Value & br)
 {
     lsm_block_range *rc = NULL;
     if (is_expected_object(br, CLASS_NAME_BLOCK_RANGE)) {
-        std::map < std::string, Value > range = br.asObject();
-
-        rc = lsm_block_range_record_alloc(range["src_block"].asUint64_t(),
-                                          range["dest_block"].asUint64_t(),
-                                          range["block_count"].asUint64_t());
+        const ValueObject & range = br.asObject();
+        const Value & src_block = field(range, "src_block");
+        const Value & dest_block = field(range, "dest_block");
+        const Value & block_count = field(range, "block_count");
+
+        rc = lsm_block_range_record_alloc(src_block.asUint64_t(),
+                                          dest_block.asUint64_t(),
+                                          block_count.asUint64_t());
     } else {
         throw ValueException("value_to_block_range: Not correct type");
     }
@@ -532,21 +630,23 @@ lsm_block_range *value_to_block_range(Value & br)
 
 Value block_range_to_value(lsm_block_range * br)
 {
+    Value rc;
+
     if (LSM_IS_BLOCK_RANGE(br)) {
-        std::map < std::string, Value > r;
+        rc = Value(Value::object_t);
+        ValueObject & r = rc.asObject();
         r["class"] = Value(CLASS_NAME_BLOCK_RANGE);
         r["src_block"] = Value(br->source_start);
         r["dest_block"] = Value(br->dest_start);
         r["block_count"] = Value(br->block_count);
-        return Value(r);
     }
-    return Value();
+    return rc;
 }
 
 lsm_block_range **value_to_block_range_list(Value & brl, uint32_t * count)
 {
     lsm_block_range **rc = NULL;
-    std::vector < Value > r = brl.asArray();
+    std::vector < Value > &r = brl.asArray();
     *count = r.size();
     if (*count) {
         rc = lsm_block_range_record_array_alloc(*count);
@@ -566,30 +666,32 @@ lsm_block_range **value_to_block_range_list(Value & brl, uint32_t * count)
 
 Value block_range_list_to_value(lsm_block_range ** brl, uint32_t count)
 {
-    std::vector < Value > r;
+    Value rc(Value::array_t);
+    std::vector < Value > &array = rc.asArray();
+
     if (brl && count) {
         uint32_t i = 0;
-        r.reserve(count);
+        array.reserve(count);
         for (i = 0; i < count; ++i) {
-            r.push_back(block_range_to_value(brl[i]));
+            array.push_back(block_range_to_value(brl[i]));
         }
     }
-    return Value(r);
+    return rc;
 }
 
 lsm_fs *value_to_fs(Value & fs)
 {
     lsm_fs *rc = NULL;
     if (is_expected_object(fs, CLASS_NAME_FILE_SYSTEM)) {
-        std::map < std::string, Value > f = fs.asObject();
-
-        rc = lsm_fs_record_alloc(f["id"].asString().c_str(),
-                                 f["name"].asString().c_str(),
-                                 f["total_space"].asUint64_t(),
-                                 f["free_space"].asUint64_t(),
-                                 f["pool_id"].asString().c_str(),
-                                 f["system_id"].asString().c_str(),
-                                 f["plugin_data"].asC_str());
+        const ValueObject & f = fs.asObject();
+
+        rc = lsm_fs_record_alloc(field(f, "id").asString().c_str(),
+                                 field(f, "name").asString().c_str(),
+                                 field(f, "total_space").asUint64_t(),
+                                 field(f, "free_space").asUint64_t(),
+                                 field(f, "pool_id").asString().c_str(),
+                                 field(f, "system_id").asString().c_str(),
+                                 field(f, "plugin_data").asC_str());
     } else {
         throw ValueException("value_to_fs: Not correct type");
     }
@@ -598,8 +700,11 @@ lsm_fs *value_to_fs(Value & fs)
 
 Value fs_to_value(lsm_fs * fs)
 {
+    Value rc;
+
     if (LSM_IS_FS(fs)) {
-        std::map < std::string, Value > f;
+        rc = Value(Value::object_t);
+        ValueObject & f = rc.asObject();
         f["class"] = Value(CLASS_NAME_FILE_SYSTEM);
         f["id"] = Value(fs->id);
         f["name"] = Value(fs->name);
@@ -608,9 +713,8 @@ Value fs_to_value(lsm_fs * fs)
         f["pool_id"] = Value(fs->pool_id);
         f["system_id"] = Value(fs->system_id);
         f["plugin_data"] = Value(fs->plugin_data);
-        return Value(f);
     }
-    return Value();
+    return rc;
 }
 
 
@@ -618,12 +722,12 @@ lsm_fs_ss *value_to_ss(Value & ss)
 {
     lsm_fs_ss *rc = NULL;
     if (is_expected_object(ss, CLASS_NAME_FS_SNAPSHOT)) {
-        std::map < std::string, Value > f = ss.asObject();
+        const ValueObject & f = ss.asObject();
 
-        rc = lsm_fs_ss_record_alloc(f["id"].asString().c_str(),
-                                    f["name"].asString().c_str(),
-                                    f["ts"].asUint64_t(),
-                                    f["plugin_data"].asC_str());
+        rc = lsm_fs_ss_record_alloc(field(f, "id").asString().c_str(),
+                                    field(f, "name").asString().c_str(),
+                                    field(f, "ts").asUint64_t(),
+                                    field(f, "plugin_data").asC_str());
     } else {
         throw ValueException("value_to_ss: Not correct type");
     }
@@ -632,16 +736,18 @@ lsm_fs_ss *value_to_ss(Value & ss)
 
 Value ss_to_value(lsm_fs_ss * ss)
 {
+    Value rc;
+
     if (LSM_IS_SS(ss)) {
-        std::map < std::string, Value > f;
+        rc = Value(Value::object_t);
+        ValueObject & f = rc.asObject();
         f["class"] = Value(CLASS_NAME_FS_SNAPSHOT);
         f["id"] = Value(ss->id);
         f["name"] = Value(ss->name);
         f["ts"] = Value(ss->time_stamp);
         f["plugin_data"] = Value(ss->plugin_data);
-        return Value(f);
     }
-    return Value();
+    return rc;
 }
 
 lsm_nfs_export *value_to_nfs_export(Value & exp)
@@ -653,14 +759,14 @@ lsm_nfs_export *value_to_nfs_export(Value & exp)
         lsm_string_list *rw = NULL;
         lsm_string_list *ro = NULL;
 
-        std::map < std::string, Value > i = exp.asObject();
+        const ValueObject & i = exp.asObject();
 
         /* Check all the arrays for successful allocation */
-        root = value_to_string_list(i["root"]);
+        root = value_to_string_list(field(i, "root"));
         if (root) {
-            rw = value_to_string_list(i["rw"]);
+            rw = value_to_string_list(field(i, "rw"));
             if (rw) {
-                ro = value_to_string_list(i["ro"]);
+                ro = value_to_string_list(field(i, "ro"));
                 if (!ro) {
                     lsm_string_list_free(rw);
                     lsm_string_list_free(root);
@@ -676,17 +782,24 @@ lsm_nfs_export *value_to_nfs_export(Value & exp)
         }
 
         if (ok) {
-            rc = lsm_nfs_export_record_alloc(i["id"].asC_str(),
-                                             i["fs_id"].asC_str(),
-                                             i["export_path"].asC_str(),
-                                             i["auth"].asC_str(),
+            const Value & id = field(i, "id");
+            const Value & fs_id = field(i, "fs_id");
+            const Value & export_path = field(i, "export_path");
+            const Value & auth = field(i, "auth");
+            const Value & options = field(i, "options");
+            const Value & plugin_data = field(i, "plugin_data");
+
+            rc = lsm_nfs_export_record_alloc(id.asC_str(),
+                                             fs_id.asC_str(),
+                                             export_path.asC_str(),
+                                             auth.asC_str(),
                                              root,
                                              rw,
                                              ro,
-                                             i["anonuid"].asUint64_t(),
-                                             i["anongid"].asUint64_t(),
-                                             i["options"].asC_str(),
-                                             i["plugin_data"].asC_str());
+                                             field(i, "anonuid").asUint64_t(),
+                                             field(i, "anongid").asUint64_t(),
+                                             options.asC_str(),
+                                             plugin_data.asC_str());
 
             lsm_string_list_free(root);
             lsm_string_list_free(rw);
@@ -700,8 +813,11 @@ lsm_nfs_export *value_to_nfs_export(Value & exp)
 
 Value nfs_export_to_value(lsm_nfs_export * exp)
 {
+    Value rc;
+
     if (LSM_IS_NFS_EXPORT(exp)) {
-        std::map < std::string, Value > f;
+        rc = Value(Value::object_t);
+        ValueObject & f = rc.asObject();
         f["class"] = Value(CLASS_NAME_FS_EXPORT);
         f["id"] = Value(exp->id);
         f["fs_id"] = Value(exp->fs_id);
@@ -724,17 +840,15 @@ Value nfs_export_to_value(lsm_nfs_export * exp)
             f["anongid"] = Value(exp->anon_gid);
         f["options"] = Value(exp->options);
         f["plugin_data"] = Value(exp->plugin_data);
-        return Value(f);
     }
-    return Value();
-
+    return rc;
 }
 
 lsm_storage_capabilities *value_to_capabilities(Value & exp)
 {
     lsm_storage_capabilities *rc = NULL;
     if (is_expected_object(exp, CLASS_NAME_CAPABILITIES)) {
-        const char *val = exp["cap"].asC_str();
+        const char *val = field(exp.asObject(), "cap").asC_str();
         rc = lsm_capability_record_alloc(val);
     } else {
         throw ValueException("value_to_capabilities: Not correct type");
@@ -744,15 +858,17 @@ lsm_storage_capabilities *value_to_capabilities(Value & exp)
 
 Value capabilities_to_value(lsm_storage_capabilities * cap)
 {
+    Value rc;
+
     if (LSM_IS_CAPABILITY(cap)) {
-        std::map < std::string, Value > c;
+        rc = Value(Value::object_t);
+        ValueObject & c = rc.asObject();
         char *t = capability_string(cap);
         c["class"] = Value(CLASS_NAME_CAPABILITIES);
         c["cap"] = Value(t);
         free(t);
-        return Value(c);
     }
-    return Value();
+    return rc;
 }
 
 
@@ -760,15 +876,24 @@ lsm_target_port *value_to_target_port(Value & tp)
 {
     lsm_target_port *rc = NULL;
     if (is_expected_object(tp, CLASS_NAME_TARGET_PORT)) {
-        rc = lsm_target_port_record_alloc(tp["id"].asC_str(),
+        const ValueObject & t = tp.asObject();
+        const Value & id = field(t, "id");
+        const Value & service_address = field(t, "service_address");
+        const Value & network_address = field(t, "network_address");
+        const Value & physical_address = field(t, "physical_address");
+        const Value & physical_name = field(t, "physical_name");
+        const Value & system_id = field(t, "system_id");
+        const Value & plugin_data = field(t, "plugin_data");
+
+        rc = lsm_target_port_record_alloc(id.asC_str(),
                                           (lsm_target_port_type)
-                                          tp["port_type"].asInt32_t(),
-                                          tp["service_address"].asC_str(),
-                                          tp["network_address"].asC_str(),
-                                          tp["physical_address"].asC_str(),
-                                          tp["physical_name"].asC_str(),
-                                          tp["system_id"].asC_str(),
-                                          tp["plugin_data"].asC_str());
+                                          field(t, "port_type").asInt32_t(),
+                                          service_address.asC_str(),
+                                          network_address.asC_str(),
+                                          physical_address.asC_str(),
+                                          physical_name.asC_str(),
+                                          system_id.asC_str(),
+                                          plugin_data.asC_str());
     } else {
         throw ValueException("value_to_target_port: Not correct type");
     }
@@ -777,8 +902,11 @@ lsm_target_port *value_to_target_port(Value & tp)
 
 Value target_port_to_value(lsm_target_port * tp)
 {
+    Value rc;
+
     if (LSM_IS_TARGET_PORT(tp)) {
-        std::map < std::string, Value > p;
+        rc = Value(Value::object_t);
+        ValueObject & p = rc.asObject();
         p["class"] = Value(CLASS_NAME_TARGET_PORT);
         p["id"] = Value(tp->id);
         p["port_type"] = Value(tp->type);
@@ -788,9 +916,8 @@ Value target_port_to_value(lsm_target_port * tp)
         p["physical_name"] = Value(tp->physical_name);
         p["system_id"] = Value(tp->system_id);
         p["plugin_data"] = Value(tp->plugin_data);
-        return Value(p);
     }
-    return Value();
+    return rc;
 }
 
 int values_to_uint32_array(Value & value, uint32_t ** uint32_array,
@@ -799,7 +926,7 @@ int values_to_uint32_array(Value & value, uint32_t ** uint32_array,
     int rc = LSM_ERR_OK;
     *count = 0;
     try {
-        std::vector < Value > data = value.asArray();
+        std::vector < Value > &data = value.asArray();
         *count = data.size();
         if (*count) {
             *uint32_array = (uint32_t *) malloc(sizeof(uint32_t) * *count);
@@ -826,12 +953,14 @@ int values_to_uint32_array(Value & value, uint32_t ** uint32_array,
 
 Value uint32_array_to_value(uint32_t * uint32_array, uint32_t count)
 {
-    std::vector < Value > rc;
+    Value rc(Value::array_t);
+    std::vector < Value > &array = rc.asArray();
+
     if (uint32_array && count) {
         uint32_t i;
-        rc.reserve(count);
+        array.reserve(count);
         for (i = 0; i < count; i++) {
-            rc.push_back(uint32_array[i]);
+            array.push_back(uint32_array[i]);
         }
     }
     return rc;
@@ -841,14 +970,16 @@ lsm_battery *value_to_battery(Value &battery)
 {
     lsm_battery *rc = NULL;
     if (is_expected_object(battery, CLASS_NAME_BATTERY)) {
-        std::map < std::string, Value > b = battery.asObject();
-
-        rc = lsm_battery_record_alloc(b["id"].asString().c_str(),
-                                      b["name"].asString().c_str(),
-                                      (lsm_battery_type) b["type"].asInt32_t(),
-                                      b["status"].asUint64_t(),
-                                      b["system_id"].asString().c_str(),
-                                      b["plugin_data"].asString().c_str());
+        const ValueObject & b = battery.asObject();
+
+        rc = lsm_battery_record_alloc(field(b, "id").asString().c_str(),
+                                      field(b, "name").asString().c_str(),
+                                      (lsm_battery_type)
+                                      field(b, "type").asInt32_t(),
+                                      field(b, "status").asUint64_t(),
+                                      field(b, "system_id").asString().c_str(),
+                                      field(b, "plugin_data").asString().
+                                      c_str());
     } else {
         throw ValueException("value_to_battery: Not correct type");
     }
@@ -857,8 +988,11 @@ lsm_battery *value_to_battery(Value &battery)
 
 Value battery_to_value(lsm_battery *battery)
 {
+    Value rc;
+
     if (LSM_IS_BATTERY(battery)) {
-        std::map < std::string, Value > b;
+        rc = Value(Value::object_t);
+        ValueObject & b = rc.asObject();
         b["class"] = Value(CLASS_NAME_BATTERY);
         b["id"] = Value(battery->id);
         b["name"] = Value(battery->name);
@@ -867,9 +1001,8 @@ Value battery_to_value(lsm_battery *battery)
         b["system_id"] = Value(battery->system_id);
         if (battery->plugin_data != NULL)
             b["plugin_data"] = Value(battery->plugin_data);
-        return Value(b);
     }
-    return Value();
+    return rc;
 }
 
 int value_array_to_batteries(Value &battery_values, lsm_battery ***bs,
@@ -880,7 +1013,7 @@ int value_array_to_batteries(Value &battery_values, lsm_battery ***bs,
         *count = 0;
 
         if (Value::array_t == battery_values.valueType()) {
-            std::vector < Value > d = battery_values.asArray();
+            std::vector < Value > &d = battery_values.asArray();
 
             *count = d.size();
 
@@ -917,3 +1050,95 @@ int value_array_to_batteries(Value &battery_values, lsm_battery ***bs,
     }
     goto out;
 }
+
+int value_array_to_fs(Value &fs_values, lsm_fs ***fs,
+                      uint32_t *count)
+{
+    int rc = LSM_ERR_OK;
+    try {
+        *count = 0;
+
+        if (Value::array_t == fs_values.valueType()) {
+            std::vector < Value > &d = fs_values.asArray();
+
+            *count = d.size();
+
+            if (d.size()) {
+                *fs = lsm_fs_record_array_alloc(d.size());
+
+                if (*fs) {
+                    for (size_t i = 0; i < d.size(); ++i) {
+                        (*fs)[i] = value_to_fs(d[i]);
+                        if (!((*fs)[i])) {
+                            rc = LSM_ERR_NO_MEMORY;
+                            goto error;
+                        }
+                    }
+                } else {
+                    rc = LSM_ERR_NO_MEMORY;
+                }
+            }
+        }
+    }
+    catch(const ValueException & ve) {
+        rc = LSM_ERR_LIB_BUG;
+        goto error;
+    }
+
+  out:
+    return rc;
+
+  error:
+    if (*fs && *count) {
+        lsm_fs_record_array_free(*fs, *count);
+        *fs = NULL;
+        *count = 0;
+    }
+    goto out;
+}
+
+int value_array_to_nfs_exports(Value &exports_values,
+                               lsm_nfs_export ***exports, uint32_t *count)
+{
+    int rc = LSM_ERR_OK;
+    try {
+        *count = 0;
+
+        if (Value::array_t == exports_values.valueType()) {
+            std::vector < Value > &d = exports_values.asArray();
+
+            *count = d.size();
+
+            if (d.size()) {
+                *exports = lsm_nfs_export_record_array_alloc(d.size());
+
+                if (*exports) {
+                    for (size_t i = 0; i < d.size(); ++i) {
+                        (*exports)[i] = value_to_nfs_export(d[i]);
+                        if (!((*exports)[i])) {
+                            rc = LSM_ERR_NO_MEMORY;
+                            goto error;
+                        }
+                    }
+                } else {
+                    rc = LSM_ERR_NO_MEMORY;
+                }
+            }
+        }
+    }
+    catch(const ValueException & ve) {
+        rc = LSM_ERR_LIB_BUG;
+        goto error;
+    }
+
+  out:
+    return rc;
+
+  error:
+    if (*exports && *count) {
+        lsm_nfs_export_record_array_free(*exports, *count);
+        *exports = NULL;
+        *count = 0;
+    }
+    goto out;
+}
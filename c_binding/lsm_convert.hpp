@@ -21,6 +21,7 @@
 
 #include "lsm_datatypes.hpp"
 #include "lsm_ipc.hpp"
+#include <set>
 
 /**
  * Class names for serialized json
@@ -58,14 +59,15 @@ const char CLASS_NAME_BATTERY[] = "Battery";
  * @param class_name    Class name to check
  * @return boolean, true if matches
  */
-bool LSM_DLL_LOCAL is_expected_object(Value & obj, std::string class_name);
+bool LSM_DLL_LOCAL is_expected_object(Value & obj,
+                                      const std::string & class_name);
 
 /**
  * Converts an array of Values to a lsm_string_list
  * @param list      List represented as an vector of strings.
  * @return lsm_string_list pointer, NULL on error.
  */
-lsm_string_list LSM_DLL_LOCAL *value_to_string_list(Value & list);
+lsm_string_list LSM_DLL_LOCAL *value_to_string_list(const Value & list);
 
 /**
  * Converts a lsm_string_list to a Value
@@ -88,6 +90,15 @@ lsm_volume LSM_DLL_LOCAL *value_to_volume(Value & vol);
  */
 Value LSM_DLL_LOCAL volume_to_value(lsm_volume *vol);
 
+/**
+ * Converts a lsm_volume *to a Value holding only some of its fields
+ * @param vol       lsm_volume to convert
+ * @param fields    Fields to include besides "id", NULL for all of them
+ * @return Value
+ */
+Value LSM_DLL_LOCAL volume_to_value(lsm_volume *vol,
+                                    const std::set < std::string > *fields);
+
 
 /**
  * Converts a vector of volume values to an array
@@ -114,6 +125,15 @@ lsm_disk LSM_DLL_LOCAL *value_to_disk(Value & disk);
  */
 Value LSM_DLL_LOCAL disk_to_value(lsm_disk * disk);
 
+/**
+ * Converts a lsm_disk to a value holding only some of its fields
+ * @param disk      lsm_disk to convert to value
+ * @param fields    Fields to include besides "id", NULL for all of them
+ * @return Value
+ */
+Value LSM_DLL_LOCAL disk_to_value(lsm_disk * disk,
+                                  const std::set < std::string > *fields);
+
 /**
  * Converts a vector of disk values to an array.
  * @param[in] disk_values       Vector of values that represents disks
@@ -326,4 +346,25 @@ int LSM_DLL_LOCAL value_array_to_batteries(Value &battery_values,
                                            lsm_battery **bs[],
                                            uint32_t * count);
 
+/**
+ * Converts a vector of file system values to an array.
+ * @param[in]  fs_values            Vector of values that represents fs.
+ * @param[out] fs                   An array of fs pointers
+ * @param[out] count                Number of fs
+ * @return LSM_ERR_OK on success, else error reason.
+ */
+int LSM_DLL_LOCAL value_array_to_fs(Value &fs_values, lsm_fs **fs[],
+                                    uint32_t * count);
+
+/**
+ * Converts a vector of NFS export values to an array.
+ * @param[in]  exports_values       Vector of values that represents exports.
+ * @param[out] exports              An array of export pointers
+ * @param[out] count                Number of exports
+ * @return LSM_ERR_OK on success, else error reason.
+ */
+int LSM_DLL_LOCAL value_array_to_nfs_exports(Value &exports_values,
+                                             lsm_nfs_export **exports[],
+                                             uint32_t * count);
+
 #endif
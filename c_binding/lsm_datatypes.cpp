@@ -199,6 +199,22 @@ lsm_connect *connection_get()
 {
     lsm_connect *c = (lsm_connect *) calloc(1, sizeof(lsm_connect));
     if (c) {
+        //Made here, off, for threads sharing the connection not to race
+        //creating it once a time to live is set
+        try {
+            c->cache = new lsm_connect_cache();
+        }
+        catch(const std::bad_alloc & ba) {
+            free(c);
+            return NULL;
+        }
+        memset(c->cache->ttl, 0, sizeof(c->cache->ttl));
+        c->cache->generation = 0;
+        c->cache->hits = 0;
+        c->cache->misses = 0;
+        pthread_mutex_init(&c->cache->lock, NULL);
+        pthread_mutex_init(&c->lock, NULL);
+
         c->magic = LSM_CONNECT_MAGIC;
     }
     return c;
@@ -226,21 +242,59 @@ void connection_free(lsm_connect * c)
             c->tp = NULL;
         }
 
+        delete c->async;
+        c->async = NULL;
+
+        if (c->cache) {
+            pthread_mutex_destroy(&c->cache->lock);
+            delete c->cache;
+            c->cache = NULL;
+        }
+
         if (c->raw_uri) {
             free(c->raw_uri);
             c->raw_uri = NULL;
         }
 
+        pthread_mutex_destroy(&c->lock);
         free(c);
     }
 }
 
+lsm_error *connection_error_swap(lsm_connect * c, lsm_error * e)
+{
+    lsm_error *rc = NULL;
+
+    pthread_mutex_lock(&c->lock);
+    rc = c->error;
+    c->error = e;
+    pthread_mutex_unlock(&c->lock);
+    return rc;
+}
+
+void connection_flag_set(lsm_connect * c, uint32_t flag)
+{
+    pthread_mutex_lock(&c->lock);
+    c->flags |= flag;
+    pthread_mutex_unlock(&c->lock);
+}
+
+int connection_flag_get(lsm_connect * c, uint32_t flag)
+{
+    int rc = 0;
+
+    pthread_mutex_lock(&c->lock);
+    rc = (c->flags & flag) != 0;
+    pthread_mutex_unlock(&c->lock);
+    return rc;
+}
+
 static int connection_establish(lsm_connect * c, const char *password,
                                 uint32_t timeout, lsm_error_ptr * e,
                                 lsm_flag flags)
 {
     int rc = LSM_ERR_OK;
-    std::map < std::string, Value > params;
+    ValueObject params;
 
     try {
         params["uri"] = Value(c->raw_uri);
@@ -254,7 +308,8 @@ static int connection_establish(lsm_connect * c, const char *password,
         params["flags"] = Value(flags);
         Value p(params);
 
-        c->tp->rpc("plugin_register", p);
+        c->tp->protocolSet(c->tp->rpc("plugin_register", p, 0,
+                                      Ipc::protocolOffer()));
     }
     catch(const ValueException & ve) {
         *e = lsm_error_create(LSM_ERR_TRANSPORT_SERIALIZATION,
@@ -605,7 +660,11 @@ lsm_volume *lsm_volume_record_alloc(const char *id, const char *name,
     if (rc) {
         rc->magic = LSM_VOL_MAGIC;
         rc->id = strdup(id);
-        rc->name = strdup(name);
+
+        /* Only id is mandatory, a projected list leaves the rest unset */
+        if (name) {
+            rc->name = strdup(name);
+        }
 
         if (vpd83) {
             rc->vpd83 = strdup(vpd83);
@@ -614,15 +673,22 @@ lsm_volume *lsm_volume_record_alloc(const char *id, const char *name,
         rc->block_size = blockSize;
         rc->number_of_blocks = numberOfBlocks;
         rc->admin_state = status;
-        rc->system_id = strdup(system_id);
-        rc->pool_id = strdup(pool_id);
+
+        if (system_id) {
+            rc->system_id = strdup(system_id);
+        }
+
+        if (pool_id) {
+            rc->pool_id = strdup(pool_id);
+        }
 
         if (plugin_data) {
             rc->plugin_data = strdup(plugin_data);
         }
 
-        if (!rc->id || !rc->name || (vpd83 && !rc->vpd83) || !rc->system_id ||
-            !rc->pool_id || (plugin_data && !rc->plugin_data)) {
+        if (!rc->id || (name && !rc->name) || (vpd83 && !rc->vpd83) ||
+            (system_id && !rc->system_id) || (pool_id && !rc->pool_id) ||
+            (plugin_data && !rc->plugin_data)) {
             lsm_volume_record_free(rc);
             rc = NULL;
         }
@@ -641,18 +707,19 @@ lsm_disk *lsm_disk_record_alloc(const char *id, const char *name,
     if (rc) {
         rc->magic = LSM_DISK_MAGIC;
         rc->id = strdup(id);
-        rc->name = strdup(name);
+        /* Only id is mandatory, a projected list leaves the rest unset */
+        rc->name = name ? strdup(name) : NULL;
         rc->type = disk_type;
         rc->block_size = block_size;
         rc->number_of_blocks = block_count;
         rc->status = disk_status;
-        rc->system_id = strdup(system_id);
+        rc->system_id = system_id ? strdup(system_id) : NULL;
         rc->vpd83 = NULL;
         rc->location = NULL;
         rc->rpm = LSM_DISK_RPM_NO_SUPPORT;
         rc->link_type = LSM_DISK_LINK_TYPE_NO_SUPPORT;
 
-        if (!rc->id || !rc->name || !rc->system_id) {
+        if (!rc->id || (name && !rc->name) || (system_id && !rc->system_id)) {
             lsm_disk_record_free(rc);
             rc = NULL;
         }
@@ -1123,9 +1190,7 @@ void lsm_access_group_initiator_id_set(lsm_access_group * group,
 lsm_error_ptr lsm_error_last_get(lsm_connect * c)
 {
     if (LSM_IS_CONNECT(c)) {
-        lsm_error_ptr e = c->error;
-        c->error = NULL;
-        return e;
+        return connection_error_swap(c, NULL);
     }
     return NULL;
 }
@@ -26,6 +26,7 @@
 #include "libstoragemgmt/libstoragemgmt_common.h"
 #include "libxml/uri.h"
 #include <glib.h>
+#include <pthread.h>
 #include "lsm_ipc.hpp"
 
 
@@ -173,6 +174,9 @@ struct _lsm_system {
 #define LSM_CONNECT_MAGIC       0xAA7A000A
 #define LSM_IS_CONNECT(obj)     MAGIC_CHECK(obj, LSM_CONNECT_MAGIC)
 
+/* Connection flag, transport failed and the connection can't be reused */
+#define LSM_CONNECT_BROKEN      0x00000001
+
 
 #define LSM_PLUGIN_MAGIC    0xAA7A000B
 #define LSM_IS_PLUGIN(obj)  MAGIC_CHECK(obj, LSM_PLUGIN_MAGIC)
@@ -195,8 +199,56 @@ struct LSM_DLL_LOCAL _lsm_plugin {
     struct lsm_fs_ops_v1 *fs_ops;      /**< Callbacks for fs ops */
     struct lsm_ops_v1_2 *ops_v1_2;     /**< Callbacks for v1.2 ops */
     struct lsm_ops_v1_3 *ops_v1_3;     /**< Callbacks for v1.3 ops */
+    struct lsm_ops_v1_6 *ops_v1_6;     /**< Callbacks for v1.6 ops */
+    uint32_t thread_count;         /**< Request handler threads, 0 for none */
+    lsm_plug_batch_begin batch_begin;  /**< Called before a batch runs */
+    lsm_plug_batch_end batch_end;      /**< Called after a batch ran */
+};
+
+
+/**
+ * Converts the response of a request sent by one of the *_async calls and
+ * hands it to the caller's callback.
+ */
+typedef void (*lsm_async_complete) (lsm_connect * c, int rc,
+                                    Value & response, void (*cb) (void),
+                                    void *user_data);
+
+/**
+ * Request sent by one of the *_async calls, waiting for its response.
+ */
+struct LSM_DLL_LOCAL lsm_async_call {
+    lsm_async_complete complete;    /**< Called with the response */
+    void (*cb) (void);              /**< Caller's callback */
+    void *user_data;                /**< Caller's callback data */
+};
+
+/**
+ * Number of lsm_cache_class values.
+ */
+#define LSM_CACHE_CLASS_COUNT   4
+
+/**
+ * Result held by the cache of a connection.
+ */
+struct LSM_DLL_LOCAL lsm_cache_entry {
+    Value result;               /**< Response of the plug-in */
+    uint64_t expires;           /**< Monotonic time (ms) it is good until */
 };
 
+/**
+ * Opt-in cache of slowly changing results, see lsm_connect_cache_ttl_set().
+ */
+struct LSM_DLL_LOCAL lsm_connect_cache {
+    uint32_t ttl[LSM_CACHE_CLASS_COUNT];
+                                /**< Time to live (ms) by class, 0 is off */
+    std::map < std::string, lsm_cache_entry > entries;
+                                /**< By method and parameters */
+    uint64_t generation;        /**< Bumped each time entries are dropped */
+    uint64_t hits;              /**< Requests answered from the cache */
+    uint64_t misses;            /**< Cacheable requests sent to the plug-in */
+    pthread_mutex_t lock;       /**< Protects the above */
+};
 
 /**
  * Information pertaining to the connection.  This is the main structure and
@@ -208,7 +260,44 @@ struct LSM_DLL_LOCAL _lsm_connect {
     xmlURIPtr uri;              /**< URI */
     char *raw_uri;              /**< Raw URI string */
     lsm_error *error;            /**< Error information */
+    pthread_mutex_t lock;       /**< Protects flags and error */
     Ipc *tp;                    /**< IPC transport */
+    lsm_connect_pool *pool;     /**< Pool the connection belongs to */
+    std::map < int32_t, lsm_async_call > *async;
+                                /**< Outstanding requests by id */
+    lsm_connect_cache *cache;   /**< Result cache, off until a ttl is set */
+    uint32_t io_timeout;        /**< Wait for the plug-in, ms, 0 for ever */
+};
+
+#define LSM_CONNECT_POOL_MAGIC      0xAA7A0014
+#define LSM_IS_CONNECT_POOL(obj)    MAGIC_CHECK(obj, LSM_CONNECT_POOL_MAGIC)
+
+/**
+ * Registered connections to one URI shared between threads.
+ */
+struct LSM_DLL_LOCAL _lsm_connect_pool {
+    uint32_t magic;             /**< Magic, used for structure validation */
+    char *uri;                  /**< URI */
+    char *password;             /**< Password, NULL if none */
+    uint32_t timeout;           /**< Time-out for new connections */
+    uint32_t size;              /**< Maximum number of connections */
+    uint32_t count;             /**< Connections open, idle or handed out */
+    uint32_t idle_count;        /**< Number of connections in idle */
+    lsm_connect **idle;         /**< Connections ready to be handed out */
+    pthread_mutex_t lock;       /**< Protects the above */
+    pthread_cond_t cond;        /**< Signalled when a connection is returned */
+};
+
+#define LSM_BATCH_MAGIC     0xAA7A0015
+#define LSM_IS_BATCH(obj)   MAGIC_CHECK(obj, LSM_BATCH_MAGIC)
+
+/**
+ * Requests queued up to be sent to the plug-in as a single "batch" call.
+ */
+struct LSM_DLL_LOCAL _lsm_batch {
+    uint32_t magic;             /**< Magic, used for structure validation */
+    Value *requests;            /**< Array of method/params objects */
+    Value *results;             /**< Per request results, NULL until run */
 };
 
 
@@ -329,6 +418,30 @@ lsm_connect LSM_DLL_LOCAL *connection_get();
  */
 void LSM_DLL_LOCAL connection_free(lsm_connect * c);
 
+/**
+ * Replaces the last error of the connection.
+ * @param c     Connection
+ * @param e     Error the connection takes ownership of, may be NULL
+ * @return The error the connection held, the caller owns it.
+ */
+lsm_error LSM_DLL_LOCAL *connection_error_swap(lsm_connect * c,
+                                               lsm_error * e);
+
+/**
+ * Sets flag(s) on the connection.
+ * @param c     Connection
+ * @param flag  Flag(s) to set
+ */
+void LSM_DLL_LOCAL connection_flag_set(lsm_connect * c, uint32_t flag);
+
+/**
+ * Checks for a flag on the connection.
+ * @param c     Connection
+ * @param flag  Flag to check for
+ * @return Non zero if set.
+ */
+int LSM_DLL_LOCAL connection_flag_get(lsm_connect * c, uint32_t flag);
+
 /**
  * Loads the requester driver specified in the uri.
  * @param c             Connection
@@ -24,13 +24,17 @@
 #include <errno.h>
 #include <sys/un.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <arpa/inet.h>
 #include <string.h>
-#include <iomanip>
 #include <sstream>
 #include <iostream>
 #include <algorithm>
 #include <stdio.h>
-#include <list>
+#include <stdlib.h>
+#include <limits.h>
+#include <time.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -45,91 +49,286 @@
 #define LSM_NEW_YAJL
 #endif
 
-static std::string zero_pad_num(unsigned int num)
+static uint64_t monotonic_ms(void)
 {
-    std::ostringstream ss;
-    ss << std::setw(Transport::HDR_LEN) << std::setfill('0') << num;
-    return ss.str();
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * Time left until a deadline, for poll().
+ * @param deadline  CLOCK_MONOTONIC time in ms
+ * @return ms left, 0 once passed
+ */
+static int ms_left(uint64_t deadline)
+{
+    uint64_t now = monotonic_ms();
+
+    if (now >= deadline) {
+        return 0;
+    }
+    return (int) std::min(deadline - now, (uint64_t) INT_MAX);
 }
 
-Transport::Transport():s(-1)
+Transport::Transport():s(-1), binary_hdr(false)
 {
 }
 
-Transport::Transport(int socket_desc):s(socket_desc)
+Transport::Transport(int socket_desc):s(socket_desc), binary_hdr(false)
 {
 }
 
 int Transport::msg_send(const std::string & msg, int &error_code)
+{
+    return msg_send(msg.data(), msg.size(), error_code);
+}
+
+int Transport::msg_send(const char *msg, size_t len, int &error_code)
+{
+    return msg_send(msg, len, error_code, 0);
+}
+
+int Transport::msg_send(const char *msg, size_t len, int &error_code,
+                        uint64_t deadline)
 {
     int rc = -1;
     error_code = 0;
 
-    if (msg.size() > 0) {
-        ssize_t written = 0;
-        //fprintf(stderr, ">>> %s\n", msg.c_str());
-        std::string data = zero_pad_num(msg.size()) + msg;
-        ssize_t msg_size = data.size();
-
-        while (written < msg_size) {
-            int wrote = send(s, data.c_str() + written, (msg_size - written),
-                             MSG_NOSIGNAL); //Prevent SIGPIPE on write
-            if (wrote != -1) {
-                written += wrote;
-            } else {
+    if (len > 0) {
+        char hdr[HDR_LEN + 1];
+        struct iovec iov[2];
+        struct msghdr mh;
+
+        //fprintf(stderr, ">>> %.*s\n", (int) len, msg);
+        if (len >= 0x80000000) {
+            error_code = EMSGSIZE;
+            return rc;
+        }
+
+        if (binary_hdr) {
+            uint32_t n = htonl((uint32_t) len);
+            memcpy(hdr, &n, HDR_BIN_LEN);
+            iov[0].iov_len = HDR_BIN_LEN;
+        } else {
+            snprintf(hdr, sizeof(hdr), "%0*lu", HDR_LEN, (unsigned long) len);
+            iov[0].iov_len = HDR_LEN;
+        }
+
+        //Header and payload go out together without being copied together
+        iov[0].iov_base = hdr;
+        iov[1].iov_base = (void *) msg;
+        iov[1].iov_len = len;
+
+        memset(&mh, 0, sizeof(mh));
+        mh.msg_iov = iov;
+        mh.msg_iovlen = 2;
+
+        //Prevent SIGPIPE, with a deadline wait in poll() instead of send
+        int send_flags = MSG_NOSIGNAL | ((deadline) ? MSG_DONTWAIT : 0);
+        size_t sent = 0;
+
+        while (mh.msg_iovlen) {
+            ssize_t wrote = sendmsg(s, &mh, send_flags);
+            if (wrote == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                if (deadline && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    struct pollfd pfd;
+                    int left = ms_left(deadline);
+
+                    if (left) {
+                        pfd.fd = s;
+                        pfd.events = POLLOUT;
+                        pfd.revents = 0;
+                        poll(&pfd, 1, left);
+                        continue;
+                    }
+
+                    error_code = ETIMEDOUT;
+                    if (sent) {
+                        shutdown(s, SHUT_RDWR);
+                    }
+                    break;
+                }
                 error_code = errno;
                 break;
             }
+            sent += wrote;
+
+            //Step over what went out, a short write can stop in either
+            while (mh.msg_iovlen && (size_t) wrote >= mh.msg_iov->iov_len) {
+                wrote -= mh.msg_iov->iov_len;
+                mh.msg_iov++;
+                mh.msg_iovlen--;
+            }
+            if (mh.msg_iovlen) {
+                mh.msg_iov->iov_base = (char *) mh.msg_iov->iov_base + wrote;
+                mh.msg_iov->iov_len -= wrote;
+            }
         }
 
-        if ((written == msg_size) && error_code == 0) {
+        if (mh.msg_iovlen == 0 && error_code == 0) {
             rc = 0;
         }
     }
     return rc;
 }
 
-static std::string string_read(int fd, size_t count, int &error_code)
+static void read_all(int fd, char *buf, size_t count, int &error_code)
 {
-    char buff[4096];
     size_t amount_read = 0;
-    std::string rc = "";
 
     error_code = 0;
 
     while (amount_read < count) {
-        ssize_t rd = recv(fd, buff, std::min(sizeof(buff),
-                                             (count - amount_read)),
+        ssize_t rd = recv(fd, buf + amount_read, count - amount_read,
                           MSG_WAITALL);
         if (rd > 0) {
             amount_read += rd;
-            rc += std::string(buff, rd);
         } else {
             error_code = errno;
             break;
         }
     }
 
-    if ((amount_read == count) && (error_code == 0))
-        return rc;
-    else
+    if ((amount_read != count) || (error_code != 0))
         throw EOFException("");
 }
 
 std::string Transport::msg_recv(int &error_code)
 {
     std::string msg;
+    msg_recv(msg, error_code);
+    return msg;
+}
+
+unsigned long int Transport::payload_len_get(const char *hdr) const
+{
+    if (binary_hdr) {
+        uint32_t len = 0;
+        memcpy(&len, hdr, HDR_BIN_LEN);
+        return ntohl(len);
+    }
+
+    char len[HDR_LEN + 1];
+    memcpy(len, hdr, HDR_LEN);
+    len[HDR_LEN] = '\0';
+    return strtoul(len, NULL, 10);
+}
+
+void Transport::msg_recv(std::string & msg, int &error_code)
+{
     error_code = 0;
     unsigned long int payload_len = 0;
-    std::string len = string_read(s, HDR_LEN, error_code);  //Read the length
-    if (len.size() && error_code == 0) {
-        payload_len = strtoul(len.c_str(), NULL, 10);
-        if (payload_len < 0x80000000) { /* Should be big enough */
-            msg = string_read(s, payload_len, error_code);
+
+    if (part.size()) {
+        //Finish what a non-blocking read started
+        struct pollfd pfd;
+
+        pfd.fd = s;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        while (!msg_recv_nb(msg, error_code)) {
+            poll(&pfd, 1, -1);
+        }
+        return;
+    }
+
+    //Read the length
+    char hdr[HDR_LEN];
+    read_all(s, hdr, (binary_hdr) ? HDR_BIN_LEN : HDR_LEN, error_code);
+    payload_len = payload_len_get(hdr);
+
+    msg.clear();
+    if (payload_len < 0x80000000) { /* Should be big enough */
+        //Sized once and read straight into
+        msg.resize(payload_len);
+        if (payload_len) {
+            read_all(s, &msg[0], payload_len, error_code);
+        }
+    }
+    //fprintf(stderr, "<<< %s\n", msg.c_str());
+}
+
+bool Transport::msg_recv(std::string & msg, int &error_code,
+                         uint64_t deadline)
+{
+    struct pollfd pfd;
+
+    if (!deadline) {
+        msg_recv(msg, error_code);
+        return true;
+    }
+
+    pfd.fd = s;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    while (!msg_recv_nb(msg, error_code)) {
+        int left = ms_left(deadline);
+
+        if (!left) {
+            error_code = ETIMEDOUT;
+            return false;
+        }
+        poll(&pfd, 1, left);
+    }
+    return true;
+}
+
+bool Transport::msg_recv_nb(std::string & msg, int &error_code)
+{
+    size_t hdr_len = (binary_hdr) ? HDR_BIN_LEN : HDR_LEN;
+
+    error_code = 0;
+
+    while (true) {
+        size_t want = hdr_len;
+
+        if (part.size() >= hdr_len) {
+            unsigned long int payload_len = payload_len_get(part.data());
+
+            if (payload_len >= 0x80000000) {
+                throw EOFException("");
+            }
+
+            want += payload_len;
+            if (part.size() == want) {
+                part.erase(0, hdr_len);
+                msg.swap(part);
+                part.clear();
+                return true;
+            }
+        }
+
+        size_t have = part.size();
+        part.resize(want);
+
+        ssize_t rd = recv(s, &part[have], want - have, MSG_DONTWAIT);
+        int e = errno;
+
+        part.resize(have + ((rd > 0) ? rd : 0));
+
+        if (rd == 0) {
+            throw EOFException("");
+        }
+
+        if (rd < 0) {
+            if (e == EINTR) {
+                continue;
+            }
+            if (e == EAGAIN || e == EWOULDBLOCK) {
+                return false;
+            }
+            error_code = e;
+            throw EOFException("");
         }
-        //fprintf(stderr, "<<< %s\n", msg.c_str());
     }
-    return msg;
 }
 
 int Transport::socket_get(const std::string & path, int &error_code)
@@ -163,6 +362,31 @@ Transport::~Transport()
     close();
 }
 
+void Transport::binary_header_set(bool binary)
+{
+    binary_hdr = binary;
+}
+
+bool Transport::idle_ok()
+{
+    struct pollfd pfd;
+
+    if (s < 0) {
+        return false;
+    }
+
+    pfd.fd = s;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    return (0 == poll(&pfd, 1, 0));
+}
+
+int Transport::fd_get() const
+{
+    return s;
+}
+
 void Transport::close()
 {
     if (s >= 0) {
@@ -205,47 +429,229 @@ error_code(code), debug(debug_addl), debug_data(debug_data_addl)
 {
 }
 
-Value::Value(void):t(null_t)
+ValueObject::ValueObject()
+{
+}
+
+ValueObject::ValueObject(const std::map < std::string, Value > &m)
+{
+    std::map < std::string, Value >::const_iterator iter;
+    size_t i = 0;
+
+    //Map iteration is already in key order
+    entries.resize(m.size());
+    for (iter = m.begin(); iter != m.end(); ++iter, ++i) {
+        entries[i].first = iter->first;
+        entries[i].second = iter->second;
+    }
+}
+
+size_t ValueObject::position(const std::string & key) const
+{
+    size_t lo = 0;
+    size_t hi = entries.size();
+
+    //Objects are mostly built, and sent to us, in key order
+    if (hi && entries[hi - 1].first < key) {
+        return hi;
+    }
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (entries[mid].first < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+Value & ValueObject::operator[](const std::string & key) {
+    size_t pos = position(key);
+
+    if (pos < entries.size() && entries[pos].first == key) {
+        return entries[pos].second;
+    }
+
+    if (entries.size() == entries.capacity()) {
+        reserve(entries.empty()? 8 : entries.size() * 2);
+    }
+
+    //Shift the tail up by swapping so no sub tree gets copied
+    entries.push_back(value_type());
+    for (size_t i = entries.size() - 1; i > pos; --i) {
+        entries[i].first.swap(entries[i - 1].first);
+        entries[i].second.swap(entries[i - 1].second);
+    }
+    entries[pos].first = key;
+    return entries[pos].second;
+}
+
+ValueObject::iterator ValueObject::find(const std::string & key)
+{
+    size_t pos = position(key);
+
+    if (pos < entries.size() && entries[pos].first == key) {
+        return entries.begin() + pos;
+    }
+    return entries.end();
+}
+
+ValueObject::const_iterator ValueObject::find(const std::string & key) const
+{
+    size_t pos = position(key);
+
+    if (pos < entries.size() && entries[pos].first == key) {
+        return entries.begin() + pos;
+    }
+    return entries.end();
+}
+
+size_t ValueObject::count(const std::string & key) const
+{
+    return (find(key) != entries.end())? 1 : 0;
+}
+
+ValueObject::iterator ValueObject::begin()
+{
+    return entries.begin();
+}
+
+ValueObject::iterator ValueObject::end()
+{
+    return entries.end();
+}
+
+ValueObject::const_iterator ValueObject::begin() const
+{
+    return entries.begin();
+}
+
+ValueObject::const_iterator ValueObject::end() const
+{
+    return entries.end();
+}
+
+size_t ValueObject::size() const
+{
+    return entries.size();
+}
+
+bool ValueObject::empty() const
+{
+    return entries.empty();
+}
+
+/*
+ * The existing entries are handed over by swapping their contents, a plain
+ * reserve would copy every sub tree before C++11.
+ */
+void ValueObject::reserve(size_t n)
+{
+    if (n <= entries.capacity()) {
+        return;
+    }
+
+    std::vector < value_type > grown;
+    grown.reserve(n);
+    grown.resize(entries.size());
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        grown[i].first.swap(entries[i].first);
+        grown[i].second.swap(entries[i].second);
+    }
+    entries.swap(grown);
+}
+
+void ValueObject::swap(ValueObject & other)
+{
+    entries.swap(other.entries);
+}
+
+Value::Value(void):t(null_t), nt(num_text)
 {
 }
 
-Value::Value(bool v):t(boolean_t), s((v) ? "true" : "false")
+Value::Value(bool v):t(boolean_t), nt(num_text), s((v) ? "true" : "false")
 {
 }
 
-Value::Value(double v):t(numeric_t), s(to_string(v))
+Value::Value(double v):t(numeric_t), nt(num_float)
 {
+    n.f = v;
 }
 
-Value::Value(long double v):t(numeric_t), s(to_string(v))
+Value::Value(long double v):t(numeric_t), nt(num_float)
 {
+    n.f = (double) v;
 }
 
-Value::Value(uint32_t v):t(numeric_t), s(to_string(v))
+Value::Value(uint32_t v):t(numeric_t), nt(num_uint)
 {
+    n.u = v;
 }
 
-Value::Value(int32_t v):t(numeric_t), s(to_string(v))
+Value::Value(int32_t v):t(numeric_t), nt(num_int)
 {
+    n.i = v;
 }
 
-Value::Value(uint64_t v):t(numeric_t), s(to_string(v))
+Value::Value(uint64_t v):t(numeric_t), nt(num_uint)
 {
+    n.u = v;
 }
 
-Value::Value(int64_t v):t(numeric_t), s(to_string(v))
+Value::Value(int64_t v):t(numeric_t), nt(num_int)
 {
+    n.i = v;
 }
 
-Value::Value(value_type type, const std::string & v):t(type), s(v)
+Value::Value(value_type type):t(type), nt(num_text)
 {
+    if (t == numeric_t) {
+        nt = num_uint;
+        n.u = 0;
+    } else if (t == boolean_t) {
+        s = "false";
+    }
+}
+
+Value::Value(value_type type, const std::string & v):t(type), nt(num_text),
+s(v)
+{
+    if (t == numeric_t) {
+        number_set(v.c_str(), v.size());
+    }
+}
+
+Value::Value(const std::vector < Value > &v):t(array_t), nt(num_text),
+array(v)
+{
+}
+
+#if __cplusplus >= 201103L
+Value::Value(ValueObject && v):t(object_t), nt(num_text), obj(std::move(v))
+{
+}
+
+Value::Value(std::map < std::string, Value > &&v):t(object_t), nt(num_text)
+{
+    std::map < std::string, Value >::iterator iter;
+
+    obj.reserve(v.size());
+    for (iter = v.begin(); iter != v.end(); ++iter) {
+        obj[iter->first].swap(iter->second);
+    }
 }
 
-Value::Value(const std::vector < Value > &v):t(array_t), array(v)
+Value::Value(std::vector < Value > &&v):t(array_t), nt(num_text),
+array(std::move(v))
 {
 }
+#endif
 
-Value::Value(const char *v)
+Value::Value(const char *v):nt(num_text)
 {
     if (v) {
         t = string_t;
@@ -255,30 +661,113 @@ Value::Value(const char *v)
     }
 }
 
-Value::Value(const std::string & v):t(string_t), s(v)
+Value::Value(const std::string & v):t(string_t), nt(num_text), s(v)
+{
+}
+
+Value::Value(const ValueObject & v):t(object_t), nt(num_text), obj(v)
+{
+}
+
+Value::Value(const std::map < std::string, Value > &v):t(object_t),
+nt(num_text), obj(v)
+{
+}
+
+void Value::number_set(const char *v, size_t len)
+{
+    t = numeric_t;
+    nt = num_text;
+
+    /* Only plain integers which fit in 64 bits are converted, anything else
+     * is kept as text and parsed when asked for. */
+    if (len > 0 && len < 21) {
+        bool neg = (v[0] == '-');
+        uint64_t u = 0;
+        size_t i = (neg) ? 1 : 0;
+
+        if (i < len) {
+            for (; i < len && v[i] >= '0' && v[i] <= '9'; ++i) {
+                uint64_t next = u * 10 + (v[i] - '0');
+                if (next / 10 != u) {
+                    break;
+                }
+                u = next;
+            }
+
+            if (i == len) {
+                if (!neg) {
+                    nt = num_uint;
+                    n.u = u;
+                } else if (u <= ((uint64_t) 1 << 63)) {
+                    nt = num_int;
+                    n.i = (int64_t) (0 - u);
+                }
+            }
+        }
+    }
+
+    if (nt == num_text) {
+        s.assign(v, len);
+    } else {
+        s.clear();
+    }
+}
+
+int Value::number_text(char *buf, size_t size)
 {
+    int rc = 0;
+
+    switch (nt) {
+    case (num_int):
+        rc = snprintf(buf, size, "%lld", (long long int) n.i);
+        break;
+    case (num_uint):
+        rc = snprintf(buf, size, "%llu", (long long unsigned int) n.u);
+        break;
+    case (num_float):
+        /* Same as what to_string() and so the stream defaults produce */
+        rc = snprintf(buf, size, "%g", n.f);
+        break;
+    case (num_text):
+        rc = snprintf(buf, size, "%s", s.c_str());
+        break;
+    }
+    return rc;
 }
 
-Value::Value(const std::map < std::string, Value > &v):t(object_t), obj(v)
+/*
+ * Indented json is only wanted when a human is going to read it, on the wire
+ * it just adds bytes to send and parse.  Set LSM_DEBUG_JSON in the
+ * environment to get it back.
+ */
+static int json_beautify(void)
 {
+    static int beautify = -1;
+
+    if (beautify < 0) {
+        beautify = (getenv("LSM_DEBUG_JSON") != NULL) ? 1 : 0;
+    }
+    return beautify;
 }
 
 std::string Value::serialize(void)
 {
     const unsigned char *buf;
     std::string json;
+    int beautify = json_beautify();
 
 #ifdef LSM_NEW_YAJL
     size_t len;
     yajl_gen g = yajl_gen_alloc(NULL);
-    if (g) {
+    if (g && beautify) {
         /* These could fail, but we will continue regardless */
         yajl_gen_config(g, yajl_gen_beautify, 1);
         yajl_gen_config(g, yajl_gen_indent_string, "  ");
     }
 #else
     unsigned int len;
-    yajl_gen_config conf = { 1, "  " };
+    yajl_gen_config conf = { beautify, "  " };
     yajl_gen g = yajl_gen_alloc(&conf, NULL);
 #endif
 
@@ -286,7 +775,7 @@ std::string Value::serialize(void)
         marshal(g);
 
         if (yajl_gen_status_ok == yajl_gen_get_buf(g, &buf, &len)) {
-            json = std::string((const char *) buf);
+            json.assign((const char *) buf, len);
         }
         yajl_gen_free(g);
     }
@@ -312,27 +801,27 @@ Value & Value::operator[](uint32_t i) {
     throw ValueException("Value not array");
 }
 
-bool Value::hasKey(const std::string & k)
+bool Value::hasKey(const std::string & k) const
 {
     if (t == object_t) {
-        std::map < std::string, Value >::iterator iter = obj.find(k);
-        if (iter != obj.end() && iter->first == k) {
-            return true;
-        }
+        return obj.count(k) != 0;
     }
     return false;
 }
 
-bool Value::isValidRequest()
+bool Value::isValidRequest() const
 {
     return (t == Value::object_t && hasKey("method") &&
             hasKey("id") && hasKey("params"));
 }
 
-Value Value::getValue(const char *key)
+Value Value::getValue(const char *key) const
 {
-    if (hasKey(key)) {
-        return obj[key];
+    if (t == object_t) {
+        ValueObject::const_iterator iter = obj.find(key);
+        if (iter != obj.end()) {
+            return iter->second;
+        }
     }
     return Value();
 }
@@ -342,12 +831,17 @@ const char *Value::asNumString()
     const char *rc = NULL;
 
     if (t == numeric_t) {
+        if (nt != num_text && s.empty()) {
+            char buf[64];
+            number_text(buf, sizeof(buf));
+            s = buf;
+        }
         rc = s.c_str();
     }
     return rc;
 }
 
-void *Value::asVoid()
+void *Value::asVoid() const
 {
     if (t == null_t) {
         return NULL;
@@ -355,7 +849,7 @@ void *Value::asVoid()
     throw ValueException("Value not null");
 }
 
-bool Value::asBool()
+bool Value::asBool() const
 {
     if (t == boolean_t) {
         return (s == "true");
@@ -363,24 +857,27 @@ bool Value::asBool()
     throw ValueException("Value not boolean");
 }
 
-double Value::asDouble()
+double Value::asDouble() const
 {
-    if (t == numeric_t) {
-        double rc;
-
-        if (sscanf(s.c_str(), "%lf", &rc) > 0) {
-            return rc;
-        }
-        throw ValueException("Value not a double");
-    }
-    throw ValueException("Value not numeric");
+    return (double) asLongDouble();
 }
 
-long double Value::asLongDouble()
+long double Value::asLongDouble() const
 {
     if (t == numeric_t) {
         long double rc;
 
+        switch (nt) {
+        case (num_int):
+            return (long double) n.i;
+        case (num_uint):
+            return (long double) n.u;
+        case (num_float):
+            return n.f;
+        case (num_text):
+            break;
+        }
+
         if (sscanf(s.c_str(), "%Lf", &rc) > 0) {
             return rc;
         }
@@ -389,11 +886,22 @@ long double Value::asLongDouble()
     throw ValueException("Value not numeric");
 }
 
-int32_t Value::asInt32_t()
+int32_t Value::asInt32_t() const
 {
     if (t == numeric_t) {
         int32_t rc;
 
+        switch (nt) {
+        case (num_int):
+            return (int32_t) n.i;
+        case (num_uint):
+            return (int32_t) n.u;
+        case (num_float):
+            return (int32_t) n.f;
+        case (num_text):
+            break;
+        }
+
         if (sscanf(s.c_str(), "%d", &rc) > 0) {
             return rc;
         }
@@ -402,10 +910,22 @@ int32_t Value::asInt32_t()
     throw ValueException("Value not numeric");
 }
 
-int64_t Value::asInt64_t()
+int64_t Value::asInt64_t() const
 {
     if (t == numeric_t) {
         int64_t rc;
+
+        switch (nt) {
+        case (num_int):
+            return n.i;
+        case (num_uint):
+            return (int64_t) n.u;
+        case (num_float):
+            return (int64_t) n.f;
+        case (num_text):
+            break;
+        }
+
         if (sscanf(s.c_str(), "%lld", (long long int *) &rc) > 0) {
             return rc;
         }
@@ -414,10 +934,22 @@ int64_t Value::asInt64_t()
     throw ValueException("Value not numeric");
 }
 
-uint32_t Value::asUint32_t()
+uint32_t Value::asUint32_t() const
 {
     if (t == numeric_t) {
         uint32_t rc;
+
+        switch (nt) {
+        case (num_int):
+            return (uint32_t) n.i;
+        case (num_uint):
+            return (uint32_t) n.u;
+        case (num_float):
+            return (uint32_t) n.f;
+        case (num_text):
+            break;
+        }
+
         if (sscanf(s.c_str(), "%u", &rc) > 0) {
             return rc;
         }
@@ -426,10 +958,22 @@ uint32_t Value::asUint32_t()
     throw ValueException("Value not numeric");
 }
 
-uint64_t Value::asUint64_t()
+uint64_t Value::asUint64_t() const
 {
     if (t == numeric_t) {
         uint64_t rc;
+
+        switch (nt) {
+        case (num_int):
+            return (uint64_t) n.i;
+        case (num_uint):
+            return n.u;
+        case (num_float):
+            return (uint64_t) n.f;
+        case (num_text):
+            break;
+        }
+
         if (sscanf(s.c_str(), "%llu", (long long unsigned int *) &rc) > 0) {
             return rc;
         }
@@ -438,7 +982,7 @@ uint64_t Value::asUint64_t()
     throw ValueException("Value not numeric");
 }
 
-std::string Value::asString()
+std::string Value::asString() const
 {
     if (t == string_t) {
         return s;
@@ -448,7 +992,7 @@ std::string Value::asString()
     throw ValueException("Value not string");
 }
 
-const char *Value::asC_str()
+const char *Value::asC_str() const
 {
     if (t == string_t) {
         return s.c_str();
@@ -458,7 +1002,15 @@ const char *Value::asC_str()
     throw ValueException("Value not string");
 }
 
-std::map < std::string, Value > Value::asObject()
+ValueObject & Value::asObject()
+{
+    if (t == object_t) {
+        return obj;
+    }
+    throw ValueException("Value not object");
+}
+
+const ValueObject & Value::asObject() const
 {
     if (t == object_t) {
         return obj;
@@ -466,7 +1018,7 @@ std::map < std::string, Value > Value::asObject()
     throw ValueException("Value not object");
 }
 
-std::vector < Value > Value::asArray()
+std::vector < Value > &Value::asArray()
 {
     if (t == array_t) {
         return array;
@@ -474,15 +1026,33 @@ std::vector < Value > Value::asArray()
     throw ValueException("Value not array");
 }
 
-void Value::marshal(yajl_gen g)
+const std::vector < Value > &Value::asArray() const
 {
-    switch (t) {
-    case (null_t):
-        {
-            if (yajl_gen_status_ok != yajl_gen_null(g)) {
-                throw ValueException("yajl_gen_null failure");
-            }
-            break;
+    if (t == array_t) {
+        return array;
+    }
+    throw ValueException("Value not array");
+}
+
+void Value::swap(Value & other)
+{
+    std::swap(t, other.t);
+    std::swap(nt, other.nt);
+    std::swap(n, other.n);
+    s.swap(other.s);
+    obj.swap(other.obj);
+    array.swap(other.array);
+}
+
+void Value::marshal(yajl_gen g)
+{
+    switch (t) {
+    case (null_t):
+        {
+            if (yajl_gen_status_ok != yajl_gen_null(g)) {
+                throw ValueException("yajl_gen_null failure");
+            }
+            break;
         }
     case (boolean_t):
         {
@@ -502,7 +1072,16 @@ void Value::marshal(yajl_gen g)
         }
     case (numeric_t):
         {
-            if (yajl_gen_status_ok != yajl_gen_number(g, s.c_str(), s.size())) {
+            char buf[64];
+            const char *num = s.c_str();
+            size_t len = s.size();
+
+            if (nt != num_text) {
+                num = buf;
+                len = number_text(buf, sizeof(buf));
+            }
+
+            if (yajl_gen_status_ok != yajl_gen_number(g, num, len)) {
                 throw ValueException("yajl_gen_number failure");
             }
             break;
@@ -514,9 +1093,9 @@ void Value::marshal(yajl_gen g)
                 throw ValueException("yajl_gen_map_open failure");
             }
 
-            std::map < std::string, Value >::iterator iter;
+            ValueObject::iterator iter;
 
-            for (iter = obj.begin(); iter != obj.end(); iter++) {
+            for (iter = obj.begin(); iter != obj.end(); ++iter) {
                 if (yajl_gen_status_ok != yajl_gen_string(g,
                                                           (const unsigned
                                                            char *) iter->first.
@@ -550,27 +1129,149 @@ void Value::marshal(yajl_gen g)
     }
 }
 
-class LSM_DLL_LOCAL ParseElement {
-  public:
+/*
+ * msgpack (https://msgpack.org) writers, each picks the smallest form which
+ * holds the value.
+ */
+
+/* Extension type for numbers msgpack can't hold, the payload is the text */
+#define MSGPACK_EXT_NUMBER 1
 
-    enum parse_type {
-        null, boolean, string, number, begin_map, end_map,
-        begin_array, end_array, map_key, unknown
-    };
+static void pack_be(std::string & out, unsigned char marker, uint64_t v,
+                    int bytes)
+{
+    char b[9];
 
-    ParseElement():t(unknown) {
-    } ParseElement(parse_type type):t(type) {
+    b[0] = (char) marker;
+    for (int i = bytes; i > 0; --i) {
+        b[i] = (char) (v & 0xff);
+        v >>= 8;
     }
+    out.append(b, bytes + 1);
+}
 
-  ParseElement(parse_type type, std::string value):t(type), v(value) {
+static void pack_uint(std::string & out, uint64_t v)
+{
+    if (v < 0x80) {
+        out += (char) v;
+    } else if (v <= 0xff) {
+        pack_be(out, 0xcc, v, 1);
+    } else if (v <= 0xffff) {
+        pack_be(out, 0xcd, v, 2);
+    } else if (v <= 0xffffffffU) {
+        pack_be(out, 0xce, v, 4);
+    } else {
+        pack_be(out, 0xcf, v, 8);
     }
-    parse_type t;
-    std::string v;
+}
 
-    std::string to_string() {
-        return "type " +::to_string(t) + ": value" + v;
+static void pack_int(std::string & out, int64_t v)
+{
+    if (v >= 0) {
+        pack_uint(out, (uint64_t) v);
+    } else if (v >= -32) {
+        out += (char) v;
+    } else if (v >= -128) {
+        pack_be(out, 0xd0, (uint64_t) v, 1);
+    } else if (v >= -32768) {
+        pack_be(out, 0xd1, (uint64_t) v, 2);
+    } else if (v >= -2147483647 - 1) {
+        pack_be(out, 0xd2, (uint64_t) v, 4);
+    } else {
+        pack_be(out, 0xd3, (uint64_t) v, 8);
     }
-};
+}
+
+static void pack_double(std::string & out, double v)
+{
+    uint64_t bits;
+
+    memcpy(&bits, &v, sizeof(bits));
+    pack_be(out, 0xcb, bits, 8);
+}
+
+static void pack_str(std::string & out, const std::string & v)
+{
+    size_t len = v.size();
+
+    if (len < 32) {
+        out += (char) (0xa0 | len);
+    } else if (len <= 0xff) {
+        pack_be(out, 0xd9, len, 1);
+    } else if (len <= 0xffff) {
+        pack_be(out, 0xda, len, 2);
+    } else {
+        pack_be(out, 0xdb, len, 4);
+    }
+    out += v;
+}
+
+static void pack_container(std::string & out, unsigned char fix,
+                           unsigned char marker16, size_t n)
+{
+    if (n < 16) {
+        out += (char) (fix | n);
+    } else if (n <= 0xffff) {
+        pack_be(out, marker16, n, 2);
+    } else {
+        pack_be(out, marker16 + 1, n, 4);
+    }
+}
+
+void Value::pack(std::string & out)
+{
+    switch (t) {
+    case (null_t):
+        out += (char) 0xc0;
+        break;
+    case (boolean_t):
+        out += (char) ((asBool())? 0xc3 : 0xc2);
+        break;
+    case (string_t):
+        pack_str(out, s);
+        break;
+    case (numeric_t):
+        switch (nt) {
+        case (num_int):
+            pack_int(out, n.i);
+            break;
+        case (num_uint):
+            pack_uint(out, n.u);
+            break;
+        case (num_float):
+            pack_double(out, n.f);
+            break;
+        case (num_text):
+            //Fractions and integers too big for 64 bits, kept as their text
+            if (s.size() <= 0xff) {
+                pack_be(out, 0xc7, s.size(), 1);
+                out += (char) MSGPACK_EXT_NUMBER;
+                out += s;
+            } else {
+                pack_double(out, strtod(s.c_str(), NULL));
+            }
+            break;
+        }
+        break;
+    case (object_t):
+        {
+            ValueObject::iterator iter;
+
+            pack_container(out, 0x80, 0xde, obj.size());
+            for (iter = obj.begin(); iter != obj.end(); ++iter) {
+                pack_str(out, iter->first);
+                iter->second.pack(out);
+            }
+            break;
+        }
+    case (array_t):
+        pack_container(out, 0x90, 0xdc, array.size());
+        for (size_t i = 0; i < array.size(); ++i) {
+            array[i].pack(out);
+        }
+        break;
+    }
+}
 
 #ifdef LSM_NEW_YAJL
 #define YAJL_SIZE_T size_t
@@ -578,69 +1279,184 @@ class LSM_DLL_LOCAL ParseElement {
 #define YAJL_SIZE_T unsigned int
 #endif
 
-static int handle_value(void *ctx, ParseElement::parse_type type)
+/**
+ * Parser state handed to the yajl callbacks, the Value tree is built in place
+ * as the tokens arrive.
+ */
+class LSM_DLL_LOCAL ParseContext {
+  public:
+    ParseContext() {
+    }
+
+    /**
+     * Creates a new value at the current position in the tree.
+     * @param type  Type of the new value
+     * @param v     String representation for scalar types
+     * @param len   Length of v
+     * @return Pointer to the new value, valid until the enclosing
+     *         container has been closed.
+     */
+    Value *add(Value::value_type type, const char *v = NULL, size_t len = 0);
+
+    /**
+     * Opens a new object or array at the current position.
+     * @param type  object_t or array_t
+     */
+    void open(Value::value_type type);
+
+    /**
+     * Closes the innermost object or array.
+     * @param type  object_t or array_t
+     * @return true on success, false if nothing of that type is open
+     */
+    bool close(Value::value_type type);
+
+    Value root;
+    std::vector < Value * >stack;  //Containers currently open, innermost last
+    std::string key;            //Pending key for the innermost object
+
+    /**
+     * Reserves room for n entries in the innermost container.
+     * @param n     Number of entries expected
+     */
+    void reserve(size_t n);
+
+  private:
+    Value & append(std::vector < Value > &array);
+};
+
+/*
+ * Appends a null entry to array.  When the array needs to grow we hand over
+ * the existing entries by swapping their contents instead of letting the
+ * vector copy each sub tree.
+ */
+Value & ParseContext::append(std::vector < Value > &array)
+{
+    if (array.size() == array.capacity()) {
+        std::vector < Value > grown;
+        grown.reserve(array.empty()? 8 : array.size() * 2);
+        grown.resize(array.size());
+
+        for (size_t i = 0; i < array.size(); ++i) {
+            grown[i].swap(array[i]);
+        }
+        array.swap(grown);
+    }
+    array.push_back(Value());
+    return array.back();
+}
+
+Value *ParseContext::add(Value::value_type type, const char *v, size_t len)
 {
-    std::list < ParseElement > *l = (std::list < ParseElement > *)ctx;
-    l->push_back(ParseElement(type));
-    return 1;
+    Value *rc = &root;
+
+    if (!stack.empty()) {
+        Value *top = stack.back();
+
+        if (top->t == Value::object_t) {
+            rc = &top->obj[key];
+            if (rc->t != Value::null_t) {
+                //Duplicate key, last one wins
+                *rc = Value();
+            }
+        } else {
+            rc = &append(top->array);
+        }
+    }
+
+    if (type == Value::numeric_t) {
+        rc->number_set(v, len);
+    } else {
+        rc->t = type;
+        if (v) {
+            rc->s.assign(v, len);
+        }
+    }
+    return rc;
 }
 
-static int handle_value(void *ctx, ParseElement::parse_type type,
-                        const char *s, size_t len)
+void ParseContext::reserve(size_t n)
 {
-    std::list < ParseElement > *l = (std::list < ParseElement > *)ctx;
-    l->push_back(ParseElement(type, std::string(s, len)));
-    return 1;
+    if (!stack.empty()) {
+        if (stack.back()->t == Value::object_t) {
+            stack.back()->obj.reserve(n);
+        } else {
+            stack.back()->array.reserve(n);
+        }
+    }
+}
+
+void ParseContext::open(Value::value_type type)
+{
+    stack.push_back(add(type));
+}
+
+bool ParseContext::close(Value::value_type type)
+{
+    if (stack.empty() || stack.back()->t != type) {
+        return false;
+    }
+    stack.pop_back();
+    return true;
 }
 
 static int handle_null(void *ctx)
 {
-    return handle_value(ctx, ParseElement::null);
+    ((ParseContext *) ctx)->add(Value::null_t);
+    return 1;
 }
 
 static int handle_boolean(void *ctx, int boolean)
 {
-    std::string b = (boolean) ? "true" : "false";
-    return handle_value(ctx, ParseElement::boolean, b.c_str(), b.size());
+    if (boolean) {
+        ((ParseContext *) ctx)->add(Value::boolean_t, "true", 4);
+    } else {
+        ((ParseContext *) ctx)->add(Value::boolean_t, "false", 5);
+    }
+    return 1;
 }
 
 static int handle_number(void *ctx, const char *s, YAJL_SIZE_T len)
 {
-    return handle_value(ctx, ParseElement::number, s, len);
+    ((ParseContext *) ctx)->add(Value::numeric_t, s, len);
+    return 1;
 }
 
 static int handle_string(void *ctx, const unsigned char *stringVal,
                          YAJL_SIZE_T len)
 {
-    return handle_value(ctx, ParseElement::string,
-                        (const char *) stringVal, len);
+    ((ParseContext *) ctx)->add(Value::string_t, (const char *) stringVal,
+                                len);
+    return 1;
 }
 
 static int handle_map_key(void *ctx, const unsigned char *stringVal,
                           YAJL_SIZE_T len)
 {
-    return handle_value(ctx, ParseElement::map_key,
-                        (const char *) stringVal, len);
+    ((ParseContext *) ctx)->key.assign((const char *) stringVal, len);
+    return 1;
 }
 
 static int handle_start_map(void *ctx)
 {
-    return handle_value(ctx, ParseElement::begin_map);
+    ((ParseContext *) ctx)->open(Value::object_t);
+    return 1;
 }
 
 static int handle_end_map(void *ctx)
 {
-    return handle_value(ctx, ParseElement::end_map);
+    return ((ParseContext *) ctx)->close(Value::object_t) ? 1 : 0;
 }
 
 static int handle_start_array(void *ctx)
 {
-    return handle_value(ctx, ParseElement::begin_array);
+    ((ParseContext *) ctx)->open(Value::array_t);
+    return 1;
 }
 
 static int handle_end_array(void *ctx)
 {
-    return handle_value(ctx, ParseElement::end_array);
+    return ((ParseContext *) ctx)->close(Value::array_t) ? 1 : 0;
 }
 
 static yajl_callbacks callbacks = {
@@ -657,150 +1473,276 @@ static yajl_callbacks callbacks = {
     handle_end_array
 };
 
-static ParseElement get_next(std::list < ParseElement > &l)
-{
-    ParseElement rc = l.front();
-    l.pop_front();
-    return rc;
-}
-
-static Value ParseElements(std::list < ParseElement > &l);
+/*
+ * msgpack reader, the values are added to the same ParseContext the json
+ * parser uses.
+ */
+#define MSGPACK_MAX_DEPTH 256
 
-static Value HandleArray(std::list < ParseElement > &l)
+static uint64_t unpack_be(const unsigned char *&p, const unsigned char *end,
+                          int bytes)
 {
-    std::vector < Value > values;
+    uint64_t v = 0;
 
-    ParseElement cur;
-
-    if (!l.empty()) {
-        do {
-            cur = l.front();
-
-            if (cur.t != ParseElement::end_array) {
-                values.push_back(ParseElements(l));
-            } else {
-                get_next(l);
-            }
+    if (end - p < bytes) {
+        throw ValueException("In-valid msgpack");
+    }
+    for (int i = 0; i < bytes; ++i) {
+        v = (v << 8) | *p++;
+    }
+    return v;
+}
 
-        } while (!l.empty() && cur.t != ParseElement::end_array);
+/*
+ * Returns the length of the str or bin at p, stepping over its header,
+ * or -1 if something else is there.
+ */
+static int64_t unpack_str_len(const unsigned char *&p,
+                              const unsigned char *end)
+{
+    int64_t len = -1;
+    const unsigned char *start = p;
+    unsigned char m = *p++;
+
+    if ((m & 0xe0) == 0xa0) {
+        len = m & 0x1f;
+    } else if (m == 0xd9 || m == 0xc4) {
+        len = unpack_be(p, end, 1);
+    } else if (m == 0xda || m == 0xc5) {
+        len = unpack_be(p, end, 2);
+    } else if (m == 0xdb || m == 0xc6) {
+        len = unpack_be(p, end, 4);
+    } else {
+        p = start;
+        return -1;
     }
 
-    return Value(values);
+    if (end - p < len) {
+        throw ValueException("In-valid msgpack");
+    }
+    return len;
 }
 
-static Value HandleObject(std::list < ParseElement > &l)
+static const unsigned char *unpack(ParseContext & ctx,
+                                   const unsigned char *p,
+                                   const unsigned char *end, int depth);
+
+static const unsigned char *unpack_container(ParseContext & ctx,
+                                             Value::value_type type,
+                                             uint64_t n,
+                                             const unsigned char *p,
+                                             const unsigned char *end,
+                                             int depth)
 {
-    std::map < std::string, Value > values;
-    ParseElement cur;
+    //Every entry takes at least a byte, don't reserve for garbage
+    if (n > (uint64_t) (end - p) || depth > MSGPACK_MAX_DEPTH) {
+        throw ValueException("In-valid msgpack");
+    }
 
-    if (!l.empty()) {
-        do {
-            cur = get_next(l);
+    ctx.open(type);
+    ctx.reserve(n);
 
-            if (cur.t == ParseElement::map_key) {
-                values[cur.v] = ParseElements(l);
-            } else if (cur.t != ParseElement::end_map) {
-                throw ValueException("Unexpected state: " + cur.to_string());
+    for (uint64_t i = 0; i < n; ++i) {
+        if (type == Value::object_t) {
+            int64_t len = (p < end) ? unpack_str_len(p, end) : -1;
+            if (len < 0) {
+                throw ValueException("In-valid msgpack");
             }
-        } while (!l.empty() && cur.t != ParseElement::end_map);
+            ctx.key.assign((const char *) p, len);
+            p += len;
+        }
+        p = unpack(ctx, p, end, depth + 1);
     }
-    return Value(values);
+
+    ctx.close(type);
+    return p;
 }
 
-static Value ParseElements(std::list < ParseElement > &l)
+static const unsigned char *unpack(ParseContext & ctx,
+                                   const unsigned char *p,
+                                   const unsigned char *end, int depth)
 {
-    if (!l.empty()) {
-        ParseElement cur = get_next(l);
+    if (p >= end) {
+        throw ValueException("In-valid msgpack");
+    }
 
-        switch (cur.t) {
-        case (ParseElement::null):
-        case (ParseElement::boolean):
-        case (ParseElement::string):
-        case (ParseElement::number):
-            {
-                return Value((Value::value_type) cur.t, cur.v);
-                break;
-            }
-        case (ParseElement::begin_map):
-            {
-                return HandleObject(l);
-                break;
-            }
-        case (ParseElement::end_map):
-            {
-                throw ValueException("Unexpected end_map");
-                break;
-            }
-        case (ParseElement::begin_array):
-            {
-                return HandleArray(l);
-                break;
-            }
-        case (ParseElement::end_array):
+    int64_t len = unpack_str_len(p, end);
+    if (len >= 0) {
+        ctx.add(Value::string_t, (const char *) p, len);
+        return p + len;
+    }
+
+    unsigned char m = *p++;
+
+    if (m < 0x80) {
+        *ctx.add(Value::null_t) = Value((uint64_t) m);
+    } else if (m >= 0xe0) {
+        *ctx.add(Value::null_t) = Value((int64_t) (int8_t) m);
+    } else if ((m & 0xf0) == 0x80) {
+        p = unpack_container(ctx, Value::object_t, m & 0x0f, p, end, depth);
+    } else if ((m & 0xf0) == 0x90) {
+        p = unpack_container(ctx, Value::array_t, m & 0x0f, p, end, depth);
+    } else {
+        switch (m) {
+        case (0xc0):
+            ctx.add(Value::null_t);
+            break;
+        case (0xc2):
+            ctx.add(Value::boolean_t, "false", 5);
+            break;
+        case (0xc3):
+            ctx.add(Value::boolean_t, "true", 4);
+            break;
+        case (0xca):
             {
-                throw ValueException("Unexpected end_array");
+                uint32_t bits = (uint32_t) unpack_be(p, end, 4);
+                float f;
+                memcpy(&f, &bits, sizeof(f));
+                *ctx.add(Value::null_t) = Value((double) f);
                 break;
             }
-        case (ParseElement::map_key):
+        case (0xcb):
             {
-                throw ValueException("Unexpected map_key");
+                uint64_t bits = unpack_be(p, end, 8);
+                double d;
+                memcpy(&d, &bits, sizeof(d));
+                *ctx.add(Value::null_t) = Value(d);
                 break;
             }
-        case (ParseElement::unknown):
-            {
-                throw ValueException("Unexpected unknown");
-                break;
+        case (0xcc):
+        case (0xcd):
+        case (0xce):
+        case (0xcf):
+            *ctx.add(Value::null_t) = Value(unpack_be(p, end, 1 << (m - 0xcc)));
+            break;
+        case (0xd0):
+            *ctx.add(Value::null_t) =
+                Value((int64_t) (int8_t) unpack_be(p, end, 1));
+            break;
+        case (0xd1):
+            *ctx.add(Value::null_t) =
+                Value((int64_t) (int16_t) unpack_be(p, end, 2));
+            break;
+        case (0xd2):
+            *ctx.add(Value::null_t) =
+                Value((int64_t) (int32_t) unpack_be(p, end, 4));
+            break;
+        case (0xd3):
+            *ctx.add(Value::null_t) = Value((int64_t) unpack_be(p, end, 8));
+            break;
+        case (0xc7):
+            len = unpack_be(p, end, 1);
+            if (end - p < len + 1 || *p != MSGPACK_EXT_NUMBER) {
+                throw ValueException("In-valid msgpack");
             }
+            ctx.add(Value::numeric_t, (const char *) p + 1, len);
+            p += len + 1;
+            break;
+        case (0xdc):
+        case (0xdd):
+            len = unpack_be(p, end, (m == 0xdc) ? 2 : 4);
+            p = unpack_container(ctx, Value::array_t, len, p, end, depth);
+            break;
+        case (0xde):
+        case (0xdf):
+            len = unpack_be(p, end, (m == 0xde) ? 2 : 4);
+            p = unpack_container(ctx, Value::object_t, len, p, end, depth);
+            break;
+        default:
+            //Extension types and the never used 0xc1
+            throw ValueException("In-valid msgpack");
         }
     }
-    return Value();
+    return p;
 }
 
-std::string Payload::serialize(Value & v)
+std::string Payload::serialize(Value & v, encoding_type encoding)
 {
+    if (encoding == msgpack_t) {
+        std::string rc;
+        v.pack(rc);
+        return rc;
+    }
     return v.serialize();
 }
 
-Value Payload::deserialize(const std::string & json)
+Value Payload::deserialize(const std::string & data,
+                            encoding_type encoding)
+{
+    return deserialize(data.data(), data.size(), encoding);
+}
+
+Value Payload::deserialize(const char *data, size_t len,
+                           encoding_type encoding)
 {
     yajl_handle hand;
     yajl_status stat;
-    std::list < ParseElement > l;
+    ParseContext ctx;
+    Value rc;
+
+    if (encoding == msgpack_t) {
+        const unsigned char *p = (const unsigned char *) data;
+        const unsigned char *end = p + len;
+
+        if (unpack(ctx, p, end, 0) != end) {
+            throw ValueException("In-valid msgpack");
+        }
+        rc.swap(ctx.root);
+        return rc;
+    }
 
 #ifdef LSM_NEW_YAJL
-    hand = yajl_alloc(&callbacks, NULL, (void *) &l);
+    hand = yajl_alloc(&callbacks, NULL, (void *) &ctx);
     yajl_config(hand, yajl_allow_comments, 1);
 #else
     yajl_parser_config cfg = { 1, 1 };
-    hand = yajl_alloc(&callbacks, &cfg, NULL, (void *) &l);
+    hand = yajl_alloc(&callbacks, &cfg, NULL, (void *) &ctx);
 #endif
 
     if (hand) {
         stat =
-            yajl_parse(hand, (const unsigned char *) json.c_str(), json.size());
+            yajl_parse(hand, (const unsigned char *) data, len);
         yajl_free(hand);
 
-        if (stat == yajl_status_ok) {
-            return ParseElements(l);
+        if (stat == yajl_status_ok && ctx.stack.empty()) {
+            rc.swap(ctx.root);
         } else {
             throw ValueException("In-valid json");
         }
     }
-    return Value();
+    return rc;
 }
 
+/**
+ * Holds a mutex for the life time of the object.
+ */
+class ScopedLock {
+  public:
+    ScopedLock(pthread_mutex_t & mutex):m(mutex) {
+        pthread_mutex_lock(&m);
+    }
+    ~ScopedLock() {
+        pthread_mutex_unlock(&m);
+    }
+  private:
+    pthread_mutex_t & m;
+};
+
 Ipc::Ipc()
 {
+    init();
 }
 
 Ipc::Ipc(int fd):t(fd)
 {
+    init();
 }
 
 Ipc::Ipc(std::string socket_path)
 {
     int e = 0;
     int fd = Transport::socket_get(socket_path, e);
+    init();
     if (fd >= 0) {
         t = Transport(fd);
     }
@@ -809,21 +1751,66 @@ Ipc::Ipc(std::string socket_path)
 Ipc::~Ipc()
 {
     t.close();
+    pthread_cond_destroy(&recv_cond);
+    pthread_mutex_destroy(&recv_lock);
+    pthread_mutex_destroy(&call_lock);
+    pthread_mutex_destroy(&send_lock);
+}
+
+void Ipc::init(void)
+{
+    enc = Payload::json_t;
+    multiplex = false;
+    next_id = 1;
+    reading = false;
+    failed = false;
+    pthread_mutex_init(&send_lock, NULL);
+    pthread_mutex_init(&call_lock, NULL);
+    pthread_mutex_init(&recv_lock, NULL);
+
+    //Deadlines are CLOCK_MONOTONIC times
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&recv_cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+int32_t Ipc::idNext(void)
+{
+    ScopedLock l(recv_lock);
+    int32_t id = next_id;
+
+    next_id = (next_id == 0x7FFFFFFF) ? 1 : next_id + 1;
+    return id;
 }
 
 void Ipc::requestSend(const std::string request, const Value & params,
-                      int32_t id)
+                      int32_t id, uint64_t deadline, const Value & protocol)
 {
     int rc = 0;
     int ec = 0;
-    std::map < std::string, Value > v;
+    ValueObject v;
 
     v["method"] = Value(request);
     v["id"] = Value(id);
     v["params"] = params;
 
+    if (Value::null_t != protocol.valueType()) {
+        v["protocol"] = protocol;
+    }
+
     Value req(v);
-    rc = t.msg_send(Payload::serialize(req), ec);
+    std::string msg = Payload::serialize(req, enc);
+    {
+        ScopedLock l(send_lock);
+        rc = t.msg_send(msg.data(), msg.size(), ec, deadline);
+    }
+
+    if (rc != 0 && ETIMEDOUT == ec) {
+        std::string em("Plug-in did not take the request in time");
+        throw LsmException((int) LSM_ERR_TIMEOUT, em);
+    }
 
     if (rc != 0) {
         std::string em = std::string("Error sending message: errno ")
@@ -837,8 +1824,8 @@ void Ipc::errorSend(int error_code, std::string msg, std::string debug,
 {
     int ec = 0;
     int rc = 0;
-    std::map < std::string, Value > v;
-    std::map < std::string, Value > error_data;
+    ValueObject v;
+    ValueObject error_data;
 
     error_data["code"] = Value(error_code);
     error_data["message"] = Value(msg);
@@ -848,7 +1835,14 @@ void Ipc::errorSend(int error_code, std::string msg, std::string debug,
     v["id"] = Value(id);
 
     Value e(v);
-    rc = t.msg_send(Payload::serialize(e), ec);
+    std::string m = Payload::serialize(e, enc);
+    {
+        ScopedLock l(send_lock);
+        rc = t.msg_send(m, ec);
+
+        //Whatever was agreed on, the registration did not go through
+        pending = Value();
+    }
 
     if (rc != 0) {
         std::string em = std::string("Error sending error message: errno ")
@@ -857,40 +1851,165 @@ void Ipc::errorSend(int error_code, std::string msg, std::string debug,
     }
 }
 
+/*
+ * Keeping a buffer of a huge response around for the rest of the connection
+ * is not worth saving an allocation.
+ */
+#define RECV_BUF_KEEP (1024 * 1024)
+
 Value Ipc::readRequest(void)
 {
     int ec;
-    std::string resp = t.msg_recv(ec);
-    return Payload::deserialize(resp);
+    Value rc;
+
+    t.msg_recv(recv_buf, ec);
+    Payload::deserialize(recv_buf.data(), recv_buf.size(), enc).swap(rc);
+
+    if (recv_buf.capacity() > RECV_BUF_KEEP) {
+        std::string().swap(recv_buf);
+    }
+    return rc;
 }
 
-void Ipc::responseSend(const Value & response, uint32_t id)
+void Ipc::responseSend(Value & response, uint32_t id)
 {
     int rc;
     int ec;
-    std::map < std::string, Value > v;
+    Value resp(Value::object_t);
 
-    v["id"] = id;
-    v["result"] = response;
+    resp["id"] = Value(id);
+    resp["result"].swap(response);
 
-    Value resp(v);
-    rc = t.msg_send(Payload::serialize(resp), ec);
+    std::string msg = Payload::serialize(resp, enc);
+    ScopedLock l(send_lock);
+    rc = t.msg_send(msg, ec);
 
     if (rc != 0) {
         std::string em = std::string("Error sending response: errno ")
             +::to_string(ec);
         throw LsmException((int) LSM_ERR_TRANSPORT_COMMUNICATION, em);
     }
+
+    if (pending.valueType() != Value::null_t) {
+        protocolSet(pending);
+        pending = Value();
+    }
+}
+
+Value Ipc::responseRead(int32_t id, uint64_t deadline)
+{
+    Value r;
+    ScopedLock l(recv_lock);
+
+    while (true) {
+        std::map<int32_t, Value>::iterator i = replies.find(id);
+        if (i != replies.end()) {
+            r.swap(i->second);
+            replies.erase(i);
+            break;
+        }
+
+        if (failed) {
+            throw EOFException("");
+        }
+
+        if (deadline && monotonic_ms() >= deadline) {
+            responseAbandon(id);
+        }
+
+        if (reading) {
+            if (deadline) {
+                struct timespec ts;
+
+                ts.tv_sec = deadline / 1000;
+                ts.tv_nsec = (deadline % 1000) * 1000000;
+                pthread_cond_timedwait(&recv_cond, &recv_lock, &ts);
+            } else {
+                pthread_cond_wait(&recv_cond, &recv_lock);
+            }
+            continue;
+        }
+
+        //Nobody is reading, read for everyone until ours shows up
+        Value m;
+        bool got = false;
+        reading = true;
+        pthread_mutex_unlock(&recv_lock);
+        try {
+            int ec = 0;
+
+            got = t.msg_recv(recv_buf, ec, deadline);
+            if (got) {
+                Payload::deserialize(recv_buf.data(), recv_buf.size(),
+                                     enc).swap(m);
+            }
+        }
+        catch( ...) {
+            pthread_mutex_lock(&recv_lock);
+            reading = false;
+            failed = true;
+            pthread_cond_broadcast(&recv_cond);
+            throw;
+        }
+
+        if (recv_buf.capacity() > RECV_BUF_KEEP) {
+            std::string().swap(recv_buf);
+        }
+
+        pthread_mutex_lock(&recv_lock);
+        reading = false;
+        if (got) {
+            responseFile(m, id);
+        } else {
+            //Out of time, somebody else may read on
+            pthread_cond_broadcast(&recv_cond);
+        }
+    }
+
+    return responseResult(r);
+}
+
+void Ipc::responseFile(Value & m, int32_t id)
+{
+    int32_t got = id;
+    Value mid = m.getValue("id");
+    if (multiplex && Value::numeric_t == mid.valueType()) {
+        got = mid.asInt32_t();
+    }
+
+    std::set<int32_t>::iterator a = abandoned.find(got);
+    if (a != abandoned.end()) {
+        abandoned.erase(a);
+        return;
+    }
+
+    replies[got].swap(m);
+    pthread_cond_broadcast(&recv_cond);
+}
+
+void Ipc::responseAbandon(int32_t id)
+{
+    std::string msg("Plug-in did not respond in time");
+
+    if (multiplex) {
+        abandoned.insert(id);
+    } else {
+        //The late response would be taken for the next one
+        failed = true;
+    }
+    pthread_cond_broadcast(&recv_cond);
+    throw LsmException((int) LSM_ERR_TIMEOUT, msg);
 }
 
-Value Ipc::responseRead()
+Value Ipc::responseResult(Value & r)
 {
-    Value r = readRequest();
     if (r.hasKey(std::string("result"))) {
-        return r.getValue("result");
+        Value result;
+        result.swap(r["result"]);
+        return result;
     } else {
-        std::map < std::string, Value > rp = r.asObject();
-        std::map < std::string, Value > error = rp["error"].asObject();
+        ValueObject & rp = r.asObject();
+        ValueObject & error = rp["error"].asObject();
 
         std::string msg = error["message"].asString();
         std::string data = error["data"].asString();
@@ -898,8 +2017,185 @@ Value Ipc::responseRead()
     }
 }
 
-Value Ipc::rpc(const std::string & request, const Value & params, int32_t id)
+int32_t Ipc::requestSubmit(const std::string & request, const Value & params)
 {
+    int32_t id = idNext();
     requestSend(request, params, id);
-    return responseRead();
+    return id;
+}
+
+void Ipc::responsesRead(void)
+{
+    {
+        ScopedLock l(recv_lock);
+        if (failed) {
+            throw EOFException("");
+        }
+
+        if (reading) {
+            return;
+        }
+        reading = true;
+    }
+
+    try {
+        int ec = 0;
+
+        while (t.msg_recv_nb(recv_buf, ec)) {
+            Value m;
+            Payload::deserialize(recv_buf.data(), recv_buf.size(),
+                                 enc).swap(m);
+
+            ScopedLock l(recv_lock);
+            responseFile(m, 0);
+        }
+    }
+    catch( ...) {
+        ScopedLock l(recv_lock);
+        reading = false;
+        failed = true;
+        pthread_cond_broadcast(&recv_cond);
+        throw;
+    }
+
+    if (recv_buf.capacity() > RECV_BUF_KEEP) {
+        std::string().swap(recv_buf);
+    }
+
+    ScopedLock l(recv_lock);
+    reading = false;
+    pthread_cond_broadcast(&recv_cond);
+}
+
+bool Ipc::responseTake(int32_t id, Value & result)
+{
+    Value r;
+    {
+        ScopedLock l(recv_lock);
+        std::map<int32_t, Value>::iterator i = replies.find(id);
+        if (i == replies.end()) {
+            if (failed) {
+                throw EOFException("");
+            }
+            return false;
+        }
+        r.swap(i->second);
+        replies.erase(i);
+    }
+
+    responseResult(r).swap(result);
+    return true;
+}
+
+Value Ipc::rpc(const std::string & request, const Value & params,
+              uint64_t deadline, const Value & protocol)
+{
+    if (!multiplex) {
+        ScopedLock l(call_lock);
+        requestSend(request, params, 100, deadline, protocol);
+        return responseRead(100, deadline);
+    }
+
+    int32_t id = idNext();
+    requestSend(request, params, id, deadline, protocol);
+    return responseRead(id, deadline);
+}
+
+static bool encoding_get(const std::string & name,
+                         Payload::encoding_type & encoding)
+{
+    if (name == "json") {
+        encoding = Payload::json_t;
+        return true;
+    }
+
+    //Debugging wants something readable on the wire
+    if (name == "msgpack" && !json_beautify()) {
+        encoding = Payload::msgpack_t;
+        return true;
+    }
+    return false;
+}
+
+Value Ipc::protocolOffer(void)
+{
+    Value offer(Value::object_t);
+    Value encodings(Value::array_t);
+    Payload::encoding_type e;
+
+    //Most preferred first
+    if (encoding_get("msgpack", e)) {
+        encodings.asArray().push_back(Value("msgpack"));
+    }
+    encodings.asArray().push_back(Value("json"));
+
+    offer["version"] = Value(PROTOCOL_V2);
+    offer["encodings"].swap(encodings);
+    return offer;
+}
+
+Value Ipc::protocolSelect(const Value & offer)
+{
+    Value agreed;
+    Value version = offer.getValue("version");
+    Value encodings = offer.getValue("encodings");
+
+    pending = Value();
+
+    //Version is the highest the client speaks, we only go up to 2
+    if (Value::numeric_t == version.valueType() &&
+        version.asInt64_t() >= PROTOCOL_V2 &&
+        Value::array_t == encodings.valueType()) {
+        const std::vector < Value > &names = encodings.asArray();
+        Payload::encoding_type e;
+
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (Value::string_t == names[i].valueType() &&
+                encoding_get(names[i].asString(), e)) {
+                agreed = Value(Value::object_t);
+                agreed["version"] = Value(PROTOCOL_V2);
+                agreed["encoding"] = names[i];
+                pending = agreed;
+                break;
+            }
+        }
+    }
+    return agreed;
+}
+
+void Ipc::protocolSet(const Value & agreed)
+{
+    Value version = agreed.getValue("version");
+    Value encoding = agreed.getValue("encoding");
+    Payload::encoding_type e;
+
+    if (Value::numeric_t == version.valueType() &&
+        version.asInt64_t() == PROTOCOL_V2 &&
+        Value::string_t == encoding.valueType() &&
+        encoding_get(encoding.asString(), e)) {
+        enc = e;
+        t.binary_header_set(true);
+        multiplex = true;
+    }
+}
+
+bool Ipc::idleOk(void)
+{
+    return t.idle_ok();
+}
+
+int Ipc::fd(void)
+{
+    return t.fd_get();
+}
+
+bool Ipc::multiplexed(void)
+{
+    return multiplex;
+}
+
+bool Ipc::usable(void)
+{
+    ScopedLock l(recv_lock);
+    return !failed;
 }
@@ -23,8 +23,10 @@
 #include <yajl/yajl_parse.h>
 #include <yajl/yajl_gen.h>
 #include <stdint.h>
+#include <pthread.h>
 #include <string>
 #include <map>
+#include <set>
 #include <vector>
 #include <sstream>
 #include <stdexcept>
@@ -44,6 +46,12 @@ class LSM_DLL_LOCAL Transport {
      */
     const static int HDR_LEN = 10;
 
+    /**
+     * Size of the binary header (payload length as a network byte order
+     * uint32) used instead once protocol version 2 is agreed on.
+     */
+    const static int HDR_BIN_LEN = 4;
+
     /**
      * Empty ctor.
      * @return
@@ -69,6 +77,30 @@ class LSM_DLL_LOCAL Transport {
      */
     int msg_send(const std::string & msg, int &error_code);
 
+    /**
+     * Sends a message held in a caller's buffer, the header and the payload
+     * are written with a single sendmsg() instead of being joined first.
+     * @param[in]   msg         The message to be sent.
+     * @param[in]   len         Length of msg
+     * @param[out]  error_code  Errno (only valid if we return -1)
+     * @return 0 on success, else -1
+     */
+    int msg_send(const char *msg, size_t len, int &error_code);
+
+    /**
+     * Sends a message, giving up at a deadline.  A message given up on
+     * part way shuts the socket down, as the other side could not tell
+     * where the next one starts.
+     * @param[in]   msg         The message to be sent.
+     * @param[in]   len         Length of msg
+     * @param[out]  error_code  Errno (only valid if we return -1),
+     *                          ETIMEDOUT when the deadline passed
+     * @param[in]   deadline    CLOCK_MONOTONIC time in ms, 0 for none
+     * @return 0 on success, else -1
+     */
+    int msg_send(const char *msg, size_t len, int &error_code,
+                 uint64_t deadline);
+
     /**
      * Received a message over the transport.
      * Note: A zero read indicates that the transport was closed by other side,
@@ -78,6 +110,38 @@ class LSM_DLL_LOCAL Transport {
      */
      std::string msg_recv(int &error_code);
 
+    /**
+     * Receives a message into a caller's buffer, which is sized once from
+     * the header and read straight into.  Passing the same buffer each time
+     * lets it be reused without allocating.
+     * @param[out]  msg         Message, 0 size on error
+     * @param[out]  error_code  0 on success, else errno
+     */
+    void msg_recv(std::string & msg, int &error_code);
+
+    /**
+     * Reads whatever has arrived of the next message without blocking,
+     * what is read of an incomplete message is kept for the next call.
+     * msg_recv() finishes a message left half read.
+     * Note: EOF and errors throw EOFException like msg_recv() does.
+     * @param[out]  msg         Message, only set when true is returned
+     * @param[out]  error_code  0 on success, else errno
+     * @return true when msg holds a complete message, false when the rest
+     *         has not arrived yet
+     */
+    bool msg_recv_nb(std::string & msg, int &error_code);
+
+    /**
+     * Receives a message, giving up at a deadline.  What was read of a
+     * message when the deadline passed is kept for the next receive.
+     * Note: EOF and errors throw EOFException like msg_recv() does.
+     * @param[out]  msg         Message, only set when true is returned
+     * @param[out]  error_code  0 on success, else errno
+     * @param[in]   deadline    CLOCK_MONOTONIC time in ms, 0 for none
+     * @return true when msg holds a message, false when the deadline passed
+     */
+    bool msg_recv(std::string & msg, int &error_code, uint64_t deadline);
+
     /**
      * Creates a connected socket (AF_UNIX) to the specified path
      * @param path of the AF_UNIX file to be used for IPC
@@ -92,8 +156,38 @@ class LSM_DLL_LOCAL Transport {
      */
     void close();
 
+    /**
+     * Selects the header format used from now on.
+     * @param binary    true for the binary header, false for the zero padded
+     *                  ascii one every connection starts out with.
+     */
+    void binary_header_set(bool binary);
+
+    /**
+     * Checks a connection which is not in the middle of a request.  Nothing
+     * is expected to arrive on it, anything readable (EOF included) or an
+     * error means the other side went away or the stream is out of step.
+     * @return true if the connection can be used
+     */
+    bool idle_ok();
+
+    /**
+     * Socket descriptor, for callers who wait for it to become readable.
+     * @return Descriptor, -1 when closed
+     */
+    int fd_get() const;
+
   private:
+    /**
+     * Payload length given in a message header.
+     * @param hdr   Header, HDR_BIN_LEN or HDR_LEN bytes
+     * @return Length
+     */
+    unsigned long int payload_len_get(const char *hdr) const;
+
     int s;                      //Socket descriptor
+    bool binary_hdr;            //Binary length header in use
+    std::string part;           //Message read in part by msg_recv_nb()
 };
 
 /**
@@ -172,6 +266,85 @@ class LSM_DLL_LOCAL LsmException:public std::runtime_error {
     std::string debug_data;
 };
 
+class Value;
+
+/**
+ * Key/value storage of an object Value.
+ *
+ * The entries are kept sorted by key in a single array instead of a tree, so
+ * building a record costs a few array allocations rather than a node per
+ * field and lookups are a binary search over contiguous memory.  Offers the
+ * subset of the std::map interface used in this library.
+ * Note: Adding a key may move the existing entries, references and
+ *       iterators into the object are only valid until the next insert.
+ */
+class LSM_DLL_LOCAL ValueObject {
+  public:
+    typedef std::pair < std::string, Value > value_type;
+    typedef std::vector < value_type >::iterator iterator;
+    typedef std::vector < value_type >::const_iterator const_iterator;
+
+    /**
+     * Constructs an empty object.
+     */
+    ValueObject();
+
+    /**
+     * Constructs an object holding a copy of the map entries.
+     * @param m     Key/values to copy
+     */
+    ValueObject(const std::map < std::string, Value > &m);
+
+    /**
+     * Returns the value for key, adding a null value if not present.
+     * @param key   Key to look up
+     * @return Value
+     */
+    Value & operator[] (const std::string & key);
+
+    /**
+     * Looks up a key.
+     * @param key   Key to look up
+     * @return Iterator to the entry, end() if not present
+     */
+    iterator find(const std::string & key);
+    const_iterator find(const std::string & key) const;
+
+    /**
+     * Number of entries with key.
+     * @param key   Key to look up
+     * @return 1 if present, else 0
+     */
+    size_t count(const std::string & key) const;
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    size_t size() const;
+    bool empty() const;
+
+    /**
+     * Pre-allocates room for n entries.
+     * @param n     Number of entries expected
+     */
+    void reserve(size_t n);
+
+    /**
+     * Exchanges the entries of two objects, nothing is copied.
+     * @param other     Object to swap with
+     */
+    void swap(ValueObject & other);
+
+  private:
+    std::vector < value_type > entries;
+
+    /**
+     * Index of the first entry which does not sort before key.
+     */
+    size_t position(const std::string & key) const;
+};
+
 /**
  * Represents a value in the serialization.
  */
@@ -227,6 +400,13 @@ class LSM_DLL_LOCAL Value {
      */
     Value(int64_t v);
 
+    /**
+     * Constructor for an empty value of the given type, e.g. an object or
+     * array to be filled in place.
+     * @param type  Type this object will hold.
+     */
+    explicit Value(value_type type);
+
     /**
      * Constructor in which you specify type and initial value as string.
      * @param type  Type this object will hold.
@@ -247,9 +427,10 @@ class LSM_DLL_LOCAL Value {
     Value(const std::string & v);
 
     /**
-     * Constructor for object type
+     * Constructors for object type
      * @param v values
      */
+    Value(const ValueObject & v);
     Value(const std::map < std::string, Value > &v);
 
     /**
@@ -258,6 +439,17 @@ class LSM_DLL_LOCAL Value {
      */
     Value(const std::vector < Value > &v);
 
+#if __cplusplus >= 201103L
+    /**
+     * Constructors for object and array types which take over the passed
+     * in container instead of copying it.
+     * @param v values
+     */
+    Value(ValueObject && v);
+    Value(std::map < std::string, Value > &&v);
+    Value(std::vector < Value > &&v);
+#endif
+
     /**
      * Serialize Value to json
      * @return
@@ -288,20 +480,20 @@ class LSM_DLL_LOCAL Value {
      * Returns true if value has a key in key/value pair
      * @return true if key exists, else false.
      */
-    bool hasKey(const std::string & k);
+    bool hasKey(const std::string & k) const;
 
     /**
      * Checks to see if a Value contains a valid request
      * @return True if it is a request, else false
      */
-    bool isValidRequest(void);
+    bool isValidRequest(void) const;
 
     /**
      * Given a key returns the value.
      * @param key
      * @return Value
      */
-    Value getValue(const char *key);
+    Value getValue(const char *key) const;
 
     /**
      * Returns a numeric as the string holding it.
@@ -312,76 +504,127 @@ class LSM_DLL_LOCAL Value {
      * Returns NULL if void type, else ValueException
      * @return NULL
      */
-    void *asVoid();
+    void *asVoid() const;
 
     /**
      * Boolean value represented by object.
      * @return true, false ValueException on error
      */
-    bool asBool();
+    bool asBool() const;
 
     /**
      * Double value represented by object.
      * @return double value else ValueException on error
      */
-    double asDouble();
-    long double asLongDouble();
+    double asDouble() const;
+    long double asLongDouble() const;
 
     /**
      * Signed 32 integer value represented by object.
      * @return integer value else ValueException on error
      */
-    int32_t asInt32_t();
+    int32_t asInt32_t() const;
 
     /**
      * Signed 64 integer value represented by object.
      * @return integer value else ValueException on error
      */
-    int64_t asInt64_t();
+    int64_t asInt64_t() const;
 
     /**
      * Unsigned 32 integer value represented by object.
      * @return integer value else ValueException on error
      */
-    uint32_t asUint32_t();
+    uint32_t asUint32_t() const;
 
     /**
      * Unsigned 64 integer value represented by object.
      * @return integer value else ValueException on error
      */
-    uint64_t asUint64_t();
+    uint64_t asUint64_t() const;
 
     /**
      * String value represented by object.
      * @return string value else ValueException on error
      */
-    std::string asString();
+    std::string asString() const;
 
     /**
      * Return string as a pointer to a character array
      * @return
      */
-    const char *asC_str();
+    const char *asC_str() const;
 
     /**
      * key/value represented by object.
-     * @return map of key and values else ValueException on error
+     * @return reference to the key and values held by this object,
+     *         else ValueException on error
      */
-    std::map < std::string, Value > asObject();
+    ValueObject & asObject();
+    const ValueObject & asObject() const;
 
     /**
      * vector of values represented by object.
-     * @return vector of array values else ValueException on error
+     * @return reference to the vector of array values held by this object,
+     *         else ValueException on error
+     */
+    std::vector < Value > &asArray();
+    const std::vector < Value > &asArray() const;
+
+    /**
+     * Exchanges the contents of this value with another, nothing is copied.
+     * @param other     Value to swap with
      */
-    std::vector < Value > asArray();
+    void swap(Value & other);
 
   private:
+    /**
+     * How a numeric_t value is held.
+     */
+    enum number_type {
+        num_text,               //Only in s, e.g. fractions or too big
+        num_int,                //In n.i
+        num_uint,               //In n.u
+        num_float               //In n.f
+    };
+
     value_type t;
+    number_type nt;
+    union {
+        int64_t i;
+        uint64_t u;
+        double f;
+    } n;
     std::string s;
-    std::map < std::string, Value > obj;
+    ValueObject obj;
     std::vector < Value > array;
 
     void marshal(yajl_gen g);
+
+    /**
+     * Makes this a numeric_t from its json text, storing it natively
+     * when it is an integer which fits.
+     * @param v     Number text
+     * @param len   Length of v
+     */
+    void number_set(const char *v, size_t len);
+
+    /**
+     * Appends the msgpack encoding of this value.
+     * @param[out]  out     Buffer to append to
+     */
+    void pack(std::string & out);
+
+    /**
+     * Formats a natively stored number as json text.
+     * @param[out]  buf     Output buffer
+     * @param[in]   size    Size of buf
+     * @return Number of characters written (excluding the terminator)
+     */
+    int number_text(char *buf, size_t size);
+
+    friend class ParseContext;
+    friend class Payload;
 };
 
 /**
@@ -390,22 +633,62 @@ class LSM_DLL_LOCAL Value {
 class LSM_DLL_LOCAL Payload {
   public:
     /**
-     * Given a Value returns json representation.
-     * @param v Value to serialize
+     * Encodings a payload can use.
+     */
+    enum encoding_type {
+        json_t, msgpack_t
+    };
+
+    /**
+     * Given a Value returns its encoded representation.
+     * @param v         Value to serialize
+     * @param encoding  Encoding to use
      * @return String representation
      */
-    static std::string serialize(Value & v);
+    static std::string serialize(Value & v, encoding_type encoding = json_t);
+
+    /**
+     * Given an encoded string return a Value
+     * @param data      String to de-serialize
+     * @param encoding  Encoding data is in
+     * @return Value
+     */
+    static Value deserialize(const std::string & data,
+                             encoding_type encoding = json_t);
 
     /**
-     * Given a json string return a Value
-     * @param json  String to de-serialize
+     * Given an encoded buffer return a Value, the buffer is parsed where it
+     * is.
+     * @param data      Buffer to de-serialize
+     * @param len       Length of data
+     * @param encoding  Encoding data is in
      * @return Value
      */
-    static Value deserialize(const std::string & json);
+    static Value deserialize(const char *data, size_t len,
+                             encoding_type encoding = json_t);
 };
 
+/**
+ * Request/response messaging on top of Transport.
+ * Notes:   Sending and rpc() are thread safe, with protocol version 2 several
+ * threads can have calls outstanding on the same connection, the responses
+ * are matched to them by request id.  Reading requests is for a single
+ * thread.
+ */
 class LSM_DLL_LOCAL Ipc {
   public:
+    /**
+     * Protocol versions.
+     * 1: Zero padded ascii length header followed by json, every connection
+     *    starts out with this.  Requests use id 100 and one is outstanding
+     *    at a time.
+     * 2: Binary length header followed by the payload in the encoding agreed
+     *    on during plugin_register.  Responses carry the id of their request
+     *    and may come back in any order.
+     */
+    const static int32_t PROTOCOL_V1 = 1;
+    const static int32_t PROTOCOL_V2 = 2;
+
     /**
      * Constructor
      */
@@ -433,9 +716,14 @@ class LSM_DLL_LOCAL Ipc {
      * @param request       IPC function name
      * @param params        Parameters
      * @param id            Request ID
+     * @param deadline      CLOCK_MONOTONIC time in ms to give up sending at,
+     *                      LSM_ERR_TIMEOUT is thrown then.  0 for none.
+     * @param protocol      Protocol offer, see protocolOffer().  Null for
+     *                      none.
      */
     void requestSend(const std::string request, const Value & params,
-                     int32_t id = 100);
+                     int32_t id = 100, uint64_t deadline = 0,
+                     const Value & protocol = Value());
     /**
      * Reads a request
      * @returns Value
@@ -444,16 +732,22 @@ class LSM_DLL_LOCAL Ipc {
 
     /**
      * Send a response to a request
+     * Note: The contents of response are moved into the message rather than
+     *       copied, it is left as a null value on return.
      * @param response      Response value
      * @param id            Id that matches request
      */
-    void responseSend(const Value & response, uint32_t id = 100);
+    void responseSend(Value & response, uint32_t id = 100);
 
     /**
-     * Read a response
+     * Read the response to a request, responses to other requests read on
+     * the way are kept for the threads waiting on them.
+     * @param id            Id of the request
+     * @param deadline      CLOCK_MONOTONIC time in ms to give up waiting at,
+     *                      LSM_ERR_TIMEOUT is thrown then.  0 for none.
      * @return Value of response
      */
-    Value responseRead();
+    Value responseRead(int32_t id = 100, uint64_t deadline = 0);
 
     /**
      * Send an error
@@ -469,15 +763,147 @@ class LSM_DLL_LOCAL Ipc {
      * Do a remote procedure call (Request with a returned response
      * @param request           Function method
      * @param params            Function parameters
-     * @param id                Id of request
+     * @param deadline          CLOCK_MONOTONIC time in ms for the response
+     *                          to have arrived by, 0 for none.  A response
+     *                          given up on is dropped when it turns up,
+     *                          without multiplex the stream is out of step
+     *                          and the connection is failed instead.
+     * @param protocol          Protocol offer, see protocolOffer().  Null
+     *                          for none.
      * @return Result of the operation.
      */
     Value rpc(const std::string & request, const Value & params,
-              int32_t id = 100);
+              uint64_t deadline = 0, const Value & protocol = Value());
+
+    /**
+     * Client side, what we can speak.  Sent as the "protocol" member of the
+     * plugin_register request, next to "method", "id" and "params" where
+     * plug-ins which predate the negotiation don't look.
+     * @return Offer
+     */
+    static Value protocolOffer(void);
+
+    /**
+     * Plug-in side, picks the protocol to use from the client's offer.  The
+     * switch happens once the next response, the one to plugin_register,
+     * has been sent.
+     * @param offer     "protocol" member of plugin_register, may be null
+     *                  for clients which predate the negotiation.
+     * @return What was agreed on, to be returned as the plugin_register
+     *         result.  Null when staying with version 1.
+     */
+    Value protocolSelect(const Value & offer);
+
+    /**
+     * Client side, switches to the protocol the plug-in agreed on.
+     * @param agreed    plugin_register result, null (plug-ins which predate
+     *                  the negotiation) keeps version 1.
+     */
+    void protocolSet(const Value & agreed);
+
+    /**
+     * Checks a connection between requests, see Transport::idle_ok().
+     * @return true if the connection can be used
+     */
+    bool idleOk(void);
+
+    /**
+     * Descriptor to wait on for responses, see Transport::fd_get().
+     * @return Descriptor, -1 when not connected
+     */
+    int fd(void);
+
+    /**
+     * Whether responses carry the id of their request (version 2), which
+     * requestSubmit() needs.
+     * @return true if multiplexed
+     */
+    bool multiplexed(void);
 
+    /**
+     * Whether the connection can still carry requests, false once the
+     * transport failed or a response was given up on without multiplex.
+     * @return true if usable
+     */
+    bool usable(void);
+
+    /**
+     * Sends a request without waiting for its response, which is
+     * collected with responseTake() once it arrived.  Needs version 2.
+     * @param request           Function method
+     * @param params            Function parameters
+     * @return Id of the request
+     */
+    int32_t requestSubmit(const std::string & request, const Value & params);
+
+    /**
+     * Reads the responses which arrived without blocking and keeps them
+     * for responseTake() and the threads in rpc().  Returns at once if
+     * another thread is reading, it keeps them too.
+     */
+    void responsesRead(void);
+
+    /**
+     * Collects the response to a submitted request if it arrived.
+     * Errors returned by the plug-in are thrown as LsmException, as by
+     * rpc().
+     * @param[in]   id          Id from requestSubmit()
+     * @param[out]  result      Result of the request
+     * @return true if the response was there
+     */
+    bool responseTake(int32_t id, Value & result);
 
   private:
+    /**
+     * Result of a response, throws LsmException for an error response.
+     * @param r     Response, contents are moved out
+     * @return Result
+     */
+    static Value responseResult(Value & r);
+
+    /**
+     * Files a response read for the request it belongs to, with recv_lock
+     * held.
+     * @param m     Response, contents are moved out
+     * @param id    Id to file under if the response has none (version 1)
+     */
+    void responseFile(Value & m, int32_t id);
+
+    /**
+     * Gives up on the response to a request, with recv_lock held, and
+     * throws LSM_ERR_TIMEOUT.
+     * @param id    Id of the request
+     */
+    void responseAbandon(int32_t id);
+
+    /**
+     * Common part of the constructors.
+     */
+    void init(void);
+
+    /**
+     * Hands out request ids.
+     * @return Id not in use on this connection
+     */
+    int32_t idNext(void);
+
     Transport t;
+    Payload::encoding_type enc;     //Payload encoding in use
+    Value pending;                  //Agreed protocol not yet switched to
+    std::string recv_buf;           //Kept between messages to reuse
+    bool multiplex;                 //Peer echoes request ids (version 2)
+    int32_t next_id;                //Next request id to hand out
+    pthread_mutex_t send_lock;      //One message written at a time
+    pthread_mutex_t call_lock;      //One call at a time without multiplex
+    pthread_mutex_t recv_lock;      //Protects the members below
+    pthread_cond_t recv_cond;       //A response was filed or reader left
+    bool reading;                   //A thread reads responses for all
+    bool failed;                    //Transport failed, no more responses
+    std::map<int32_t, Value> replies;   //Read, not yet collected
+    std::set<int32_t> abandoned;        //Given up on, dropped on arrival
+
+    Ipc(const Ipc &);
+    Ipc & operator=(const Ipc &);
 };
 
 #endif
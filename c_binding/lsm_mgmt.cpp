@@ -23,7 +23,11 @@
 #include <stdio.h>
 #include <string.h>
 #include <dirent.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
 #include <libxml/uri.h>
+#include <algorithm>
 
 #include "lsm_datatypes.hpp"
 #include "lsm_convert.hpp"
@@ -59,6 +63,18 @@ static const char *const TARGET_PORT_SEARCH_KEYS[] = { "id", "system_id" };
 
 #define TARGET_PORT_SEARCH_KEYS_COUNT COUNT_OF(TARGET_PORT_SEARCH_KEYS)
 
+static const char *const VOLUME_FIELDS[] =
+    { "id", "name", "vpd83", "block_size", "num_of_blocks", "admin_state",
+    "system_id", "pool_id", "plugin_data" };
+
+#define VOLUME_FIELDS_COUNT COUNT_OF(VOLUME_FIELDS)
+
+static const char *const DISK_FIELDS[] =
+    { "id", "name", "disk_type", "block_size", "num_of_blocks", "status",
+    "system_id", "location", "rpm", "link_type", "vpd83" };
+
+#define DISK_FIELDS_COUNT COUNT_OF(DISK_FIELDS)
+
 static int get_battery_array(lsm_connect *c, int rc, Value &response,
                              lsm_battery **bs[], uint32_t *count);
 
@@ -69,8 +85,7 @@ static int get_battery_array(lsm_connect *c, int rc, Value &response,
     if(!LSM_IS_CONNECT(c)) {            \
         return LSM_ERR_INVALID_ARGUMENT;\
     }                                   \
-    lsm_error_free(c->error);           \
-    c->error = NULL;                    \
+    lsm_error_free(connection_error_swap(c, NULL)); \
     } while (0)
 
 static int check_search_key(const char *search_key,
@@ -229,12 +244,7 @@ static int lsm_error_log(lsm_connect * c, lsm_error_ptr error)
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    if (c->error) {
-        lsm_error_free(c->error);
-        c->error = NULL;
-    }
-
-    c->error = error;
+    lsm_error_free(connection_error_swap(c, error));
     return LSM_ERR_OK;
 }
 
@@ -252,20 +262,30 @@ static lsm_error_number log_exception(lsm_connect * c,
     return error;
 }
 
-static int rpc(lsm_connect * c, const char *method,
-               const Value & parameters, Value & response) throw()
+/**
+ * Maps the exception being handled to an error and logs it, to be called
+ * from a catch block of transport calls.
+ * @param c     Connection
+ * @return Error code
+ */
+static int ipc_exception(lsm_connect * c) throw()
 {
     try {
-        response = c->tp->rpc(method, parameters);
+        throw;
     } catch(const ValueException & ve) {
         return log_exception(c, LSM_ERR_TRANSPORT_SERIALIZATION,
                              "Serialization error", ve.what());
     }
     catch(const LsmException & le) {
+        if (LSM_ERR_TRANSPORT_COMMUNICATION == le.error_code ||
+            !c->tp->usable()) {
+            connection_flag_set(c, LSM_CONNECT_BROKEN);
+        }
         return log_exception(c, (lsm_error_number) le.error_code,
                              le.what(), NULL);
     }
     catch(const EOFException & eof) {
+        connection_flag_set(c, LSM_CONNECT_BROKEN);
         return log_exception(c, LSM_ERR_TRANSPORT_COMMUNICATION,
                              "Plug-in died", "Check syslog");
     }
@@ -273,7 +293,216 @@ static int rpc(lsm_connect * c, const char *method,
         return log_exception(c, LSM_ERR_LIB_BUG, "Unexpected exception",
                              "Unknown exception");
     }
-    return LSM_ERR_OK;
+}
+
+static uint64_t monotonic_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ * Methods which only read, all others may change what the cache holds.
+ */
+static const char *const READ_ONLY_METHODS[] = {
+    "access_groups", "access_groups_granted_to_volume", "access_groups_page",
+    "batteries", "capabilities", "disks", "disks_page", "export_auth",
+    "exports", "exports_page", "fs", "fs_child_dependency", "fs_page",
+    "fs_snapshots", "plugin_info", "pool_member_info", "pools", "systems",
+    "target_ports", "time_out_get", "volume_cache_info",
+    "volume_child_dependency", "volume_raid_create_cap_get",
+    "volume_raid_info", "volume_replicate_range_block_size", "volumes",
+    "volumes_accessible_by_access_group", "volumes_page"
+};
+
+/*
+ * Past this many results, expired ones are dropped before adding another.
+ */
+#define CACHE_ENTRIES_MAX 256
+
+/**
+ * Cache class of a method.
+ * @param method    Method name
+ * @return lsm_cache_class value, -1 if the method is not cached
+ */
+static int cache_class_get(const char *method)
+{
+    if (0 == strcmp(method, "systems")) {
+        return LSM_CACHE_SYSTEMS;
+    } else if (0 == strcmp(method, "pools")) {
+        return LSM_CACHE_POOLS;
+    } else if (0 == strcmp(method, "capabilities")) {
+        return LSM_CACHE_CAPABILITIES;
+    } else if (0 == strcmp(method, "target_ports")) {
+        return LSM_CACHE_TARGET_PORTS;
+    }
+    return -1;
+}
+
+static void cache_invalidate(lsm_connect_cache * cache)
+{
+    pthread_mutex_lock(&cache->lock);
+    cache->entries.clear();
+    cache->generation++;
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/**
+ * Looks a request up in the cache.
+ * @param[in]   cache       Cache
+ * @param[in]   cls         Cache class of the method
+ * @param[in]   method      Method name
+ * @param[in]   parameters  Parameters
+ * @param[out]  key         Cache key for cache_put(), empty if the result
+ *                          is not to be cached
+ * @param[out]  generation  Generation for cache_put()
+ * @param[out]  response    Cached result on a hit
+ * @return true on a hit
+ */
+static bool cache_get(lsm_connect_cache * cache, int cls, const char *method,
+                      const Value & parameters, std::string & key,
+                      uint64_t & generation, Value & response)
+{
+    bool hit = false;
+
+    pthread_mutex_lock(&cache->lock);
+    try {
+        if (cache->ttl[cls]) {
+            Value p(parameters);
+            key = std::string(method) + "\n" + Payload::serialize(p);
+
+            std::map < std::string, lsm_cache_entry >::iterator i =
+                cache->entries.find(key);
+            if (i != cache->entries.end() &&
+                i->second.expires > monotonic_ms()) {
+                response = i->second.result;
+                cache->hits++;
+                hit = true;
+            } else {
+                generation = cache->generation;
+                cache->misses++;
+            }
+        }
+    }
+    catch( ...) {
+        //Not cached then
+        key.clear();
+    }
+    pthread_mutex_unlock(&cache->lock);
+    return hit;
+}
+
+/**
+ * Keeps a result for its time to live, unless the cache was invalidated
+ * since the request was looked up.
+ */
+static void cache_put(lsm_connect_cache * cache, int cls,
+                      const std::string & key, uint64_t generation,
+                      const Value & response)
+{
+    if (key.empty()) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    try {
+        if (generation == cache->generation && cache->ttl[cls]) {
+            uint64_t now = monotonic_ms();
+
+            if (cache->entries.size() >= CACHE_ENTRIES_MAX) {
+                std::map < std::string, lsm_cache_entry >::iterator i =
+                    cache->entries.begin();
+                while (i != cache->entries.end()) {
+                    if (i->second.expires <= now) {
+                        cache->entries.erase(i++);
+                    } else {
+                        ++i;
+                    }
+                }
+
+                if (cache->entries.size() >= CACHE_ENTRIES_MAX) {
+                    cache->entries.clear();
+                }
+            }
+
+            lsm_cache_entry & e = cache->entries[key];
+            e.result = response;
+            e.expires = now + cache->ttl[cls];
+        }
+    }
+    catch( ...) {
+        //Not cached then
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/*
+ * Time out set by lsm_connect_call_timeout_set() for the next request the
+ * thread sends through call_timeout_conn.
+ */
+static __thread lsm_connect *call_timeout_conn = NULL;
+static __thread uint32_t call_timeout = 0;
+
+/**
+ * Deadline of a request.
+ * @param c         Connection
+ * @param extra     Time the plug-in was asked to take on top, in ms
+ * @return CLOCK_MONOTONIC time in ms, 0 for none
+ */
+static uint64_t rpc_deadline(lsm_connect * c, uint32_t extra)
+{
+    uint32_t timeout = c->io_timeout;
+
+    if (call_timeout_conn == c) {
+        timeout = call_timeout;
+        call_timeout_conn = NULL;
+    }
+
+    if (!timeout) {
+        return 0;
+    }
+    return monotonic_ms() + timeout + extra;
+}
+
+static int rpc(lsm_connect * c, const char *method,
+               const Value & parameters, Value & response,
+               uint32_t extra = 0) throw()
+{
+    int rc = LSM_ERR_OK;
+    lsm_connect_cache *cache = c->cache;
+    int cls = cache_class_get(method);
+    bool mutating = (cls < 0 &&
+                     !check_search_key(method, READ_ONLY_METHODS,
+                                       COUNT_OF(READ_ONLY_METHODS)));
+    std::string key;
+    uint64_t generation = 0;
+
+    try {
+        if (cls >= 0 && cache_get(cache, cls, method, parameters, key,
+                                  generation, response)) {
+            return LSM_ERR_OK;
+        }
+
+        if (mutating) {
+            cache_invalidate(cache);
+        }
+
+        c->tp->rpc(method, parameters,
+                   rpc_deadline(c, extra)).swap(response);
+    }
+    catch( ...) {
+        rc = ipc_exception(c);
+    }
+
+    //Whatever changed, changed while the request was in flight
+    if (mutating) {
+        cache_invalidate(cache);
+    } else if (cls >= 0 && LSM_ERR_OK == rc) {
+        cache_put(cache, cls, key, generation, response);
+    }
+    return rc;
 }
 
 static int job_check(lsm_connect * c, int rc, Value & response, char **job)
@@ -314,7 +543,7 @@ static int get_access_groups(lsm_connect * c, int rc, Value & response,
     return rc;
 }
 
-static int add_search_params(std::map < std::string, Value > &p,
+static int add_search_params(ValueObject & p,
                              const char *k, const char *v,
                              const char *const supported_keys[],
                              size_t supported_keys_count)
@@ -333,6 +562,200 @@ static int add_search_params(std::map < std::string, Value > &p,
     return LSM_ERR_OK;
 }
 
+/**
+ * Adds the optional "fields" parameter of a list call.
+ * @param p                     Parameters to add to
+ * @param fields                Requested fields, NULL for all of them
+ * @param supported_fields      Fields of the listed type
+ * @param supported_fields_count Number of fields
+ * @return LSM_ERR_OK, else LSM_ERR_INVALID_ARGUMENT on an unknown field
+ */
+static int add_fields_param(ValueObject & p, lsm_string_list * fields,
+                            const char *const supported_fields[],
+                            size_t supported_fields_count)
+{
+    if (fields) {
+        if (!LSM_IS_STRING_LIST(fields)) {
+            return LSM_ERR_INVALID_ARGUMENT;
+        }
+
+        for (uint32_t i = 0; i < lsm_string_list_size(fields); ++i) {
+            const char *f = lsm_string_list_elem_get(fields, i);
+            if (!f || !check_search_key(f, supported_fields,
+                                        supported_fields_count)) {
+                return LSM_ERR_INVALID_ARGUMENT;
+            }
+        }
+        p["fields"] = string_list_to_value(fields);
+    }
+    return LSM_ERR_OK;
+}
+
+/**
+ * Sends a "*_page" request.
+ * @param c             Connection
+ * @param method        Method name
+ * @param k             Search key
+ * @param v             Search value
+ * @param supported_keys        Search keys of the method
+ * @param supported_keys_count  Number of search keys
+ * @param cursor        Cursor, NULL for the first page
+ * @param limit         Maximum page size
+ * @param next_cursor   Cursor of the next page, NULL when last
+ * @param flags         Flags
+ * @param items         Items of the page
+ * @return LSM_ERR_OK on success, else error reason.
+ */
+static int list_page(lsm_connect * c, const char *method,
+                     const char *k, const char *v,
+                     const char *const supported_keys[],
+                     size_t supported_keys_count,
+                     const char *cursor, uint32_t limit,
+                     char **next_cursor, lsm_flag flags, Value & items)
+{
+    if (!limit || CHECK_RP(next_cursor) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    ValueObject p;
+    int rc = add_search_params(p, k, v, supported_keys, supported_keys_count);
+    if (LSM_ERR_OK != rc) {
+        return rc;
+    }
+
+    p["cursor"] = Value(cursor);
+    p["limit"] = Value(limit);
+    p["flags"] = Value(flags);
+
+    Value parameters(p);
+    Value response;
+
+    rc = rpc(c, method, parameters, response);
+    if (LSM_ERR_OK == rc) {
+        try {
+            std::vector < Value > &r = response.asArray();
+            if (r.size() != 2 || Value::array_t != r[0].valueType() ||
+                (Value::string_t != r[1].valueType() &&
+                 Value::null_t != r[1].valueType())) {
+                return log_exception(c, LSM_ERR_PLUGIN_BUG,
+                                     "Unexpected page", NULL);
+            }
+
+            if (Value::string_t == r[1].valueType()) {
+                *next_cursor = strdup(r[1].asC_str());
+                if (!*next_cursor) {
+                    return LSM_ERR_NO_MEMORY;
+                }
+            }
+            items.swap(r[0]);
+        }
+        catch(const ValueException & ve) {
+            rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type",
+                               ve.what());
+        }
+    }
+    return rc;
+}
+
+/**
+ * Sends a list request matching any of a list of search values.
+ * @param c             Connection
+ * @param method        Method name
+ * @param k             Search key
+ * @param values        Search values
+ * @param supported_keys        Search keys of the method
+ * @param supported_keys_count  Number of search keys
+ * @param flags         Flags
+ * @param items         Listed items
+ * @return LSM_ERR_OK on success, else error reason
+ */
+static int list_in(lsm_connect * c, const char *method, const char *k,
+                   lsm_string_list * values,
+                   const char *const supported_keys[],
+                   size_t supported_keys_count, lsm_flag flags,
+                   Value & items)
+{
+    if (CHECK_STR(k) || !LSM_IS_STRING_LIST(values) ||
+        LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    if (!check_search_key(k, supported_keys, supported_keys_count)) {
+        return LSM_ERR_UNSUPPORTED_SEARCH_KEY;
+    }
+
+    int rc = LSM_ERR_OK;
+    ValueObject p;
+    p["search_key"] = Value(k);
+    p["flags"] = Value(flags);
+
+    /* Sets of values came along with protocol version 2, older plug-ins
+     * either reject them (C) or match nothing (Python). */
+    if (c->tp->multiplexed()) {
+        p["search_value"] = string_list_to_value(values);
+        Value parameters(p);
+
+        rc = rpc(c, method, parameters, items);
+        if (LSM_ERR_TRANSPORT_INVALID_ARG != rc) {
+            if (LSM_ERR_OK == rc && Value::array_t != items.valueType()) {
+                rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type",
+                                   NULL);
+            }
+            return rc;
+        }
+
+        lsm_error_free(connection_error_swap(c, NULL));
+    }
+
+    //One search per value then, a record only matches one of them
+    try {
+        std::set < std::string > searched;
+        Value found_all(Value::array_t);
+        std::vector < Value > &all = found_all.asArray();
+
+        for (uint32_t i = 0; i < lsm_string_list_size(values); ++i) {
+            const char *v = lsm_string_list_elem_get(values, i);
+
+            if (!searched.insert(v).second) {
+                continue;
+            }
+
+            p["search_value"] = Value(v);
+            Value parameters(p);
+            Value found;
+
+            rc = rpc(c, method, parameters, found);
+            if (LSM_ERR_OK != rc) {
+                return rc;
+            }
+
+            std::vector < Value > &f = found.asArray();
+            for (size_t j = 0; j < f.size(); ++j) {
+                all.push_back(Value());
+                all.back().swap(f[j]);
+            }
+        }
+        items.swap(found_all);
+    }
+    catch(const ValueException & ve) {
+        rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type",
+                           ve.what());
+    }
+    return rc;
+}
+
+/**
+ * Takes a connection out of the pool's count, used when one is torn down.
+ * @param p     Pool
+ */
+static void connect_pool_release(lsm_connect_pool * p)
+{
+    pthread_mutex_lock(&p->lock);
+    p->count--;
+    pthread_cond_signal(&p->cond);
+    pthread_mutex_unlock(&p->lock);
+}
+
 int lsm_connect_close(lsm_connect * c, lsm_flag flags)
 {
     CONN_SETUP(c);
@@ -341,7 +764,7 @@ int lsm_connect_close(lsm_connect * c, lsm_flag flags)
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["flags"] = Value(flags);
     Value parameters(p);
     Value response;
@@ -349,14 +772,195 @@ int lsm_connect_close(lsm_connect * c, lsm_flag flags)
     //No response data needed on plugin_unregister
     int rc = rpc(c, "plugin_unregister", parameters, response);
 
+    //A pooled connection closed by the user is no longer counted
+    if (c->pool) {
+        connect_pool_release(c->pool);
+    }
+
     //Free the connection.
     connection_free(c);
     return rc;
 }
 
+int lsm_connect_pool_create(const char *uri, const char *password,
+                            uint32_t size, lsm_connect_pool ** pool,
+                            uint32_t timeout, lsm_error_ptr * e,
+                            lsm_flag flags)
+{
+    int rc = LSM_ERR_OK;
+    lsm_connect *c = NULL;
+    lsm_connect_pool *p = NULL;
+    pthread_condattr_t attr;
+
+    if (CHECK_STR(uri) || !size || CHECK_RP(pool) || !timeout ||
+        CHECK_RP(e) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    /* The first connection checks the URI and password up front */
+    rc = lsm_connect_password(uri, password, &c, timeout, e, flags);
+    if (LSM_ERR_OK != rc) {
+        return rc;
+    }
+
+    p = (lsm_connect_pool *) calloc(1, sizeof(lsm_connect_pool));
+    if (p) {
+        p->uri = strdup(uri);
+        p->password = (password) ? strdup(password) : NULL;
+        p->idle = (lsm_connect **) calloc(size, sizeof(lsm_connect *));
+    }
+
+    if (!p || !p->uri || (password && !p->password) || !p->idle) {
+        if (p) {
+            free(p->uri);
+            free(p->password);
+            free(p->idle);
+            free(p);
+        }
+        lsm_connect_close(c, LSM_CLIENT_FLAG_RSVD);
+        return LSM_ERR_NO_MEMORY;
+    }
+
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&p->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    p->timeout = timeout;
+    p->size = size;
+    p->magic = LSM_CONNECT_POOL_MAGIC;
+
+    c->pool = p;
+    p->idle[p->idle_count++] = c;
+    p->count = 1;
+
+    *pool = p;
+    return LSM_ERR_OK;
+}
+
+int lsm_connect_pool_get(lsm_connect_pool * pool, lsm_connect ** conn,
+                         uint32_t timeout, lsm_error_ptr * e, lsm_flag flags)
+{
+    int rc = LSM_ERR_OK;
+    lsm_connect *c = NULL;
+    struct timespec deadline;
+
+    if (!LSM_IS_CONNECT_POOL(pool) || CHECK_RP(conn) || CHECK_RP(e) ||
+        LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout / 1000;
+    deadline.tv_nsec += (long) (timeout % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        if (pool->idle_count) {
+            /* Most recently returned first */
+            c = pool->idle[--pool->idle_count];
+            pthread_mutex_unlock(&pool->lock);
+
+            if (c->tp->idleOk()) {
+                *conn = c;
+                return LSM_ERR_OK;
+            }
+
+            /* Plug-in went away while the connection sat idle */
+            c->pool = NULL;
+            connection_free(c);
+            c = NULL;
+
+            pthread_mutex_lock(&pool->lock);
+            pool->count--;
+        } else if (pool->count < pool->size) {
+            pool->count++;
+            pthread_mutex_unlock(&pool->lock);
+
+            rc = lsm_connect_password(pool->uri, pool->password, &c,
+                                      pool->timeout, e, LSM_CLIENT_FLAG_RSVD);
+            if (LSM_ERR_OK == rc) {
+                c->pool = pool;
+                *conn = c;
+            } else {
+                connect_pool_release(pool);
+            }
+            return rc;
+        } else if (ETIMEDOUT == pthread_cond_timedwait(&pool->cond,
+                                                       &pool->lock,
+                                                       &deadline)) {
+            pthread_mutex_unlock(&pool->lock);
+            return LSM_ERR_TIMEOUT;
+        }
+    }
+}
+
+int lsm_connect_pool_put(lsm_connect_pool * pool, lsm_connect * conn,
+                         lsm_flag flags)
+{
+    if (!LSM_IS_CONNECT_POOL(pool) || !LSM_IS_CONNECT(conn) ||
+        conn->pool != pool || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    if (connection_flag_get(conn, LSM_CONNECT_BROKEN)) {
+        /* Nothing to unregister with, the plug-in is gone */
+        conn->pool = NULL;
+        connection_free(conn);
+        connect_pool_release(pool);
+        return LSM_ERR_OK;
+    }
+
+    lsm_error_free(connection_error_swap(conn, NULL));
+
+    pthread_mutex_lock(&pool->lock);
+    pool->idle[pool->idle_count++] = conn;
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+    return LSM_ERR_OK;
+}
+
+int lsm_connect_pool_free(lsm_connect_pool * pool, lsm_flag flags)
+{
+    uint32_t i = 0;
+
+    if (!LSM_IS_CONNECT_POOL(pool) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->count != pool->idle_count) {
+        pthread_mutex_unlock(&pool->lock);
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+    pool->magic = LSM_DEL_MAGIC(LSM_CONNECT_POOL_MAGIC);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->idle_count; ++i) {
+        pool->idle[i]->pool = NULL;
+        lsm_connect_close(pool->idle[i], LSM_CLIENT_FLAG_RSVD);
+    }
+
+    if (pool->password) {
+        memset(pool->password, 0, strlen(pool->password));
+        free(pool->password);
+    }
+    free(pool->uri);
+    free(pool->idle);
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+    return LSM_ERR_OK;
+}
+
 static Value _create_flag_param(lsm_flag flags)
 {
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["flags"] = Value(flags);
     return Value(p);
 }
@@ -383,7 +987,7 @@ int lsm_plugin_info_get(lsm_connect * c, char **desc,
         rc = rpc(c, "plugin_info", parameters, response);
 
         if (rc == LSM_ERR_OK) {
-            std::vector < Value > j = response.asArray();
+            std::vector < Value > &j = response.asArray();
             *desc = strdup(j[0].asC_str());
             *version = strdup(j[1].asC_str());
 
@@ -514,7 +1118,7 @@ int lsm_connect_timeout_set(lsm_connect * c, uint32_t timeout, lsm_flag flags)
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["ms"] = Value(timeout);
     p["flags"] = Value(flags);
     Value parameters(p);
@@ -549,28 +1153,115 @@ int lsm_connect_timeout_get(lsm_connect * c, uint32_t * timeout, lsm_flag flags)
     return rc;
 }
 
-static int job_status(lsm_connect * c, const char *job,
-                      lsm_job_status * status, uint8_t * percentComplete,
-                      Value & returned_value, lsm_flag flags)
+int lsm_connect_cache_ttl_set(lsm_connect * c, lsm_cache_class cache_class,
+                              uint32_t ttl, lsm_flag flags)
 {
-    int rc = LSM_ERR_OK;
     CONN_SETUP(c);
 
-    if (!job || !status || !percentComplete) {
+    if (cache_class < 0 || cache_class >= LSM_CACHE_CLASS_COUNT ||
+        LSM_FLAG_UNUSED_CHECK(flags)) {
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    try {
-        std::map < std::string, Value > p;
-        p["job_id"] = Value(job);
-        p["flags"] = Value(flags);
-        Value parameters(p);
+    pthread_mutex_lock(&c->cache->lock);
+    c->cache->ttl[cache_class] = ttl;
+    pthread_mutex_unlock(&c->cache->lock);
+
+    //Results kept under the old time to live go
+    cache_invalidate(c->cache);
+    return LSM_ERR_OK;
+}
+
+int lsm_connect_cache_clear(lsm_connect * c, lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    cache_invalidate(c->cache);
+    return LSM_ERR_OK;
+}
+
+int lsm_connect_cache_stats_get(lsm_connect * c, uint64_t * hits,
+                                uint64_t * misses, lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (!hits || !misses || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    pthread_mutex_lock(&c->cache->lock);
+    *hits = c->cache->hits;
+    *misses = c->cache->misses;
+    pthread_mutex_unlock(&c->cache->lock);
+    return LSM_ERR_OK;
+}
+
+int lsm_connect_io_timeout_set(lsm_connect * c, uint32_t timeout,
+                               lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    c->io_timeout = timeout;
+    return LSM_ERR_OK;
+}
+
+int lsm_connect_io_timeout_get(lsm_connect * c, uint32_t * timeout,
+                               lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (!timeout || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    *timeout = c->io_timeout;
+    return LSM_ERR_OK;
+}
+
+int lsm_connect_call_timeout_set(lsm_connect * c, uint32_t timeout,
+                                 lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    call_timeout_conn = c;
+    call_timeout = timeout;
+    return LSM_ERR_OK;
+}
+
+static int job_status(lsm_connect * c, const char *job,
+                      lsm_job_status * status, uint8_t * percentComplete,
+                      Value & returned_value, lsm_flag flags)
+{
+    int rc = LSM_ERR_OK;
+    CONN_SETUP(c);
+
+    if (!job || !status || !percentComplete) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    try {
+        ValueObject p;
+        p["job_id"] = Value(job);
+        p["flags"] = Value(flags);
+        Value parameters(p);
         Value response;
 
         rc = rpc(c, "job_status", parameters, response);
         if (LSM_ERR_OK == rc) {
             //We get back an array [status, percent, volume]
-            std::vector < Value > j = response.asArray();
+            std::vector < Value > &j = response.asArray();
             *status = (lsm_job_status) j[0].asInt32_t();
             *percentComplete = (uint8_t) j[1].asUint32_t();
 
@@ -737,6 +1428,133 @@ int lsm_job_status_ss_get(lsm_connect * c, const char *job,
     return rc;
 }
 
+/*
+ * lsm_job_wait() with plug-ins which predate "job_wait" checks on the jobs
+ * itself, backing off the same way the plug-in side does.
+ */
+#define JOB_WAIT_POLL_MIN_MS 10
+#define JOB_WAIT_POLL_MAX_MS 1000
+
+static int job_wait_each(lsm_connect * c, lsm_string_list * job_ids,
+                         uint32_t timeout, uint32_t * index,
+                         lsm_job_status * status, uint8_t * percent_complete,
+                         lsm_flag flags)
+{
+    uint64_t deadline = monotonic_ms() + timeout;
+    uint64_t interval = JOB_WAIT_POLL_MIN_MS;
+
+    while (true) {
+        for (uint32_t i = 0; i < lsm_string_list_size(job_ids); ++i) {
+            lsm_job_status s = LSM_JOB_INPROGRESS;
+            uint8_t p = 0;
+            Value rv;
+
+            int rc = job_status(c, lsm_string_list_elem_get(job_ids, i), &s,
+                                &p, rv, flags);
+            if (LSM_ERR_OK != rc) {
+                return rc;
+            }
+
+            if (LSM_JOB_INPROGRESS != s) {
+                *index = i;
+                *status = s;
+                *percent_complete = p;
+                return LSM_ERR_OK;
+            }
+        }
+
+        uint64_t now = monotonic_ms();
+        if (now >= deadline) {
+            return log_exception(c, LSM_ERR_TIMEOUT, "Job still in progress",
+                                 NULL);
+        }
+
+        usleep(std::min(interval, deadline - now) * 1000);
+        interval = std::min(interval * 2, (uint64_t) JOB_WAIT_POLL_MAX_MS);
+    }
+}
+
+int lsm_job_wait_any(lsm_connect * c, lsm_string_list * job_ids,
+                     uint32_t timeout, uint32_t * index,
+                     lsm_job_status * status, uint8_t * percent_complete,
+                     lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (!LSM_IS_STRING_LIST(job_ids) || !lsm_string_list_size(job_ids) ||
+        !index || !status || !percent_complete ||
+        LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    for (uint32_t i = 0; i < lsm_string_list_size(job_ids); ++i) {
+        if (CHECK_STR(lsm_string_list_elem_get(job_ids, i))) {
+            return LSM_ERR_INVALID_ARGUMENT;
+        }
+    }
+
+    ValueObject p;
+    p["job_ids"] = string_list_to_value(job_ids);
+    p["timeout"] = Value(timeout);
+    p["flags"] = Value(flags);
+    Value parameters(p);
+    Value response;
+
+    //The plug-in holds on to the request for up to timeout
+    int rc = rpc(c, "job_wait", parameters, response, timeout);
+    if (LSM_ERR_NO_SUPPORT == rc) {
+        lsm_error_free(connection_error_swap(c, NULL));
+        return job_wait_each(c, job_ids, timeout, index, status,
+                             percent_complete, flags);
+    }
+
+    if (LSM_ERR_OK == rc) {
+        try {
+            //We get back an array [index, status, percent]
+            std::vector < Value > &j = response.asArray();
+            if (j.size() != 3 ||
+                j[0].asUint32_t() >= lsm_string_list_size(job_ids)) {
+                return log_exception(c, LSM_ERR_PLUGIN_BUG,
+                                     "Unexpected job_wait response", NULL);
+            }
+            *index = j[0].asUint32_t();
+            *status = (lsm_job_status) j[1].asInt32_t();
+            *percent_complete = (uint8_t) j[2].asUint32_t();
+        }
+        catch(const ValueException & ve) {
+            rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type",
+                               ve.what());
+        }
+    }
+    return rc;
+}
+
+int lsm_job_wait(lsm_connect * c, const char *job_id, uint32_t timeout,
+                 lsm_job_status * status, uint8_t * percent_complete,
+                 lsm_flag flags)
+{
+    uint32_t index = 0;
+    CONN_SETUP(c);
+
+    if (CHECK_STR(job_id)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    lsm_string_list *job_ids = lsm_string_list_alloc(0);
+    if (!job_ids) {
+        return LSM_ERR_NO_MEMORY;
+    }
+
+    int rc = lsm_string_list_append(job_ids, job_id);
+    if (LSM_ERR_OK == rc) {
+        rc = lsm_job_wait_any(c, job_ids, timeout, &index, status,
+                              percent_complete, flags);
+    }
+
+    lsm_string_list_free(job_ids);
+    return rc;
+}
+
 int lsm_job_free(lsm_connect * c, char **job, lsm_flag flags)
 {
     CONN_SETUP(c);
@@ -745,7 +1563,7 @@ int lsm_job_free(lsm_connect * c, char **job, lsm_flag flags)
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["job_id"] = Value(*job);
     p["flags"] = Value(flags);
     Value parameters(p);
@@ -772,7 +1590,7 @@ int lsm_capabilities(lsm_connect * c, lsm_system * system,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
 
     p["system"] = system_to_value(system);
     p["flags"] = Value(flags);
@@ -797,10 +1615,50 @@ int lsm_capabilities(lsm_connect * c, lsm_system * system,
     return rc;
 }
 
+static int get_pool_array(lsm_connect * c, int rc, Value & response,
+                          lsm_pool ** pools[], uint32_t * count)
+{
+    if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
+        try {
+            std::vector < Value > &pool = response.asArray();
+
+            *count = pool.size();
+
+            if (pool.size()) {
+                *pools = lsm_pool_record_array_alloc(pool.size());
+
+                if (*pools) {
+                    for (size_t i = 0; i < pool.size(); ++i) {
+                        (*pools)[i] = value_to_pool(pool[i]);
+                        if (!(*pools)[i]) {
+                            rc = LSM_ERR_NO_MEMORY;
+                            break;
+                        }
+                    }
+                } else {
+                    rc = LSM_ERR_NO_MEMORY;
+                }
+            }
+        }
+        catch(const ValueException & ve) {
+            rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type",
+                               ve.what());
+        }
+
+        if (LSM_ERR_OK != rc) {
+            if (*pools) {
+                lsm_pool_record_array_free(*pools, *count);
+                *pools = NULL;
+            }
+            *count = 0;
+        }
+    }
+    return rc;
+}
+
 int lsm_pool_list(lsm_connect * c, char *search_key, char *search_value,
                   lsm_pool ** poolArray[], uint32_t * count, lsm_flag flags)
 {
-    int rc = LSM_ERR_OK;
     CONN_SETUP(c);
 
     if (!poolArray || !count || CHECK_RP(poolArray)) {
@@ -810,53 +1668,20 @@ int lsm_pool_list(lsm_connect * c, char *search_key, char *search_value,
     *count = 0;
     *poolArray = NULL;
 
-    try {
-        std::map < std::string, Value > p;
+    ValueObject p;
 
-        rc = add_search_params(p, search_key, search_value,
+    int rc = add_search_params(p, search_key, search_value,
                                POOL_SEARCH_KEYS, POOL_SEARCH_KEYS_COUNT);
-        if (LSM_ERR_OK != rc) {
-            return rc;
-        }
-
-        p["flags"] = Value(flags);
-        Value parameters(p);
-        Value response;
-
-        rc = rpc(c, "pools", parameters, response);
-        if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-            std::vector < Value > pools = response.asArray();
-
-            *count = pools.size();
-
-            if (pools.size()) {
-                *poolArray = lsm_pool_record_array_alloc(pools.size());
-
-                for (size_t i = 0; i < pools.size(); ++i) {
-                    (*poolArray)[i] = value_to_pool(pools[i]);
-                    if (!(*poolArray)[i]) {
-                        rc = LSM_ERR_NO_MEMORY;
-                        goto error;
-                    }
-                }
-            }
-        }
-    }
-    catch(const ValueException & ve) {
-        rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", ve.what());
-        goto error;
+    if (LSM_ERR_OK != rc) {
+        return rc;
     }
 
-  out:
-    return rc;
+    p["flags"] = Value(flags);
+    Value parameters(p);
+    Value response;
 
-  error:
-    if (*poolArray && *count) {
-        lsm_pool_record_array_free(*poolArray, *count);
-        *poolArray = NULL;
-        *count = 0;
-    }
-    goto out;
+    rc = rpc(c, "pools", parameters, response);
+    return get_pool_array(c, rc, response, poolArray, count);
 }
 
 int lsm_pool_member_info(lsm_connect * c, lsm_pool * pool,
@@ -879,7 +1704,7 @@ int lsm_pool_member_info(lsm_connect * c, lsm_pool * pool,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["pool"] = pool_to_value(pool);
     p["flags"] = Value(flags);
     Value parameters(p);
@@ -889,7 +1714,7 @@ int lsm_pool_member_info(lsm_connect * c, lsm_pool * pool,
 
         rc = rpc(c, "pool_member_info", parameters, response);
         if (LSM_ERR_OK == rc) {
-            std::vector < Value > j = response.asArray();
+            std::vector < Value > &j = response.asArray();
             *raid_type = (lsm_volume_raid_type) j[0].asInt32_t();
             *member_type = (lsm_pool_member_type) j[1].asInt32_t();
             *member_ids = NULL;
@@ -932,7 +1757,7 @@ int lsm_target_port_list(lsm_connect * c, const char *search_key,
     }
 
     try {
-        std::map < std::string, Value > p;
+        ValueObject p;
 
         rc = add_search_params(p, search_key, search_value,
                                TARGET_PORT_SEARCH_KEYS,
@@ -947,7 +1772,7 @@ int lsm_target_port_list(lsm_connect * c, const char *search_key,
 
         rc = rpc(c, "target_ports", parameters, response);
         if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-            std::vector < Value > tp = response.asArray();
+            std::vector < Value > &tp = response.asArray();
 
             *count = tp.size();
 
@@ -998,6 +1823,15 @@ static int get_volume_array(lsm_connect * c, int rc, Value & response,
 int lsm_volume_list(lsm_connect * c, const char *search_key,
                     const char *search_value, lsm_volume ** volumes[],
                     uint32_t * count, lsm_flag flags)
+{
+    return lsm_volume_list_fields(c, search_key, search_value, NULL, volumes,
+                                  count, flags);
+}
+
+int lsm_volume_list_fields(lsm_connect * c, const char *search_key,
+                           const char *search_value, lsm_string_list * fields,
+                           lsm_volume ** volumes[], uint32_t * count,
+                           lsm_flag flags)
 {
     CONN_SETUP(c);
 
@@ -1005,7 +1839,7 @@ int lsm_volume_list(lsm_connect * c, const char *search_key,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["flags"] = Value(flags);
 
     int rc = add_search_params(p, search_key, search_value, VOLUME_SEARCH_KEYS,
@@ -1014,6 +1848,11 @@ int lsm_volume_list(lsm_connect * c, const char *search_key,
         return rc;
     }
 
+    rc = add_fields_param(p, fields, VOLUME_FIELDS, VOLUME_FIELDS_COUNT);
+    if (LSM_ERR_OK != rc) {
+        return rc;
+    }
+
     Value parameters(p);
     Value response;
 
@@ -1038,6 +1877,15 @@ static int get_disk_array(lsm_connect * c, int rc, Value & response,
 int lsm_disk_list(lsm_connect * c, const char *search_key,
                   const char *search_value,
                   lsm_disk ** disks[], uint32_t * count, lsm_flag flags)
+{
+    return lsm_disk_list_fields(c, search_key, search_value, NULL, disks,
+                                count, flags);
+}
+
+int lsm_disk_list_fields(lsm_connect * c, const char *search_key,
+                         const char *search_value, lsm_string_list * fields,
+                         lsm_disk ** disks[], uint32_t * count,
+                         lsm_flag flags)
 {
     CONN_SETUP(c);
 
@@ -1045,7 +1893,7 @@ int lsm_disk_list(lsm_connect * c, const char *search_key,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["flags"] = Value(flags);
 
     int rc = add_search_params(p, search_key, search_value, DISK_SEARCH_KEYS,
@@ -1054,6 +1902,11 @@ int lsm_disk_list(lsm_connect * c, const char *search_key,
         return rc;
     }
 
+    rc = add_fields_param(p, fields, DISK_FIELDS, DISK_FIELDS_COUNT);
+    if (LSM_ERR_OK != rc) {
+        return rc;
+    }
+
     Value parameters(p);
     Value response;
 
@@ -1072,7 +1925,7 @@ static void *parse_job_response(lsm_connect * c, Value response, int &rc,
     try {
         //We get an array back. first value is job, second is data of interest.
         if (Value::array_t == response.valueType()) {
-            std::vector < Value > r = response.asArray();
+            std::vector < Value > &r = response.asArray();
             if (Value::string_t == r[0].valueType()) {
                 *job = strdup((r[0].asString()).c_str());
                 if (!(*job)) {
@@ -1105,6 +1958,20 @@ static void *parse_job_response(lsm_connect * c, Value response, int &rc,
     goto out;
 }
 
+static Value volume_create_params(lsm_pool * pool, const char *volumeName,
+                                  uint64_t size,
+                                  lsm_volume_provision_type provisioning,
+                                  lsm_flag flags)
+{
+    ValueObject p;
+    p["pool"] = pool_to_value(pool);
+    p["volume_name"] = Value(volumeName);
+    p["size_bytes"] = Value(size);
+    p["provisioning"] = Value((int32_t) provisioning);
+    p["flags"] = Value(flags);
+    return Value(p);
+}
+
 int lsm_volume_create(lsm_connect * c, lsm_pool * pool,
                       const char *volumeName, uint64_t size,
                       lsm_volume_provision_type provisioning,
@@ -1121,14 +1988,8 @@ int lsm_volume_create(lsm_connect * c, lsm_pool * pool,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
-    p["pool"] = pool_to_value(pool);
-    p["volume_name"] = Value(volumeName);
-    p["size_bytes"] = Value(size);
-    p["provisioning"] = Value((int32_t) provisioning);
-    p["flags"] = Value(flags);
-
-    Value parameters(p);
+    Value parameters = volume_create_params(pool, volumeName, size,
+                                            provisioning, flags);
     Value response;
 
     int rc = rpc(c, "volume_create", parameters, response);
@@ -1155,7 +2016,7 @@ int lsm_volume_resize(lsm_connect * c, lsm_volume * volume,
         return LSM_ERR_NO_STATE_CHANGE;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["volume"] = volume_to_value(volume);
     p["new_size_bytes"] = Value(newSize);
     p["flags"] = Value(flags);
@@ -1188,7 +2049,7 @@ int lsm_volume_replicate(lsm_connect * c, lsm_pool * pool,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["pool"] = pool_to_value(pool);
     p["rep_type"] = Value((int32_t) repType);
     p["volume_src"] = volume_to_value(volumeSrc);
@@ -1220,7 +2081,7 @@ int lsm_volume_replicate_range_block_size(lsm_connect * c,
     }
 
     try {
-        std::map < std::string, Value > p;
+        ValueObject p;
         p["system"] = system_to_value(system);
         p["flags"] = Value(flags);
         Value parameters(p);
@@ -1258,7 +2119,7 @@ int lsm_volume_replicate_range(lsm_connect * c,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["rep_type"] = Value((int32_t) repType);
     p["volume_src"] = volume_to_value(source);
     p["volume_dest"] = volume_to_value(dest);
@@ -1274,7 +2135,7 @@ int lsm_volume_replicate_range(lsm_connect * c,
 
 static Value _create_volume_flag_param(lsm_volume * volume, lsm_flag flags)
 {
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["volume"] = volume_to_value(volume);
     p["flags"] = Value(flags);
 
@@ -1340,7 +2201,7 @@ int lsm_volume_raid_info(lsm_connect * c, lsm_volume * volume,
         rc = rpc(c, "volume_raid_info", parameters, response);
         if (LSM_ERR_OK == rc) {
             //We get a value back, either null or job id.
-            std::vector < Value > j = response.asArray();
+            std::vector < Value > &j = response.asArray();
             *raid_type = (lsm_volume_raid_type) j[0].asInt32_t();
             *strip_size = j[1].asUint32_t();
             *disk_count = j[2].asUint32_t();
@@ -1366,7 +2227,7 @@ int lsm_iscsi_chap_auth(lsm_connect * c, const char *init_id,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["init_id"] = Value(init_id);
     p["in_user"] = Value(username);
     p["in_password"] = Value(password);
@@ -1394,7 +2255,7 @@ static int online_offline(lsm_connect * c, lsm_volume * v,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["volume"] = volume_to_value(v);
     p["flags"] = Value(flags);
 
@@ -1424,7 +2285,7 @@ int lsm_access_group_list(lsm_connect * c, const char *search_key,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
 
     int rc = add_search_params(p, search_key, search_value,
                                ACCESS_GROUP_SEARCH_KEYS,
@@ -1460,7 +2321,7 @@ int lsm_access_group_create(lsm_connect * c, const char *name,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["name"] = Value(name);
     p["init_id"] = id;
     p["init_type"] = Value((int32_t) init_type);
@@ -1499,7 +2360,7 @@ int lsm_access_group_delete(lsm_connect * c,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["access_group"] = access_group_to_value(access_group);
     p["flags"] = Value(flags);
 
@@ -1509,17 +2370,13 @@ int lsm_access_group_delete(lsm_connect * c,
     return rpc(c, "access_group_delete", parameters, response);
 }
 
-static int _lsm_ag_add_delete(lsm_connect * c,
-                              lsm_access_group * access_group,
-                              const char *init_id,
-                              lsm_access_group_init_type init_type,
-                              lsm_access_group ** updated_access_group,
-                              lsm_flag flags, const char *message)
+static int ag_initiator_params(lsm_access_group * access_group,
+                               const char *init_id,
+                               lsm_access_group_init_type init_type,
+                               lsm_flag flags, Value & parameters)
 {
-    CONN_SETUP(c);
-
     if (!LSM_IS_ACCESS_GROUP(access_group) || CHECK_STR(init_id) ||
-        LSM_FLAG_UNUSED_CHECK(flags) || CHECK_RP(updated_access_group)) {
+        LSM_FLAG_UNUSED_CHECK(flags)) {
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
@@ -1529,15 +2386,37 @@ static int _lsm_ag_add_delete(lsm_connect * c,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["access_group"] = access_group_to_value(access_group);
     p["init_id"] = id;
     p["init_type"] = Value((int32_t) init_type);
     p["flags"] = Value(flags);
 
-    Value parameters(p);
+    parameters = Value(p);
+    return LSM_ERR_OK;
+}
+
+static int _lsm_ag_add_delete(lsm_connect * c,
+                              lsm_access_group * access_group,
+                              const char *init_id,
+                              lsm_access_group_init_type init_type,
+                              lsm_access_group ** updated_access_group,
+                              lsm_flag flags, const char *message)
+{
+    CONN_SETUP(c);
+
+    if (CHECK_RP(updated_access_group)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    Value parameters;
     Value response;
 
+    if (LSM_ERR_OK != ag_initiator_params(access_group, init_id, init_type,
+                                          flags, parameters)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
     int rc = rpc(c, message, parameters, response);
     try {
         if (LSM_ERR_OK == rc) {
@@ -1581,6 +2460,16 @@ int lsm_access_group_initiator_delete(lsm_connect * c,
                               "access_group_initiator_delete");
 }
 
+static Value volume_mask_params(lsm_access_group * access_group,
+                                lsm_volume * volume, lsm_flag flags)
+{
+    ValueObject p;
+    p["access_group"] = access_group_to_value(access_group);
+    p["volume"] = volume_to_value(volume);
+    p["flags"] = Value(flags);
+    return Value(p);
+}
+
 int lsm_volume_mask(lsm_connect * c, lsm_access_group * access_group,
                     lsm_volume * volume, lsm_flag flags)
 {
@@ -1591,12 +2480,7 @@ int lsm_volume_mask(lsm_connect * c, lsm_access_group * access_group,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
-    p["access_group"] = access_group_to_value(access_group);
-    p["volume"] = volume_to_value(volume);
-    p["flags"] = Value(flags);
-
-    Value parameters(p);
+    Value parameters = volume_mask_params(access_group, volume, flags);
     Value response;
 
     return rpc(c, "volume_mask", parameters, response);
@@ -1613,15 +2497,311 @@ int lsm_volume_unmask(lsm_connect * c, lsm_access_group * group,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
-    p["access_group"] = access_group_to_value(group);
-    p["volume"] = volume_to_value(volume);
+    Value parameters = volume_mask_params(group, volume, flags);
+    Value response;
+
+    return rpc(c, "volume_unmask", parameters, response);
+}
+
+lsm_batch *lsm_batch_alloc(void)
+{
+    lsm_batch *rc = (lsm_batch *) calloc(1, sizeof(lsm_batch));
+    if (rc) {
+        try {
+            rc->requests = new Value(Value::array_t);
+            rc->magic = LSM_BATCH_MAGIC;
+        }
+        catch( ...) {
+            free(rc);
+            rc = NULL;
+        }
+    }
+    return rc;
+}
+
+int lsm_batch_free(lsm_batch * batch)
+{
+    if (!LSM_IS_BATCH(batch)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    batch->magic = LSM_DEL_MAGIC(LSM_BATCH_MAGIC);
+    delete batch->requests;
+    delete batch->results;
+    free(batch);
+    return LSM_ERR_OK;
+}
+
+uint32_t lsm_batch_size(lsm_batch * batch)
+{
+    if (!LSM_IS_BATCH(batch)) {
+        return 0;
+    }
+    return batch->requests->asArray().size();
+}
+
+static int batch_add(lsm_batch * batch, const char *method,
+                     const Value & parameters)
+{
+    try {
+        ValueObject r;
+        r["method"] = Value(method);
+        r["params"] = parameters;
+        batch->requests->asArray().push_back(Value(r));
+    }
+    catch( ...) {
+        return LSM_ERR_NO_MEMORY;
+    }
+    return LSM_ERR_OK;
+}
+
+int lsm_batch_volume_create(lsm_batch * batch, lsm_pool * pool,
+                            const char *volume_name, uint64_t size,
+                            lsm_volume_provision_type provisioning,
+                            lsm_flag flags)
+{
+    if (!LSM_IS_BATCH(batch) || !LSM_IS_POOL(pool) ||
+        CHECK_STR(volume_name) || !size || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    return batch_add(batch, "volume_create",
+                     volume_create_params(pool, volume_name, size,
+                                          provisioning, flags));
+}
+
+int lsm_batch_volume_mask(lsm_batch * batch, lsm_access_group * access_group,
+                          lsm_volume * volume, lsm_flag flags)
+{
+    if (!LSM_IS_BATCH(batch) || !LSM_IS_ACCESS_GROUP(access_group) ||
+        !LSM_IS_VOL(volume) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    return batch_add(batch, "volume_mask",
+                     volume_mask_params(access_group, volume, flags));
+}
+
+int lsm_batch_volume_unmask(lsm_batch * batch,
+                            lsm_access_group * access_group,
+                            lsm_volume * volume, lsm_flag flags)
+{
+    if (!LSM_IS_BATCH(batch) || !LSM_IS_ACCESS_GROUP(access_group) ||
+        !LSM_IS_VOL(volume) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    return batch_add(batch, "volume_unmask",
+                     volume_mask_params(access_group, volume, flags));
+}
+
+int lsm_batch_access_group_initiator_add(lsm_batch * batch,
+                                         lsm_access_group * access_group,
+                                         const char *init_id,
+                                         lsm_access_group_init_type init_type,
+                                         lsm_flag flags)
+{
+    Value parameters;
+
+    if (!LSM_IS_BATCH(batch) ||
+        LSM_ERR_OK != ag_initiator_params(access_group, init_id, init_type,
+                                          flags, parameters)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    return batch_add(batch, "access_group_initiator_add", parameters);
+}
+
+/**
+ * Runs the requests of a batch one rpc at a time, for plug-ins which do not
+ * handle "batch".  Fills in response the same way the plug-in would.
+ */
+static int batch_run_each(lsm_connect * c, lsm_batch * batch,
+                          Value & response)
+{
+    std::vector < Value > &requests = batch->requests->asArray();
+    std::vector < Value > results;
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        Value item_response;
+        ValueObject item;
+        int rc = rpc(c, requests[i]["method"].asC_str(),
+                     requests[i]["params"], item_response);
+
+        if (LSM_ERR_OK == rc) {
+            item["result"] = item_response;
+        } else if (LSM_ERR_TRANSPORT_COMMUNICATION == rc ||
+                   LSM_ERR_TRANSPORT_SERIALIZATION == rc ||
+                   LSM_ERR_LIB_BUG == rc) {
+            return rc;
+        } else {
+            ValueObject error_data;
+            lsm_error *e = connection_error_swap(c, NULL);
+
+            error_data["code"] = Value(rc);
+            error_data["message"] =
+                Value((e && e->message) ? e->message : "");
+            error_data["data"] = Value("");
+            item["error"] = Value(error_data);
+            lsm_error_free(e);
+        }
+        results.push_back(Value(item));
+    }
+
+    lsm_error_free(connection_error_swap(c, NULL));
+    response = Value(results);
+    return LSM_ERR_OK;
+}
+
+int lsm_batch_run(lsm_connect * c, lsm_batch * batch, lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (!LSM_IS_BATCH(batch) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    delete batch->results;
+    batch->results = NULL;
+
+    ValueObject p;
+    p["requests"] = *batch->requests;
     p["flags"] = Value(flags);
 
     Value parameters(p);
     Value response;
 
-    return rpc(c, "volume_unmask", parameters, response);
+    int rc = rpc(c, "batch", parameters, response);
+    if (LSM_ERR_NO_SUPPORT == rc) {
+        lsm_error_free(connection_error_swap(c, NULL));
+        rc = batch_run_each(c, batch, response);
+    }
+
+    if (LSM_ERR_OK == rc) {
+        if (Value::array_t != response.valueType() ||
+            response.asArray().size() !=
+            batch->requests->asArray().size()) {
+            return log_exception(c, LSM_ERR_PLUGIN_BUG,
+                                 "Unexpected batch response", NULL);
+        }
+
+        try {
+            batch->results = new Value(response);
+        }
+        catch( ...) {
+            rc = LSM_ERR_NO_MEMORY;
+        }
+    }
+    return rc;
+}
+
+/**
+ * Result of one request of a batch, NULL if the batch did not run or the
+ * index is out of range.
+ */
+static Value *batch_item(lsm_batch * batch, uint32_t index)
+{
+    if (!LSM_IS_BATCH(batch) || !batch->results ||
+        index >= batch->results->asArray().size()) {
+        return NULL;
+    }
+    return &(batch->results->asArray()[index]);
+}
+
+int lsm_batch_result_get(lsm_batch * batch, uint32_t index, char **job,
+                         lsm_flag flags)
+{
+    Value *item = batch_item(batch, index);
+
+    if (!item || (job && *job) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    try {
+        Value error = item->getValue("error");
+        if (Value::object_t == error.valueType()) {
+            return error["code"].asInt32_t();
+        }
+
+        Value result = item->getValue("result");
+        if (Value::array_t == result.valueType() &&
+            result.asArray().size() == 2) {
+            result = result[0];
+        }
+
+        if (Value::string_t == result.valueType()) {
+            if (job) {
+                *job = strdup(result.asC_str());
+                if (!*job) {
+                    return LSM_ERR_NO_MEMORY;
+                }
+            }
+            return LSM_ERR_JOB_STARTED;
+        }
+    }
+    catch(const ValueException & ve) {
+        return LSM_ERR_PLUGIN_BUG;
+    }
+    return LSM_ERR_OK;
+}
+
+lsm_error_ptr lsm_batch_error_get(lsm_batch * batch, uint32_t index)
+{
+    Value *item = batch_item(batch, index);
+
+    if (!item) {
+        return NULL;
+    }
+
+    try {
+        Value error = item->getValue("error");
+        if (Value::object_t == error.valueType()) {
+            Value data = error.getValue("data");
+            const char *debug = NULL;
+
+            if (Value::string_t == data.valueType() &&
+                data.asString().size()) {
+                debug = data.asC_str();
+            }
+            return lsm_error_create((lsm_error_number)
+                                    error["code"].asInt32_t(),
+                                    error["message"].asC_str(), NULL, debug,
+                                    NULL, 0);
+        }
+    }
+    catch(const ValueException & ve) {
+        //Malformed error from the plug-in, nothing sensible to report
+    }
+    return NULL;
+}
+
+int lsm_batch_volume_get(lsm_batch * batch, uint32_t index,
+                         lsm_volume ** volume, lsm_flag flags)
+{
+    if (CHECK_RP(volume) || !batch_item(batch, index) ||
+        std::string("volume_create") !=
+        (*batch->requests)[index]["method"].asString()) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    int rc = lsm_batch_result_get(batch, index, NULL, flags);
+    if (LSM_ERR_OK == rc) {
+        try {
+            Value result = batch_item(batch, index)->getValue("result");
+            if (Value::array_t == result.valueType() &&
+                result.asArray().size() == 2 &&
+                Value::object_t == result[1].valueType()) {
+                *volume = value_to_volume(result[1]);
+                if (!*volume) {
+                    rc = LSM_ERR_NO_MEMORY;
+                }
+            }
+        }
+        catch(const ValueException & ve) {
+            rc = LSM_ERR_PLUGIN_BUG;
+        }
+    }
+    return rc;
 }
 
 int lsm_volumes_accessible_by_access_group(lsm_connect * c,
@@ -1638,7 +2818,7 @@ int lsm_volumes_accessible_by_access_group(lsm_connect * c,
     }
 
     try {
-        std::map < std::string, Value > p;
+        ValueObject p;
         p["access_group"] = access_group_to_value(group);
         p["flags"] = Value(flags);
 
@@ -1647,7 +2827,7 @@ int lsm_volumes_accessible_by_access_group(lsm_connect * c,
 
         rc = rpc(c, "volumes_accessible_by_access_group", parameters, response);
         if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-            std::vector < Value > vol = response.asArray();
+            std::vector < Value > &vol = response.asArray();
 
             *count = vol.size();
 
@@ -1672,165 +2852,430 @@ int lsm_volumes_accessible_by_access_group(lsm_connect * c,
         rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", ve.what());
         goto error;
 
-    }
+    }
+
+  out:
+    return rc;
+
+  error:
+    if (*volumes && *count) {
+        lsm_volume_record_array_free(*volumes, *count);
+        *volumes = NULL;
+        *count = 0;
+    }
+    goto out;
+}
+
+int lsm_access_groups_granted_to_volume(lsm_connect * c,
+                                        lsm_volume * volume,
+                                        lsm_access_group ** groups[],
+                                        uint32_t * groupCount, lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (!LSM_IS_VOL(volume)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    if (!groups || !groupCount || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    ValueObject p;
+    p["volume"] = volume_to_value(volume);
+    p["flags"] = Value(flags);
+
+    Value parameters(p);
+    Value response;
+
+    int rc = rpc(c, "access_groups_granted_to_volume", parameters, response);
+    return get_access_groups(c, rc, response, groups, groupCount);
+}
+
+static int _retrieve_bool(int rc, Value & response, uint8_t * yes)
+{
+    int rc_out = rc;
+
+    *yes = 0;
+
+    if (LSM_ERR_OK == rc) {
+        //We should be getting a boolean value back.
+        if (Value::boolean_t == response.valueType()) {
+            if (response.asBool()) {
+                *yes = 1;
+            }
+        } else {
+            rc_out = LSM_ERR_PLUGIN_BUG;
+        }
+    }
+    return rc_out;
+}
+
+int lsm_volume_child_dependency(lsm_connect * c, lsm_volume * volume,
+                                uint8_t * yes, lsm_flag flags)
+{
+    int rc = LSM_ERR_OK;
+    CONN_SETUP(c);
+
+    if (!LSM_IS_VOL(volume)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    if (!yes || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    try {
+
+        Value parameters = _create_volume_flag_param(volume, flags);
+        Value response;
+
+        rc = rpc(c, "volume_child_dependency", parameters, response);
+        rc = _retrieve_bool(rc, response, yes);
+    }
+    catch(const ValueException & ve) {
+        rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", ve.what());
+    }
+    return rc;
+}
+
+int lsm_volume_child_dependency_delete(lsm_connect * c,
+                                       lsm_volume * volume, char **job,
+                                       lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (!LSM_IS_VOL(volume) || CHECK_RP(job)
+        || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    Value parameters = _create_volume_flag_param(volume, flags);
+    Value response;
+
+    int rc = rpc(c, "volume_child_dependency_rm", parameters, response);
+    return job_check(c, rc, response, job);
+}
+
+static int get_system_array(lsm_connect * c, int rc, Value & response,
+                            lsm_system ** systems[], uint32_t * count)
+{
+    if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
+        try {
+            std::vector < Value > &sys = response.asArray();
+
+            *count = sys.size();
+
+            if (sys.size()) {
+                *systems = lsm_system_record_array_alloc(sys.size());
+
+                if (*systems) {
+                    for (size_t i = 0; i < sys.size(); ++i) {
+                        (*systems)[i] = value_to_system(sys[i]);
+                        if (!(*systems)[i]) {
+                            rc = LSM_ERR_NO_MEMORY;
+                            break;
+                        }
+                    }
+                } else {
+                    rc = LSM_ERR_NO_MEMORY;
+                }
+            }
+        }
+        catch(const ValueException & ve) {
+            rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type",
+                               ve.what());
+        }
+
+        if (LSM_ERR_OK != rc) {
+            if (*systems) {
+                lsm_system_record_array_free(*systems, *count);
+                *systems = NULL;
+            }
+            *count = 0;
+        }
+    }
+    return rc;
+}
+
+int lsm_system_list(lsm_connect * c, lsm_system ** systems[],
+                    uint32_t * systemCount, lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (!systems || !systemCount) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    ValueObject p;
+    p["flags"] = Value(flags);
+    Value parameters(p);
+    Value response;
+
+    int rc = rpc(c, "systems", parameters, response);
+    return get_system_array(c, rc, response, systems, systemCount);
+}
+
+int lsm_connect_fd_get(lsm_connect * c, int *fd, lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (!fd || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    *fd = c->tp->fd();
+    if (*fd < 0) {
+        return log_exception(c, LSM_ERR_TRANSPORT_COMMUNICATION,
+                             "Not connected", NULL);
+    }
+    return LSM_ERR_OK;
+}
+
+/**
+ * Sends a request of one of the *_async calls.
+ * @param c             Connection
+ * @param method        Method name
+ * @param parameters    Parameters
+ * @param complete      Converts the response and calls cb
+ * @param cb            Caller's callback
+ * @param user_data     Caller's callback data
+ * @return LSM_ERR_OK on success, else error reason.
+ */
+static int async_submit(lsm_connect * c, const char *method,
+                        const Value & parameters,
+                        lsm_async_complete complete, void (*cb) (void),
+                        void *user_data)
+{
+    if (!c->tp->multiplexed()) {
+        return log_exception(c, LSM_ERR_NO_SUPPORT,
+                             "Plug-in does not support asynchronous requests",
+                             NULL);
+    }
+
+    try {
+        if (!c->async) {
+            c->async = new std::map < int32_t, lsm_async_call > ();
+        }
+
+        lsm_async_call call;
+        call.complete = complete;
+        call.cb = cb;
+        call.user_data = user_data;
+
+        int32_t id = c->tp->requestSubmit(method, parameters);
+        (*c->async)[id] = call;
+    }
+    catch(const std::bad_alloc & ba) {
+        return LSM_ERR_NO_MEMORY;
+    }
+    catch( ...) {
+        return ipc_exception(c);
+    }
+    return LSM_ERR_OK;
+}
+
+int lsm_connect_process(lsm_connect * c, uint32_t * outstanding,
+                        lsm_flag flags)
+{
+    int rc = LSM_ERR_OK;
+    CONN_SETUP(c);
+
+    if (LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    if (c->async && c->async->size()) {
+        lsm_error *read_error = NULL;
+
+        try {
+            c->tp->responsesRead();
+        }
+        catch( ...) {
+            rc = ipc_exception(c);
+            read_error = connection_error_swap(c, NULL);
+        }
+
+        //The callbacks may submit more, so look the next one up each time
+        std::map < int32_t, lsm_async_call >::iterator i =
+            c->async->begin();
+
+        while (i != c->async->end()) {
+            int32_t id = i->first;
+            int call_rc = LSM_ERR_OK;
+            Value response;
+
+            lsm_error_free(connection_error_swap(c, NULL));
+
+            try {
+                if (!c->tp->responseTake(id, response)) {
+                    ++i;
+                    continue;
+                }
+            }
+            catch( ...) {
+                call_rc = ipc_exception(c);
+            }
+
+            lsm_async_call call = i->second;
+            c->async->erase(i);
+            call.complete(c, call_rc, response, call.cb, call.user_data);
+            i = c->async->upper_bound(id);
+        }
 
-  out:
-    return rc;
+        lsm_error_free(connection_error_swap(c, read_error));
+    }
 
-  error:
-    if (*volumes && *count) {
-        lsm_volume_record_array_free(*volumes, *count);
-        *volumes = NULL;
-        *count = 0;
+    if (outstanding) {
+        *outstanding = (c->async) ? c->async->size() : 0;
     }
-    goto out;
+    return rc;
 }
 
-int lsm_access_groups_granted_to_volume(lsm_connect * c,
-                                        lsm_volume * volume,
-                                        lsm_access_group ** groups[],
-                                        uint32_t * groupCount, lsm_flag flags)
+/**
+ * Builds the parameters of an asynchronous list call.
+ * @param k                     Search key
+ * @param v                     Search value
+ * @param supported_keys        Search keys of the method
+ * @param supported_keys_count  Number of search keys
+ * @param flags                 Flags
+ * @param parameters            Parameters
+ * @return LSM_ERR_OK on success, else error reason.
+ */
+static int async_list_params(const char *k, const char *v,
+                             const char *const supported_keys[],
+                             size_t supported_keys_count, lsm_flag flags,
+                             Value & parameters)
 {
-    CONN_SETUP(c);
+    ValueObject p;
 
-    if (!LSM_IS_VOL(volume)) {
-        return LSM_ERR_INVALID_ARGUMENT;
+    int rc = add_search_params(p, k, v, supported_keys,
+                               supported_keys_count);
+    if (LSM_ERR_OK == rc) {
+        p["flags"] = Value(flags);
+        parameters = Value(p);
     }
+    return rc;
+}
 
-    if (!groups || !groupCount || LSM_FLAG_UNUSED_CHECK(flags)) {
-        return LSM_ERR_INVALID_ARGUMENT;
-    }
+static void system_list_complete(lsm_connect * c, int rc, Value & response,
+                                 void (*cb) (void), void *user_data)
+{
+    lsm_system **systems = NULL;
+    uint32_t count = 0;
 
-    std::map < std::string, Value > p;
-    p["volume"] = volume_to_value(volume);
-    p["flags"] = Value(flags);
+    rc = get_system_array(c, rc, response, &systems, &count);
+    ((lsm_system_list_cb) cb) (c, rc, systems, count, user_data);
+}
 
-    Value parameters(p);
-    Value response;
+static void pool_list_complete(lsm_connect * c, int rc, Value & response,
+                               void (*cb) (void), void *user_data)
+{
+    lsm_pool **pools = NULL;
+    uint32_t count = 0;
 
-    int rc = rpc(c, "access_groups_granted_to_volume", parameters, response);
-    return get_access_groups(c, rc, response, groups, groupCount);
+    rc = get_pool_array(c, rc, response, &pools, &count);
+    ((lsm_pool_list_cb) cb) (c, rc, pools, count, user_data);
 }
 
-static int _retrieve_bool(int rc, Value & response, uint8_t * yes)
+static void volume_list_complete(lsm_connect * c, int rc, Value & response,
+                                 void (*cb) (void), void *user_data)
 {
-    int rc_out = rc;
+    lsm_volume **volumes = NULL;
+    uint32_t count = 0;
 
-    *yes = 0;
+    rc = get_volume_array(c, rc, response, &volumes, &count);
+    ((lsm_volume_list_cb) cb) (c, rc, volumes, count, user_data);
+}
 
-    if (LSM_ERR_OK == rc) {
-        //We should be getting a boolean value back.
-        if (Value::boolean_t == response.valueType()) {
-            if (response.asBool()) {
-                *yes = 1;
-            }
-        } else {
-            rc_out = LSM_ERR_PLUGIN_BUG;
-        }
-    }
-    return rc_out;
+static void disk_list_complete(lsm_connect * c, int rc, Value & response,
+                               void (*cb) (void), void *user_data)
+{
+    lsm_disk **disks = NULL;
+    uint32_t count = 0;
+
+    rc = get_disk_array(c, rc, response, &disks, &count);
+    ((lsm_disk_list_cb) cb) (c, rc, disks, count, user_data);
 }
 
-int lsm_volume_child_dependency(lsm_connect * c, lsm_volume * volume,
-                                uint8_t * yes, lsm_flag flags)
+int lsm_system_list_async(lsm_connect * c, lsm_system_list_cb cb,
+                          void *user_data, lsm_flag flags)
 {
-    int rc = LSM_ERR_OK;
     CONN_SETUP(c);
 
-    if (!LSM_IS_VOL(volume)) {
-        return LSM_ERR_INVALID_ARGUMENT;
-    }
-
-    if (!yes || LSM_FLAG_UNUSED_CHECK(flags)) {
+    if (!cb || LSM_FLAG_UNUSED_CHECK(flags)) {
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    try {
-
-        Value parameters = _create_volume_flag_param(volume, flags);
-        Value response;
+    ValueObject p;
+    p["flags"] = Value(flags);
+    Value parameters(p);
 
-        rc = rpc(c, "volume_child_dependency", parameters, response);
-        rc = _retrieve_bool(rc, response, yes);
-    }
-    catch(const ValueException & ve) {
-        rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", ve.what());
-    }
-    return rc;
+    return async_submit(c, "systems", parameters, system_list_complete,
+                        (void (*)(void)) cb, user_data);
 }
 
-int lsm_volume_child_dependency_delete(lsm_connect * c,
-                                       lsm_volume * volume, char **job,
-                                       lsm_flag flags)
+int lsm_pool_list_async(lsm_connect * c, const char *search_key,
+                        const char *search_value, lsm_pool_list_cb cb,
+                        void *user_data, lsm_flag flags)
 {
     CONN_SETUP(c);
 
-    if (!LSM_IS_VOL(volume) || CHECK_RP(job)
-        || LSM_FLAG_UNUSED_CHECK(flags)) {
+    if (!cb || LSM_FLAG_UNUSED_CHECK(flags)) {
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    Value parameters = _create_volume_flag_param(volume, flags);
-    Value response;
+    Value parameters;
+    int rc = async_list_params(search_key, search_value, POOL_SEARCH_KEYS,
+                               POOL_SEARCH_KEYS_COUNT, flags, parameters);
+    if (LSM_ERR_OK != rc) {
+        return rc;
+    }
 
-    int rc = rpc(c, "volume_child_dependency_rm", parameters, response);
-    return job_check(c, rc, response, job);
+    return async_submit(c, "pools", parameters, pool_list_complete,
+                        (void (*)(void)) cb, user_data);
 }
 
-int lsm_system_list(lsm_connect * c, lsm_system ** systems[],
-                    uint32_t * systemCount, lsm_flag flags)
+int lsm_volume_list_async(lsm_connect * c, const char *search_key,
+                          const char *search_value, lsm_volume_list_cb cb,
+                          void *user_data, lsm_flag flags)
 {
-    int rc = LSM_ERR_OK;
     CONN_SETUP(c);
 
-    if (!systems || !systemCount) {
+    if (!cb || LSM_FLAG_UNUSED_CHECK(flags)) {
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    try {
-        std::map < std::string, Value > p;
-        p["flags"] = Value(flags);
-        Value parameters(p);
-        Value response;
-
-        rc = rpc(c, "systems", parameters, response);
-        if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-            std::vector < Value > sys = response.asArray();
+    Value parameters;
+    int rc = async_list_params(search_key, search_value, VOLUME_SEARCH_KEYS,
+                               VOLUME_SEARCH_KEYS_COUNT, flags, parameters);
+    if (LSM_ERR_OK != rc) {
+        return rc;
+    }
 
-            *systemCount = sys.size();
+    return async_submit(c, "volumes", parameters, volume_list_complete,
+                        (void (*)(void)) cb, user_data);
+}
 
-            if (sys.size()) {
-                *systems = lsm_system_record_array_alloc(sys.size());
+int lsm_disk_list_async(lsm_connect * c, const char *search_key,
+                        const char *search_value, lsm_disk_list_cb cb,
+                        void *user_data, lsm_flag flags)
+{
+    CONN_SETUP(c);
 
-                if (*systems) {
-                    for (size_t i = 0; i < sys.size(); ++i) {
-                        (*systems)[i] = value_to_system(sys[i]);
-                        if (!(*systems)[i]) {
-                            rc = LSM_ERR_NO_MEMORY;
-                            goto error;
-                        }
-                    }
-                } else {
-                    rc = LSM_ERR_NO_MEMORY;
-                }
-            }
-        }
+    if (!cb || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
     }
-    catch(const ValueException & ve) {
-        rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", ve.what());
-        goto error;
 
+    Value parameters;
+    int rc = async_list_params(search_key, search_value, DISK_SEARCH_KEYS,
+                               DISK_SEARCH_KEYS_COUNT, flags, parameters);
+    if (LSM_ERR_OK != rc) {
+        return rc;
     }
-  out:
-    return rc;
 
-  error:
-    if (*systems) {
-        lsm_system_record_array_free(*systems, *systemCount);
-        *systems = NULL;
-        *systemCount = 0;
-    }
-    goto out;
+    return async_submit(c, "disks", parameters, disk_list_complete,
+                        (void (*)(void)) cb, user_data);
 }
 
 int lsm_fs_list(lsm_connect * c, const char *search_key,
@@ -1845,7 +3290,7 @@ int lsm_fs_list(lsm_connect * c, const char *search_key,
     }
 
     try {
-        std::map < std::string, Value > p;
+        ValueObject p;
 
         rc = add_search_params(p, search_key, search_value, FS_SEARCH_KEYS,
                                FS_SEARCH_KEYS_COUNT);
@@ -1859,7 +3304,7 @@ int lsm_fs_list(lsm_connect * c, const char *search_key,
 
         rc = rpc(c, "fs", parameters, response);
         if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-            std::vector < Value > sys = response.asArray();
+            std::vector < Value > &sys = response.asArray();
 
             *fsCount = sys.size();
 
@@ -1911,7 +3356,7 @@ int lsm_fs_create(lsm_connect * c, lsm_pool * pool, const char *name,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["pool"] = pool_to_value(pool);
     p["name"] = Value(name);
     p["size_bytes"] = Value(size_bytes);
@@ -1930,7 +3375,7 @@ int lsm_fs_create(lsm_connect * c, lsm_pool * pool, const char *name,
 
 static Value _create_fs_flag_param(lsm_fs * fs, lsm_flag flags)
 {
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["fs"] = fs_to_value(fs);
     p["flags"] = Value(flags);
     return Value(p);
@@ -1963,7 +3408,7 @@ int lsm_fs_resize(lsm_connect * c, lsm_fs * fs,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["fs"] = fs_to_value(fs);
     p["new_size_bytes"] = Value(new_size_bytes);
     p["flags"] = Value(flags);
@@ -1990,7 +3435,7 @@ int lsm_fs_clone(lsm_connect * c, lsm_fs * src_fs,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["src_fs"] = fs_to_value(src_fs);
     p["dest_fs_name"] = Value(name);
     p["snapshot"] = ss_to_value(optional_ss);
@@ -2020,7 +3465,7 @@ int lsm_fs_file_clone(lsm_connect * c, lsm_fs * fs,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["fs"] = fs_to_value(fs);
     p["src_file_name"] = Value(src_file_name);
     p["dest_file_name"] = Value(dest_file_name);
@@ -2038,7 +3483,7 @@ static Value _create_fs_file_flag_params(lsm_fs * fs,
                                          lsm_string_list * files,
                                          lsm_flag flags)
 {
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["fs"] = fs_to_value(fs);
     p["files"] = string_list_to_value(files);
     p["flags"] = Value(flags);
@@ -2127,7 +3572,7 @@ int lsm_fs_ss_list(lsm_connect * c, lsm_fs * fs, lsm_fs_ss ** ss[],
     try {
         rc = rpc(c, "fs_snapshots", parameters, response);
         if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-            std::vector < Value > sys = response.asArray();
+            std::vector < Value > &sys = response.asArray();
 
             *ssCount = sys.size();
 
@@ -2179,7 +3624,7 @@ int lsm_fs_ss_create(lsm_connect * c, lsm_fs * fs, const char *name,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["fs"] = fs_to_value(fs);
     p["snapshot_name"] = Value(name);
     p["flags"] = Value(flags);
@@ -2213,7 +3658,7 @@ int lsm_fs_ss_delete(lsm_connect * c, lsm_fs * fs, lsm_fs_ss * ss,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["fs"] = fs_to_value(fs);
     p["snapshot"] = ss_to_value(ss);
     p["flags"] = Value(flags);
@@ -2256,7 +3701,7 @@ int lsm_fs_ss_restore(lsm_connect * c, lsm_fs * fs, lsm_fs_ss * ss,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["fs"] = fs_to_value(fs);
     p["snapshot"] = ss_to_value(ss);
     p["files"] = string_list_to_value(files);
@@ -2287,7 +3732,7 @@ int lsm_nfs_list(lsm_connect * c, const char *search_key,
     *exports = NULL;
 
     try {
-        std::map < std::string, Value > p;
+        ValueObject p;
 
         rc = add_search_params(p, search_key, search_value,
                                NFS_EXPORT_SEARCH_KEYS,
@@ -2302,7 +3747,7 @@ int lsm_nfs_list(lsm_connect * c, const char *search_key,
 
         rc = rpc(c, "exports", parameters, response);
         if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-            std::vector < Value > exps = response.asArray();
+            std::vector < Value > &exps = response.asArray();
 
             *count = exps.size();
 
@@ -2339,6 +3784,235 @@ int lsm_nfs_list(lsm_connect * c, const char *search_key,
     goto out;
 }
 
+int lsm_volume_list_page(lsm_connect * c, const char *search_key,
+                         const char *search_value, const char *cursor,
+                         uint32_t limit, lsm_volume ** volumes[],
+                         uint32_t * count, char **next_cursor, lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (CHECK_RP(volumes) || !count) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    Value items;
+    int rc = list_page(c, "volumes_page", search_key, search_value,
+                       VOLUME_SEARCH_KEYS, VOLUME_SEARCH_KEYS_COUNT,
+                       cursor, limit, next_cursor, flags, items);
+    if (LSM_ERR_OK == rc) {
+        rc = value_array_to_volumes(items, volumes, count);
+        if (LSM_ERR_OK != rc) {
+            free(*next_cursor);
+            *next_cursor = NULL;
+        }
+    }
+    return rc;
+}
+
+int lsm_disk_list_page(lsm_connect * c, const char *search_key,
+                       const char *search_value, const char *cursor,
+                       uint32_t limit, lsm_disk ** disks[],
+                       uint32_t * count, char **next_cursor, lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (CHECK_RP(disks) || !count) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    Value items;
+    int rc = list_page(c, "disks_page", search_key, search_value,
+                       DISK_SEARCH_KEYS, DISK_SEARCH_KEYS_COUNT,
+                       cursor, limit, next_cursor, flags, items);
+    if (LSM_ERR_OK == rc) {
+        rc = value_array_to_disks(items, disks, count);
+        if (LSM_ERR_OK != rc) {
+            free(*next_cursor);
+            *next_cursor = NULL;
+        }
+    }
+    return rc;
+}
+
+int lsm_access_group_list_page(lsm_connect * c, const char *search_key,
+                               const char *search_value, const char *cursor,
+                               uint32_t limit, lsm_access_group ** groups[],
+                               uint32_t * count, char **next_cursor,
+                               lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (CHECK_RP(groups) || !count) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    Value items;
+    int rc = list_page(c, "access_groups_page", search_key, search_value,
+                       ACCESS_GROUP_SEARCH_KEYS, ACCESS_GROUP_SEARCH_KEYS_COUNT,
+                       cursor, limit, next_cursor, flags, items);
+    if (LSM_ERR_OK == rc) {
+        rc = value_array_to_access_groups(items, groups, count);
+        if (LSM_ERR_OK != rc) {
+            free(*next_cursor);
+            *next_cursor = NULL;
+        }
+    }
+    return rc;
+}
+
+int lsm_fs_list_page(lsm_connect * c, const char *search_key,
+                     const char *search_value, const char *cursor,
+                     uint32_t limit, lsm_fs ** fs[],
+                     uint32_t * count, char **next_cursor, lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (CHECK_RP(fs) || !count) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    Value items;
+    int rc = list_page(c, "fs_page", search_key, search_value,
+                       FS_SEARCH_KEYS, FS_SEARCH_KEYS_COUNT,
+                       cursor, limit, next_cursor, flags, items);
+    if (LSM_ERR_OK == rc) {
+        rc = value_array_to_fs(items, fs, count);
+        if (LSM_ERR_OK != rc) {
+            free(*next_cursor);
+            *next_cursor = NULL;
+        }
+    }
+    return rc;
+}
+
+int lsm_nfs_list_page(lsm_connect * c, const char *search_key,
+                      const char *search_value, const char *cursor,
+                      uint32_t limit, lsm_nfs_export ** exports[],
+                      uint32_t * count, char **next_cursor, lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (CHECK_RP(exports) || !count) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    Value items;
+    int rc = list_page(c, "exports_page", search_key, search_value,
+                       NFS_EXPORT_SEARCH_KEYS, NFS_EXPORT_SEARCH_KEYS_COUNT,
+                       cursor, limit, next_cursor, flags, items);
+    if (LSM_ERR_OK == rc) {
+        rc = value_array_to_nfs_exports(items, exports, count);
+        if (LSM_ERR_OK != rc) {
+            free(*next_cursor);
+            *next_cursor = NULL;
+        }
+    }
+    return rc;
+}
+
+int lsm_volume_list_in(lsm_connect * c, const char *search_key,
+                       lsm_string_list * search_values,
+                       lsm_volume ** volumes[], uint32_t * count,
+                       lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (CHECK_RP(volumes) || !count) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    Value items;
+    int rc = list_in(c, "volumes", search_key, search_values,
+                     VOLUME_SEARCH_KEYS,
+                     VOLUME_SEARCH_KEYS_COUNT, flags, items);
+    if (LSM_ERR_OK == rc) {
+        rc = value_array_to_volumes(items, volumes, count);
+    }
+    return rc;
+}
+
+int lsm_disk_list_in(lsm_connect * c, const char *search_key,
+                     lsm_string_list * search_values,
+                     lsm_disk ** disks[], uint32_t * count,
+                     lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (CHECK_RP(disks) || !count) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    Value items;
+    int rc = list_in(c, "disks", search_key, search_values,
+                     DISK_SEARCH_KEYS, DISK_SEARCH_KEYS_COUNT, flags, items);
+    if (LSM_ERR_OK == rc) {
+        rc = value_array_to_disks(items, disks, count);
+    }
+    return rc;
+}
+
+int lsm_access_group_list_in(lsm_connect * c, const char *search_key,
+                             lsm_string_list * search_values,
+                             lsm_access_group ** groups[], uint32_t * count,
+                             lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (CHECK_RP(groups) || !count) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    Value items;
+    int rc = list_in(c, "access_groups", search_key, search_values,
+                     ACCESS_GROUP_SEARCH_KEYS,
+                     ACCESS_GROUP_SEARCH_KEYS_COUNT, flags, items);
+    if (LSM_ERR_OK == rc) {
+        rc = value_array_to_access_groups(items, groups, count);
+    }
+    return rc;
+}
+
+int lsm_fs_list_in(lsm_connect * c, const char *search_key,
+                   lsm_string_list * search_values,
+                   lsm_fs ** fs[], uint32_t * count,
+                   lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (CHECK_RP(fs) || !count) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    Value items;
+    int rc = list_in(c, "fs", search_key, search_values,
+                     FS_SEARCH_KEYS, FS_SEARCH_KEYS_COUNT, flags, items);
+    if (LSM_ERR_OK == rc) {
+        rc = value_array_to_fs(items, fs, count);
+    }
+    return rc;
+}
+
+int lsm_nfs_list_in(lsm_connect * c, const char *search_key,
+                    lsm_string_list * search_values,
+                    lsm_nfs_export ** exports[], uint32_t * count,
+                    lsm_flag flags)
+{
+    CONN_SETUP(c);
+
+    if (CHECK_RP(exports) || !count) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    Value items;
+    int rc = list_in(c, "exports", search_key, search_values,
+                     NFS_EXPORT_SEARCH_KEYS,
+                     NFS_EXPORT_SEARCH_KEYS_COUNT, flags, items);
+    if (LSM_ERR_OK == rc) {
+        rc = value_array_to_nfs_exports(items, exports, count);
+    }
+    return rc;
+}
+
 int lsm_nfs_export_fs(lsm_connect * c,
                       const char *fs_id,
                       const char *export_path,
@@ -2377,7 +4051,7 @@ int lsm_nfs_export_fs(lsm_connect * c,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
 
     p["fs_id"] = Value(fs_id);
     p["export_path"] = Value(export_path);
@@ -2426,7 +4100,7 @@ int lsm_nfs_export_delete(lsm_connect * c, lsm_nfs_export * e, lsm_flag flags)
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["export"] = nfs_export_to_value(e);
     p["flags"] = Value(flags);
 
@@ -2453,7 +4127,7 @@ int lsm_volume_raid_create_cap_get(lsm_connect * c, lsm_system * system,
 
     *supported_raid_types = NULL;
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["system"] = system_to_value(system);
     p["flags"] = Value(flags);
 
@@ -2462,7 +4136,7 @@ int lsm_volume_raid_create_cap_get(lsm_connect * c, lsm_system * system,
 
     int rc = rpc(c, "volume_raid_create_cap_get", parameters, response);
     try {
-        std::vector < Value > j = response.asArray();
+        std::vector < Value > &j = response.asArray();
 
         rc = values_to_uint32_array(j[0], supported_raid_types,
                                     supported_raid_type_count);
@@ -2546,7 +4220,7 @@ int lsm_volume_raid_create(lsm_connect * c, const char *name,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["name"] = Value(name);
     p["raid_type"] = Value((int32_t) raid_type);
     p["strip_size"] = Value((int32_t) strip_size);
@@ -2581,7 +4255,7 @@ int lsm_volume_ident_led_on(lsm_connect * c, lsm_volume * volume,
 {
     CONN_SETUP(c);
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["flags"] = Value(flags);
     p["volume"] = volume_to_value(volume);
 
@@ -2598,7 +4272,7 @@ int lsm_volume_ident_led_off(lsm_connect * c, lsm_volume * volume,
 {
     CONN_SETUP(c);
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["flags"] = Value(flags);
     p["volume"] = volume_to_value(volume);
 
@@ -2628,7 +4302,7 @@ int lsm_system_read_cache_pct_update(lsm_connect * c, lsm_system * system,
                              "Invalid argument: read_pct, "
                              "should >=0 and <= 100", NULL);
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["flags"] = Value(flags);
     p["read_pct"] = Value((int32_t) read_pct);
     p["system"] = system_to_value(system);
@@ -2666,7 +4340,7 @@ int lsm_battery_list(lsm_connect *c, const char *search_key,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["flags"] = Value(flags);
 
     int rc = add_search_params(p, search_key, search_value, DISK_SEARCH_KEYS,
@@ -2709,7 +4383,7 @@ int lsm_volume_cache_info(lsm_connect *c, lsm_volume *volume,
 
         rc = rpc(c, "volume_cache_info", parameters, response);
         if (LSM_ERR_OK == rc) {
-            std::vector < Value > j = response.asArray();
+            std::vector < Value > &j = response.asArray();
             *write_cache_policy = j[0].asUint32_t();
             *write_cache_status = j[1].asUint32_t();
             *read_cache_policy = j[2].asUint32_t();
@@ -2743,7 +4417,7 @@ int lsm_volume_physical_disk_cache_update(lsm_connect *c, lsm_volume *volume,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["volume"] = volume_to_value(volume);
     p["pdc"] = Value(pdc);
     p["flags"] = Value(flags);
@@ -2766,7 +4440,7 @@ int lsm_volume_write_cache_policy_update(lsm_connect *c, lsm_volume *volume,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["volume"] = volume_to_value(volume);
     p["wcp"] = Value(wcp);
     p["flags"] = Value(flags);
@@ -2788,7 +4462,7 @@ int lsm_volume_read_cache_policy_update(lsm_connect *c, lsm_volume *volume,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    std::map < std::string, Value > p;
+    ValueObject p;
     p["volume"] = volume_to_value(volume);
     p["rcp"] = Value(rcp);
     p["flags"] = Value(flags);
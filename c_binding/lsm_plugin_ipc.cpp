@@ -37,6 +37,16 @@
 #include <libxml/uri.h>
 #include "util/qparams.h"
 #include <syslog.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <deque>
+#include <algorithm>
+#include <time.h>
+
+/* Set by lsmd for plug-in processes it starts ahead of a client connecting */
+#define LSM_PLUGIN_WORKER_ENV "LSM_PLUGIN_WORKER"
 
 //Forward decl.
 static int lsm_plugin_run(lsm_plugin_ptr plug);
@@ -171,6 +181,25 @@ int lsm_register_plugin_v1_3(lsm_plugin_ptr plug, void *private_data,
     return rc;
 }
 
+int lsm_register_plugin_v1_6(lsm_plugin_ptr plug, void *private_data,
+                             struct lsm_mgmt_ops_v1 *mgm_op,
+                             struct lsm_san_ops_v1 *san_op,
+                             struct lsm_fs_ops_v1 *fs_op,
+                             struct lsm_nas_ops_v1 *nas_op,
+                             struct lsm_ops_v1_2 *ops_v1_2,
+                             struct lsm_ops_v1_3 *ops_v1_3,
+                             struct lsm_ops_v1_6 *ops_v1_6)
+{
+    int rc = lsm_register_plugin_v1_3(plug, private_data, mgm_op, san_op, fs_op,
+                                      nas_op, ops_v1_2, ops_v1_3);
+
+    if (rc != LSM_ERR_OK) {
+        return rc;
+    }
+    plug->ops_v1_6 = ops_v1_6;
+    return rc;
+}
+
 void *lsm_private_data_get(lsm_plugin_ptr plug)
 {
     if (!LSM_IS_PLUGIN(plug)) {
@@ -180,6 +209,37 @@ void *lsm_private_data_get(lsm_plugin_ptr plug)
     return plug->private_data;
 }
 
+/*
+ * Upper bound on handler threads, more would only contend on the plug-in's
+ * own resources.
+ */
+#define LSM_PLUGIN_THREADS_MAX 64
+
+int lsm_plugin_thread_count_set(lsm_plugin_ptr plug, uint32_t count,
+                                lsm_flag flags)
+{
+    if (!LSM_IS_PLUGIN(plug) || count > LSM_PLUGIN_THREADS_MAX ||
+        LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    plug->thread_count = count;
+    return LSM_ERR_OK;
+}
+
+int lsm_plugin_batch_hooks_set(lsm_plugin_ptr plug,
+                               lsm_plug_batch_begin begin,
+                               lsm_plug_batch_end end, lsm_flag flags)
+{
+    if (!LSM_IS_PLUGIN(plug) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    plug->batch_begin = begin;
+    plug->batch_end = end;
+    return LSM_ERR_OK;
+}
+
 static void lsm_plugin_free(lsm_plugin_ptr p, lsm_flag flags)
 {
     if (LSM_IS_PLUGIN(p)) {
@@ -231,7 +291,7 @@ static lsm_plugin_ptr lsm_plugin_alloc(lsm_plugin_register reg,
     return rc;
 }
 
-static void error_send(lsm_plugin_ptr p, int error_code)
+static void error_send(lsm_plugin_ptr p, int error_code, uint32_t id)
 {
     if (!LSM_IS_PLUGIN(p)) {
         return;
@@ -240,22 +300,54 @@ static void error_send(lsm_plugin_ptr p, int error_code)
     if (p->error) {
         if (p->tp) {
             p->tp->errorSend(p->error->code, ss(p->error->message),
-                             ss(p->error->debug));
+                             ss(p->error->debug), id);
             lsm_error_free(p->error);
             p->error = NULL;
         }
     } else {
-        p->tp->errorSend(error_code, "Plugin didn't provide error message", "");
+        p->tp->errorSend(error_code, "Plugin didn't provide error message", "",
+                         id);
     }
 }
 
-static int get_search_params(Value & params, char **k, char **v)
+/**
+ * Gets the search key and value of a list call.
+ * @param params        Request parameters
+ * @param k             Search key, NULL for all
+ * @param v             Search value
+ * @param values        When not NULL, the search value may also be a list
+ *                      of values (IN search), returned here with v NULL
+ * @return LSM_ERR_OK, else error reason
+ */
+static int get_search_params(Value & params, char **k, char **v,
+                             lsm_string_list ** values = NULL)
 {
     int rc = LSM_ERR_OK;
     Value key = params["search_key"];
     Value val = params["search_value"];
 
-    if (Value::string_t == key.valueType()) {
+    if (Value::string_t == key.valueType() &&
+        Value::array_t == val.valueType() && values) {
+        std::vector < Value > &vl = val.asArray();
+        for (size_t i = 0; i < vl.size(); ++i) {
+            if (Value::string_t != vl[i].valueType()) {
+                return LSM_ERR_TRANSPORT_INVALID_ARG;
+            }
+        }
+
+        *k = strdup(key.asC_str());
+        *values = value_to_string_list(val);
+
+        if (*k == NULL || *values == NULL) {
+            free(*k);
+            *k = NULL;
+            if (*values) {
+                lsm_string_list_free(*values);
+                *values = NULL;
+            }
+            rc = LSM_ERR_NO_MEMORY;
+        }
+    } else if (Value::string_t == key.valueType()) {
         if (Value::string_t == val.valueType()) {
             *k = strdup(key.asC_str());
             *v = strdup(val.asC_str());
@@ -277,6 +369,37 @@ static int get_search_params(Value & params, char **k, char **v)
     return rc;
 }
 
+/**
+ * Gets the optional list of fields the client wants back from a list call.
+ * @param params        Request parameters
+ * @param fields        Requested fields
+ * @param all           True when the client wants every field
+ * @return LSM_ERR_OK, else LSM_ERR_TRANSPORT_INVALID_ARG
+ */
+static int get_fields_param(Value & params, std::set < std::string > &fields,
+                            bool & all)
+{
+    Value f = params["fields"];
+
+    all = true;
+    if (Value::null_t == f.valueType()) {
+        return LSM_ERR_OK;
+    }
+    if (Value::array_t != f.valueType()) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    std::vector < Value > &names = f.asArray();
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (Value::string_t != names[i].valueType()) {
+            return LSM_ERR_TRANSPORT_INVALID_ARG;
+        }
+        fields.insert(names[i].asString());
+    }
+    all = false;
+    return LSM_ERR_OK;
+}
+
 /**
  * Checks to see if a character string is an integer and returns result
  * @param[in] sn    Character array holding the integer
@@ -294,6 +417,48 @@ static bool get_num(char *sn, int &num)
     return false;
 }
 
+/**
+ * Plug-in processes lsmd starts ahead of time get a control socket instead of
+ * the client connection, which gets passed over it once a client connects.
+ * @param[in] ctl   Control socket, closed on return
+ * @return Client connection, -1 if lsmd went away instead
+ */
+static int worker_client_wait(int ctl)
+{
+    int fd = -1;
+    char b;
+    ssize_t rc;
+    struct iovec iov;
+    struct msghdr mh;
+    struct cmsghdr *c = NULL;
+    union {
+        struct cmsghdr h;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } cmsg;
+
+    memset(&mh, 0, sizeof(mh));
+    iov.iov_base = &b;
+    iov.iov_len = 1;
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = cmsg.buf;
+    mh.msg_controllen = sizeof(cmsg.buf);
+
+    do {
+        rc = recvmsg(ctl, &mh, 0);
+    } while (rc == -1 && errno == EINTR);
+
+    if (rc == 1) {
+        c = CMSG_FIRSTHDR(&mh);
+        if (c && c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS) {
+            memcpy(&fd, CMSG_DATA(c), sizeof(int));
+        }
+    }
+
+    close(ctl);
+    return fd;
+}
+
 int lsm_plugin_init_v1(int argc, char *argv[], lsm_plugin_register reg,
                        lsm_plugin_unregister unreg,
                        const char *desc, const char *version)
@@ -307,6 +472,15 @@ int lsm_plugin_init_v1(int argc, char *argv[], lsm_plugin_register reg,
 
     int sd = 0;
     if (argc == 2 && get_num(argv[1], sd)) {
+        if (getenv(LSM_PLUGIN_WORKER_ENV)) {
+            unsetenv(LSM_PLUGIN_WORKER_ENV);
+            sd = worker_client_wait(sd);
+            if (sd < 0) {
+                //lsmd shut down or reloaded before handing us a client
+                return 0;
+            }
+        }
+
         plug = lsm_plugin_alloc(reg, unreg, desc, version);
         if (plug) {
             plug->tp = new Ipc(sd);
@@ -493,6 +667,102 @@ static int handle_job_free(lsm_plugin_ptr p, Value & params, Value & response)
     return rc;
 }
 
+/*
+ * "job_wait" checks on the jobs often at first, backing off to once a
+ * second for long running ones.
+ */
+#define JOB_WAIT_POLL_MIN_MS 10
+#define JOB_WAIT_POLL_MAX_MS 1000
+
+static uint64_t monotonic_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * Frees the result a job_status callback returned along with the status.
+ */
+static void job_value_free(lsm_data_type t, void *value)
+{
+    if (LSM_DATA_TYPE_VOLUME == t && LSM_IS_VOL((lsm_volume *) value)) {
+        lsm_volume_record_free((lsm_volume *) value);
+    } else if (LSM_DATA_TYPE_FS == t && LSM_IS_FS((lsm_fs *) value)) {
+        lsm_fs_record_free((lsm_fs *) value);
+    } else if (LSM_DATA_TYPE_SS == t && LSM_IS_SS((lsm_fs_ss *) value)) {
+        lsm_fs_ss_record_free((lsm_fs_ss *) value);
+    } else if (LSM_DATA_TYPE_POOL == t && LSM_IS_POOL((lsm_pool *) value)) {
+        lsm_pool_record_free((lsm_pool *) value);
+    }
+}
+
+static int handle_job_wait(lsm_plugin_ptr p, Value & params, Value & response)
+{
+    int rc = LSM_ERR_NO_SUPPORT;
+
+    if (p && p->mgmt_ops && p->mgmt_ops->job_status) {
+        Value v_ids = params["job_ids"];
+        Value v_timeout = params["timeout"];
+
+        if (Value::array_t != v_ids.valueType() ||
+            v_ids.asArray().empty() ||
+            Value::numeric_t != v_timeout.valueType() ||
+            !LSM_FLAG_EXPECTED_TYPE(params)) {
+            return LSM_ERR_TRANSPORT_INVALID_ARG;
+        }
+
+        std::vector < Value > &ids = v_ids.asArray();
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (Value::string_t != ids[i].valueType()) {
+                return LSM_ERR_TRANSPORT_INVALID_ARG;
+            }
+        }
+
+        lsm_flag flags = LSM_FLAG_GET_VALUE(params);
+        uint64_t deadline = monotonic_ms() + v_timeout.asUint32_t();
+        uint64_t interval = JOB_WAIT_POLL_MIN_MS;
+
+        while (true) {
+            for (size_t i = 0; i < ids.size(); ++i) {
+                lsm_job_status status = LSM_JOB_INPROGRESS;
+                uint8_t percent = 0;
+                lsm_data_type t = LSM_DATA_TYPE_UNKNOWN;
+                void *value = NULL;
+
+                rc = p->mgmt_ops->job_status(p, ids[i].asC_str(), &status,
+                                             &percent, &t, &value, flags);
+                job_value_free(t, value);
+
+                if (LSM_ERR_OK != rc) {
+                    return rc;
+                }
+
+                if (LSM_JOB_INPROGRESS != status) {
+                    std::vector < Value > result;
+                    result.push_back(Value((uint32_t) i));
+                    result.push_back(Value((int32_t) status));
+                    result.push_back(Value(percent));
+                    response = Value(result);
+                    return LSM_ERR_OK;
+                }
+            }
+
+            uint64_t now = monotonic_ms();
+            if (now >= deadline) {
+                return lsm_log_error_basic(p, LSM_ERR_TIMEOUT,
+                                           "Job still in progress");
+            }
+
+            usleep(std::min(interval, deadline - now) * 1000);
+            interval = std::min(interval * 2,
+                                (uint64_t) JOB_WAIT_POLL_MAX_MS);
+        }
+    }
+    return rc;
+}
+
 static int handle_system_list(lsm_plugin_ptr p, Value & params,
                               Value & response)
 {
@@ -507,7 +777,8 @@ static int handle_system_list(lsm_plugin_ptr p, Value & params,
             rc = p->mgmt_ops->system_list(p, &systems, &count,
                                           LSM_FLAG_GET_VALUE(params));
             if (LSM_ERR_OK == rc) {
-                std::vector < Value > result;
+                response = Value(Value::array_t);
+                std::vector < Value > &result = response.asArray();
                 result.reserve(count);
 
                 for (uint32_t i = 0; i < count; ++i) {
@@ -516,7 +787,6 @@ static int handle_system_list(lsm_plugin_ptr p, Value & params,
 
                 lsm_system_record_array_free(systems, count);
                 systems = NULL;
-                response = Value(result);
             }
         } else {
             rc = LSM_ERR_TRANSPORT_INVALID_ARG;
@@ -540,7 +810,8 @@ static int handle_pools(lsm_plugin_ptr p, Value & params, Value & response)
             rc = p->mgmt_ops->pool_list(p, key, val, &pools, &count,
                                         LSM_FLAG_GET_VALUE(params));
             if (LSM_ERR_OK == rc) {
-                std::vector < Value > result;
+                response = Value(Value::array_t);
+                std::vector < Value > &result = response.asArray();
                 result.reserve(count);
 
                 for (uint32_t i = 0; i < count; ++i) {
@@ -549,7 +820,6 @@ static int handle_pools(lsm_plugin_ptr p, Value & params, Value & response)
 
                 lsm_pool_record_array_free(pools, count);
                 pools = NULL;
-                response = Value(result);
             }
             free(key);
             free(val);
@@ -579,7 +849,8 @@ static int handle_target_ports(lsm_plugin_ptr p, Value & params,
                                               &count,
                                               LSM_FLAG_GET_VALUE(params));
             if (LSM_ERR_OK == rc) {
-                std::vector < Value > result;
+                response = Value(Value::array_t);
+                std::vector < Value > &result = response.asArray();
                 result.reserve(count);
 
                 for (uint32_t i = 0; i < count; ++i) {
@@ -588,7 +859,6 @@ static int handle_target_ports(lsm_plugin_ptr p, Value & params,
 
                 lsm_target_port_record_array_free(target_ports, count);
                 target_ports = NULL;
-                response = Value(result);
             }
             free(key);
             free(val);
@@ -632,20 +902,57 @@ static int capabilities(lsm_plugin_ptr p, Value & params, Value & response)
     return rc;
 }
 
+/**
+ * Runs an IN search: the plug-in does it when it provides a callback for
+ * it, else the whole list is fetched and filtered here.
+ */
+template < typename T > static int list_in(lsm_plugin_ptr p, const char *key,
+                                           lsm_string_list * values,
+                                           int (*in) (lsm_plugin_ptr,
+                                                      const char *,
+                                                      lsm_string_list *,
+                                                      T ** [], uint32_t *,
+                                                      lsm_flag),
+                                           int (*list) (lsm_plugin_ptr,
+                                                        const char *,
+                                                        const char *,
+                                                        T ** [], uint32_t *,
+                                                        lsm_flag),
+                                           void (*filter_in) (const char *,
+                                                              lsm_string_list
+                                                              *, T *[],
+                                                              uint32_t *),
+                                           T ** items[], uint32_t * count,
+                                           lsm_flag flags)
+{
+    int rc = LSM_ERR_OK;
+
+    if (in) {
+        return in(p, key, values, items, count, flags);
+    }
+
+    rc = list(p, NULL, NULL, items, count, flags);
+    if (LSM_ERR_OK == rc) {
+        filter_in(key, values, *items, count);
+    }
+    return rc;
+}
+
 static void get_volumes(int rc, lsm_volume ** vols, uint32_t count,
-                        Value & response)
+                        Value & response,
+                        const std::set < std::string > *fields)
 {
     if (LSM_ERR_OK == rc) {
-        std::vector < Value > result;
+        response = Value(Value::array_t);
+        std::vector < Value > &result = response.asArray();
         result.reserve(count);
 
         for (uint32_t i = 0; i < count; ++i) {
-            result.push_back(volume_to_value(vols[i]));
+            result.push_back(volume_to_value(vols[i], fields));
         }
 
         lsm_volume_record_array_free(vols, count);
         vols = NULL;
-        response = Value(result);
     }
 }
 
@@ -654,18 +961,33 @@ static int handle_volumes(lsm_plugin_ptr p, Value & params, Value & response)
     int rc = LSM_ERR_NO_SUPPORT;
     char *key = NULL;
     char *val = NULL;
-
+    lsm_string_list *values = NULL;
+    std::set < std::string > fields;
+    bool all = true;
 
     if (p && p->san_ops && p->san_ops->vol_get) {
         lsm_volume **vols = NULL;
         uint32_t count = 0;
 
         if (LSM_FLAG_EXPECTED_TYPE(params) &&
-            (rc = get_search_params(params, &key, &val)) == LSM_ERR_OK) {
-            rc = p->san_ops->vol_get(p, key, val, &vols, &count,
-                                     LSM_FLAG_GET_VALUE(params));
+            (rc = get_fields_param(params, fields, all)) == LSM_ERR_OK &&
+            (rc = get_search_params(params, &key, &val, &values)) ==
+            LSM_ERR_OK) {
+            if (values) {
+                rc = list_in < lsm_volume > (p, key, values,
+                                             (p->ops_v1_6) ?
+                                             p->ops_v1_6->vol_list_in : NULL,
+                                             p->san_ops->vol_get,
+                                             lsm_plug_volume_search_filter_in,
+                                             &vols, &count,
+                                             LSM_FLAG_GET_VALUE(params));
+                lsm_string_list_free(values);
+            } else {
+                rc = p->san_ops->vol_get(p, key, val, &vols, &count,
+                                         LSM_FLAG_GET_VALUE(params));
+            }
 
-            get_volumes(rc, vols, count, response);
+            get_volumes(rc, vols, count, response, all ? NULL : &fields);
             free(key);
             free(val);
         } else {
@@ -678,19 +1000,20 @@ static int handle_volumes(lsm_plugin_ptr p, Value & params, Value & response)
 }
 
 static void get_disks(int rc, lsm_disk ** disks, uint32_t count,
-                      Value & response)
+                      Value & response,
+                      const std::set < std::string > *fields)
 {
     if (LSM_ERR_OK == rc) {
-        std::vector < Value > result;
+        response = Value(Value::array_t);
+        std::vector < Value > &result = response.asArray();
         result.reserve(count);
 
         for (uint32_t i = 0; i < count; ++i) {
-            result.push_back(disk_to_value(disks[i]));
+            result.push_back(disk_to_value(disks[i], fields));
         }
 
         lsm_disk_record_array_free(disks, count);
         disks = NULL;
-        response = Value(result);
     }
 }
 
@@ -699,16 +1022,32 @@ static int handle_disks(lsm_plugin_ptr p, Value & params, Value & response)
     int rc = LSM_ERR_NO_SUPPORT;
     char *key = NULL;
     char *val = NULL;
+    lsm_string_list *values = NULL;
+    std::set < std::string > fields;
+    bool all = true;
 
     if (p && p->san_ops && p->san_ops->disk_get) {
         lsm_disk **disks = NULL;
         uint32_t count = 0;
 
         if (LSM_FLAG_EXPECTED_TYPE(params) &&
-            (rc = get_search_params(params, &key, &val)) == LSM_ERR_OK) {
-            rc = p->san_ops->disk_get(p, key, val, &disks, &count,
-                                      LSM_FLAG_GET_VALUE(params));
-            get_disks(rc, disks, count, response);
+            (rc = get_fields_param(params, fields, all)) == LSM_ERR_OK &&
+            (rc = get_search_params(params, &key, &val, &values)) ==
+            LSM_ERR_OK) {
+            if (values) {
+                rc = list_in < lsm_disk > (p, key, values,
+                                           (p->ops_v1_6) ?
+                                           p->ops_v1_6->disk_list_in : NULL,
+                                           p->san_ops->disk_get,
+                                           lsm_plug_disk_search_filter_in,
+                                           &disks, &count,
+                                           LSM_FLAG_GET_VALUE(params));
+                lsm_string_list_free(values);
+            } else {
+                rc = p->san_ops->disk_get(p, key, val, &disks, &count,
+                                          LSM_FLAG_GET_VALUE(params));
+            }
+            get_disks(rc, disks, count, response, all ? NULL : &fields);
             free(key);
             free(val);
         } else {
@@ -1114,15 +1453,28 @@ static int ag_list(lsm_plugin_ptr p, Value & params, Value & response)
     char *key = NULL;
     char *val = NULL;
 
+    lsm_string_list *values = NULL;
+
     if (p && p->san_ops && p->san_ops->ag_list) {
 
         if (LSM_FLAG_EXPECTED_TYPE(params) &&
-            (rc = get_search_params(params, &key, &val)) == LSM_ERR_OK) {
+            (rc = get_search_params(params, &key, &val, &values)) ==
+            LSM_ERR_OK) {
             lsm_access_group **groups = NULL;
             uint32_t count;
 
-            rc = p->san_ops->ag_list(p, key, val, &groups, &count,
-                                     LSM_FLAG_GET_VALUE(params));
+            if (values) {
+                rc = list_in < lsm_access_group >
+                    (p, key, values,
+                     (p->ops_v1_6) ? p->ops_v1_6->ag_list_in : NULL,
+                     p->san_ops->ag_list,
+                     lsm_plug_access_group_search_filter_in, &groups, &count,
+                     LSM_FLAG_GET_VALUE(params));
+                lsm_string_list_free(values);
+            } else {
+                rc = p->san_ops->ag_list(p, key, val, &groups, &count,
+                                         LSM_FLAG_GET_VALUE(params));
+            }
             if (LSM_ERR_OK == rc) {
                 response = access_group_list_to_value(groups, count);
 
@@ -1381,13 +1733,13 @@ static int vol_accessible_by_ag(lsm_plugin_ptr p, Value & params,
                                                       (params));
 
                 if (LSM_ERR_OK == rc) {
-                    std::vector < Value > result;
+                    response = Value(Value::array_t);
+                    std::vector < Value > &result = response.asArray();
                     result.reserve(count);
 
                     for (uint32_t i = 0; i < count; ++i) {
                         result.push_back(volume_to_value(vols[i]));
                     }
-                    response = Value(result);
                 }
 
                 lsm_access_group_record_free(ag);
@@ -1425,13 +1777,13 @@ static int ag_granted_to_volume(lsm_plugin_ptr p, Value & params,
                                                    LSM_FLAG_GET_VALUE(params));
 
                 if (LSM_ERR_OK == rc) {
-                    std::vector < Value > result;
+                    response = Value(Value::array_t);
+                    std::vector < Value > &result = response.asArray();
                     result.reserve(count);
 
                     for (uint32_t i = 0; i < count; ++i) {
                         result.push_back(access_group_to_value(groups[i]));
                     }
-                    response = Value(result);
                 }
 
                 lsm_volume_record_free(volume);
@@ -1524,25 +1876,39 @@ static int fs(lsm_plugin_ptr p, Value & params, Value & response)
     char *key = NULL;
     char *val = NULL;
 
+    lsm_string_list *values = NULL;
+
     if (p && p->fs_ops && p->fs_ops->fs_list) {
         if (LSM_FLAG_EXPECTED_TYPE(params) &&
-            ((rc = get_search_params(params, &key, &val)) == LSM_ERR_OK)) {
+            ((rc = get_search_params(params, &key, &val, &values)) ==
+             LSM_ERR_OK)) {
 
             lsm_fs **fs = NULL;
             uint32_t count = 0;
 
-            rc = p->fs_ops->fs_list(p, key, val, &fs, &count,
-                                    LSM_FLAG_GET_VALUE(params));
+            if (values) {
+                rc = list_in < lsm_fs > (p, key, values,
+                                         (p->ops_v1_6) ?
+                                         p->ops_v1_6->fs_list_in : NULL,
+                                         p->fs_ops->fs_list,
+                                         lsm_plug_fs_search_filter_in,
+                                         &fs, &count,
+                                         LSM_FLAG_GET_VALUE(params));
+                lsm_string_list_free(values);
+            } else {
+                rc = p->fs_ops->fs_list(p, key, val, &fs, &count,
+                                        LSM_FLAG_GET_VALUE(params));
+            }
 
             if (LSM_ERR_OK == rc) {
-                std::vector < Value > result;
+                response = Value(Value::array_t);
+                std::vector < Value > &result = response.asArray();
                 result.reserve(count);
 
                 for (uint32_t i = 0; i < count; ++i) {
                     result.push_back(fs_to_value(fs[i]));
                 }
 
-                response = Value(result);
                 lsm_fs_record_array_free(fs, count);
                 fs = NULL;
             }
@@ -1907,13 +2273,13 @@ static int ss_list(lsm_plugin_ptr p, Value & params, Value & response)
                                            LSM_FLAG_GET_VALUE(params));
 
                 if (LSM_ERR_OK == rc) {
-                    std::vector < Value > result;
+                    response = Value(Value::array_t);
+                    std::vector < Value > &result = response.asArray();
                     result.reserve(count);
 
                     for (uint32_t i = 0; i < count; ++i) {
                         result.push_back(ss_to_value(ss[i]));
                     }
-                    response = Value(result);
 
                     lsm_fs_record_free(fs);
                     fs = NULL;
@@ -2101,23 +2467,36 @@ static int exports(lsm_plugin_ptr p, Value & params, Value & response)
     char *key = NULL;
     char *val = NULL;
 
+    lsm_string_list *values = NULL;
+
     if (p && p->nas_ops && p->nas_ops->nfs_list) {
         lsm_nfs_export **exports = NULL;
         uint32_t count = 0;
 
         if (LSM_FLAG_EXPECTED_TYPE(params) &&
-            (rc = get_search_params(params, &key, &val)) == LSM_ERR_OK) {
-            rc = p->nas_ops->nfs_list(p, key, val, &exports, &count,
-                                      LSM_FLAG_GET_VALUE(params));
+            (rc = get_search_params(params, &key, &val, &values)) ==
+            LSM_ERR_OK) {
+            if (values) {
+                rc = list_in < lsm_nfs_export >
+                    (p, key, values,
+                     (p->ops_v1_6) ? p->ops_v1_6->nfs_list_in : NULL,
+                     p->nas_ops->nfs_list,
+                     lsm_plug_nfs_export_search_filter_in, &exports, &count,
+                     LSM_FLAG_GET_VALUE(params));
+                lsm_string_list_free(values);
+            } else {
+                rc = p->nas_ops->nfs_list(p, key, val, &exports, &count,
+                                          LSM_FLAG_GET_VALUE(params));
+            }
 
             if (LSM_ERR_OK == rc) {
-                std::vector < Value > result;
+                response = Value(Value::array_t);
+                std::vector < Value > &result = response.asArray();
                 result.reserve(count);
 
                 for (uint32_t i = 0; i < count; ++i) {
                     result.push_back(nfs_export_to_value(exports[i]));
                 }
-                response = Value(result);
 
                 lsm_nfs_export_record_array_free(exports, count);
                 exports = NULL;
@@ -2449,6 +2828,316 @@ static int handle_system_read_cache_pct_update(lsm_plugin_ptr p, Value & params,
     return rc;
 }
 
+/**
+ * Handles a "*_page" request.  Plug-ins without the page callback get it
+ * done by the framework from the full list, with the offset as cursor; that
+ * still bounds the size of each response.
+ */
+template < typename T > static int list_page(lsm_plugin_ptr p,
+                                             Value & params,
+                                             Value & response,
+                                             int (*page) (lsm_plugin_ptr,
+                                                          const char *,
+                                                          const char *,
+                                                          const char *,
+                                                          uint32_t, T ** [],
+                                                          uint32_t *,
+                                                          char **,
+                                                          lsm_flag),
+                                             int (*list) (lsm_plugin_ptr,
+                                                          const char *,
+                                                          const char *,
+                                                          T ** [],
+                                                          uint32_t *,
+                                                          lsm_flag),
+                                             Value(*to_value) (T *),
+                                             int (*record_free) (T *),
+                                             int (*array_free) (T *[],
+                                                                uint32_t))
+{
+    int rc = LSM_ERR_NO_SUPPORT;
+    char *key = NULL;
+    char *val = NULL;
+    char *next = NULL;
+    T **items = NULL;
+    uint32_t count = 0;
+    Value v_cursor = params["cursor"];
+    Value v_limit = params["limit"];
+
+    if (!page && !list) {
+        return rc;
+    }
+
+    if (!LSM_FLAG_EXPECTED_TYPE(params) ||
+        Value::numeric_t != v_limit.valueType() ||
+        (Value::string_t != v_cursor.valueType() &&
+         Value::null_t != v_cursor.valueType())) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    const char *cursor = (Value::string_t == v_cursor.valueType()) ?
+        v_cursor.asC_str() : NULL;
+    uint32_t limit = v_limit.asUint32_t();
+    lsm_flag flags = LSM_FLAG_GET_VALUE(params);
+
+    if (!limit) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    rc = get_search_params(params, &key, &val);
+    if (LSM_ERR_OK != rc) {
+        return rc;
+    }
+
+    if (page) {
+        rc = page(p, key, val, cursor, limit, &items, &count, &next, flags);
+    } else {
+        char *end = NULL;
+        uint64_t offset = 0;
+
+        if (cursor) {
+            errno = 0;
+            offset = strtoull(cursor, &end, 10);
+            if (errno || !*cursor || *end) {
+                rc = LSM_ERR_INVALID_ARGUMENT;
+                goto out;
+            }
+        }
+
+        rc = list(p, key, val, &items, &count, flags);
+        if (LSM_ERR_OK == rc) {
+            uint32_t i = 0;
+            uint32_t kept = 0;
+
+            //Only keep the requested window of the full list
+            for (i = 0; i < count; ++i) {
+                if (i >= offset && kept < limit) {
+                    items[kept++] = items[i];
+                } else {
+                    record_free(items[i]);
+                }
+                if (i >= kept) {
+                    items[i] = NULL;
+                }
+            }
+
+            if (offset + kept < count) {
+                next = strdup(::to_string(offset + kept).c_str());
+                if (!next) {
+                    rc = LSM_ERR_NO_MEMORY;
+                }
+            }
+            count = kept;
+        }
+    }
+
+    if (LSM_ERR_OK == rc) {
+        std::vector < Value > result;
+        std::vector < Value > values;
+
+        values.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            values.push_back(to_value(items[i]));
+        }
+        result.push_back(Value(values));
+        result.push_back(next ? Value(next) : Value());
+        response = Value(result);
+    }
+
+    if (items) {
+        array_free(items, count);
+    }
+
+  out:
+    free(next);
+    free(key);
+    free(val);
+    return rc;
+}
+
+static int handle_volumes_page(lsm_plugin_ptr p, Value & params,
+                               Value & response)
+{
+    return list_page < lsm_volume > (p, params, response,
+                                     (p->ops_v1_6) ?
+                                     p->ops_v1_6->vol_list_page : NULL,
+                                     (p->san_ops) ? p->san_ops->vol_get : NULL,
+                                     volume_to_value, lsm_volume_record_free,
+                                     lsm_volume_record_array_free);
+}
+
+static int handle_disks_page(lsm_plugin_ptr p, Value & params,
+                             Value & response)
+{
+    return list_page < lsm_disk > (p, params, response,
+                                   (p->ops_v1_6) ?
+                                   p->ops_v1_6->disk_list_page : NULL,
+                                   (p->san_ops) ? p->san_ops->disk_get : NULL,
+                                   disk_to_value, lsm_disk_record_free,
+                                   lsm_disk_record_array_free);
+}
+
+static int handle_access_groups_page(lsm_plugin_ptr p, Value & params,
+                                     Value & response)
+{
+    return list_page < lsm_access_group > (p, params, response,
+                                           (p->ops_v1_6) ?
+                                           p->ops_v1_6->ag_list_page : NULL,
+                                           (p->san_ops) ?
+                                           p->san_ops->ag_list : NULL,
+                                           access_group_to_value,
+                                           lsm_access_group_record_free,
+                                           lsm_access_group_record_array_free);
+}
+
+static int handle_fs_page(lsm_plugin_ptr p, Value & params, Value & response)
+{
+    return list_page < lsm_fs > (p, params, response,
+                                 (p->ops_v1_6) ?
+                                 p->ops_v1_6->fs_list_page : NULL,
+                                 (p->fs_ops) ? p->fs_ops->fs_list : NULL,
+                                 fs_to_value, lsm_fs_record_free,
+                                 lsm_fs_record_array_free);
+}
+
+static int handle_exports_page(lsm_plugin_ptr p, Value & params,
+                               Value & response)
+{
+    return list_page < lsm_nfs_export > (p, params, response,
+                                         (p->ops_v1_6) ?
+                                         p->ops_v1_6->nfs_list_page : NULL,
+                                         (p->nas_ops) ?
+                                         p->nas_ops->nfs_list : NULL,
+                                         nfs_export_to_value,
+                                         lsm_nfs_export_record_free,
+                                         lsm_nfs_export_record_array_free);
+}
+
+static int process_request(lsm_plugin_ptr p, const std::string & method,
+                           Value & request, Value & response);
+
+/**
+ * Result of one request of a batch, in the same form as a response.
+ */
+static Value batch_item_result(lsm_plugin_ptr p, int rc, Value & response)
+{
+    ValueObject item;
+
+    if (LSM_ERR_OK == rc || LSM_ERR_JOB_STARTED == rc) {
+        item["result"] = response;
+    } else {
+        ValueObject error_data;
+
+        if (p->error) {
+            error_data["code"] = Value((int32_t) p->error->code);
+            error_data["message"] = Value(ss(p->error->message));
+            error_data["data"] = Value(ss(p->error->debug));
+            lsm_error_free(p->error);
+            p->error = NULL;
+        } else {
+            error_data["code"] = Value(rc);
+            error_data["message"] =
+                Value("Plugin didn't provide error message");
+            error_data["data"] = Value("");
+        }
+        item["error"] = Value(error_data);
+    }
+    return Value(item);
+}
+
+/**
+ * Runs one request of a batch.  Exceptions fail the request and not the
+ * batch, which has to reach batch_end whatever happens.
+ */
+static int batch_item_run(lsm_plugin_ptr p, Value & request,
+                          Value & response)
+{
+    if (Value::object_t != request.valueType()) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    Value &method = request["method"];
+
+    if (Value::string_t != method.valueType() ||
+        Value::object_t != request["params"].valueType()) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    std::string m = method.asString();
+
+    //Session and nested requests have no place in a batch
+    if (m == "batch" || m == "plugin_register" || m == "plugin_unregister") {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    try {
+        return process_request(p, m, request, response);
+    }
+    catch(const ValueException & ve) {
+        response = Value();
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+    catch(const std::bad_alloc & ba) {
+        response = Value();
+        return LSM_ERR_NO_MEMORY;
+    }
+}
+
+/**
+ * Default "batch" handler, runs the requests one after the other through
+ * the dispatch map.  A request which fails only fails its own item.
+ */
+static int handle_batch(lsm_plugin_ptr p, Value & params, Value & response)
+{
+    int rc = LSM_ERR_OK;
+    Value &v_requests = params["requests"];
+
+    if (Value::array_t != v_requests.valueType() ||
+        !LSM_FLAG_EXPECTED_TYPE(params)) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    lsm_flag flags = LSM_FLAG_GET_VALUE(params);
+
+    if (p->batch_begin) {
+        rc = p->batch_begin(p, flags);
+        if (LSM_ERR_OK != rc) {
+            return rc;
+        }
+    }
+
+    std::vector < Value > &requests = v_requests.asArray();
+    std::vector < Value > results;
+
+    try {
+        results.reserve(requests.size());
+
+        for (size_t i = 0; i < requests.size(); ++i) {
+            Value item_response;
+            int item_rc = batch_item_run(p, requests[i], item_response);
+
+            results.push_back(batch_item_result(p, item_rc, item_response));
+        }
+    }
+    catch( ...) {
+        //Don't leave the plug-in with a batch open
+        if (p->batch_end) {
+            p->batch_end(p, flags);
+        }
+        throw;
+    }
+
+    if (p->batch_end) {
+        rc = p->batch_end(p, flags);
+        if (LSM_ERR_OK != rc) {
+            return rc;
+        }
+    }
+
+    response = Value(results);
+    return rc;
+}
+
 /**
  * map of function pointers
  */
@@ -2458,16 +3147,20 @@ static std::map < std::string, handler > dispatch =
     ("access_group_create", ag_create)
     ("access_group_delete", ag_delete)
     ("access_group_initiator_delete", ag_initiator_del)
+    ("batch", handle_batch)
     ("volume_mask", volume_mask)
     ("access_groups", ag_list)
+    ("access_groups_page", handle_access_groups_page)
     ("volume_unmask", volume_unmask)
     ("access_groups_granted_to_volume", ag_granted_to_volume)
     ("capabilities", capabilities)
     ("disks", handle_disks)
+    ("disks_page", handle_disks_page)
     ("export_auth", export_auth)
     ("export_fs", export_fs)
     ("export_remove", export_remove)
     ("exports", exports)
+    ("exports_page", handle_exports_page)
     ("fs_file_clone", fs_file_clone)
     ("fs_child_dependency", fs_child_dependency)
     ("fs_child_dependency_rm", fs_child_dependency_rm)
@@ -2475,6 +3168,7 @@ static std::map < std::string, handler > dispatch =
     ("fs_create", fs_create)
     ("fs_delete", fs_delete)
     ("fs", fs)
+    ("fs_page", handle_fs_page)
     ("fs_resize", fs_resize)
     ("fs_snapshot_create", ss_create)
     ("fs_snapshot_delete", ss_delete)
@@ -2484,6 +3178,7 @@ static std::map < std::string, handler > dispatch =
     ("iscsi_chap_auth", iscsi_chap)
     ("job_free", handle_job_free)
     ("job_status", handle_job_status)
+    ("job_wait", handle_job_wait)
     ("plugin_info", handle_plugin_info)
     ("pools", handle_pools)
     ("target_ports", handle_target_ports)
@@ -2504,6 +3199,7 @@ static std::map < std::string, handler > dispatch =
     ("volume_resize", handle_volume_resize)
     ("volumes_accessible_by_access_group", vol_accessible_by_ag)
     ("volumes", handle_volumes)
+    ("volumes_page", handle_volumes_page)
     ("volume_raid_info", handle_volume_raid_info)
     ("pool_member_info", handle_pool_member_info)
     ("volume_raid_create", handle_volume_raid_create)
@@ -2526,8 +3222,10 @@ static int process_request(lsm_plugin_ptr p, const std::string & method,
 
     response = Value();         //Default response will be null
 
-    if (dispatch.find(method) != dispatch.end()) {
-        rc = (dispatch[method]) (p, request["params"], response);
+    //Looked up without operator[] as handler threads share the map
+    std::map < std::string, handler >::const_iterator h = dispatch.find(method);
+    if (h != dispatch.end()) {
+        rc = (h->second) (p, request["params"], response);
     } else {
         rc = LSM_ERR_NO_SUPPORT;
     }
@@ -2535,12 +3233,170 @@ static int process_request(lsm_plugin_ptr p, const std::string & method,
     return rc;
 }
 
+/**
+ * Id of a request, echoed in its response.
+ */
+static uint32_t request_id(Value & req)
+{
+    Value id = req.getValue("id");
+    if (Value::numeric_t == id.valueType()) {
+        return id.asUint32_t();
+    }
+    return 100;
+}
+
+/**
+ * Runs a request and sends its response.
+ * @param p     Plug-in
+ * @param req   Request, a valid one
+ * @return Result of the request handler
+ */
+static int request_run(lsm_plugin_ptr p, Value & req)
+{
+    Value resp;
+    std::string method = req["method"].asString();
+    int rc = process_request(p, method, req, resp);
+
+    //The offer sits next to params, where runners which predate it
+    //don't look
+    if (method == "plugin_register" && LSM_ERR_OK == rc) {
+        resp = p->tp->protocolSelect(req.getValue("protocol"));
+    }
+
+    if (LSM_ERR_OK == rc || LSM_ERR_JOB_STARTED == rc) {
+        p->tp->responseSend(resp, request_id(req));
+    } else {
+        error_send(p, rc, request_id(req));
+    }
+    return rc;
+}
+
+/**
+ * Requests queued for the handler threads of a plug-in which opted in with
+ * lsm_plugin_thread_count_set().
+ */
+struct LSM_DLL_LOCAL request_queue {
+    lsm_plugin_ptr p;
+    pthread_mutex_t lock;
+    pthread_cond_t work;        //Request queued or stopping
+    pthread_cond_t done;        //Request completed
+    std::deque<Value> requests;
+    uint32_t busy;              //Requests being handled
+    bool stop;
+    std::vector<pthread_t> threads;
+};
+
+static void *request_thread(void *arg)
+{
+    request_queue *q = (request_queue *) arg;
+
+    /* Own copy of the plug-in so errors logged by a handler stay with its
+     * request, everything else is shared. */
+    struct _lsm_plugin tp = *q->p;
+    tp.error = NULL;
+
+    pthread_mutex_lock(&q->lock);
+    while (true) {
+        while (q->requests.empty() && !q->stop) {
+            pthread_cond_wait(&q->work, &q->lock);
+        }
+
+        //Drain what is queued before stopping
+        if (q->requests.empty()) {
+            break;
+        }
+
+        Value req;
+        req.swap(q->requests.front());
+        q->requests.pop_front();
+        q->busy++;
+        pthread_mutex_unlock(&q->lock);
+
+        try {
+            request_run(&tp, req);
+        }
+        catch(const std::exception & e) {
+            syslog(LOG_USER | LOG_NOTICE, "Plug-in exception: %s", e.what());
+        }
+        catch( ...) {
+            syslog(LOG_USER | LOG_NOTICE, "Plug-in un-handled exception");
+        }
+
+        pthread_mutex_lock(&q->lock);
+        q->busy--;
+        pthread_cond_broadcast(&q->done);
+    }
+    pthread_mutex_unlock(&q->lock);
+
+    lsm_error_free(tp.error);
+    return NULL;
+}
+
+static void request_queue_start(request_queue & q, lsm_plugin_ptr p)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < p->thread_count; ++i) {
+        pthread_t t;
+        if (pthread_create(&t, NULL, request_thread, &q)) {
+            syslog(LOG_USER | LOG_NOTICE, "Unable to start request handler "
+                   "thread: %s", strerror(errno));
+            break;
+        }
+        q.threads.push_back(t);
+    }
+}
+
+static void request_queue_add(request_queue & q, Value & req)
+{
+    pthread_mutex_lock(&q.lock);
+    q.requests.push_back(Value());
+    q.requests.back().swap(req);
+    pthread_cond_signal(&q.work);
+    pthread_mutex_unlock(&q.lock);
+}
+
+/**
+ * Waits for every queued request to be handled.
+ */
+static void request_queue_drain(request_queue & q)
+{
+    pthread_mutex_lock(&q.lock);
+    while (!q.requests.empty() || q.busy) {
+        pthread_cond_wait(&q.done, &q.lock);
+    }
+    pthread_mutex_unlock(&q.lock);
+}
+
+static void request_queue_stop(request_queue & q)
+{
+    size_t i = 0;
+
+    pthread_mutex_lock(&q.lock);
+    q.stop = true;
+    pthread_cond_broadcast(&q.work);
+    pthread_mutex_unlock(&q.lock);
+
+    for (i = 0; i < q.threads.size(); ++i) {
+        pthread_join(q.threads[i], NULL);
+    }
+    q.threads.clear();
+}
+
 static int lsm_plugin_run(lsm_plugin_ptr p)
 {
     int rc = 0;
     lsm_flag flags = 0;
+    request_queue q;
 
     if (LSM_IS_PLUGIN(p)) {
+        q.p = p;
+        q.busy = 0;
+        q.stop = false;
+        pthread_mutex_init(&q.lock, NULL);
+        pthread_cond_init(&q.work, NULL);
+        pthread_cond_init(&q.done, NULL);
+
         while (true) {
             try {
 
@@ -2551,22 +3407,30 @@ static int lsm_plugin_run(lsm_plugin_ptr p)
                 }
 
                 Value req = p->tp->readRequest();
-                Value resp;
 
                 if (req.isValidRequest()) {
                     std::string method = req["method"].asString();
-                    rc = process_request(p, method, req, resp);
-
-                    if (LSM_ERR_OK == rc || LSM_ERR_JOB_STARTED == rc) {
-                        p->tp->responseSend(resp);
-                    } else {
-                        error_send(p, rc);
-                    }
 
                     if (method == "plugin_unregister") {
+                        //Everything sent before it completes first
+                        request_queue_drain(q);
+                        rc = request_run(p, req);
                         flags = LSM_FLAG_GET_VALUE(req["params"]);
                         break;
                     }
+
+                    if (!q.threads.empty()) {
+                        request_queue_add(q, req);
+                        continue;
+                    }
+
+                    rc = request_run(p, req);
+
+                    //The register callback is where a plug-in opts in
+                    if (method == "plugin_register" && LSM_ERR_OK == rc &&
+                        p->thread_count) {
+                        request_queue_start(q, p);
+                    }
                 } else {
                     syslog(LOG_USER | LOG_NOTICE, "Invalid request");
                     break;
@@ -2593,6 +3457,12 @@ static int lsm_plugin_run(lsm_plugin_ptr p)
                 break;
             }
         }
+
+        request_queue_stop(q);
+        pthread_cond_destroy(&q.done);
+        pthread_cond_destroy(&q.work);
+        pthread_mutex_destroy(&q.lock);
+
         lsm_plugin_free(p, flags);
         p = NULL;
     } else {
@@ -2762,6 +3632,69 @@ static int filter(void *a[], size_t size, array_cmp cmp, void *cmp_data,
     return remaining;
 }
 
+/*
+ * Search values of an IN search.  Records are looked up in a hash table of
+ * the values instead of being compared against each one of them.
+ */
+struct LSM_DLL_LOCAL search_set {
+    lsm_hash *set;              /* NULL if it could not be allocated */
+    lsm_string_list *values;
+};
+
+static int search_set_has(struct search_set *s, const char *value)
+{
+    uint32_t i = 0;
+
+    if (!value) {
+        return 0;
+    }
+
+    if (s->set) {
+        return lsm_hash_string_get(s->set, value) != NULL;
+    }
+
+    for (i = 0; i < lsm_string_list_size(s->values); ++i) {
+        if (strcmp(lsm_string_list_elem_get(s->values, i), value) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#define CMP_IN_FUNCTION(name, method, method_type)              \
+static int name(void *i, void *d)                               \
+{                                                               \
+    return search_set_has((struct search_set *)d,               \
+                          method((method_type *)i));            \
+}                                                               \
+
+static int filter_in(void *a[], size_t size, array_cmp cmp,
+                     lsm_string_list * values, free_item fo)
+{
+    struct search_set s;
+    uint32_t i = 0;
+    int remaining = 0;
+
+    s.values = values;
+    s.set = lsm_hash_alloc();
+
+    for (i = 0; s.set && i < lsm_string_list_size(values); ++i) {
+        if (lsm_hash_string_set(s.set, lsm_string_list_elem_get(values, i),
+                                "") != LSM_ERR_OK) {
+            /* Fall back to comparing against the list */
+            lsm_hash_free(s.set);
+            s.set = NULL;
+        }
+    }
+
+    remaining = filter(a, size, cmp, &s, fo);
+
+    if (s.set) {
+        lsm_hash_free(s.set);
+    }
+    return remaining;
+}
+
 CMP_FUNCTION(volume_compare_id, lsm_volume_id_get, lsm_volume)
     CMP_FUNCTION(volume_compare_system, lsm_volume_system_id_get, lsm_volume)
     CMP_FUNCTION(volume_compare_pool, lsm_volume_pool_id_get, lsm_volume)
@@ -2791,6 +3724,33 @@ void lsm_plug_volume_search_filter(const char *search_key,
     }
 }
 
+CMP_IN_FUNCTION(volume_in_id, lsm_volume_id_get, lsm_volume)
+CMP_IN_FUNCTION(volume_in_system_id, lsm_volume_system_id_get, lsm_volume)
+CMP_IN_FUNCTION(volume_in_pool_id, lsm_volume_pool_id_get, lsm_volume)
+
+void lsm_plug_volume_search_filter_in(const char *search_key,
+                                      lsm_string_list * search_values,
+                                      lsm_volume * vols[], uint32_t * count)
+{
+    array_cmp cmp = NULL;
+
+    if (search_key && search_values) {
+
+        if (0 == strcmp("id", search_key)) {
+            cmp = volume_in_id;
+        } else if (0 == strcmp("system_id", search_key)) {
+            cmp = volume_in_system_id;
+        } else if (0 == strcmp("pool_id", search_key)) {
+            cmp = volume_in_pool_id;
+        }
+
+        if (cmp) {
+            *count = filter_in((void **) vols, *count, cmp, search_values,
+                               volume_free);
+        }
+    }
+}
+
 CMP_FUNCTION(pool_compare_id, lsm_pool_id_get, lsm_pool)
     CMP_FUNCTION(pool_compare_system, lsm_pool_system_id_get, lsm_pool)
 CMP_FREE_FUNCTION(pool_free, lsm_pool_record_free, lsm_pool);
@@ -2843,6 +3803,30 @@ void lsm_plug_disk_search_filter(const char *search_key,
     }
 }
 
+CMP_IN_FUNCTION(disk_in_id, lsm_disk_id_get, lsm_disk)
+CMP_IN_FUNCTION(disk_in_system_id, lsm_disk_system_id_get, lsm_disk)
+
+void lsm_plug_disk_search_filter_in(const char *search_key,
+                                    lsm_string_list * search_values,
+                                    lsm_disk * disks[], uint32_t * count)
+{
+    array_cmp cmp = NULL;
+
+    if (search_key && search_values) {
+
+        if (0 == strcmp("id", search_key)) {
+            cmp = disk_in_id;
+        } else if (0 == strcmp("system_id", search_key)) {
+            cmp = disk_in_system_id;
+        }
+
+        if (cmp) {
+            *count = filter_in((void **) disks, *count, cmp, search_values,
+                               disk_free);
+        }
+    }
+}
+
 CMP_FUNCTION(access_group_compare_id, lsm_access_group_id_get, lsm_access_group)
     CMP_FUNCTION(access_group_compare_system, lsm_access_group_system_id_get,
              lsm_access_group)
@@ -2872,6 +3856,32 @@ void lsm_plug_access_group_search_filter(const char *search_key,
     }
 }
 
+CMP_IN_FUNCTION(access_group_in_id, lsm_access_group_id_get, lsm_access_group)
+CMP_IN_FUNCTION(access_group_in_system_id, lsm_access_group_system_id_get,
+                lsm_access_group)
+
+void lsm_plug_access_group_search_filter_in(const char *search_key,
+                                            lsm_string_list * search_values,
+                                            lsm_access_group * ag[],
+                                            uint32_t * count)
+{
+    array_cmp cmp = NULL;
+
+    if (search_key && search_values) {
+
+        if (0 == strcmp("id", search_key)) {
+            cmp = access_group_in_id;
+        } else if (0 == strcmp("system_id", search_key)) {
+            cmp = access_group_in_system_id;
+        }
+
+        if (cmp) {
+            *count = filter_in((void **) ag, *count, cmp, search_values,
+                               access_group_free);
+        }
+    }
+}
+
 CMP_FUNCTION(fs_compare_id, lsm_fs_id_get, lsm_fs)
     CMP_FUNCTION(fs_compare_system, lsm_fs_system_id_get, lsm_fs)
 CMP_FREE_FUNCTION(fs_free, lsm_fs_record_free, lsm_fs);
@@ -2898,6 +3908,30 @@ void lsm_plug_fs_search_filter(const char *search_key,
     }
 }
 
+CMP_IN_FUNCTION(fs_in_id, lsm_fs_id_get, lsm_fs)
+CMP_IN_FUNCTION(fs_in_system_id, lsm_fs_system_id_get, lsm_fs)
+
+void lsm_plug_fs_search_filter_in(const char *search_key,
+                                  lsm_string_list * search_values,
+                                  lsm_fs * fs[], uint32_t * count)
+{
+    array_cmp cmp = NULL;
+
+    if (search_key && search_values) {
+
+        if (0 == strcmp("id", search_key)) {
+            cmp = fs_in_id;
+        } else if (0 == strcmp("system_id", search_key)) {
+            cmp = fs_in_system_id;
+        }
+
+        if (cmp) {
+            *count = filter_in((void **) fs, *count, cmp, search_values,
+                               fs_free);
+        }
+    }
+}
+
 CMP_FUNCTION(nfs_compare_id, lsm_nfs_export_id_get, lsm_nfs_export)
     CMP_FUNCTION(nfs_compare_fs_id, lsm_nfs_export_fs_id_get, lsm_nfs_export)
 CMP_FREE_FUNCTION(nfs_free, lsm_nfs_export_record_free, lsm_nfs_export)
@@ -2925,6 +3959,31 @@ void lsm_plug_nfs_export_search_filter(const char *search_key,
     }
 }
 
+CMP_IN_FUNCTION(nfs_in_id, lsm_nfs_export_id_get, lsm_nfs_export)
+CMP_IN_FUNCTION(nfs_in_fs_id, lsm_nfs_export_fs_id_get, lsm_nfs_export)
+
+void lsm_plug_nfs_export_search_filter_in(const char *search_key,
+                                          lsm_string_list * search_values,
+                                          lsm_nfs_export * exports[],
+                                          uint32_t * count)
+{
+    array_cmp cmp = NULL;
+
+    if (search_key && search_values) {
+
+        if (0 == strcmp("id", search_key)) {
+            cmp = nfs_in_id;
+        } else if (0 == strcmp("fs_id", search_key)) {
+            cmp = nfs_in_fs_id;
+        }
+
+        if (cmp) {
+            *count = filter_in((void **) exports, *count, cmp, search_values,
+                               nfs_free);
+        }
+    }
+}
+
 CMP_FUNCTION(tp_compare_id, lsm_target_port_id_get, lsm_target_port)
     CMP_FUNCTION(tp_compare_system_id, lsm_target_port_system_id_get,
              lsm_target_port)
@@ -2959,7 +4018,8 @@ static void get_batteries(int rc, lsm_battery *bs[], uint32_t count,
     uint32_t i = 0;
 
     if (LSM_ERR_OK == rc) {
-        std::vector < Value > result;
+        response = Value(Value::array_t);
+        std::vector < Value > &result = response.asArray();
         result.reserve(count);
 
         for (; i < count; ++i)
@@ -2967,7 +4027,6 @@ static void get_batteries(int rc, lsm_battery *bs[], uint32_t count,
 
         lsm_battery_record_array_free(bs, count);
         bs = NULL;
-        response = Value(result);
     }
 }
 
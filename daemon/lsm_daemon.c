@@ -38,6 +38,8 @@
 #include <sys/queue.h>
 #include <sys/wait.h>
 #include <sys/time.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
 #include <libgen.h>
 #include <assert.h>
 #include <grp.h>
@@ -53,6 +55,12 @@
 #define LSMD_CONF_FILE "lsmd.conf"
 #define LSM_CONF_ALLOW_ROOT_OPT_NAME "allow-plugin-root-privilege"
 #define LSM_CONF_REQUIRE_ROOT_OPT_NAME "require-root-privilege"
+#define LSM_CONF_POOL_SIZE_OPT_NAME "plugin-pool-size"
+#define LSM_PCONF_POOL_SIZE_OPT_NAME "pool-size"
+#define LSM_POOL_SIZE_MAX 32
+#define LSM_PLUGIN_WORKER_ENV "LSM_PLUGIN_WORKER"
+#define EPOLL_MAX_EVENTS 32
+#define WORKER_RETRY_MS 1000
 
 #define min(a,b) \
    ({ __typeof__ (a) _a = (a); \
@@ -82,6 +90,19 @@ int plugin_mem_debug = 0;
 
 int allow_root_plugin = 0;
 int has_root_plugin = 0;
+int pool_size = 0;
+
+int signal_fd = -1;
+sigset_t signal_mask;
+
+/**
+ * A pre-started plug-in process waiting to be handed a client connection
+ */
+struct worker {
+    pid_t pid;
+    int fd;                     /* Our end of the worker's control socket */
+    LIST_ENTRY(worker) pointers;
+};
 
 /**
  * Each item in plugin list contains this information
@@ -90,6 +111,9 @@ struct plugin {
     char *file_path;
     int require_root;
     int fd;
+    int pool_size;              /* Number of idle workers to keep */
+    int idle;                   /* Number of idle workers in workers */
+    LIST_HEAD(worker_list, worker) workers;
     LIST_ENTRY(plugin) pointers;
 };
 
@@ -136,29 +160,27 @@ void logger(int severity, const char *fmt, ...)
 #define info(fmt, ...)  logger(LOG_INFO, fmt, ##__VA_ARGS__)
 
 /**
- * Our signal handler.
- * @param s     Received signal
- */
-void signal_handler(int s)
-{
-    if (SIGTERM == s) {
-        serve_state = EXIT;
-    } else if (SIGHUP == s) {
-        serve_state = RESTART;
-    }
-}
-
-/**
- * Installs our signal handler
+ * Blocks the signals we handle and creates a signalfd for the event loop to
+ * receive them on instead.
  */
 void install_sh(void)
 {
-    if (signal(SIGTERM, signal_handler) == SIG_ERR) {
-        log_and_exit("Can't catch signal SIGTERM\n");
+    int err = 0;
+
+    sigemptyset(&signal_mask);
+    sigaddset(&signal_mask, SIGTERM);
+    sigaddset(&signal_mask, SIGHUP);
+    sigaddset(&signal_mask, SIGCHLD);
+
+    if (-1 == sigprocmask(SIG_BLOCK, &signal_mask, NULL)) {
+        err = errno;
+        log_and_exit("Can't block signals: %s\n", strerror(err));
     }
 
-    if (signal(SIGHUP, signal_handler) == SIG_ERR) {
-        log_and_exit("Can't catch signal SIGHUP\n");
+    signal_fd = signalfd(-1, &signal_mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (-1 == signal_fd) {
+        err = errno;
+        log_and_exit("Can't create signalfd: %s\n", strerror(err));
     }
 }
 
@@ -386,7 +408,7 @@ int setup_socket(char *full_name)
                          strerror(err));
         }
 
-        if (-1 == listen(fd, 5)) {
+        if (-1 == listen(fd, SOMAXCONN)) {
             err = errno;
             log_and_exit("Error on listening %s: %s\n", socket_file,
                          strerror(err));
@@ -421,6 +443,14 @@ void empty_plugin_list(struct plugin_list *list)
                  item->file_path, strerror(err));
         }
 
+        /* Idle workers exit once their control socket is closed */
+        while (!LIST_EMPTY(&item->workers)) {
+            struct worker *w = LIST_FIRST(&item->workers);
+            LIST_REMOVE(w, pointers);
+            close(w->fd);
+            free(w);
+        }
+
         free(item->file_path);
         item->file_path = NULL;
         item->fd = INT_MAX;
@@ -428,8 +458,26 @@ void empty_plugin_list(struct plugin_list *list)
     }
 }
 
+/* Call back signature for looking up a config value */
+typedef void (*conf_lookup) (config_t * cfg, const char *key_name,
+                             int *value);
+
+void lookup_bool(config_t * cfg, const char *key_name, int *value)
+{
+    config_lookup_bool(cfg, key_name, value);
+}
+
+void lookup_int(config_t * cfg, const char *key_name, int *value)
+{
+    /* config_lookup_int() takes a long * before libconfig 1.4 */
+    config_setting_t *setting = config_lookup(cfg, key_name);
+    if (setting && config_setting_type(setting) == CONFIG_TYPE_INT) {
+        *value = config_setting_get_int(setting);
+    }
+}
+
 /**
- * Parse config and seeking provided key name bool
+ * Parse config and seeking provided key name
  *  1. Keep value untouched if file not exist
  *  2. If file is not readable, abort via log_and_exit()
  *  3. Keep value untouched if provided key not found
@@ -437,9 +485,10 @@ void empty_plugin_list(struct plugin_list *list)
  * @param conf_path     config file path
  * @param key_name      string, searching key
  * @param value         int, output, value of this config key
+ * @param lookup        Call back which looks up a key of the expected type
  */
-
-void parse_conf_bool(const char *conf_path, const char *key_name, int *value)
+void parse_conf(const char *conf_path, const char *key_name, int *value,
+                conf_lookup lookup)
 {
     if (access(conf_path, F_OK) == -1) {
         /* file not exist. */
@@ -449,7 +498,7 @@ void parse_conf_bool(const char *conf_path, const char *key_name, int *value)
     if (cfg) {
         config_init(cfg);
         if (CONFIG_TRUE == config_read_file(cfg, conf_path)) {
-            config_lookup_bool(cfg, key_name, value);
+            lookup(cfg, key_name, value);
         } else {
             log_and_exit("configure %s parsing failed: %s at line %d\n",
                          conf_path, config_error_text(cfg),
@@ -465,15 +514,35 @@ void parse_conf_bool(const char *conf_path, const char *key_name, int *value)
 }
 
 /**
- * Load plugin config for root privilege setting.
- * If config not found, return 0 for no root privilege required.
- * @param plugin_path Full path of plugin
- * @return 1 for require root privilege, 0 or not.
+ * Parse config and seeking provided key name bool, see parse_conf().
+ * @param conf_path     config file path
+ * @param key_name      string, searching key
+ * @param value         int, output, value of this config key
  */
+void parse_conf_bool(const char *conf_path, const char *key_name, int *value)
+{
+    parse_conf(conf_path, key_name, value, lookup_bool);
+}
 
-int chk_pconf_root_pri(char *plugin_path)
+/**
+ * Parse config and seeking provided key name integer, see parse_conf().
+ * @param conf_path     config file path
+ * @param key_name      string, searching key
+ * @param value         int, output, value of this config key
+ */
+void parse_conf_int(const char *conf_path, const char *key_name, int *value)
 {
-    int require_root = 0;
+    parse_conf(conf_path, key_name, value, lookup_int);
+}
+
+/**
+ * Forms the path of a plugin's config file.
+ * @param plugin_path Full path of plugin
+ * @return Config file path, caller must call free when done
+ */
+char *plugin_conf_path(char *plugin_path)
+{
+    char *rc = NULL;
     char *base_name = basename(plugin_path);
     ssize_t plugin_name_len = strlen(base_name) - strlen(plugin_extension);
     if (plugin_name_len <= 0) {
@@ -491,25 +560,62 @@ int chk_pconf_root_pri(char *plugin_path)
         char *plugin_conf_dir_path = path_form(conf_dir,
                                                LSM_PLUGIN_CONF_DIR_NAME);
 
-        char *plugin_conf_path = path_form(plugin_conf_dir_path,
-                                           plugin_conf_filename);
-        parse_conf_bool(plugin_conf_path, LSM_CONF_REQUIRE_ROOT_OPT_NAME,
-                        &require_root);
-
-        if (require_root == 1 && allow_root_plugin == 0) {
-            warn("Plugin %s require root privilege while %s disable globally\n",
-                 base_name, LSMD_CONF_FILE);
-        }
+        rc = path_form(plugin_conf_dir_path, plugin_conf_filename);
         free(plugin_conf_dir_path);
         free(plugin_conf_filename);
-        free(plugin_conf_path);
     } else {
         log_and_exit("malloc failure while trying to allocate %d "
                      "bytes\n", conf_file_name_len);
     }
+    return rc;
+}
+
+/**
+ * Load plugin config for root privilege setting.
+ * If config not found, return 0 for no root privilege required.
+ * @param plugin_path Full path of plugin
+ * @return 1 for require root privilege, 0 or not.
+ */
+
+int chk_pconf_root_pri(char *plugin_path)
+{
+    int require_root = 0;
+    char *plugin_conf_path_str = plugin_conf_path(plugin_path);
+
+    parse_conf_bool(plugin_conf_path_str, LSM_CONF_REQUIRE_ROOT_OPT_NAME,
+                    &require_root);
+
+    if (require_root == 1 && allow_root_plugin == 0) {
+        warn("Plugin %s require root privilege while %s disable globally\n",
+             basename(plugin_path), LSMD_CONF_FILE);
+    }
+    free(plugin_conf_path_str);
     return require_root;
 }
 
+/**
+ * Load plugin config for the number of pre-started plug-in processes, the
+ * plugin config overrides the lsmd.conf setting.
+ * @param plugin_path Full path of plugin
+ * @return Pool size, 0 for none.
+ */
+int chk_pconf_pool_size(char *plugin_path)
+{
+    int size = pool_size;
+    char *plugin_conf_path_str = plugin_conf_path(plugin_path);
+
+    parse_conf_int(plugin_conf_path_str, LSM_PCONF_POOL_SIZE_OPT_NAME, &size);
+    free(plugin_conf_path_str);
+
+    if (size < 0 || size > LSM_POOL_SIZE_MAX) {
+        warn("Plugin %s %s %d out of range, using %d\n",
+             basename(plugin_path), LSM_PCONF_POOL_SIZE_OPT_NAME, size,
+             min(max(size, 0), LSM_POOL_SIZE_MAX));
+        size = min(max(size, 0), LSM_POOL_SIZE_MAX);
+    }
+    return size;
+}
+
 /**
  * Call back for plug-in processing.
  * @param p             Private data
@@ -531,6 +637,8 @@ int process_plugin(void *p, char *full_name)
                     item->file_path = strdup(full_name);
                     item->fd = setup_socket(full_name);
                     item->require_root = chk_pconf_root_pri(full_name);
+                    item->pool_size = chk_pconf_pool_size(full_name);
+                    LIST_INIT(&item->workers);
                     has_root_plugin |= item->require_root;
 
                     if (item->file_path && item->fd >= 0) {
@@ -553,39 +661,6 @@ int process_plugin(void *p, char *full_name)
     return 0;
 }
 
-/**
- * Cleans up any children that have exited.
- */
-void child_cleanup(void)
-{
-    int rc;
-    int err;
-
-    do {
-        siginfo_t si;
-        memset(&si, 0, sizeof(siginfo_t));
-
-        rc = waitid(P_ALL, 0, &si, WNOHANG | WEXITED);
-
-        if (-1 == rc) {
-            err = errno;
-            if (err != ECHILD) {
-                info("waitid %d - %s\n", err, strerror(err));
-            }
-            break;
-        } else {
-            if (0 == rc && si.si_pid == 0) {
-                break;
-            } else {
-                if (si.si_code == CLD_EXITED && si.si_status != 0) {
-                    info("Plug-in process %d exited with %d\n", si.si_pid,
-                         si.si_status);
-                }
-            }
-        }
-    } while (1);
-}
-
 /**
  * Closes and frees memory and removes Unix domain sockets.
  */
@@ -613,19 +688,107 @@ int process_plugins(void)
 }
 
 /**
- * Given a socket descriptor looks it up and returns the plug-in
- * @param fd        Socket descriptor to lookup
- * @return struct plugin
+ * Works out whether a plug-in process serving a client can keep our root
+ * privilege, logging why not where it matters.
+ * @param plugin        Full filename and path of plug-in
+ * @param client_fd     Client connected file descriptor
+ * @param require_root  int, indicate whether this plugin require root
+ *                      privilege or not
+ * @return 1 if privileges are to be kept, 0 if they are to be dropped
  */
-struct plugin *plugin_lookup(int fd)
+int plugin_keeps_privilege(char *plugin, int client_fd, int require_root)
 {
-    struct plugin *plug = NULL;
-    LIST_FOREACH(plug, &head, pointers) {
-        if (plug->fd == fd) {
-            return plug;
+    struct ucred cli_user_cred;
+    socklen_t cli_user_cred_len = sizeof(cli_user_cred);
+
+    /*
+     * The plugin will still run no matter with root privilege or not.
+     * so that client could get detailed error message.
+     */
+    if (require_root == 0) {
+        return 0;
+    }
+
+    if (getuid()) {
+        warn("Plugin %s require root privilege, but lsmd daemon "
+             "is not run as root user\n", plugin);
+        return 1;
+    }
+
+    if (allow_root_plugin == 0) {
+        warn("Plugin %s require root privilege, but %s disabled "
+             "it globally\n", plugin, LSMD_CONF_FILE);
+        return 0;
+    }
+
+    /* Check socket client uid */
+    int rc_get_cli_uid = getsockopt(client_fd, SOL_SOCKET, SO_PEERCRED,
+                                    &cli_user_cred, &cli_user_cred_len);
+    if (0 == rc_get_cli_uid) {
+        if (cli_user_cred.uid != 0) {
+            warn("Plugin %s require root privilege, but "
+                 "client is not run as root user\n", plugin);
+            return 0;
         }
+        info("Plugin %s is running as root privilege\n", plugin);
+        return 1;
+    }
+
+    warn("Failed to get client socket uid, getsockopt() "
+         "error: %d\n", errno);
+    return 0;
+}
+
+/**
+ * Exec's the plug-in, called in the forked child.  Does not return.
+ * @param plugin        Full filename and path of plug-in to exec.
+ * @param fd            File descriptor handed to the plug-in
+ */
+void plugin_exec(char *plugin, int fd)
+{
+    int err = 0;
+    int exec_rc = 0;
+    char fd_str[12];
+    const char *plugin_argv[7];
+    extern char **environ;
+
+    /* Make copy of plug-in string as once we call empty_plugin_list it
+     * will be deleted :-) */
+    char *p_copy = strdup(plugin);
+
+    empty_plugin_list(&head);
+    sprintf(fd_str, "%d", fd);
+
+    /* The signal mask survives execve, give the plug-in the default one */
+    sigprocmask(SIG_UNBLOCK, &signal_mask, NULL);
+
+    if (plugin_mem_debug) {
+        char debug_out[64];
+        snprintf(debug_out, (sizeof(debug_out) - 1),
+                 "--log-file=/tmp/leaking_%d-%d", getppid(), getpid());
+
+        plugin_argv[0] = "valgrind";
+        plugin_argv[1] = "--leak-check=full";
+        plugin_argv[2] = "--show-reachable=no";
+        plugin_argv[3] = debug_out;
+        plugin_argv[4] = p_copy;
+        plugin_argv[5] = fd_str;
+        plugin_argv[6] = NULL;
+
+        exec_rc = execve("/usr/bin/valgrind", (char * const*) plugin_argv,
+                         environ);
+    } else {
+        plugin_argv[0] = basename(p_copy);
+        plugin_argv[1] = fd_str;
+        plugin_argv[2] = NULL;
+        exec_rc = execve(p_copy, (char * const*) plugin_argv, environ);
+    }
+
+    if (-1 == exec_rc) {
+        err = errno;
+        log_and_exit("Error on exec'ing Plugin %s: %s\n",
+                     p_copy, strerror(err));
     }
-    return NULL;
 }
 
 /**
@@ -653,84 +816,284 @@ void exec_plugin(char *plugin, int client_fd, int require_root)
 
     } else {
         /* Child */
-        int exec_rc = 0;
-        char fd_str[12];
-        const char *plugin_argv[7];
-        extern char **environ;
-        struct ucred cli_user_cred;
-        socklen_t cli_user_cred_len = sizeof(cli_user_cred);
-
-        /*
-         * The plugin will still run no matter with root privilege or not.
-         * so that client could get detailed error message.
-         */
-        if (require_root == 0) {
+        if (!plugin_keeps_privilege(plugin, client_fd, require_root)) {
             drop_privileges();
-        } else {
-            if (getuid()) {
-                warn("Plugin %s require root privilege, but lsmd daemon "
-                     "is not run as root user\n", plugin);
-            } else if (allow_root_plugin == 0) {
-                warn("Plugin %s require root privilege, but %s disabled "
-                     "it globally\n", LSMD_CONF_FILE);
-                drop_privileges();
-            } else {
-                /* Check socket client uid */
-                int rc_get_cli_uid =
-                    getsockopt(client_fd, SOL_SOCKET, SO_PEERCRED,
-                               &cli_user_cred, &cli_user_cred_len);
-                if (0 == rc_get_cli_uid) {
-                    if (cli_user_cred.uid != 0) {
-                        warn("Plugin %s require root privilege, but "
-                             "client is not run as root user\n", plugin);
-                        drop_privileges();
-                    } else {
-                        info("Plugin %s is running as root privilege\n",
-                             plugin);
-                    }
-                } else {
-                    warn("Failed to get client socket uid, getsockopt() "
-                         "error: %d\n", errno);
-                    drop_privileges();
-                }
+        }
+        plugin_exec(plugin, client_fd);
+    }
+}
+
+/**
+ * Pre-starts a plug-in process which waits on a control socket for a client
+ * connection to be handed to it.  Workers always run without root
+ * privilege, connections which get to keep it are exec'd as before.
+ * @param plug          Plug-in to start a worker for
+ * @return 0 on success, else -1
+ */
+int worker_start(struct plugin *plug)
+{
+    int err = 0;
+    int sv[2];
+    struct worker *w = calloc(1, sizeof(struct worker));
+
+    if (!w) {
+        log_and_exit("Memory allocation failure!\n");
+    }
+
+    if (-1 == socketpair(AF_UNIX, SOCK_STREAM, 0, sv)) {
+        err = errno;
+        warn("Error on creating worker socket for %s: %s\n",
+             plug->file_path, strerror(err));
+        free(w);
+        return -1;
+    }
+
+    pid_t process = fork();
+    if (-1 == process) {
+        err = errno;
+        warn("Error on forking worker for %s: %s\n", plug->file_path,
+             strerror(err));
+        close(sv[0]);
+        close(sv[1]);
+        free(w);
+        return -1;
+    }
+
+    if (process) {
+        /* Parent */
+        close(sv[1]);
+        w->pid = process;
+        w->fd = sv[0];
+        LIST_INSERT_HEAD(&plug->workers, w, pointers);
+        plug->idle++;
+        info("Started worker %d for plug-in %s\n", process, plug->file_path);
+    } else {
+        /* Child */
+        close(sv[0]);
+        free(w);
+        drop_privileges();
+        setenv(LSM_PLUGIN_WORKER_ENV, "1", 1);
+        plugin_exec(plug->file_path, sv[1]);
+    }
+    return 0;
+}
+
+/**
+ * Starts workers until each plug-in has its pool filled.
+ * @return 0 if all pools are full, else -1
+ */
+int workers_fill(void)
+{
+    int rc = 0;
+    struct plugin *plug = NULL;
+    LIST_FOREACH(plug, &head, pointers) {
+        while (plug->idle < plug->pool_size) {
+            if (worker_start(plug)) {
+                rc = -1;
+                break;
             }
+        }
+    }
+    return rc;
+}
 
+/**
+ * Passes a file descriptor over a unix domain socket.
+ * @param sock      Socket to send on
+ * @param fd        File descriptor to pass
+ * @return 0 on success, else -1
+ */
+int fd_send(int sock, int fd)
+{
+    char b = 0;
+    struct iovec iov;
+    struct msghdr mh;
+    struct cmsghdr *c = NULL;
+    union {
+        struct cmsghdr h;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } cmsg;
+
+    memset(&mh, 0, sizeof(mh));
+    memset(&cmsg, 0, sizeof(cmsg));
+    iov.iov_base = &b;
+    iov.iov_len = 1;
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = cmsg.buf;
+    mh.msg_controllen = sizeof(cmsg.buf);
+
+    c = CMSG_FIRSTHDR(&mh);
+    c->cmsg_level = SOL_SOCKET;
+    c->cmsg_type = SCM_RIGHTS;
+    c->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(c), &fd, sizeof(int));
+
+    return (1 == sendmsg(sock, &mh, MSG_NOSIGNAL)) ? 0 : -1;
+}
+
+/**
+ * Hands a client connection to an idle worker of the plug-in if there is
+ * one and the connection would not keep root privilege.
+ * @param plug          Plug-in
+ * @param client_fd     Client connected file descriptor
+ * @return 0 if a worker took the connection, else -1 (caller exec's)
+ */
+int worker_hand_off(struct plugin *plug, int client_fd)
+{
+    int err = 0;
+    int rc = -1;
+    struct worker *w = LIST_FIRST(&plug->workers);
+
+    if (!w || (!getuid() &&
+               plugin_keeps_privilege(plug->file_path, client_fd,
+                                      plug->require_root))) {
+        return -1;
+    }
+
+    LIST_REMOVE(w, pointers);
+    plug->idle--;
+
+    rc = fd_send(w->fd, client_fd);
+    if (0 == rc) {
+        info("Handed connection to worker %d of plug-in %s\n", w->pid,
+             plug->file_path);
+        if (-1 == close(client_fd)) {
+            err = errno;
+            info("Error on closing accepted socket in parent: %s\n",
+                 strerror(err));
         }
+    } else {
+        err = errno;
+        warn("Error on handing connection to worker %d of plug-in %s: %s\n",
+             w->pid, plug->file_path, strerror(err));
+    }
 
-        /* Make copy of plug-in string as once we call empty_plugin_list it
-         * will be deleted :-) */
-        char *p_copy = strdup(plugin);
+    /* From here on the worker is a plug-in process like any other */
+    close(w->fd);
+    free(w);
+    return rc;
+}
 
-        empty_plugin_list(&head);
-        sprintf(fd_str, "%d", client_fd);
+/**
+ * Called for each child which exited, a worker which exits before it was
+ * used disables the pool for its plug-in rather than being restarted over
+ * and over (e.g. a plug-in run time without worker support).
+ * @param pid       Process id of exited child
+ */
+void worker_exited(pid_t pid)
+{
+    struct plugin *plug = NULL;
+    struct worker *w = NULL;
 
-        if (plugin_mem_debug) {
-            char debug_out[64];
-            snprintf(debug_out, (sizeof(debug_out) - 1),
-                     "--log-file=/tmp/leaking_%d-%d", getppid(), getpid());
+    LIST_FOREACH(plug, &head, pointers) {
+        LIST_FOREACH(w, &plug->workers, pointers) {
+            if (w->pid == pid) {
+                warn("Worker %d of plug-in %s exited before use, disabling "
+                     "its pool\n", pid, plug->file_path);
+                LIST_REMOVE(w, pointers);
+                plug->idle--;
+                plug->pool_size = 0;
+                close(w->fd);
+                free(w);
+                return;
+            }
+        }
+    }
+}
 
-            plugin_argv[0] = "valgrind";
-            plugin_argv[1] = "--leak-check=full";
-            plugin_argv[2] = "--show-reachable=no";
-            plugin_argv[3] = debug_out;
-            plugin_argv[4] = p_copy;
-            plugin_argv[5] = fd_str;
-            plugin_argv[6] = NULL;
+/**
+ * Cleans up any children that have exited.
+ */
+void child_cleanup(void)
+{
+    int rc;
+    int err;
+
+    do {
+        siginfo_t si;
+        memset(&si, 0, sizeof(siginfo_t));
 
-            exec_rc = execve("/usr/bin/valgrind", (char * const*) plugin_argv,
-                             environ);
+        rc = waitid(P_ALL, 0, &si, WNOHANG | WEXITED);
+
+        if (-1 == rc) {
+            err = errno;
+            if (err != ECHILD) {
+                info("waitid %d - %s\n", err, strerror(err));
+            }
+            break;
         } else {
-            plugin_argv[0] = basename(p_copy);
-            plugin_argv[1] = fd_str;
-            plugin_argv[2] = NULL;
-            exec_rc = execve(p_copy, (char * const*) plugin_argv, environ);
+            if (0 == rc && si.si_pid == 0) {
+                break;
+            } else {
+                if (si.si_code == CLD_EXITED && si.si_status != 0) {
+                    info("Plug-in process %d exited with %d\n", si.si_pid,
+                         si.si_status);
+                }
+                worker_exited(si.si_pid);
+            }
         }
+    } while (1);
+}
 
-        if (-1 == exec_rc) {
-            err = errno;
-            log_and_exit("Error on exec'ing Plugin %s: %s\n",
-                         p_copy, strerror(err));
+/**
+ * Drains the signalfd and acts on the signals read.
+ */
+void signals_process(void)
+{
+    struct signalfd_siginfo si;
+
+    while (sizeof(si) == read(signal_fd, &si, sizeof(si))) {
+        if (SIGTERM == si.ssi_signo) {
+            serve_state = EXIT;
+        } else if (SIGHUP == si.ssi_signo) {
+            serve_state = RESTART;
+        }
+    }
+
+    /* SIGCHLD coalesces, always reap everything which has exited */
+    child_cleanup();
+}
+
+/**
+ * Accepts a connection on a plug-in socket and hands it to a worker or a
+ * newly exec'd plug-in.
+ * @param plug      Plug-in whose socket is readable
+ */
+void plugin_accept(struct plugin *plug)
+{
+    int err = 0;
+    int cfd = accept(plug->fd, NULL, NULL);
+
+    if (-1 != cfd) {
+        if (worker_hand_off(plug, cfd)) {
+            exec_plugin(plug->file_path, cfd, plug->require_root);
         }
+    } else {
+        err = errno;
+        info("Error on accepting request: %s", strerror(err));
+    }
+}
+
+/**
+ * Adds a file descriptor to the epoll set.
+ * @param epfd      epoll instance
+ * @param fd        File descriptor to watch for input
+ * @param data      Returned with its events, NULL for the signalfd
+ */
+void epoll_watch(int epfd, int fd, void *data)
+{
+    int err = 0;
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = data;
+
+    if (-1 == epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev)) {
+        err = errno;
+        log_and_exit("Error on adding fd %d to epoll: %s\n", fd,
+                     strerror(err));
     }
 }
 
@@ -740,56 +1103,58 @@ void exec_plugin(char *plugin, int client_fd, int require_root)
 void _serving(void)
 {
     struct plugin *plug = NULL;
-    struct timeval tmo;
-    fd_set readfds;
-    int nfds = 0;
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    int epfd = -1;
+    int tmo = -1;
     int err = 0;
+    int i = 0;
 
     process_plugins();
 
-    while (serve_state == RUNNING) {
-        FD_ZERO(&readfds);
-        nfds = 0;
+    if (LIST_EMPTY(&head)) {
+        log_and_exit("No plugins found in directory %s\n", plugin_dir);
+    }
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == epfd) {
+        err = errno;
+        log_and_exit("Error on creating epoll instance: %s\n",
+                     strerror(err));
+    }
 
-        tmo.tv_sec = 15;
-        tmo.tv_usec = 0;
+    epoll_watch(epfd, signal_fd, NULL);
+    LIST_FOREACH(plug, &head, pointers) {
+        epoll_watch(epfd, plug->fd, plug);
+    }
 
-        LIST_FOREACH(plug, &head, pointers) {
-            nfds = max(plug->fd, nfds);
-            FD_SET(plug->fd, &readfds);
-        }
+    /* Children may have exited while we were not watching */
+    child_cleanup();
 
-        if (!nfds) {
-            log_and_exit("No plugins found in directory %s\n", plugin_dir);
-        }
+    while (serve_state == RUNNING) {
+        /* Only wake up on our own if a worker failed to start */
+        tmo = workers_fill() ? WORKER_RETRY_MS : -1;
 
-        nfds += 1;
-        int ready = select(nfds, &readfds, NULL, NULL, &tmo);
+        int ready = epoll_wait(epfd, events, EPOLL_MAX_EVENTS, tmo);
 
         if (-1 == ready) {
-            if (serve_state != RUNNING) {
-                return;
-            } else {
-                err = errno;
-                log_and_exit("Error on selecting Plugin: %s", strerror(err));
+            err = errno;
+            if (EINTR != err) {
+                log_and_exit("Error on waiting for Plugin: %s",
+                             strerror(err));
             }
-        } else if (ready > 0) {
-            int fd = 0;
-            for (fd = 0; fd < nfds; fd++) {
-                if (FD_ISSET(fd, &readfds)) {
-                    int cfd = accept(fd, NULL, NULL);
-                    if (-1 != cfd) {
-                        struct plugin *p = plugin_lookup(fd);
-                        exec_plugin(p->file_path, cfd, p->require_root);
-                    } else {
-                        err = errno;
-                        info("Error on accepting request: %s", strerror(err));
-                    }
-                }
+            continue;
+        }
+
+        for (i = 0; i < ready; i++) {
+            if (NULL == events[i].data.ptr) {
+                signals_process();
+            } else {
+                plugin_accept((struct plugin *) events[i].data.ptr);
             }
         }
-        child_cleanup();
     }
+
+    close(epfd);
     clean_up();
 }
 
@@ -885,6 +1250,8 @@ int main(int argc, char *argv[])
     char *lsmd_conf_path = path_form(conf_dir, LSMD_CONF_FILE);
     parse_conf_bool(lsmd_conf_path, (char *) LSM_CONF_ALLOW_ROOT_OPT_NAME,
                     &allow_root_plugin);
+    parse_conf_int(lsmd_conf_path, (char *) LSM_CONF_POOL_SIZE_OPT_NAME,
+                   &pool_size);
     free(lsmd_conf_path);
 
     /* Check to see if we want to check plugin for memory errors */
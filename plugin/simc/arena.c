@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2016 Red Hat, Inc.
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+#define _ARENA_CHUNK_SIZE                   16384
+#define _ARENA_ALIGN                        sizeof(long double)
+
+struct _arena_chunk {
+    struct _arena_chunk *next;
+    size_t size;
+    size_t used;
+    long double data[];
+};
+
+struct _arena {
+    struct _arena_chunk *chunks;
+};
+
+struct _arena *_arena_new(void)
+{
+    struct _arena *arena = NULL;
+
+    arena = (struct _arena *) malloc(sizeof(struct _arena));
+    if (arena == NULL)
+        return NULL;
+
+    arena->chunks = NULL;
+    return arena;
+}
+
+void *_arena_alloc(struct _arena *arena, size_t size)
+{
+    struct _arena_chunk *chunk = NULL;
+    size_t chunk_size = _ARENA_CHUNK_SIZE;
+    void *ptr = NULL;
+
+    assert(arena != NULL);
+
+    size = (size + _ARENA_ALIGN - 1) / _ARENA_ALIGN * _ARENA_ALIGN;
+
+    chunk = arena->chunks;
+    if ((chunk == NULL) || (chunk->size - chunk->used < size)) {
+        /* Oversized requests get a chunk of their own */
+        if (size > chunk_size)
+            chunk_size = size;
+        chunk = (struct _arena_chunk *)
+            malloc(sizeof(struct _arena_chunk) + chunk_size);
+        if (chunk == NULL)
+            return NULL;
+        chunk->size = chunk_size;
+        chunk->used = 0;
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+    }
+
+    ptr = (char *) chunk->data + chunk->used;
+    chunk->used += size;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+char *_arena_strdup(struct _arena *arena, const char *str)
+{
+    size_t len = 0;
+    char *new_str = NULL;
+
+    assert(arena != NULL);
+    assert(str != NULL);
+
+    len = strlen(str) + 1;
+    new_str = (char *) _arena_alloc(arena, len);
+    if (new_str != NULL)
+        memcpy(new_str, str, len);
+    return new_str;
+}
+
+void _arena_free(struct _arena *arena)
+{
+    struct _arena_chunk *chunk = NULL;
+
+    if (arena == NULL)
+        return;
+
+    while (arena->chunks != NULL) {
+        chunk = arena->chunks;
+        arena->chunks = chunk->next;
+        free(chunk);
+    }
+    free(arena);
+}
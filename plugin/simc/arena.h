@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2016 Red Hat, Inc.
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _SIMC_ARENA_H_
+#define _SIMC_ARENA_H_
+
+#include <stddef.h>
+
+/*
+ * Bump allocator for the rows of one query.  Nothing is freed on its own,
+ * _arena_free() releases everything handed out at once.
+ */
+struct _arena;
+
+/*
+ * Return NULL if no memory.
+ */
+struct _arena *_arena_new(void);
+
+/*
+ * Abort by assert() if arena pointer is NULL.
+ * Return zeroed memory aligned for any type, or NULL if no memory.
+ */
+void *_arena_alloc(struct _arena *arena, size_t size);
+
+/*
+ * Abort by assert() if arena or str pointer is NULL.
+ * Return NULL if no memory.
+ */
+char *_arena_strdup(struct _arena *arena, const char *str);
+
+void _arena_free(struct _arena *arena);
+
+#endif  /* End of _SIMC_ARENA_H_ */
@@ -32,10 +32,12 @@
 #include "db.h"
 #include "db_table_init.h"
 #include "vector.h"
+#include "arena.h"
 
 #define _DB_VERSION_CHECK_PASS                      0
 #define _DB_VERSION_CHECK_FAIL                      1
 #define _DB_VERSION_CHECK_EMPTY                     2
+#define _DB_VERSION_CHECK_OLD                       3
 #define _SIZE_2TIB_STR                              "2199023255552"
 #define _SIZE_512GIB_STR                            "549755813888"
 #define _DEFAULT_POOL_STRIP_SIZE                    131072    /* 128 KiB*/
@@ -73,12 +75,190 @@ static const uint32_t _SUPPORTED_STRIP_SIZES[] = {
 
 static int _parse_sql_column(void *v, int columne_count, char **values,
                              char **keys);
-static int _db_version_check(sqlite3 *db);
+
+/*
+ * Upgrade steps for state files written by an older _DB_VERSION.  Starting
+ * from the entry matching the stored version every later step is applied in
+ * order, each one bringing the schema up to the version of the next entry
+ * and the last one up to _DB_VERSION.
+ */
+struct _db_migration {
+    const char *version;
+    const char *sql;
+};
+
+static const struct _db_migration _DB_MIGRATIONS[] = {
+    /* 4.1 -> 4.2: indexes on join and filter columns */
+    {"4.1", _INDEX_INIT},
+    /* 4.2 -> 4.3: pool capacity counters instead of aggregating views */
+    {"4.2", _POOL_USAGE_INIT
+            "DROP VIEW IF EXISTS " _DB_TABLE_POOLS_VIEW ";\n"
+            _POOLS_VIEW_INIT},
+};
+
+#define _DB_MIGRATION_COUNT \
+    (sizeof(_DB_MIGRATIONS) / sizeof(_DB_MIGRATIONS[0]))
+
+static int _db_version_check(sqlite3 *db, size_t *migration);
+
+static int _db_migrate(char *err_msg, sqlite3 *db, size_t migration);
 
 static int _db_data_init(char *err_msg, sqlite3 *db);
 
+static void _db_version_str(const char *db_version, char *buff);
+
 static const char *_sys_version(void);
 
+/*
+ * Prepared statements, looked up by their SQL text so each statement shape
+ * is parsed and planned once for the life of the database connection.
+ * Only _DB_STMT_CACHE_MAX are kept, statements after that are finalized
+ * after use.  The plug-in handles one request at a time.
+ */
+#define _DB_STMT_CACHE_BUCKETS                      64
+#define _DB_STMT_CACHE_MAX                          256
+
+struct _db_stmt {
+    sqlite3 *db;
+    sqlite3_stmt *stmt;
+    struct _db_stmt *next;
+};
+
+static struct _db_stmt *_db_stmt_cache[_DB_STMT_CACHE_BUCKETS];
+static uint32_t _db_stmt_cache_count = 0;
+
+/* Most columns any _db_row_desc lists */
+#define _DB_ROW_COL_MAX                             16
+
+#define _DB_COL(row_type, col_type, member) \
+    {#member, col_type, offsetof(struct row_type, member)}
+
+#define _DB_ROW_DESC(row_type, cols) \
+    const struct _db_row_desc row_type##_desc = { \
+        sizeof(struct row_type), cols, \
+    }
+
+static const struct _db_col _db_sys_row_cols[] = {
+    _DB_COL(_db_sys_row, _DB_COL_TEXT, id),
+    _DB_COL(_db_sys_row, _DB_COL_TEXT, name),
+    _DB_COL(_db_sys_row, _DB_COL_INT, status),
+    _DB_COL(_db_sys_row, _DB_COL_TEXT, status_info),
+    _DB_COL(_db_sys_row, _DB_COL_INT, read_cache_pct),
+    _DB_COL(_db_sys_row, _DB_COL_TEXT, version),
+    {NULL, 0, 0},
+};
+_DB_ROW_DESC(_db_sys_row, _db_sys_row_cols);
+
+static const struct _db_col _db_pool_row_cols[] = {
+    _DB_COL(_db_pool_row, _DB_COL_INT, id),
+    _DB_COL(_db_pool_row, _DB_COL_TEXT, lsm_pool_id),
+    _DB_COL(_db_pool_row, _DB_COL_TEXT, name),
+    _DB_COL(_db_pool_row, _DB_COL_INT, status),
+    _DB_COL(_db_pool_row, _DB_COL_TEXT, status_info),
+    _DB_COL(_db_pool_row, _DB_COL_INT, element_type),
+    _DB_COL(_db_pool_row, _DB_COL_INT, unsupported_actions),
+    _DB_COL(_db_pool_row, _DB_COL_INT, total_space),
+    _DB_COL(_db_pool_row, _DB_COL_INT, free_space),
+    {NULL, 0, 0},
+};
+_DB_ROW_DESC(_db_pool_row, _db_pool_row_cols);
+
+static const struct _db_col _db_vol_row_cols[] = {
+    _DB_COL(_db_vol_row, _DB_COL_INT, id),
+    _DB_COL(_db_vol_row, _DB_COL_TEXT, lsm_vol_id),
+    _DB_COL(_db_vol_row, _DB_COL_TEXT, name),
+    _DB_COL(_db_vol_row, _DB_COL_TEXT, vpd83),
+    _DB_COL(_db_vol_row, _DB_COL_INT, total_space),
+    _DB_COL(_db_vol_row, _DB_COL_INT, admin_state),
+    _DB_COL(_db_vol_row, _DB_COL_TEXT, lsm_pool_id),
+    {NULL, 0, 0},
+};
+_DB_ROW_DESC(_db_vol_row, _db_vol_row_cols);
+
+static const struct _db_col _db_disk_row_cols[] = {
+    _DB_COL(_db_disk_row, _DB_COL_INT, id),
+    _DB_COL(_db_disk_row, _DB_COL_TEXT, lsm_disk_id),
+    _DB_COL(_db_disk_row, _DB_COL_TEXT, name),
+    _DB_COL(_db_disk_row, _DB_COL_INT, total_space),
+    _DB_COL(_db_disk_row, _DB_COL_INT, disk_type),
+    _DB_COL(_db_disk_row, _DB_COL_TEXT, role),
+    _DB_COL(_db_disk_row, _DB_COL_INT, status),
+    _DB_COL(_db_disk_row, _DB_COL_TEXT, vpd83),
+    _DB_COL(_db_disk_row, _DB_COL_INT, rpm),
+    _DB_COL(_db_disk_row, _DB_COL_INT, link_type),
+    _DB_COL(_db_disk_row, _DB_COL_TEXT, location),
+    {NULL, 0, 0},
+};
+_DB_ROW_DESC(_db_disk_row, _db_disk_row_cols);
+
+static const struct _db_col _db_ag_row_cols[] = {
+    _DB_COL(_db_ag_row, _DB_COL_INT, id),
+    _DB_COL(_db_ag_row, _DB_COL_TEXT, lsm_ag_id),
+    _DB_COL(_db_ag_row, _DB_COL_TEXT, name),
+    _DB_COL(_db_ag_row, _DB_COL_INT, init_type),
+    _DB_COL(_db_ag_row, _DB_COL_TEXT, init_ids_str),
+    {NULL, 0, 0},
+};
+_DB_ROW_DESC(_db_ag_row, _db_ag_row_cols);
+
+static const struct _db_col _db_tgt_row_cols[] = {
+    _DB_COL(_db_tgt_row, _DB_COL_INT, id),
+    _DB_COL(_db_tgt_row, _DB_COL_TEXT, lsm_tgt_id),
+    _DB_COL(_db_tgt_row, _DB_COL_INT, port_type),
+    _DB_COL(_db_tgt_row, _DB_COL_TEXT, service_address),
+    _DB_COL(_db_tgt_row, _DB_COL_TEXT, network_address),
+    _DB_COL(_db_tgt_row, _DB_COL_TEXT, physical_address),
+    _DB_COL(_db_tgt_row, _DB_COL_TEXT, physical_name),
+    {NULL, 0, 0},
+};
+_DB_ROW_DESC(_db_tgt_row, _db_tgt_row_cols);
+
+static const struct _db_col _db_fs_row_cols[] = {
+    _DB_COL(_db_fs_row, _DB_COL_INT, id),
+    _DB_COL(_db_fs_row, _DB_COL_TEXT, lsm_fs_id),
+    _DB_COL(_db_fs_row, _DB_COL_TEXT, name),
+    _DB_COL(_db_fs_row, _DB_COL_INT, total_space),
+    _DB_COL(_db_fs_row, _DB_COL_INT, free_space),
+    _DB_COL(_db_fs_row, _DB_COL_TEXT, lsm_pool_id),
+    {NULL, 0, 0},
+};
+_DB_ROW_DESC(_db_fs_row, _db_fs_row_cols);
+
+static const struct _db_col _db_fs_snap_row_cols[] = {
+    _DB_COL(_db_fs_snap_row, _DB_COL_INT, id),
+    _DB_COL(_db_fs_snap_row, _DB_COL_TEXT, lsm_fs_snap_id),
+    _DB_COL(_db_fs_snap_row, _DB_COL_TEXT, name),
+    _DB_COL(_db_fs_snap_row, _DB_COL_INT, timestamp),
+    {NULL, 0, 0},
+};
+_DB_ROW_DESC(_db_fs_snap_row, _db_fs_snap_row_cols);
+
+static const struct _db_col _db_exp_row_cols[] = {
+    _DB_COL(_db_exp_row, _DB_COL_INT, id),
+    _DB_COL(_db_exp_row, _DB_COL_TEXT, lsm_exp_id),
+    _DB_COL(_db_exp_row, _DB_COL_TEXT, lsm_fs_id),
+    _DB_COL(_db_exp_row, _DB_COL_TEXT, exp_path),
+    _DB_COL(_db_exp_row, _DB_COL_TEXT, auth_type),
+    _DB_COL(_db_exp_row, _DB_COL_INT, anon_uid),
+    _DB_COL(_db_exp_row, _DB_COL_INT, anon_gid),
+    _DB_COL(_db_exp_row, _DB_COL_TEXT, options),
+    _DB_COL(_db_exp_row, _DB_COL_TEXT, exp_root_hosts_str),
+    _DB_COL(_db_exp_row, _DB_COL_TEXT, exp_rw_hosts_str),
+    _DB_COL(_db_exp_row, _DB_COL_TEXT, exp_ro_hosts_str),
+    {NULL, 0, 0},
+};
+_DB_ROW_DESC(_db_exp_row, _db_exp_row_cols);
+
+static const struct _db_col _db_bat_row_cols[] = {
+    _DB_COL(_db_bat_row, _DB_COL_INT, id),
+    _DB_COL(_db_bat_row, _DB_COL_TEXT, lsm_bat_id),
+    _DB_COL(_db_bat_row, _DB_COL_TEXT, name),
+    _DB_COL(_db_bat_row, _DB_COL_INT, type),
+    _DB_COL(_db_bat_row, _DB_COL_INT, status),
+    {NULL, 0, 0},
+};
+_DB_ROW_DESC(_db_bat_row, _db_bat_row_cols);
+
 /*
  * Returned memory should be freed by lsm_hash_free().
  */
@@ -93,6 +273,24 @@ static int _db_pool_create_sub_pool(char *err_msg, sqlite3 *db,
                                     const char *size_str, uint64_t element_type,
                                     uint64_t unsupported_actions);
 
+static int _db_stmt_get(char *err_msg, sqlite3 *db, const char *sql,
+                        sqlite3_stmt **stmt, bool *cached);
+
+static int _db_stmt_bind(char *err_msg, sqlite3_stmt *stmt, bool cached,
+                         const char *types, va_list arg);
+
+static int _db_stmt_run(char *err_msg, sqlite3 *db, sqlite3_stmt *stmt,
+                        bool cached, const struct _db_row_desc *desc,
+                        struct _arena *arena, struct _vector **vec);
+
+static void _db_stmt_cache_free(sqlite3 *db);
+
+static int _db_row_of_sim_id(char *err_msg, sqlite3 *db,
+                             const char *table_name,
+                             const struct _db_row_desc *desc, uint64_t sim_id,
+                             struct _arena *arena, void **row,
+                             int not_found_err, const char *not_found_err_str);
+
 static int _parse_sql_column(void *v, int columne_count, char **values,
                              char **keys)
 {
@@ -128,17 +326,21 @@ static int _parse_sql_column(void *v, int columne_count, char **values,
     return 0;
 }
 
-static int _db_version_check(sqlite3 *db)
+static int _db_version_check(sqlite3 *db, size_t *migration)
 {
     int rc = _DB_VERSION_CHECK_FAIL;
     struct _vector *vec = NULL;
     lsm_hash *sim_sys = NULL;
     const char *version = NULL;
+    char old_version[_BUFF_SIZE];
     char err_msg[_LSM_ERR_MSG_LEN];
+    size_t i = 0;
 
-    /* We ignore the failure of below command, assigning to rc just to pass
-     * convscan */
-    rc = _db_sql_exec(err_msg, db, "SELECT * from systems;", &vec);
+    assert(migration != NULL);
+
+    if (_db_sql_exec_bind(err_msg, db, "SELECT * FROM " _DB_TABLE_SYS ";",
+                          &vec, "") != LSM_ERR_OK)
+        goto out;
 
     if (_vector_size(vec) == 0) {
         rc = _DB_VERSION_CHECK_EMPTY;
@@ -148,9 +350,22 @@ static int _db_version_check(sqlite3 *db)
     sim_sys = _vector_get(vec, 0);
 
     version = lsm_hash_string_get(sim_sys, "version");
+    if (version == NULL)
+        goto out;
 
-    if ((version != NULL) && (strcmp(version, _sys_version()) == 0))
+    if (strcmp(version, _sys_version()) == 0) {
         rc = _DB_VERSION_CHECK_PASS;
+        goto out;
+    }
+
+    for (; i < _DB_MIGRATION_COUNT; ++i) {
+        _db_version_str(_DB_MIGRATIONS[i].version, old_version);
+        if (strcmp(version, old_version) == 0) {
+            *migration = i;
+            rc = _DB_VERSION_CHECK_OLD;
+            break;
+        }
+    }
 
  out:
     _db_sql_exec_vec_free(vec);
@@ -158,6 +373,24 @@ static int _db_version_check(sqlite3 *db)
     return rc;
 }
 
+static int _db_migrate(char *err_msg, sqlite3 *db, size_t migration)
+{
+    int rc = LSM_ERR_OK;
+
+    for (; migration < _DB_MIGRATION_COUNT; ++migration)
+        _good(_db_sql_exec(err_msg, db, _DB_MIGRATIONS[migration].sql, NULL),
+              rc, out);
+
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "UPDATE " _DB_TABLE_SYS " SET version = ?;",
+                            NULL /* don't parse output */, "s",
+                            _sys_version()),
+          rc, out);
+
+ out:
+    return rc;
+}
+
 static int _db_data_init(char *err_msg, sqlite3 *db)
 {
     int rc = LSM_ERR_OK;
@@ -406,14 +639,19 @@ static int _db_data_init(char *err_msg, sqlite3 *db)
     return rc;
 }
 
-static const char *_sys_version(void)
+static void _db_version_str(const char *db_version, char *buff)
 {
     char version_md5[_MD5_HASH_STR_LEN];
 
-    _md5(_DB_VERSION, version_md5);
+    _md5(db_version, version_md5);
 
-    snprintf(_SYS_VERSION, _BUFF_SIZE, "%s_%s_%s", _DB_VERSION_STR_PREFIX,
-             _DB_VERSION, version_md5);
+    snprintf(buff, _BUFF_SIZE, "%s_%s_%s", _DB_VERSION_STR_PREFIX,
+             db_version, version_md5);
+}
+
+static const char *_sys_version(void)
+{
+    _db_version_str(_DB_VERSION, _SYS_VERSION);
 
     return _SYS_VERSION;
 }
@@ -627,6 +865,7 @@ int _db_init(char *err_msg, sqlite3 **db, const char *db_file,
     int db_rc = SQLITE_OK;
     struct _vector *vec = NULL;
     int db_check_rc = _DB_VERSION_CHECK_FAIL;
+    size_t migration = 0;
 
     assert(db != NULL);
 
@@ -649,6 +888,13 @@ int _db_init(char *err_msg, sqlite3 **db, const char *db_file,
         goto out;
     }
 
+    /* Let read only requests of other plug-in processes go on while one is
+     * writing.  Not every file system supports WAL, fall back silently to
+     * the default journal if the switch fails. */
+    sqlite3_exec(*db, "PRAGMA journal_mode = WAL;", NULL /* callback func */,
+                 NULL /* callback func first argument */,
+                 NULL /* don't generate error message */);
+
     sqlite3_exec(*db, _TABLE_INIT, NULL /* callback func */,
                  NULL /* callback func first argument */,
                  NULL /* don't generate error message */);
@@ -656,9 +902,11 @@ int _db_init(char *err_msg, sqlite3 **db, const char *db_file,
     _good(_db_sql_trans_begin(err_msg, *db), rc, out);
 
     /* Check db version */
-    db_check_rc = _db_version_check(*db);
+    db_check_rc = _db_version_check(*db, &migration);
     if (db_check_rc == _DB_VERSION_CHECK_EMPTY) {
         _good(_db_data_init(err_msg, *db), rc, out);
+    } else if (db_check_rc == _DB_VERSION_CHECK_OLD) {
+        _good(_db_migrate(err_msg, *db, migration), rc, out);
     } else if (db_check_rc == _DB_VERSION_CHECK_FAIL) {
         rc = LSM_ERR_INVALID_ARGUMENT;
         _lsm_err_msg_set(err_msg, "Stored simulator state incompatible with "
@@ -671,8 +919,9 @@ int _db_init(char *err_msg, sqlite3 **db, const char *db_file,
  out:
     if (rc != LSM_ERR_OK) {
         if (*db != NULL) {
-            sqlite3_close(*db);
             _db_sql_trans_rollback(*db);
+            _db_close(*db);
+            *db = NULL;
         }
     }
 
@@ -729,6 +978,525 @@ int _db_sql_exec(char *err_msg, sqlite3 *db, const char *cmd,
     return rc;
 }
 
+static int _db_sql_rc_check(char *err_msg, sqlite3 *db, int sql_rc)
+{
+    if (sql_rc == SQLITE_BUSY) {
+        _lsm_err_msg_set(err_msg, "Timeout on locking database");
+        return LSM_ERR_TIMEOUT;
+    }
+    _lsm_err_msg_set(err_msg, "SQLite error %d: %s", sql_rc,
+                     sqlite3_errmsg(db));
+    return LSM_ERR_PLUGIN_BUG;
+}
+
+static uint32_t _db_stmt_hash(const char *sql)
+{
+    uint32_t hash = 2166136261U;
+
+    for (; *sql != '\0'; ++sql)
+        hash = (hash ^ (uint8_t) *sql) * 16777619U;
+    return hash % _DB_STMT_CACHE_BUCKETS;
+}
+
+static int _db_stmt_get(char *err_msg, sqlite3 *db, const char *sql,
+                        sqlite3_stmt **stmt, bool *cached)
+{
+    uint32_t bucket = _db_stmt_hash(sql);
+    struct _db_stmt *entry = NULL;
+    int sql_rc = SQLITE_OK;
+
+    assert(db != NULL);
+    assert(stmt != NULL);
+    assert(cached != NULL);
+
+    for (entry = _db_stmt_cache[bucket]; entry != NULL; entry = entry->next) {
+        if ((entry->db == db) &&
+            (strcmp(sqlite3_sql(entry->stmt), sql) == 0)) {
+            *stmt = entry->stmt;
+            *cached = true;
+            return LSM_ERR_OK;
+        }
+    }
+
+    *cached = false;
+    sql_rc = sqlite3_prepare_v2(db, sql, -1, stmt, NULL);
+    if (sql_rc != SQLITE_OK) {
+        sqlite3_finalize(*stmt);
+        *stmt = NULL;
+        return _db_sql_rc_check(err_msg, db, sql_rc);
+    }
+
+    if (_db_stmt_cache_count < _DB_STMT_CACHE_MAX) {
+        entry = (struct _db_stmt *) malloc(sizeof(struct _db_stmt));
+        if (entry != NULL) {
+            entry->db = db;
+            entry->stmt = *stmt;
+            entry->next = _db_stmt_cache[bucket];
+            _db_stmt_cache[bucket] = entry;
+            ++_db_stmt_cache_count;
+            *cached = true;
+        }
+    }
+    return LSM_ERR_OK;
+}
+
+/*
+ * Look up the column index of each desc column once, so the rows can be
+ * decoded by index.
+ */
+static int _db_row_cols_resolve(char *err_msg, sqlite3_stmt *stmt,
+                                const struct _db_row_desc *desc, int *col_idx)
+{
+    const struct _db_col *col = NULL;
+    int col_count = sqlite3_column_count(stmt);
+    int i = 0;
+
+    for (col = desc->cols; col->name != NULL; ++col, ++col_idx) {
+        assert(col - desc->cols < _DB_ROW_COL_MAX);
+        for (i = 0; i < col_count; ++i) {
+            if (strcmp(sqlite3_column_name(stmt, i), col->name) == 0)
+                break;
+        }
+        if (i == col_count) {
+            _lsm_err_msg_set(err_msg, "BUG: No column '%s' in '%s'",
+                             col->name, sqlite3_sql(stmt));
+            return LSM_ERR_PLUGIN_BUG;
+        }
+        *col_idx = i;
+    }
+    return LSM_ERR_OK;
+}
+
+/*
+ * Return NULL if no memory.
+ */
+static void *_db_row_decode(sqlite3_stmt *stmt,
+                            const struct _db_row_desc *desc,
+                            const int *col_idx, struct _arena *arena)
+{
+    char *row = NULL;
+    const struct _db_col *col = NULL;
+    const char *value = NULL;
+
+    row = (char *) _arena_alloc(arena, desc->size);
+    if (row == NULL)
+        return NULL;
+
+    for (col = desc->cols; col->name != NULL; ++col, ++col_idx) {
+        if (col->type == _DB_COL_INT) {
+            *(uint64_t *) (row + col->offset) =
+                (uint64_t) sqlite3_column_int64(stmt, *col_idx);
+            continue;
+        }
+        value = (const char *) sqlite3_column_text(stmt, *col_idx);
+        if (value == NULL) {
+            value = "";
+        } else {
+            value = _arena_strdup(arena, value);
+            if (value == NULL)
+                return NULL;
+        }
+        *(const char **) (row + col->offset) = value;
+    }
+    return row;
+}
+
+/*
+ * Steps through a statement from _db_stmt_get() with its parameters bound,
+ * then resets it for the next use, or finalizes it if not cached.  Rows
+ * are decoded as desc from arena, or into lsm_hash if desc is NULL.
+ */
+static int _db_stmt_run(char *err_msg, sqlite3 *db, sqlite3_stmt *stmt,
+                        bool cached, const struct _db_row_desc *desc,
+                        struct _arena *arena, struct _vector **vec)
+{
+    int rc = LSM_ERR_OK;
+    int sql_rc = SQLITE_OK;
+    lsm_hash *sim_xxx = NULL;
+    void *row = NULL;
+    const char *value = NULL;
+    int col_idx[_DB_ROW_COL_MAX];
+    int i = 0;
+
+    assert((desc == NULL) || (arena != NULL));
+
+    if (vec != NULL) {
+        *vec = _vector_new(_VECTOR_NO_PRE_ALLOCATION);
+        _alloc_null_check(err_msg, *vec, rc, out);
+        if (desc != NULL)
+            _good(_db_row_cols_resolve(err_msg, stmt, desc, col_idx), rc,
+                  out);
+    }
+
+    while ((sql_rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (vec == NULL)
+            continue;
+
+        if (desc != NULL) {
+            row = _db_row_decode(stmt, desc, col_idx, arena);
+            _alloc_null_check(err_msg, row, rc, out);
+            if (_vector_insert(*vec, row) != 0) {
+                rc = LSM_ERR_NO_MEMORY;
+                goto out;
+            }
+            continue;
+        }
+
+        sim_xxx = lsm_hash_alloc();
+        _alloc_null_check(err_msg, sim_xxx, rc, out);
+        if (_vector_insert(*vec, sim_xxx) != 0) {
+            lsm_hash_free(sim_xxx);
+            rc = LSM_ERR_NO_MEMORY;
+            goto out;
+        }
+        for (i = 0; i < sqlite3_column_count(stmt); ++i) {
+            value = (const char *) sqlite3_column_text(stmt, i);
+            if (value == NULL)
+                value = "";
+            if (lsm_hash_string_set(sim_xxx, sqlite3_column_name(stmt, i),
+                                    value) != LSM_ERR_OK) {
+                rc = LSM_ERR_NO_MEMORY;
+                goto out;
+            }
+        }
+    }
+
+    if (sql_rc != SQLITE_DONE)
+        rc = _db_sql_rc_check(err_msg, db, sql_rc);
+
+ out:
+    /* Keeps the error code for sqlite3_errcode() callers */
+    if (cached) {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    } else {
+        sqlite3_finalize(stmt);
+    }
+    if ((rc != LSM_ERR_OK) && (vec != NULL)) {
+        if (desc != NULL)
+            _vector_free(*vec);
+        else
+            _db_sql_exec_vec_free(*vec);
+        *vec = NULL;
+    }
+    return rc;
+}
+
+static void _db_stmt_cache_free(sqlite3 *db)
+{
+    struct _db_stmt **entry = NULL;
+    struct _db_stmt *tmp = NULL;
+    uint32_t i = 0;
+
+    for (; i < _DB_STMT_CACHE_BUCKETS; ++i) {
+        entry = &_db_stmt_cache[i];
+        while (*entry != NULL) {
+            if ((*entry)->db != db) {
+                entry = &(*entry)->next;
+                continue;
+            }
+            tmp = *entry;
+            *entry = tmp->next;
+            sqlite3_finalize(tmp->stmt);
+            free(tmp);
+            --_db_stmt_cache_count;
+        }
+    }
+}
+
+/*
+ * Bind the '?' parameters of stmt as described in _db_sql_exec_bind().  On
+ * failure the statement is released as _db_stmt_run() would.
+ */
+static int _db_stmt_bind(char *err_msg, sqlite3_stmt *stmt, bool cached,
+                         const char *types, va_list arg)
+{
+    int sql_rc = SQLITE_OK;
+    const char *str = NULL;
+    int i = 0;
+
+    for (i = 0; (types[i] != '\0') && (sql_rc == SQLITE_OK); ++i) {
+        switch (types[i]) {
+        case 's':
+            str = va_arg(arg, const char *);
+            if (str == NULL)
+                sql_rc = sqlite3_bind_null(stmt, i + 1);
+            else
+                sql_rc = sqlite3_bind_text(stmt, i + 1, str, -1,
+                                           SQLITE_STATIC);
+            break;
+        case 'i':
+            sql_rc = sqlite3_bind_int64(stmt, i + 1,
+                                        (sqlite3_int64) va_arg(arg, uint64_t));
+            break;
+        default:
+            sql_rc = SQLITE_MISUSE;
+            break;
+        }
+    }
+
+    if (sql_rc == SQLITE_OK)
+        return LSM_ERR_OK;
+
+    _lsm_err_msg_set(err_msg, "BUG: Failed to bind parameter %d of '%s'",
+                     i, sqlite3_sql(stmt));
+    if (cached)
+        sqlite3_clear_bindings(stmt);
+    else
+        sqlite3_finalize(stmt);
+    return LSM_ERR_PLUGIN_BUG;
+}
+
+int _db_sql_exec_bind(char *err_msg, sqlite3 *db, const char *sql,
+                      struct _vector **vec, const char *types, ...)
+{
+    int rc = LSM_ERR_OK;
+    sqlite3_stmt *stmt = NULL;
+    bool cached = false;
+    va_list arg;
+
+    assert(db != NULL);
+    assert(sql != NULL);
+    assert(types != NULL);
+
+    if (vec != NULL)
+        *vec = NULL;
+
+    _good(_db_stmt_get(err_msg, db, sql, &stmt, &cached), rc, out);
+
+    va_start(arg, types);
+    rc = _db_stmt_bind(err_msg, stmt, cached, types, arg);
+    va_end(arg);
+    if (rc != LSM_ERR_OK)
+        goto out;
+
+    rc = _db_stmt_run(err_msg, db, stmt, cached, NULL /* lsm_hash rows */,
+                      NULL, vec);
+
+ out:
+    return rc;
+}
+
+int _db_sql_exec_rows(char *err_msg, sqlite3 *db, const char *sql,
+                      const struct _db_row_desc *desc, struct _arena *arena,
+                      struct _vector **vec, const char *types, ...)
+{
+    int rc = LSM_ERR_OK;
+    sqlite3_stmt *stmt = NULL;
+    bool cached = false;
+    va_list arg;
+
+    assert(db != NULL);
+    assert(sql != NULL);
+    assert(desc != NULL);
+    assert(arena != NULL);
+    assert(vec != NULL);
+    assert(types != NULL);
+
+    *vec = NULL;
+
+    _good(_db_stmt_get(err_msg, db, sql, &stmt, &cached), rc, out);
+
+    va_start(arg, types);
+    rc = _db_stmt_bind(err_msg, stmt, cached, types, arg);
+    va_end(arg);
+    if (rc != LSM_ERR_OK)
+        goto out;
+
+    rc = _db_stmt_run(err_msg, db, stmt, cached, desc, arena, vec);
+
+ out:
+    return rc;
+}
+
+int _db_sql_search(char *err_msg, sqlite3 *db, const char *table,
+                   const struct _db_search_key *search_keys,
+                   const char *search_key, const char *search_value,
+                   const struct _db_row_desc *desc, struct _arena *arena,
+                   struct _vector **vec)
+{
+    return _db_sql_search_page(err_msg, db, table, search_keys, search_key,
+                               search_value, _DB_SIM_ID_NONE, 0, desc, arena,
+                               vec);
+}
+
+int _db_sql_search_page(char *err_msg, sqlite3 *db, const char *table,
+                        const struct _db_search_key *search_keys,
+                        const char *search_key, const char *search_value,
+                        uint64_t after_sim_id, uint32_t limit,
+                        const struct _db_row_desc *desc,
+                        struct _arena *arena, struct _vector **vec)
+{
+    int rc = LSM_ERR_OK;
+    int sql_rc = SQLITE_OK;
+    char sql_cmd[_BUFF_SIZE];
+    char where[_BUFF_SIZE];
+    const struct _db_search_key *sk = NULL;
+    sqlite3_stmt *stmt = NULL;
+    bool cached = false;
+    uint64_t sim_id = _DB_SIM_ID_NONE;
+
+    assert(db != NULL);
+    assert(table != NULL);
+    assert(search_keys != NULL);
+    assert(vec != NULL);
+
+    *vec = NULL;
+
+    /* Everything belongs to the one system, so all rows match or none */
+    if ((search_key != NULL) && (strcmp(search_key, "system_id") == 0)) {
+        if ((search_value == NULL) || (strcmp(search_value, _SYS_ID) != 0)) {
+            *vec = _vector_new(_VECTOR_NO_PRE_ALLOCATION);
+            _alloc_null_check(err_msg, *vec, rc, out);
+            goto out;
+        }
+        search_key = NULL;
+    }
+
+    if (search_key != NULL) {
+        for (sk = search_keys; sk->key != NULL; ++sk) {
+            if (strcmp(sk->key, search_key) == 0)
+                break;
+        }
+        if (sk->key == NULL)
+            sk = NULL;
+    }
+
+    if (sk != NULL) {
+        /* Not an id this plug-in hands out, nothing can match */
+        sim_id = _db_lsm_id_to_sim_id(search_value);
+        if (sim_id == _DB_SIM_ID_NONE) {
+            *vec = _vector_new(_VECTOR_NO_PRE_ALLOCATION);
+            _alloc_null_check(err_msg, *vec, rc, out);
+            goto out;
+        }
+        _snprintf_buff(err_msg, rc, out, where,
+                       " WHERE %s = ?1 AND %s = ?2 AND id > ?3",
+                       sk->sim_id_column, sk->lsm_id_column);
+    } else if ((after_sim_id != _DB_SIM_ID_NONE) || (limit != 0)) {
+        _snprintf_buff(err_msg, rc, out, where, " WHERE id > ?3");
+    } else {
+        where[0] = '\0';
+    }
+
+    /* The limit is bound too so every page size shares the statement */
+    _snprintf_buff(err_msg, rc, out, sql_cmd, "SELECT * FROM %s%s%s;",
+                   table, where, (limit != 0) ? " ORDER BY id LIMIT ?4" : "");
+
+    _good(_db_stmt_get(err_msg, db, sql_cmd, &stmt, &cached), rc, out);
+
+    if (sk != NULL) {
+        sql_rc = sqlite3_bind_int64(stmt, 1, (sqlite3_int64) sim_id);
+        if (sql_rc == SQLITE_OK)
+            sql_rc = sqlite3_bind_text(stmt, 2, search_value, -1,
+                                       SQLITE_STATIC);
+    }
+    if ((sql_rc == SQLITE_OK) && (where[0] != '\0'))
+        sql_rc = sqlite3_bind_int64(stmt, 3, (sqlite3_int64) after_sim_id);
+    if ((sql_rc == SQLITE_OK) && (limit != 0))
+        sql_rc = sqlite3_bind_int64(stmt, 4, (sqlite3_int64) limit);
+
+    if (sql_rc != SQLITE_OK) {
+        rc = _db_sql_rc_check(err_msg, db, sql_rc);
+        if (cached)
+            sqlite3_clear_bindings(stmt);
+        else
+            sqlite3_finalize(stmt);
+        goto out;
+    }
+
+    rc = _db_stmt_run(err_msg, db, stmt, cached, desc, arena, vec);
+
+ out:
+    return rc;
+}
+
+/*
+ * The IN list is made of sim ids formatted here, its length changes with
+ * every call so the statement is prepared and finalized here instead of
+ * taking a slot of the statement cache.
+ */
+int _db_sql_search_in(char *err_msg, sqlite3 *db, const char *table,
+                      const struct _db_search_key *search_keys,
+                      const char *search_key, lsm_string_list *search_values,
+                      const struct _db_row_desc *desc, struct _arena *arena,
+                      struct _vector **vec)
+{
+    int rc = LSM_ERR_OK;
+    int sql_rc = SQLITE_OK;
+    sqlite3_stmt *stmt = NULL;
+    const struct _db_search_key *sk = NULL;
+    char *sql_cmd = NULL;
+    size_t sql_len = 0;
+    uint32_t value_count = 0;
+    uint32_t sim_id_count = 0;
+    uint32_t i = 0;
+    uint64_t sim_id = _DB_SIM_ID_NONE;
+
+    assert(db != NULL);
+    assert(table != NULL);
+    assert(search_keys != NULL);
+    assert(search_key != NULL);
+    assert(search_values != NULL);
+    assert(vec != NULL);
+
+    *vec = NULL;
+
+    for (sk = search_keys; sk->key != NULL; ++sk) {
+        if (strcmp(sk->key, search_key) == 0)
+            break;
+    }
+    if (sk->key == NULL)
+        return _db_sql_search(err_msg, db, table, search_keys, NULL, NULL,
+                              desc, arena, vec);
+
+    value_count = lsm_string_list_size(search_values);
+    /* Each sim id takes at most 20 digits and a comma */
+    sql_len = _BUFF_SIZE + value_count * 21;
+    sql_cmd = (char *) malloc(sql_len);
+    _alloc_null_check(err_msg, sql_cmd, rc, out);
+
+    i = snprintf(sql_cmd, _BUFF_SIZE, "SELECT * FROM %s WHERE %s IN (", table,
+                 sk->sim_id_column);
+    if (i >= _BUFF_SIZE - 3) {
+        rc = LSM_ERR_PLUGIN_BUG;
+        _lsm_err_msg_set(err_msg, "Buff too small");
+        goto out;
+    }
+    sql_len = i;
+
+    for (i = 0; i < value_count; ++i) {
+        /* Not an id this plug-in hands out, nothing can match */
+        sim_id = _db_lsm_id_to_sim_id(lsm_string_list_elem_get(search_values,
+                                                               i));
+        if (sim_id == _DB_SIM_ID_NONE)
+            continue;
+        sql_len += sprintf(sql_cmd + sql_len, "%s%" PRIu64,
+                           (sim_id_count == 0) ? "" : ",", sim_id);
+        ++sim_id_count;
+    }
+    strcpy(sql_cmd + sql_len, ");");
+
+    if (sim_id_count == 0) {
+        *vec = _vector_new(_VECTOR_NO_PRE_ALLOCATION);
+        _alloc_null_check(err_msg, *vec, rc, out);
+        goto out;
+    }
+
+    sql_rc = sqlite3_prepare_v2(db, sql_cmd, -1, &stmt, NULL);
+    if (sql_rc != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        rc = _db_sql_rc_check(err_msg, db, sql_rc);
+        goto out;
+    }
+    rc = _db_stmt_run(err_msg, db, stmt, false /* not cached */, desc, arena,
+                      vec);
+
+ out:
+    free(sql_cmd);
+    return rc;
+}
+
 void _db_sql_exec_vec_free(struct _vector *vec)
 {
     uint32_t i = 0;
@@ -741,33 +1509,97 @@ void _db_sql_exec_vec_free(struct _vector *vec)
 
 void _db_close(sqlite3 *db)
 {
-    assert(db != NULL);
+    if (db == NULL)
+        return;
+    /* Unfinalized statements would keep the connection open */
+    _db_stmt_cache_free(db);
     sqlite3_close(db);
 }
 
+/*
+ * Set while a batch transaction is open, the transactions of the requests in
+ * it then become savepoints so a failed request only undoes its own changes.
+ * The plug-in handles one request at a time.
+ */
+static bool _batch_active = false;
+
 int _db_sql_trans_begin(char *err_msg, sqlite3 *db)
 {
     assert(db != NULL);
-    return _db_sql_exec(err_msg, db, "BEGIN IMMEDIATE TRANSACTION;",
-                        NULL /* don't parse output */);
+    if (_batch_active)
+        return _db_sql_exec_bind(err_msg, db, "SAVEPOINT simc_item;",
+                                 NULL /* don't parse output */, "");
+    return _db_sql_exec_bind(err_msg, db, "BEGIN IMMEDIATE TRANSACTION;",
+                             NULL /* don't parse output */, "");
+}
+
+int _db_sql_trans_begin_read(char *err_msg, sqlite3 *db)
+{
+    assert(db != NULL);
+    if (_batch_active)
+        return _db_sql_exec_bind(err_msg, db, "SAVEPOINT simc_item;",
+                                 NULL /* don't parse output */, "");
+    return _db_sql_exec_bind(err_msg, db, "BEGIN DEFERRED TRANSACTION;",
+                             NULL /* don't parse output */, "");
 }
 
 int _db_sql_trans_commit(char *err_msg, sqlite3 *db)
 {
     assert(db != NULL);
-    return _db_sql_exec(err_msg, db, "COMMIT;", NULL /* don't parse output */);
+    if (_batch_active)
+        return _db_sql_exec_bind(err_msg, db, "RELEASE simc_item;",
+                                 NULL /* don't parse output */, "");
+    return _db_sql_exec_bind(err_msg, db, "COMMIT;",
+                             NULL /* don't parse output */, "");
 }
 
 void _db_sql_trans_rollback(sqlite3 *db)
 {
-    if (db != NULL)
-        _db_sql_exec(NULL /* ignore error message */, db,
-                     "ROLLBACK;", NULL /* don't parse output */);
+    if (db == NULL)
+        return;
+    if (_batch_active) {
+        _db_sql_exec_bind(NULL /* ignore error message */, db,
+                          "ROLLBACK TO simc_item;",
+                          NULL /* don't parse output */, "");
+        _db_sql_exec_bind(NULL /* ignore error message */, db,
+                          "RELEASE simc_item;",
+                          NULL /* don't parse output */, "");
+    } else {
+        _db_sql_exec_bind(NULL /* ignore error message */, db, "ROLLBACK;",
+                          NULL /* don't parse output */, "");
+    }
+}
+
+int _db_sql_batch_begin(char *err_msg, sqlite3 *db)
+{
+    int rc = LSM_ERR_OK;
+
+    assert(db != NULL);
+    rc = _db_sql_exec_bind(err_msg, db, "BEGIN IMMEDIATE TRANSACTION;",
+                           NULL /* don't parse output */, "");
+    if (rc == LSM_ERR_OK)
+        _batch_active = true;
+    return rc;
+}
+
+int _db_sql_batch_commit(char *err_msg, sqlite3 *db)
+{
+    int rc = LSM_ERR_OK;
+
+    assert(db != NULL);
+    _batch_active = false;
+    rc = _db_sql_exec_bind(err_msg, db, "COMMIT;",
+                           NULL /* don't parse output */, "");
+    if (rc != LSM_ERR_OK)
+        _db_sql_exec_bind(NULL /* ignore error message */, db, "ROLLBACK;",
+                          NULL /* don't parse output */, "");
+    return rc;
 }
 
 int _db_data_add(char *err_msg, sqlite3 *db, const char *table_name, ...)
 {
     int rc = LSM_ERR_OK;
+    int sql_rc = SQLITE_OK;
     char sql_cmd[_BUFF_SIZE];
     char keys_str[_BUFF_SIZE];
     char values_str[_BUFF_SIZE];
@@ -775,11 +1607,18 @@ int _db_data_add(char *err_msg, sqlite3 *db, const char *table_name, ...)
     const char *value_str = NULL;
     int keys_printed = 0;
     int values_printed = 0;
+    int i = 0;
+    sqlite3_stmt *stmt = NULL;
+    bool cached = false;
     va_list arg;
 
     assert(db != NULL);
     assert(table_name != NULL);
 
+    keys_str[0] = '\0';
+    values_str[0] = '\0';
+
+    /* Keys make up the statement, values are bound to it afterwards */
     va_start(arg, table_name);
 
     key_str = va_arg(arg, const char *);
@@ -788,12 +1627,12 @@ int _db_data_add(char *err_msg, sqlite3 *db, const char *table_name, ...)
 
     while ((key_str != NULL) && (value_str != NULL)) {
         keys_printed += snprintf(keys_str + keys_printed,
-                                 _BUFF_SIZE - keys_printed,
-                                 "'%s', ", key_str) - 1;
+                                 _BUFF_SIZE - keys_printed, "%s\"%s\"",
+                                 (keys_printed == 0) ? "" : ", ", key_str);
         values_printed += snprintf(values_str + values_printed,
-                                   _BUFF_SIZE - values_printed,
-                                   "'%s', ", value_str) - 1;
-        if ((_BUFF_SIZE == keys_printed) || (_BUFF_SIZE == values_printed)) {
+                                   _BUFF_SIZE - values_printed, "%s",
+                                   (values_printed == 0) ? "?" : ", ?");
+        if ((keys_printed >= _BUFF_SIZE) || (values_printed >= _BUFF_SIZE)) {
             va_end(arg);
             rc = LSM_ERR_PLUGIN_BUG;
             _lsm_err_msg_set(err_msg, "Buff too small");
@@ -805,17 +1644,38 @@ int _db_data_add(char *err_msg, sqlite3 *db, const char *table_name, ...)
     }
     va_end(arg);
 
-    /* Remove the trailing ", " */
-    keys_str[keys_printed - strlen(", ") + 1] = '\0';
-    values_str[values_printed - strlen(", ") + 1] = '\0';
-
     _snprintf_buff(err_msg, rc, out, sql_cmd,
                    "INSERT INTO %s (%s) VALUES (%s);", table_name, keys_str,
                    values_str);
 
-    _good(_db_sql_exec(err_msg, db, sql_cmd,
-                       NULL /* no need to parse output */),
-          rc, out);
+    _good(_db_stmt_get(err_msg, db, sql_cmd, &stmt, &cached), rc, out);
+
+    va_start(arg, table_name);
+
+    key_str = va_arg(arg, const char *);
+    if (key_str != NULL)
+        value_str = va_arg(arg, const char *);
+
+    while ((key_str != NULL) && (value_str != NULL) &&
+           (sql_rc == SQLITE_OK)) {
+        sql_rc = sqlite3_bind_text(stmt, ++i, value_str, -1, SQLITE_STATIC);
+        key_str = va_arg(arg, const char *);
+        if (key_str != NULL)
+            value_str = va_arg(arg, const char *);
+    }
+    va_end(arg);
+
+    if (sql_rc != SQLITE_OK) {
+        rc = _db_sql_rc_check(err_msg, db, sql_rc);
+        if (cached)
+            sqlite3_clear_bindings(stmt);
+        else
+            sqlite3_finalize(stmt);
+        goto out;
+    }
+
+    rc = _db_stmt_run(err_msg, db, stmt, cached, NULL, NULL,
+                      NULL /* no need to parse output */);
 
  out:
 
@@ -825,54 +1685,32 @@ int _db_data_add(char *err_msg, sqlite3 *db, const char *table_name, ...)
 int _db_data_update(char *err_msg, sqlite3 *db, const char *table_name,
                     uint64_t data_id, const char *key, const char *value)
 {
+    int rc = LSM_ERR_OK;
     char sql_cmd[_BUFF_SIZE];
-    if (value == NULL) {
-        if (snprintf(sql_cmd, _BUFF_SIZE, "UPDATE %s SET %s=NULL "
-                     "WHERE id='%" PRIu64 "';", table_name, key,
-                     data_id) == _BUFF_SIZE)
-            goto buff_too_small;
-    } else {
-        if (snprintf(sql_cmd, _BUFF_SIZE, "UPDATE %s SET %s='%s' "
-                     "WHERE id='%" PRIu64 "';", table_name, key, value,
-                     data_id) == _BUFF_SIZE)
-            goto buff_too_small;
-    }
 
-    return _db_sql_exec(err_msg, db, sql_cmd,
-                        NULL /* no need to parse output */);
-buff_too_small:
-    _lsm_err_msg_set(err_msg, "BUG: _db_data_add(): Buff too small");
-    return LSM_ERR_PLUGIN_BUG;
+    _snprintf_buff(err_msg, rc, out, sql_cmd,
+                   "UPDATE %s SET \"%s\" = ? WHERE id = ?;", table_name, key);
+
+    rc = _db_sql_exec_bind(err_msg, db, sql_cmd,
+                           NULL /* no need to parse output */, "si", value,
+                           data_id);
+ out:
+    return rc;
 }
 
 int _db_data_delete(char *err_msg, sqlite3 *db, const char *table_name,
                     uint64_t data_id)
 {
+    int rc = LSM_ERR_OK;
     char sql_cmd[_BUFF_SIZE];
 
-    if (snprintf(sql_cmd, _BUFF_SIZE, "DELETE FROM %s WHERE id=%" PRIu64 ";",
-                 table_name, data_id) == _BUFF_SIZE) {
-        _lsm_err_msg_set(err_msg, "BUG: _db_data_add(): Buff too small");
-        return LSM_ERR_PLUGIN_BUG;
-    }
-
-    return _db_sql_exec(err_msg, db, sql_cmd,
-                        NULL /* no need to parse output */);
-}
-
-int _db_data_delete_condition(char *err_msg, sqlite3 *db,
-                              const char *table_name, const char *condition)
-{
-    char sql_cmd[_BUFF_SIZE];
-
-    if (snprintf(sql_cmd, _BUFF_SIZE, "DELETE FROM %s WHERE %s;",
-                 table_name, condition) == _BUFF_SIZE) {
-        _lsm_err_msg_set(err_msg, "BUG: _db_data_add(): Buff too small");
-        return LSM_ERR_PLUGIN_BUG;
-    }
+    _snprintf_buff(err_msg, rc, out, sql_cmd,
+                   "DELETE FROM %s WHERE id = ?;", table_name);
 
-    return _db_sql_exec(err_msg, db, sql_cmd,
-                        NULL /* no need to parse output */);
+    rc = _db_sql_exec_bind(err_msg, db, sql_cmd,
+                           NULL /* no need to parse output */, "i", data_id);
+ out:
+    return rc;
 }
 
 const char *_db_lsm_id_to_sim_id_str(const char *lsm_id)
@@ -982,9 +1820,10 @@ static int _db_sim_xxx_of_sim_id(char *err_msg, sqlite3 *db,
     }
 
     _snprintf_buff(err_msg, rc, out, sql_cmd,
-                   "SELECT * FROM %s WHERE id=%" PRIu64, table_name, sim_id);
+                   "SELECT * FROM %s WHERE id = ?;", table_name);
 
-    _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db, sql_cmd, &vec, "i", sim_id),
+          rc, out);
 
     if (_vector_size(vec) == 1) {
         *sim_xxx = _vector_get(vec, 0);
@@ -1073,6 +1912,117 @@ int _db_sim_disk_of_sim_id(char *err_msg, sqlite3 *db, uint64_t sim_disk_id,
                                  "Disk not found");
 }
 
+static int _db_row_of_sim_id(char *err_msg, sqlite3 *db,
+                             const char *table_name,
+                             const struct _db_row_desc *desc, uint64_t sim_id,
+                             struct _arena *arena, void **row,
+                             int not_found_err, const char *not_found_err_str)
+{
+    int rc = LSM_ERR_OK;
+    struct _vector *vec = NULL;
+    char sql_cmd[_BUFF_SIZE];
+
+    assert(db != NULL);
+    assert(table_name != NULL);
+    assert(row != NULL);
+
+    *row = NULL;
+
+    if (sim_id == _DB_SIM_ID_NONE) {
+        rc = not_found_err;
+        _lsm_err_msg_set(err_msg, "%s", not_found_err_str);
+        goto out;
+    }
+
+    _snprintf_buff(err_msg, rc, out, sql_cmd,
+                   "SELECT * FROM %s WHERE id = ?;", table_name);
+
+    _good(_db_sql_exec_rows(err_msg, db, sql_cmd, desc, arena, &vec, "i",
+                            sim_id),
+          rc, out);
+
+    if (_vector_size(vec) == 1) {
+        *row = _vector_get(vec, 0);
+    } else if (_vector_size(vec) == 0) {
+        rc = not_found_err;
+        _lsm_err_msg_set(err_msg, "%s", not_found_err_str);
+    } else {
+        rc = LSM_ERR_PLUGIN_BUG;
+        _lsm_err_msg_set(err_msg, "Got more than 1 data with id %" PRIu64
+                         "in table %s", sim_id, table_name);
+    }
+
+ out:
+    _vector_free(vec);
+    if (rc != LSM_ERR_OK)
+        *row = NULL;
+    return rc;
+}
+
+int _db_vol_row_of_sim_id(char *err_msg, sqlite3 *db, uint64_t sim_vol_id,
+                          struct _arena *arena, struct _db_vol_row **vol_row)
+{
+    void *row = NULL;
+    int rc = _db_row_of_sim_id(err_msg, db, _DB_TABLE_VOLS_VIEW,
+                               &_db_vol_row_desc, sim_vol_id, arena, &row,
+                               LSM_ERR_NOT_FOUND_VOLUME, "Volume not found");
+
+    *vol_row = (struct _db_vol_row *) row;
+    return rc;
+}
+
+int _db_ag_row_of_sim_id(char *err_msg, sqlite3 *db, uint64_t sim_ag_id,
+                         struct _arena *arena, struct _db_ag_row **ag_row)
+{
+    void *row = NULL;
+    int rc = _db_row_of_sim_id(err_msg, db, _DB_TABLE_AGS_VIEW,
+                               &_db_ag_row_desc, sim_ag_id, arena, &row,
+                               LSM_ERR_NOT_FOUND_ACCESS_GROUP,
+                               "Access group not found");
+
+    *ag_row = (struct _db_ag_row *) row;
+    return rc;
+}
+
+int _db_fs_row_of_sim_id(char *err_msg, sqlite3 *db, uint64_t sim_fs_id,
+                         struct _arena *arena, struct _db_fs_row **fs_row)
+{
+    void *row = NULL;
+    int rc = _db_row_of_sim_id(err_msg, db, _DB_TABLE_FSS_VIEW,
+                               &_db_fs_row_desc, sim_fs_id, arena, &row,
+                               LSM_ERR_NOT_FOUND_FS, "FS not found");
+
+    *fs_row = (struct _db_fs_row *) row;
+    return rc;
+}
+
+int _db_fs_snap_row_of_sim_id(char *err_msg, sqlite3 *db,
+                              uint64_t sim_fs_snap_id, struct _arena *arena,
+                              struct _db_fs_snap_row **fs_snap_row)
+{
+    void *row = NULL;
+    int rc = _db_row_of_sim_id(err_msg, db, _DB_TABLE_FS_SNAPS_VIEW,
+                               &_db_fs_snap_row_desc, sim_fs_snap_id, arena,
+                               &row, LSM_ERR_NOT_FOUND_FS_SS,
+                               "FS snapshot not found");
+
+    *fs_snap_row = (struct _db_fs_snap_row *) row;
+    return rc;
+}
+
+int _db_exp_row_of_sim_id(char *err_msg, sqlite3 *db, uint64_t sim_exp_id,
+                          struct _arena *arena, struct _db_exp_row **exp_row)
+{
+    void *row = NULL;
+    int rc = _db_row_of_sim_id(err_msg, db, _DB_TABLE_NFS_EXPS_VIEW,
+                               &_db_exp_row_desc, sim_exp_id, arena, &row,
+                               LSM_ERR_NOT_FOUND_NFS_EXPORT,
+                               "NFS export not found");
+
+    *exp_row = (struct _db_exp_row *) row;
+    return rc;
+}
+
 int _db_volume_raid_create_cap_get(char *err_msg,
                                    uint32_t **supported_raid_types,
                                    uint32_t *supported_raid_type_count,
@@ -17,15 +17,17 @@
  */
 
 #ifndef _SIMC_DB_H_
-#define _SIMC_DB_H
+#define _SIMC_DB_H_
 
 #include <sqlite3.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#include "arena.h"
 #include "vector.h"
 #include "utils.h"
 
-#define _DB_VERSION                                         "4.1"
+#define _DB_VERSION                                         "4.3"
 
 #define _SYS_ID                                             "sim-01"
 
@@ -46,6 +48,7 @@
 #define _DB_TABLE_SYS                                       "systems"
 #define _DB_TABLE_POOLS_VIEW                                "pools_view"
 #define _DB_TABLE_POOLS                                     "pools"
+#define _DB_TABLE_POOL_USAGE                                "pool_usage"
 #define _DB_TABLE_VOLS_VIEW                                 "volumes_view"
 #define _DB_TABLE_VOLS                                      "volumes"
 #define _DB_TABLE_DISKS_VIEW                                "disks_view"
@@ -91,14 +94,233 @@ int _db_init(char *err_msg, sqlite3 **db, const char *db_file,
 int _db_sql_exec(char *err_msg, sqlite3 *db, const char *cmd,
                  struct _vector **vec);
 
+/*
+ * Like _db_sql_exec() for a single statement whose '?' parameters are bound
+ * from the va_args, one for each character of types:
+ *      's'     const char *, NULL binds NULL
+ *      'i'     uint64_t
+ * The statement is prepared once and kept for the connection, so sql must
+ * only be made of table and column names, never of values.  vec may be
+ * NULL when the rows are not needed.
+ */
+int _db_sql_exec_bind(char *err_msg, sqlite3 *db, const char *sql,
+                      struct _vector **vec, const char *types, ...);
+
+/*
+ * Typed rows for the list paths.  Each column listed in a _db_row_desc is
+ * decoded straight from the statement into the member at its offset:
+ * integers by sqlite3_column_int64() and text copied into the arena of the
+ * query, with NULL as "".  Column indexes are looked up by name once per
+ * query, not per row.  Row structs of tables with an integer id start with
+ * it, see _db_row_sim_id().
+ */
+enum _db_col_type {
+    _DB_COL_INT,                /* uint64_t, signed values kept as is */
+    _DB_COL_TEXT,               /* const char * */
+};
+
+struct _db_col {
+    const char *name;
+    enum _db_col_type type;
+    size_t offset;
+};
+
+struct _db_row_desc {
+    size_t size;
+    const struct _db_col *cols; /* NULL name terminated */
+};
+
+#define _db_row_sim_id(row)     (*(const uint64_t *) (row))
+
+struct _db_sys_row {
+    const char *id;
+    const char *name;
+    uint64_t status;
+    const char *status_info;
+    uint64_t read_cache_pct;
+    const char *version;
+};
+
+struct _db_pool_row {
+    uint64_t id;
+    const char *lsm_pool_id;
+    const char *name;
+    uint64_t status;
+    const char *status_info;
+    uint64_t element_type;
+    uint64_t unsupported_actions;
+    uint64_t total_space;
+    uint64_t free_space;
+};
+
+struct _db_vol_row {
+    uint64_t id;
+    const char *lsm_vol_id;
+    const char *name;
+    const char *vpd83;
+    uint64_t total_space;
+    uint64_t admin_state;
+    const char *lsm_pool_id;
+};
+
+struct _db_disk_row {
+    uint64_t id;
+    const char *lsm_disk_id;
+    const char *name;
+    uint64_t total_space;
+    uint64_t disk_type;
+    const char *role;
+    uint64_t status;
+    const char *vpd83;
+    uint64_t rpm;
+    uint64_t link_type;
+    const char *location;
+};
+
+struct _db_ag_row {
+    uint64_t id;
+    const char *lsm_ag_id;
+    const char *name;
+    uint64_t init_type;
+    const char *init_ids_str;
+};
+
+struct _db_tgt_row {
+    uint64_t id;
+    const char *lsm_tgt_id;
+    uint64_t port_type;
+    const char *service_address;
+    const char *network_address;
+    const char *physical_address;
+    const char *physical_name;
+};
+
+struct _db_fs_row {
+    uint64_t id;
+    const char *lsm_fs_id;
+    const char *name;
+    uint64_t total_space;
+    uint64_t free_space;
+    const char *lsm_pool_id;
+};
+
+struct _db_fs_snap_row {
+    uint64_t id;
+    const char *lsm_fs_snap_id;
+    const char *name;
+    uint64_t timestamp;
+};
+
+struct _db_exp_row {
+    uint64_t id;
+    const char *lsm_exp_id;
+    const char *lsm_fs_id;
+    const char *exp_path;
+    const char *auth_type;
+    uint64_t anon_uid;
+    uint64_t anon_gid;
+    const char *options;
+    const char *exp_root_hosts_str;
+    const char *exp_rw_hosts_str;
+    const char *exp_ro_hosts_str;
+};
+
+struct _db_bat_row {
+    uint64_t id;
+    const char *lsm_bat_id;
+    const char *name;
+    uint64_t type;
+    uint64_t status;
+};
+
+extern const struct _db_row_desc _db_sys_row_desc;
+extern const struct _db_row_desc _db_pool_row_desc;
+extern const struct _db_row_desc _db_vol_row_desc;
+extern const struct _db_row_desc _db_disk_row_desc;
+extern const struct _db_row_desc _db_ag_row_desc;
+extern const struct _db_row_desc _db_tgt_row_desc;
+extern const struct _db_row_desc _db_fs_row_desc;
+extern const struct _db_row_desc _db_fs_snap_row_desc;
+extern const struct _db_row_desc _db_exp_row_desc;
+extern const struct _db_row_desc _db_bat_row_desc;
+
+/*
+ * Like _db_sql_exec_bind(), but decodes the rows as desc into the vec, the
+ * rows and their strings are allocated from arena.  Free the vec with
+ * _vector_free() and the rows with _arena_free().
+ */
+int _db_sql_exec_rows(char *err_msg, sqlite3 *db, const char *sql,
+                      const struct _db_row_desc *desc, struct _arena *arena,
+                      struct _vector **vec, const char *types, ...);
+
+/*
+ * Search key a list view can answer with a WHERE clause.  The lsm id is
+ * matched on the integer column it was generated from, so the lookup uses
+ * the primary key or an index instead of scanning the whole view.
+ */
+struct _db_search_key {
+    const char *key;            /* search_key as sent by the client */
+    const char *sim_id_column;  /* integer column of the view */
+    const char *lsm_id_column;  /* lsm id column generated from it */
+};
+
+/*
+ * Like _db_sql_exec_rows() with "SELECT * FROM <table>;", but only returns
+ * the rows matching search_key/search_value when search_key is
+ * "system_id" or one of the NULL key terminated search_keys.  Any other
+ * search_key returns every row, to be filtered by the caller.
+ */
+int _db_sql_search(char *err_msg, sqlite3 *db, const char *table,
+                   const struct _db_search_key *search_keys,
+                   const char *search_key, const char *search_value,
+                   const struct _db_row_desc *desc, struct _arena *arena,
+                   struct _vector **vec);
+
+/*
+ * Same as _db_sql_search(), but only returns up to 'limit' rows whose
+ * integer "id" column is bigger than after_sim_id, ordered by that column.
+ * A limit of 0 means no limit.
+ */
+int _db_sql_search_page(char *err_msg, sqlite3 *db, const char *table,
+                        const struct _db_search_key *search_keys,
+                        const char *search_key, const char *search_value,
+                        uint64_t after_sim_id, uint32_t limit,
+                        const struct _db_row_desc *desc,
+                        struct _arena *arena, struct _vector **vec);
+
+/*
+ * Same as _db_sql_search(), but matches any of search_values.  Rows are
+ * selected on the integer column only, the caller should still check the
+ * lsm id of what comes back.
+ */
+int _db_sql_search_in(char *err_msg, sqlite3 *db, const char *table,
+                      const struct _db_search_key *search_keys,
+                      const char *search_key, lsm_string_list *search_values,
+                      const struct _db_row_desc *desc, struct _arena *arena,
+                      struct _vector **vec);
+
 void _db_sql_exec_vec_free(struct _vector *vec);
 
 void _db_close(sqlite3 *db);
 
 int _db_sql_trans_begin(char *err_msg, sqlite3 *db);
+/*
+ * Start a deferred transaction for requests which only read.  It takes no
+ * lock until the first query and then reads a snapshot of the state file
+ * without blocking other plug-in processes.  Ended by either
+ * _db_sql_trans_commit() or _db_sql_trans_rollback().
+ */
+int _db_sql_trans_begin_read(char *err_msg, sqlite3 *db);
 int _db_sql_trans_commit(char *err_msg, sqlite3 *db);
 void _db_sql_trans_rollback(sqlite3 *db);
 
+/*
+ * Wrap several requests in one transaction, in between the
+ * _db_sql_trans_*() functions above work on savepoints instead.
+ */
+int _db_sql_batch_begin(char *err_msg, sqlite3 *db);
+int _db_sql_batch_commit(char *err_msg, sqlite3 *db);
+
 /*
  * The ... va_arg should be NULL terminated strings.
  */
@@ -110,9 +332,6 @@ int _db_data_update(char *err_msg, sqlite3 *db, const char *table_name,
 int _db_data_delete(char *err_msg, sqlite3 *db, const char *table_name,
                     uint64_t data_id);
 
-int _db_data_delete_condition(char *err_msg, sqlite3 *db,
-                              const char *table_name, const char *condition);
-
 const char *_db_lsm_id_to_sim_id_str(const char *lsm_id);
 
 uint64_t _db_lsm_id_to_sim_id(const char *lsm_id);
@@ -154,6 +373,26 @@ int _db_sim_exp_of_sim_id(char *err_msg, sqlite3 *db, uint64_t sim_exp_id,
 int _db_sim_disk_of_sim_id(char *err_msg, sqlite3 *db, uint64_t sim_disk_id,
                            lsm_hash **sim_disk);
 
+/*
+ * Typed row variants of the above for rows handed back to the client, the
+ * row is allocated from arena.
+ */
+int _db_vol_row_of_sim_id(char *err_msg, sqlite3 *db, uint64_t sim_vol_id,
+                          struct _arena *arena, struct _db_vol_row **vol_row);
+
+int _db_ag_row_of_sim_id(char *err_msg, sqlite3 *db, uint64_t sim_ag_id,
+                         struct _arena *arena, struct _db_ag_row **ag_row);
+
+int _db_fs_row_of_sim_id(char *err_msg, sqlite3 *db, uint64_t sim_fs_id,
+                         struct _arena *arena, struct _db_fs_row **fs_row);
+
+int _db_fs_snap_row_of_sim_id(char *err_msg, sqlite3 *db,
+                              uint64_t sim_fs_snap_id, struct _arena *arena,
+                              struct _db_fs_snap_row **fs_snap_row);
+
+int _db_exp_row_of_sim_id(char *err_msg, sqlite3 *db, uint64_t sim_exp_id,
+                          struct _arena *arena, struct _db_exp_row **exp_row);
+
 /*
  * This function does not check whether disk is free!
  */
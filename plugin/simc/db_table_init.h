@@ -24,6 +24,207 @@
 #define _LSM_ACCESS_GROUP_INIT_TYPE_ISCSI_WWPN_MIXED_STR    "7"
 #define _LSM_ACCESS_GROUP_INIT_TYPE_UNKNOWN_STR             "0"
 
+/*
+ * Indexes on the columns used by joins, view filters and foreign key
+ * cascades.  Kept apart from _TABLE_INIT so that _db_init() can also apply
+ * them when upgrading a state file created by an older _DB_VERSION.
+ */
+#define _INDEX_INIT \
+    "CREATE INDEX IF NOT EXISTS pools_parent_pool_id_idx\n" \
+    "    ON " _DB_TABLE_POOLS "(parent_pool_id);\n" \
+    "CREATE INDEX IF NOT EXISTS disks_owner_pool_id_idx\n" \
+    "    ON " _DB_TABLE_DISKS "(owner_pool_id);\n" \
+    "CREATE INDEX IF NOT EXISTS volumes_pool_id_idx\n" \
+    "    ON " _DB_TABLE_VOLS "(pool_id);\n" \
+    "CREATE INDEX IF NOT EXISTS inits_owner_ag_id_idx\n" \
+    "    ON " _DB_TABLE_INITS "(owner_ag_id);\n" \
+    "CREATE INDEX IF NOT EXISTS vol_masks_vol_id_idx\n" \
+    "    ON " _DB_TABLE_VOL_MASKS "(vol_id);\n" \
+    "CREATE INDEX IF NOT EXISTS vol_masks_ag_id_idx\n" \
+    "    ON " _DB_TABLE_VOL_MASKS "(ag_id);\n" \
+    "CREATE INDEX IF NOT EXISTS vol_reps_src_vol_id_idx\n" \
+    "    ON " _DB_TABLE_VOL_REPS "(src_vol_id);\n" \
+    "CREATE INDEX IF NOT EXISTS vol_reps_dst_vol_id_idx\n" \
+    "    ON " _DB_TABLE_VOL_REPS "(dst_vol_id);\n" \
+    "CREATE INDEX IF NOT EXISTS fss_pool_id_idx\n" \
+    "    ON " _DB_TABLE_FSS "(pool_id);\n" \
+    "CREATE INDEX IF NOT EXISTS fs_snaps_fs_id_idx\n" \
+    "    ON " _DB_TABLE_FS_SNAPS "(fs_id);\n" \
+    "CREATE INDEX IF NOT EXISTS fs_clones_src_fs_id_idx\n" \
+    "    ON " _DB_TABLE_FS_CLONES "(src_fs_id);\n" \
+    "CREATE INDEX IF NOT EXISTS fs_clones_dst_fs_id_idx\n" \
+    "    ON " _DB_TABLE_FS_CLONES "(dst_fs_id);\n" \
+    "CREATE INDEX IF NOT EXISTS exps_fs_id_idx\n" \
+    "    ON " _DB_TABLE_NFS_EXPS "(fs_id);\n" \
+    "CREATE INDEX IF NOT EXISTS exp_root_hosts_exp_id_idx\n" \
+    "    ON " _DB_TABLE_NFS_EXP_ROOT_HOSTS "(exp_id);\n" \
+    "CREATE INDEX IF NOT EXISTS exp_rw_hosts_exp_id_idx\n" \
+    "    ON " _DB_TABLE_NFS_EXP_RW_HOSTS "(exp_id);\n" \
+    "CREATE INDEX IF NOT EXISTS exp_ro_hosts_exp_id_idx\n" \
+    "    ON " _DB_TABLE_NFS_EXP_RO_HOSTS "(exp_id);\n"
+
+/*
+ * Per-pool disk counts and consumed space, kept up to date by the triggers
+ * below on every change to disks, volumes, file systems and sub-pools so
+ * that reading a pool does not aggregate those tables.  consumed_space is
+ * the space used by volumes, file systems and sub-pools allocated from the
+ * pool.  The trailing statement rebuilds the counters from scratch, it does
+ * nothing on a new state file and fills them in when upgrading.
+ */
+#define _POOL_USAGE_INIT \
+    "CREATE TABLE IF NOT EXISTS " _DB_TABLE_POOL_USAGE " (\n" \
+    "    pool_id INTEGER PRIMARY KEY,\n" \
+    "    disk_count INTEGER NOT NULL DEFAULT 0,\n" \
+    "    data_disk_count INTEGER NOT NULL DEFAULT 0,\n" \
+    "    data_disk_space LONG NOT NULL DEFAULT 0,\n" \
+    "    consumed_space LONG NOT NULL DEFAULT 0,\n" \
+    "    FOREIGN KEY(pool_id)\n" \
+    "    REFERENCES pools(id) ON DELETE CASCADE);\n" \
+    "CREATE TRIGGER IF NOT EXISTS pool_usage_pool_insert\n" \
+    "    AFTER INSERT ON pools\n" \
+    "BEGIN\n" \
+    "    INSERT INTO " _DB_TABLE_POOL_USAGE " (pool_id) VALUES (NEW.id);\n" \
+    "    UPDATE " _DB_TABLE_POOL_USAGE "\n" \
+    "        SET consumed_space =\n" \
+    "            consumed_space + ifnull(NEW.total_space, 0)\n" \
+    "        WHERE pool_id = NEW.parent_pool_id;\n" \
+    "END;\n" \
+    "CREATE TRIGGER IF NOT EXISTS pool_usage_pool_update\n" \
+    "    AFTER UPDATE OF total_space, parent_pool_id ON pools\n" \
+    "BEGIN\n" \
+    "    UPDATE " _DB_TABLE_POOL_USAGE "\n" \
+    "        SET consumed_space =\n" \
+    "            consumed_space - ifnull(OLD.total_space, 0)\n" \
+    "        WHERE pool_id = OLD.parent_pool_id;\n" \
+    "    UPDATE " _DB_TABLE_POOL_USAGE "\n" \
+    "        SET consumed_space =\n" \
+    "            consumed_space + ifnull(NEW.total_space, 0)\n" \
+    "        WHERE pool_id = NEW.parent_pool_id;\n" \
+    "END;\n" \
+    "CREATE TRIGGER IF NOT EXISTS pool_usage_pool_delete\n" \
+    "    AFTER DELETE ON pools\n" \
+    "BEGIN\n" \
+    "    UPDATE " _DB_TABLE_POOL_USAGE "\n" \
+    "        SET consumed_space =\n" \
+    "            consumed_space - ifnull(OLD.total_space, 0)\n" \
+    "        WHERE pool_id = OLD.parent_pool_id;\n" \
+    "END;\n" \
+    "CREATE TRIGGER IF NOT EXISTS pool_usage_disk_insert\n" \
+    "    AFTER INSERT ON disks\n" \
+    "BEGIN\n" \
+    _POOL_USAGE_DISK_UPDATE("NEW", "+") \
+    "END;\n" \
+    "CREATE TRIGGER IF NOT EXISTS pool_usage_disk_update\n" \
+    "    AFTER UPDATE OF owner_pool_id, role, total_space ON disks\n" \
+    "BEGIN\n" \
+    _POOL_USAGE_DISK_UPDATE("OLD", "-") \
+    _POOL_USAGE_DISK_UPDATE("NEW", "+") \
+    "END;\n" \
+    "CREATE TRIGGER IF NOT EXISTS pool_usage_disk_delete\n" \
+    "    AFTER DELETE ON disks\n" \
+    "BEGIN\n" \
+    _POOL_USAGE_DISK_UPDATE("OLD", "-") \
+    "END;\n" \
+    _POOL_USAGE_CONSUMER_TRIGGERS("vol", _DB_TABLE_VOLS) \
+    _POOL_USAGE_CONSUMER_TRIGGERS("fs", _DB_TABLE_FSS) \
+    "INSERT OR REPLACE INTO " _DB_TABLE_POOL_USAGE "\n" \
+    "    SELECT\n" \
+    "        pool.id,\n" \
+    "        (SELECT COUNT(*) FROM disks\n" \
+    "            WHERE owner_pool_id = pool.id),\n" \
+    "        (SELECT COUNT(*) FROM disks\n" \
+    "            WHERE owner_pool_id = pool.id AND role = 'DATA'),\n" \
+    "        (SELECT ifnull(SUM(total_space), 0) FROM disks\n" \
+    "            WHERE owner_pool_id = pool.id AND role = 'DATA'),\n" \
+    "        (SELECT ifnull(SUM(consumed_size), 0) FROM " _DB_TABLE_VOLS "\n" \
+    "            WHERE pool_id = pool.id) +\n" \
+    "        (SELECT ifnull(SUM(consumed_size), 0) FROM " _DB_TABLE_FSS "\n" \
+    "            WHERE pool_id = pool.id) +\n" \
+    "        (SELECT ifnull(SUM(total_space), 0) FROM pools\n" \
+    "            WHERE parent_pool_id = pool.id)\n" \
+    "    FROM\n" \
+    "        pools pool;\n"
+
+/*
+ * Add (op "+") or remove (op "-") disk row 'row' from its owner pool.
+ */
+#define _POOL_USAGE_DISK_UPDATE(row, op) \
+    "    UPDATE " _DB_TABLE_POOL_USAGE " SET\n" \
+    "        disk_count = disk_count " op " 1,\n" \
+    "        data_disk_count = data_disk_count " op "\n" \
+    "            CASE WHEN " row ".role = 'DATA' THEN 1 ELSE 0 END,\n" \
+    "        data_disk_space = data_disk_space " op "\n" \
+    "            CASE WHEN " row ".role = 'DATA'\n" \
+    "                THEN " row ".total_space ELSE 0 END\n" \
+    "        WHERE pool_id = " row ".owner_pool_id;\n"
+
+/*
+ * Triggers charging consumed_size of volumes or file systems in 'table' to
+ * their pool_id.
+ */
+#define _POOL_USAGE_CONSUMER_TRIGGERS(name, table) \
+    "CREATE TRIGGER IF NOT EXISTS pool_usage_" name "_insert\n" \
+    "    AFTER INSERT ON " table "\n" \
+    "BEGIN\n" \
+    "    UPDATE " _DB_TABLE_POOL_USAGE "\n" \
+    "        SET consumed_space = consumed_space + NEW.consumed_size\n" \
+    "        WHERE pool_id = NEW.pool_id;\n" \
+    "END;\n" \
+    "CREATE TRIGGER IF NOT EXISTS pool_usage_" name "_update\n" \
+    "    AFTER UPDATE OF consumed_size, pool_id ON " table "\n" \
+    "BEGIN\n" \
+    "    UPDATE " _DB_TABLE_POOL_USAGE "\n" \
+    "        SET consumed_space = consumed_space - OLD.consumed_size\n" \
+    "        WHERE pool_id = OLD.pool_id;\n" \
+    "    UPDATE " _DB_TABLE_POOL_USAGE "\n" \
+    "        SET consumed_space = consumed_space + NEW.consumed_size\n" \
+    "        WHERE pool_id = NEW.pool_id;\n" \
+    "END;\n" \
+    "CREATE TRIGGER IF NOT EXISTS pool_usage_" name "_delete\n" \
+    "    AFTER DELETE ON " table "\n" \
+    "BEGIN\n" \
+    "    UPDATE " _DB_TABLE_POOL_USAGE "\n" \
+    "        SET consumed_space = consumed_space - OLD.consumed_size\n" \
+    "        WHERE pool_id = OLD.pool_id;\n" \
+    "END;\n"
+
+#define _POOLS_VIEW_INIT \
+    "CREATE VIEW " _DB_TABLE_POOLS_VIEW " AS\n" \
+    "    SELECT\n" \
+    "        pool.id,\n" \
+    "            'POOL_ID_' || \n" \
+    "                SUBSTR('" _DB_ID_PADDING "' || pool.id, \n" \
+    "                       -" _DB_ID_FMT_LEN_STR ", " \
+    _DB_ID_FMT_LEN_STR ")\n" \
+    "        lsm_pool_id,\n" \
+    "        pool.name,\n" \
+    "        pool.status,\n" \
+    "        pool.status_info,\n" \
+    "        pool.element_type,\n" \
+    "        pool.unsupported_actions,\n" \
+    "        pool.raid_type,\n" \
+    "        pool.member_type,\n" \
+    "        pool.parent_pool_id,\n" \
+    "            'POOL_ID_' || \n" \
+    "                SUBSTR('" _DB_ID_PADDING "' || pool.parent_pool_id,\n" \
+    "                       -" _DB_ID_FMT_LEN_STR ", " \
+    _DB_ID_FMT_LEN_STR ")\n" \
+    "        parent_lsm_pool_id,\n" \
+    "        pool.strip_size,\n" \
+    "            ifnull(pool.total_space, " _DB_TABLE_POOL_USAGE \
+    ".data_disk_space)\n" \
+    "        total_space,\n" \
+    "            ifnull(pool.total_space, " _DB_TABLE_POOL_USAGE \
+    ".data_disk_space) -\n" \
+    "            " _DB_TABLE_POOL_USAGE ".consumed_space\n" \
+    "        free_space,\n" \
+    "        " _DB_TABLE_POOL_USAGE ".data_disk_count,\n" \
+    "        " _DB_TABLE_POOL_USAGE ".disk_count\n" \
+    "    FROM\n" \
+    "        pools pool\n" \
+    "            LEFT JOIN " _DB_TABLE_POOL_USAGE "\n" \
+    "                ON " _DB_TABLE_POOL_USAGE ".pool_id = pool.id;\n"
+
 static const char *_TABLE_INIT =
     "PRAGMA foreign_keys = ON;\n"
     "CREATE TABLE " _DB_TABLE_SYS " (\n"
@@ -168,95 +369,9 @@ static const char *_TABLE_INIT =
     "    name TEXT NOT NULL,\n"
     "    type INTEGER NOT NULL,\n"
     "    status INTEGER NOT NULL);\n"
+    _POOL_USAGE_INIT
     /* Create views */
-    "CREATE VIEW " _DB_TABLE_POOLS_VIEW " AS\n"
-    "    SELECT\n"
-    "        pool0.id,\n"
-    "            'POOL_ID_' || \n"
-    "                SUBSTR('" _DB_ID_PADDING "' || pool0.id, \n"
-    "                       -" _DB_ID_FMT_LEN_STR ", " _DB_ID_FMT_LEN_STR ")\n"
-    "        lsm_pool_id,\n"
-    "        pool0.name,\n"
-    "        pool0.status,\n"
-    "        pool0.status_info,\n"
-    "        pool0.element_type,\n"
-    "        pool0.unsupported_actions,\n"
-    "        pool0.raid_type,\n"
-    "        pool0.member_type,\n"
-    "        pool0.parent_pool_id,\n"
-    "            'POOL_ID_' || \n"
-    "                SUBSTR('" _DB_ID_PADDING "' || pool0.parent_pool_id, \n"
-    "                       -" _DB_ID_FMT_LEN_STR ", " _DB_ID_FMT_LEN_STR ")\n"
-    "        parent_lsm_pool_id,\n"
-    "        pool0.strip_size,\n"
-    "        pool1.total_space total_space,\n"
-    "        pool1.total_space -\n"
-    "        pool2.vol_consumed_size  -\n"
-    "        pool3.fs_consumed_size -\n"
-    "        pool4.sub_pool_consumed_size free_space,\n"
-    "        pool1.data_disk_count,\n"
-    "        pool5.disk_count\n"
-    "    FROM\n"
-    "        pools pool0\n"
-    "            LEFT JOIN (\n"
-    "                SELECT\n"
-    "                    pool.id,\n"
-    "                        ifnull(pool.total_space,\n"
-    "                            ifnull(SUM(disk.total_space), 0))\n"
-    "                    total_space,\n"
-    "                    COUNT(disk.id) data_disk_count\n"
-    "                FROM pools pool\n"
-    "                    LEFT JOIN disks disk\n"
-    "                        ON pool.id = disk.owner_pool_id AND\n"
-    "                            disk.role = 'DATA'\n"
-    "                GROUP BY\n"
-    "                    pool.id\n"
-    "            ) pool1 ON pool0.id = pool1.id\n"
-    "            LEFT JOIN (\n"
-    "                SELECT\n"
-    "                    pool.id,\n"
-    "                        ifnull(SUM(volume.consumed_size), 0)\n"
-    "                    vol_consumed_size\n"
-    "                FROM pools pool\n"
-    "                    LEFT JOIN volumes volume\n"
-    "                        ON volume.pool_id = pool.id\n"
-    "                GROUP BY\n"
-    "                    pool.id\n"
-    "            ) pool2 ON pool0.id = pool2.id\n"
-    "            LEFT JOIN (\n"
-    "                SELECT\n"
-    "                    pool.id,\n"
-    "                        ifnull(SUM(fs.consumed_size), 0)\n"
-    "                    fs_consumed_size\n"
-    "                FROM pools pool\n"
-    "                    LEFT JOIN fss fs\n"
-    "                        ON fs.pool_id = pool.id\n"
-    "                GROUP BY\n"
-    "                    pool.id\n"
-    "            ) pool3 ON pool0.id = pool3.id\n"
-    "            LEFT JOIN (\n"
-    "                SELECT\n"
-    "                    pool.id,\n"
-    "                        ifnull(SUM(sub_pool.total_space), 0)\n"
-    "                    sub_pool_consumed_size\n"
-    "                FROM pools pool\n"
-    "                    LEFT JOIN pools sub_pool\n"
-    "                        ON sub_pool.parent_pool_id = pool.id\n"
-    "                GROUP BY\n"
-    "                    pool.id\n"
-    "            ) pool4 ON pool0.id = pool4.id\n"
-    "            LEFT JOIN (\n"
-    "            SELECT\n"
-    "                pool.id,\n"
-    "                COUNT(disk.id) disk_count\n"
-    "            FROM pools pool\n"
-    "                LEFT JOIN disks disk\n"
-    "                    ON pool.id = disk.owner_pool_id\n"
-    "            GROUP BY\n"
-    "                pool.id\n"
-    "            ) pool5 ON pool0.id = pool5.id\n"
-    "    GROUP BY\n"
-    "         pool0.id;\n"
+    _POOLS_VIEW_INIT
     "CREATE VIEW " _DB_TABLE_TGTS_VIEW " AS\n"
     "    SELECT\n"
     "        id,\n"
@@ -515,6 +630,8 @@ static const char *_TABLE_INIT =
     "                ON exp.id = exp4.id\n"
     "    GROUP BY\n"
     "        exp.id;\n"
+    /* Create indexes */
+    _INDEX_INIT
 ;
 
 #endif  /* End of _SIMC_DB_TABLE_INIT_H_ */
@@ -34,30 +34,36 @@
 static int _fs_create_internal(char *err_msg, sqlite3 *db, const char *name,
                                uint64_t size, uint64_t sim_pool_id);
 
+static const struct _db_search_key _fs_search_keys[] = {
+    {"id", "id", "lsm_fs_id"},
+    {"pool_id", "pool_id", "lsm_pool_id"},
+    {NULL, NULL, NULL},
+};
+
 _xxx_list_func_gen(fs_list, lsm_fs, _sim_fs_to_lsm,
                    lsm_plug_fs_search_filter, _DB_TABLE_FSS_VIEW,
-                   lsm_fs_record_array_free);
+                   _db_fs_row_desc, _fs_search_keys, lsm_fs_record_array_free);
+
+_xxx_list_page_func_gen(fs_list_page, lsm_fs, _sim_fs_to_lsm,
+                        lsm_plug_fs_search_filter, _DB_TABLE_FSS_VIEW,
+                        _db_fs_row_desc, _fs_search_keys,
+                        lsm_fs_record_array_free);
+
+_xxx_list_in_func_gen(fs_list_in, lsm_fs, _sim_fs_to_lsm,
+                      lsm_plug_fs_search_filter_in, _DB_TABLE_FSS_VIEW,
+                      _db_fs_row_desc, _fs_search_keys,
+                      lsm_fs_record_array_free);
 
-lsm_fs *_sim_fs_to_lsm(char *err_msg, lsm_hash *sim_fs)
+lsm_fs *_sim_fs_to_lsm(char *err_msg, const struct _db_fs_row *sim_fs)
 {
     const char *plugin_data = NULL;
-    uint64_t total_space = 0;
-    uint64_t free_space = 0;
     lsm_fs *lsm_fs_obj = NULL;
 
     assert(sim_fs != NULL);
 
-    if ((_str_to_uint64(err_msg, lsm_hash_string_get(sim_fs, "free_space"),
-                        &free_space) != LSM_ERR_OK) ||
-        (_str_to_uint64(err_msg, lsm_hash_string_get(sim_fs, "total_space"),
-                        &total_space) != LSM_ERR_OK))
-        return NULL;
-
     lsm_fs_obj = lsm_fs_record_alloc
-        (lsm_hash_string_get(sim_fs, "lsm_fs_id"),
-         lsm_hash_string_get(sim_fs, "name"),
-         total_space, free_space, lsm_hash_string_get(sim_fs, "lsm_pool_id"),
-         _SYS_ID, plugin_data);
+        (sim_fs->lsm_fs_id, sim_fs->name, sim_fs->total_space,
+         sim_fs->free_space, sim_fs->lsm_pool_id, _SYS_ID, plugin_data);
 
     if (lsm_fs_obj == NULL)
         _lsm_err_msg_set(err_msg, "No memory");
@@ -65,22 +71,17 @@ lsm_fs *_sim_fs_to_lsm(char *err_msg, lsm_hash *sim_fs)
     return lsm_fs_obj;
 }
 
-lsm_fs_ss *_sim_fs_snap_to_lsm(char *err_msg, lsm_hash *sim_fs_snap)
+lsm_fs_ss *_sim_fs_snap_to_lsm(char *err_msg,
+                               const struct _db_fs_snap_row *sim_fs_snap)
 {
     const char *plugin_data = NULL;
-    uint64_t timestamp = 0;
     lsm_fs_ss *lsm_fs_snap = NULL;
 
     assert(sim_fs_snap != NULL);
 
-    if (_str_to_uint64(err_msg, lsm_hash_string_get(sim_fs_snap, "timestamp"),
-                       &timestamp) != LSM_ERR_OK)
-        return NULL;
-
     lsm_fs_snap = lsm_fs_ss_record_alloc
-        (lsm_hash_string_get(sim_fs_snap, "lsm_fs_snap_id"),
-         lsm_hash_string_get(sim_fs_snap, "name"),
-         timestamp, plugin_data);
+        (sim_fs_snap->lsm_fs_snap_id, sim_fs_snap->name,
+         sim_fs_snap->timestamp, plugin_data);
 
     if (lsm_fs_snap == NULL)
         _lsm_err_msg_set(err_msg, "No memory");
@@ -185,7 +186,6 @@ int fs_delete(lsm_plugin_ptr c, lsm_fs *fs, char **job, lsm_flag flags)
     char err_msg[_LSM_ERR_MSG_LEN];
     lsm_hash *sim_fs = NULL;
     uint64_t sim_fs_id = 0;
-    char sql_cmd[_BUFF_SIZE];
     struct _vector *vec = NULL;
 
     _UNUSED(flags);
@@ -198,11 +198,10 @@ int fs_delete(lsm_plugin_ptr c, lsm_fs *fs, char **job, lsm_flag flags)
     /* Check fs existence */
     _good(_db_sim_fs_of_sim_id(err_msg, db, sim_fs_id, &sim_fs), rc, out);
     /* Check fs snapshot status */
-    _snprintf_buff(err_msg, rc, out, sql_cmd,
-                   "SELECT * FROM " _DB_TABLE_FS_SNAPS_VIEW " WHERE fs_id=%"
-                   PRIu64 ";", sim_fs_id);
-
-    _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "SELECT * FROM " _DB_TABLE_FS_SNAPS_VIEW
+                            " WHERE fs_id = ?;", &vec, "i", sim_fs_id),
+          rc, out);
     if (_vector_size(vec) != 0) {
         rc = LSM_ERR_PLUGIN_BUG;
         /* TODO(Gris Ge): API does not have dedicate error for this scenario.*/
@@ -212,11 +211,10 @@ int fs_delete(lsm_plugin_ptr c, lsm_fs *fs, char **job, lsm_flag flags)
     _db_sql_exec_vec_free(vec);
     vec = NULL;
     /* Check fs clone(clone here means read and writeable snapshot) */
-    _snprintf_buff(err_msg, rc, out, sql_cmd,
-                   "SELECT * FROM " _DB_TABLE_FS_CLONES " WHERE src_fs_id = %"
-                   PRIu64 ";", sim_fs_id);
-
-    _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "SELECT * FROM " _DB_TABLE_FS_CLONES
+                            " WHERE src_fs_id = ?;", &vec, "i", sim_fs_id),
+          rc, out);
     if (_vector_size(vec) != 0) {
         rc = LSM_ERR_PLUGIN_BUG;
         /* We don't have error number for this yet */
@@ -328,7 +326,6 @@ int fs_child_dependency(lsm_plugin_ptr c, lsm_fs *fs, lsm_string_list *files,
     char err_msg[_LSM_ERR_MSG_LEN];
     lsm_hash *sim_fs = NULL;
     uint64_t sim_fs_id = 0;
-    char sql_cmd[_BUFF_SIZE];
     struct _vector *vec = NULL;
 
     _UNUSED(files);
@@ -338,18 +335,17 @@ int fs_child_dependency(lsm_plugin_ptr c, lsm_fs *fs, lsm_string_list *files,
 
     _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
 
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    _good(_db_sql_trans_begin_read(err_msg, db), rc, out);
 
     sim_fs_id = _db_lsm_id_to_sim_id(lsm_fs_id_get(fs));
 
     _good(_db_sim_fs_of_sim_id(err_msg, db, sim_fs_id, &sim_fs), rc, out);
 
     /* Check fs snapshot status */
-    _snprintf_buff(err_msg, rc, out, sql_cmd,
-                   "SELECT * FROM " _DB_TABLE_FS_SNAPS_VIEW " WHERE fs_id=%"
-                   PRIu64 ";", sim_fs_id);
-
-    _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "SELECT * FROM " _DB_TABLE_FS_SNAPS_VIEW
+                            " WHERE fs_id = ?;", &vec, "i", sim_fs_id),
+          rc, out);
     if (_vector_size(vec) != 0) {
         *yes = 1;
         goto out;
@@ -357,11 +353,10 @@ int fs_child_dependency(lsm_plugin_ptr c, lsm_fs *fs, lsm_string_list *files,
     _db_sql_exec_vec_free(vec);
     vec = NULL;
     /* Check fs clone(clone here means read and writeable snapshot) */
-    _snprintf_buff(err_msg, rc, out, sql_cmd,
-                   "SELECT * FROM " _DB_TABLE_FS_CLONES " WHERE src_fs_id = %"
-                   PRIu64 ";", sim_fs_id);
-
-    _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "SELECT * FROM " _DB_TABLE_FS_CLONES
+                            " WHERE src_fs_id = ?;", &vec, "i", sim_fs_id),
+          rc, out);
     if (_vector_size(vec) != 0)
         *yes = 1;
 
@@ -385,7 +380,6 @@ int fs_child_dependency_rm(lsm_plugin_ptr c, lsm_fs *fs,
     uint8_t yes = 0;
     char err_msg[_LSM_ERR_MSG_LEN];
     uint64_t sim_fs_id = 0;
-    char condition[_BUFF_SIZE];
     sqlite3 *db = NULL;
 
     _UNUSED(flags);
@@ -412,16 +406,14 @@ int fs_child_dependency_rm(lsm_plugin_ptr c, lsm_fs *fs,
     /* Previous fs_child_dependency() call already checked the fs existence */
     sim_fs_id = _db_lsm_id_to_sim_id(lsm_fs_id_get(fs));
 
-    _snprintf_buff(err_msg, rc, out, condition, "src_fs_id = %" PRIu64,
-                   sim_fs_id);
-    _good(_db_data_delete_condition(err_msg, db, _DB_TABLE_FS_CLONES,
-                                    condition),
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "DELETE FROM " _DB_TABLE_FS_CLONES
+                            " WHERE src_fs_id = ?;", NULL, "i", sim_fs_id),
           rc, out);
 
-    _snprintf_buff(err_msg, rc, out, condition, "fs_id = %" PRIu64,
-                   sim_fs_id);
-    _good(_db_data_delete_condition(err_msg, db, _DB_TABLE_FS_SNAPS,
-                                    condition),
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "DELETE FROM " _DB_TABLE_FS_SNAPS
+                            " WHERE fs_id = ?;", NULL, "i", sim_fs_id),
           rc, out);
 
     _good(_job_create(err_msg, db, LSM_DATA_TYPE_NONE, _DB_SIM_ID_NONE, job),
@@ -573,8 +565,8 @@ int fs_snapshot_list(lsm_plugin_ptr c, lsm_fs *fs, lsm_fs_ss **ss[],
     struct _vector *vec = NULL;
     sqlite3 *db = NULL;
     char err_msg[_LSM_ERR_MSG_LEN];
-    char sql_cmd[_BUFF_SIZE];
-    lsm_hash *sim_fs = NULL;
+    struct _arena *arena = NULL;
+    struct _db_fs_row *sim_fs = NULL;
     uint64_t sim_fs_id = 0;
 
     _UNUSED(flags);
@@ -583,16 +575,19 @@ int fs_snapshot_list(lsm_plugin_ptr c, lsm_fs *fs, lsm_fs_ss **ss[],
           rc, out);
 
     _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    _good(_db_sql_trans_begin_read(err_msg, db), rc, out);
     /* Check fs existence */
     sim_fs_id = _db_lsm_id_to_sim_id(lsm_fs_id_get(fs));
-    _good(_db_sim_fs_of_sim_id(err_msg, db, sim_fs_id, &sim_fs), rc, out);
-
-    _snprintf_buff(err_msg, rc, out, sql_cmd,
-                   "SELECT * from " _DB_TABLE_FS_SNAPS_VIEW
-                   " WHERE fs_id=%" PRIu64 ";", sim_fs_id);
+    arena = _arena_new();
+    _alloc_null_check(err_msg, arena, rc, out);
+    _good(_db_fs_row_of_sim_id(err_msg, db, sim_fs_id, arena, &sim_fs),
+          rc, out);
 
-    _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+    _good(_db_sql_exec_rows(err_msg, db,
+                            "SELECT * FROM " _DB_TABLE_FS_SNAPS_VIEW
+                            " WHERE fs_id = ?;", &_db_fs_snap_row_desc, arena,
+                            &vec, "i", sim_fs_id),
+          rc, out);
     if (_vector_size(vec) == 0) {
         *ss = NULL;
         *ss_count = 0;
@@ -602,10 +597,8 @@ int fs_snapshot_list(lsm_plugin_ptr c, lsm_fs *fs, lsm_fs_ss **ss[],
                           ss_count, rc, out);
  out:
     _db_sql_trans_rollback(db);
-    _db_sql_exec_vec_free(vec);
-
-    if (sim_fs != NULL)
-        lsm_hash_free(sim_fs);
+    _vector_free(vec);
+    _arena_free(arena);
 
     if (rc != LSM_ERR_OK) {
         if ((ss != NULL) && (ss_count != NULL)) {
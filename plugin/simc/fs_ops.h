@@ -24,9 +24,20 @@
 #include <stdint.h>
 #include <sqlite3.h>
 
+#include "db.h"
+
 int fs_list(lsm_plugin_ptr c, const char *search_key, const char *search_value,
             lsm_fs **fs[], uint32_t *fs_count, lsm_flag flags);
 
+int fs_list_page(lsm_plugin_ptr c, const char *search_key,
+                 const char *search_value, const char *cursor, uint32_t limit,
+                 lsm_fs **fs[], uint32_t *fs_count, char **next_cursor,
+                 lsm_flag flags);
+
+int fs_list_in(lsm_plugin_ptr c, const char *search_key,
+               lsm_string_list *search_values, lsm_fs **fs[],
+               uint32_t *fs_count, lsm_flag flags);
+
 int fs_create(lsm_plugin_ptr c, lsm_pool *pool, const char *name,
               uint64_t size_bytes, lsm_fs **fs, char **job, lsm_flag flags);
 
@@ -62,7 +73,8 @@ int fs_snapshot_restore(lsm_plugin_ptr c, lsm_fs *fs, lsm_fs_ss *ss,
                         lsm_string_list *files, lsm_string_list *restore_files,
                         int all_files, char **job, lsm_flag flags);
 
-lsm_fs *_sim_fs_to_lsm(char *err_msg, lsm_hash *sim_fs);
-lsm_fs_ss *_sim_fs_snap_to_lsm(char *err_msg, lsm_hash *sim_fs_snap);
+lsm_fs *_sim_fs_to_lsm(char *err_msg, const struct _db_fs_row *sim_fs);
+lsm_fs_ss *_sim_fs_snap_to_lsm(char *err_msg,
+                               const struct _db_fs_snap_row *sim_fs_snap);
 
 #endif  /* End of _SIMC_FS_OPS_H_ */
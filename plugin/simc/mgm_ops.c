@@ -31,75 +31,57 @@
 #include "san_ops.h"
 #include "fs_ops.h"
 
-static lsm_system *sim_sys_to_lsm(char *err_msg, lsm_hash *sim_sys);
-static lsm_pool *sim_p_to_lsm(char *err_msg, lsm_hash *sim_p);
+static lsm_system *sim_sys_to_lsm(char *err_msg,
+                                  const struct _db_sys_row *sim_sys);
+static lsm_pool *sim_p_to_lsm(char *err_msg, const struct _db_pool_row *sim_p);
 static const char *time_stamp_str_get(char *buff);
 
+static const struct _db_search_key _pool_search_keys[] = {
+    {"id", "id", "lsm_pool_id"},
+    {NULL, NULL, NULL},
+};
+
 _xxx_list_func_gen(pool_list, lsm_pool, sim_p_to_lsm,
                    lsm_plug_pool_search_filter, _DB_TABLE_POOLS_VIEW,
+                   _db_pool_row_desc, _pool_search_keys,
                    lsm_pool_record_array_free);
 
-static lsm_system *sim_sys_to_lsm(char *err_msg, lsm_hash *sim_sys)
+static lsm_system *sim_sys_to_lsm(char *err_msg,
+                                  const struct _db_sys_row *sim_sys)
 {
     lsm_system *sys = NULL;
-    uint32_t status = LSM_SYSTEM_STATUS_OK;
     const char *plugin_data = NULL;
-    int read_cache_pct = LSM_SYSTEM_READ_CACHE_PCT_UNKNOWN;
 
     assert(sim_sys != NULL);
 
-    if (_str_to_uint32(err_msg, lsm_hash_string_get(sim_sys, "status"),
-                       &status) != LSM_ERR_OK)
-        return NULL;
-    if (_str_to_int(err_msg, lsm_hash_string_get(sim_sys, "read_cache_pct"),
-                    &read_cache_pct) != LSM_ERR_OK)
-        return NULL;
-
-    sys = lsm_system_record_alloc(lsm_hash_string_get(sim_sys, "id"),
-                                  lsm_hash_string_get(sim_sys, "name"),
-                                  status,
-                                  lsm_hash_string_get(sim_sys, "status_info"),
-                                  plugin_data);
+    sys = lsm_system_record_alloc(sim_sys->id, sim_sys->name,
+                                  (uint32_t) sim_sys->status,
+                                  sim_sys->status_info, plugin_data);
 
     if (sys != NULL) {
-        lsm_system_fw_version_set(sys, lsm_hash_string_get(sim_sys, "version"));
+        lsm_system_fw_version_set(sys, sim_sys->version);
         lsm_system_mode_set(sys, LSM_SYSTEM_MODE_HARDWARE_RAID);
-        lsm_system_read_cache_pct_set(sys, read_cache_pct);
+        lsm_system_read_cache_pct_set(sys, (int) sim_sys->read_cache_pct);
+    } else {
+        _lsm_err_msg_set(err_msg, "No memory");
     }
 
     return sys;
 }
 
-static lsm_pool *sim_p_to_lsm(char *err_msg, lsm_hash *sim_p)
+static lsm_pool *sim_p_to_lsm(char *err_msg, const struct _db_pool_row *sim_p)
 {
     lsm_pool *p = NULL;
-    uint64_t element_type = 0;
-    uint64_t unsupported_actions = 0;
-    uint64_t total_space = 0;
-    uint64_t free_space = 0;
-    uint64_t status = 0;
     const char *plugin_data = NULL;
 
-    if ((_str_to_uint64(err_msg, lsm_hash_string_get(sim_p, "status"),
-                        &status) != LSM_ERR_OK) ||
-        (_str_to_uint64(err_msg, lsm_hash_string_get(sim_p, "element_type"),
-                        &element_type) != LSM_ERR_OK) ||
-        (_str_to_uint64(err_msg, lsm_hash_string_get(sim_p,
-                                                     "unsupported_actions"),
-                        &unsupported_actions) != LSM_ERR_OK) ||
-        (_str_to_uint64(err_msg, lsm_hash_string_get(sim_p, "total_space"),
-                        &total_space) != LSM_ERR_OK) ||
-        (_str_to_uint64(err_msg, lsm_hash_string_get(sim_p, "free_space"),
-                        &free_space) != LSM_ERR_OK))
-        return NULL;
-
-    p = lsm_pool_record_alloc(lsm_hash_string_get(sim_p, "lsm_pool_id"),
-                              lsm_hash_string_get(sim_p, "name"),
-                              element_type,
-                              unsupported_actions,
-                              total_space, free_space, status,
-                              lsm_hash_string_get(sim_p, "status_info"),
+    p = lsm_pool_record_alloc(sim_p->lsm_pool_id, sim_p->name,
+                              sim_p->element_type,
+                              sim_p->unsupported_actions,
+                              sim_p->total_space, sim_p->free_space,
+                              sim_p->status, sim_p->status_info,
                               _SYS_ID, plugin_data);
+    if (p == NULL)
+        _lsm_err_msg_set(err_msg, "No memory");
     return p;
 }
 
@@ -166,6 +148,44 @@ int tmo_set(lsm_plugin_ptr c, uint32_t timeout, lsm_flag flags)
     return rc;
 }
 
+int batch_begin(lsm_plugin_ptr c, lsm_flag flags)
+{
+    int rc = LSM_ERR_OK;
+    char err_msg[_LSM_ERR_MSG_LEN];
+    sqlite3 *db = NULL;
+
+    _UNUSED(flags);
+    _lsm_err_msg_clear(err_msg);
+
+    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
+    _good(_db_sql_batch_begin(err_msg, db), rc, out);
+
+ out:
+    if (rc != LSM_ERR_OK)
+        lsm_log_error_basic(c, rc, err_msg);
+
+    return rc;
+}
+
+int batch_end(lsm_plugin_ptr c, lsm_flag flags)
+{
+    int rc = LSM_ERR_OK;
+    char err_msg[_LSM_ERR_MSG_LEN];
+    sqlite3 *db = NULL;
+
+    _UNUSED(flags);
+    _lsm_err_msg_clear(err_msg);
+
+    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
+    _good(_db_sql_batch_commit(err_msg, db), rc, out);
+
+ out:
+    if (rc != LSM_ERR_OK)
+        lsm_log_error_basic(c, rc, err_msg);
+
+    return rc;
+}
+
 int tmo_get(lsm_plugin_ptr c, uint32_t *timeout, lsm_flag flags)
 {
     int rc = LSM_ERR_NO_SUPPORT;
@@ -316,7 +336,10 @@ int job_status(lsm_plugin_ptr c, const char *job, lsm_job_status *status,
     lsm_hash *sim_job = NULL;
     uint64_t sim_job_id = 0;
     uint64_t sim_data_id = 0;
-    lsm_hash *sim_data = NULL;
+    struct _arena *arena = NULL;
+    struct _db_vol_row *sim_vol = NULL;
+    struct _db_fs_row *sim_fs = NULL;
+    struct _db_fs_snap_row *sim_fs_snap = NULL;
     const char *time_stamp_str = NULL;
     char cur_time_stamp_str[_BUFF_SIZE];
     double job_start_time = 0;
@@ -332,7 +355,7 @@ int job_status(lsm_plugin_ptr c, const char *job, lsm_job_status *status,
 
     _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
 
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    _good(_db_sql_trans_begin_read(err_msg, db), rc, out);
 
     sim_job_id = _db_lsm_id_to_sim_id(job);
     if (sim_job_id == 0) {
@@ -394,20 +417,27 @@ int job_status(lsm_plugin_ptr c, const char *job, lsm_job_status *status,
     _good(_str_to_uint64(err_msg, lsm_hash_string_get(sim_job, "data_id"),
                          &sim_data_id), rc, out);
 
+    if (*type != LSM_DATA_TYPE_NONE) {
+        arena = _arena_new();
+        _alloc_null_check(err_msg, arena, rc, out);
+    }
+
     if (*type == LSM_DATA_TYPE_NONE) {
         *value = NULL;
     } else if (*type == LSM_DATA_TYPE_VOLUME) {
-        _good(_db_sim_vol_of_sim_id(err_msg, db, sim_data_id, &sim_data),
+        _good(_db_vol_row_of_sim_id(err_msg, db, sim_data_id, arena,
+                                    &sim_vol),
               rc, out);
-        *value = _sim_vol_to_lsm(err_msg, sim_data);
+        *value = _sim_vol_to_lsm(err_msg, sim_vol);
     } else if (*type == LSM_DATA_TYPE_FS) {
-        _good(_db_sim_fs_of_sim_id(err_msg, db, sim_data_id, &sim_data),
+        _good(_db_fs_row_of_sim_id(err_msg, db, sim_data_id, arena, &sim_fs),
               rc, out);
-        *value = _sim_fs_to_lsm(err_msg, sim_data);
+        *value = _sim_fs_to_lsm(err_msg, sim_fs);
     } else if (*type == LSM_DATA_TYPE_SS) {
-        _good(_db_sim_fs_snap_of_sim_id(err_msg, db, sim_data_id, &sim_data),
+        _good(_db_fs_snap_row_of_sim_id(err_msg, db, sim_data_id, arena,
+                                        &sim_fs_snap),
               rc, out);
-        *value = _sim_fs_snap_to_lsm(err_msg, sim_data);
+        *value = _sim_fs_snap_to_lsm(err_msg, sim_fs_snap);
     } else {
         rc = LSM_ERR_NO_SUPPORT;
         _lsm_err_msg_set(err_msg, "job data type %d not supported yet", *type);
@@ -420,8 +450,7 @@ int job_status(lsm_plugin_ptr c, const char *job, lsm_job_status *status,
     if (sim_job != NULL)
         lsm_hash_free(sim_job);
 
-    if (sim_data != NULL)
-        lsm_hash_free(sim_data);
+    _arena_free(arena);
 
     if (rc != LSM_ERR_OK) {
         *status = LSM_JOB_ERROR;
@@ -484,8 +513,9 @@ int system_list(lsm_plugin_ptr c, lsm_system **systems[],
     sqlite3 *db = NULL;
     char err_msg[_LSM_ERR_MSG_LEN];
     struct _vector *vec = NULL;
+    struct _arena *arena = NULL;
     uint32_t i = 0;
-    lsm_hash *sim_sys = NULL;
+    const struct _db_sys_row *sim_sys = NULL;
     lsm_system *lsm_sys = NULL;
 
      _UNUSED(flags);
@@ -497,9 +527,12 @@ int system_list(lsm_plugin_ptr c, lsm_system **systems[],
 
     _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
 
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    _good(_db_sql_trans_begin_read(err_msg, db), rc, out);
 
-    _good(_db_sql_exec(err_msg, db, "SELECT * from systems;", &vec),
+    arena = _arena_new();
+    _alloc_null_check(err_msg, arena, rc, out);
+    _good(_db_sql_exec_rows(err_msg, db, "SELECT * FROM " _DB_TABLE_SYS ";",
+                            &_db_sys_row_desc, arena, &vec, ""),
           rc, out);
 
     if (_vector_size(vec) == 0) {
@@ -525,7 +558,8 @@ int system_list(lsm_plugin_ptr c, lsm_system **systems[],
 
  out:
     _db_sql_trans_rollback(db);
-    _db_sql_exec_vec_free(vec);
+    _vector_free(vec);
+    _arena_free(arena);
 
     if (rc != LSM_ERR_OK) {
         if ((systems != NULL) && (*systems != NULL)) {
@@ -32,6 +32,13 @@ int tmo_set(lsm_plugin_ptr c, uint32_t timeout, lsm_flag flags);
 
 int tmo_get(lsm_plugin_ptr c, uint32_t *timeout, lsm_flag flags);
 
+/*
+ * Run every request of a batch in one sqlite transaction.
+ */
+int batch_begin(lsm_plugin_ptr c, lsm_flag flags);
+
+int batch_end(lsm_plugin_ptr c, lsm_flag flags);
+
 int capabilities(lsm_plugin_ptr c, lsm_system *sys,
                  lsm_storage_capabilities **cap, lsm_flag flags);
 
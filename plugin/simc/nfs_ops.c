@@ -28,7 +28,8 @@
 #include "utils.h"
 #include "db.h"
 
-static lsm_nfs_export *_sim_exp_to_lsm(char *err_msg, lsm_hash *sim_exp);
+static lsm_nfs_export *_sim_exp_to_lsm(char *err_msg,
+                                       const struct _db_exp_row *sim_exp);
 
 /*
  * This function is simply split some lines of out nfs_export_fs() to make
@@ -41,70 +42,52 @@ static int _nfs_export(char *err_msg, sqlite3 *db, const char *sim_fs_id_str,
                        uint64_t anon_gid, const char *auth_type,
                        const char *options, uint64_t *sim_exp_id);
 
+static const struct _db_search_key _exp_search_keys[] = {
+    {"id", "id", "lsm_exp_id"},
+    {"fs_id", "fs_id", "lsm_fs_id"},
+    {NULL, NULL, NULL},
+};
+
 _xxx_list_func_gen(nfs_list, lsm_nfs_export, _sim_exp_to_lsm,
                    lsm_plug_nfs_export_search_filter, _DB_TABLE_NFS_EXPS_VIEW,
+                   _db_exp_row_desc, _exp_search_keys,
                    lsm_nfs_export_record_array_free);
 
-static lsm_nfs_export *_sim_exp_to_lsm(char *err_msg, lsm_hash *sim_exp)
+_xxx_list_page_func_gen(nfs_list_page, lsm_nfs_export, _sim_exp_to_lsm,
+                        lsm_plug_nfs_export_search_filter,
+                        _DB_TABLE_NFS_EXPS_VIEW, _db_exp_row_desc,
+                        _exp_search_keys, lsm_nfs_export_record_array_free);
+
+_xxx_list_in_func_gen(nfs_list_in, lsm_nfs_export, _sim_exp_to_lsm,
+                      lsm_plug_nfs_export_search_filter_in,
+                      _DB_TABLE_NFS_EXPS_VIEW, _db_exp_row_desc,
+                      _exp_search_keys, lsm_nfs_export_record_array_free);
+
+static lsm_nfs_export *_sim_exp_to_lsm(char *err_msg,
+                                       const struct _db_exp_row *sim_exp)
 {
     const char *plugin_data = NULL;
-    uint64_t anon_uid = 0;
-    uint64_t anon_gid = 0;
     lsm_nfs_export *lsm_nfs_obj = NULL;
     lsm_string_list *root_hosts = NULL;
     lsm_string_list *rw_hosts = NULL;
     lsm_string_list *ro_hosts = NULL;
-    const char *root_hosts_str = NULL;
-    const char *rw_hosts_str = NULL;
-    const char *ro_hosts_str = NULL;
 
     assert(sim_exp != NULL);
 
-    if (strcmp(lsm_hash_string_get(sim_exp, "anon_uid"), "-1") == 0)
-        anon_uid = -1;
-    else if (_str_to_uint64(err_msg, lsm_hash_string_get(sim_exp, "anon_uid"),
-                            &anon_uid) != LSM_ERR_OK)
-        return NULL;
-
-    if (strcmp(lsm_hash_string_get(sim_exp, "anon_gid"), "-1") == 0)
-        anon_gid = -1;
-    else if (_str_to_uint64(err_msg, lsm_hash_string_get(sim_exp, "anon_gid"),
-                            &anon_gid) != LSM_ERR_OK)
-        return NULL;
-
-    root_hosts_str = lsm_hash_string_get(sim_exp, "exp_root_hosts_str");
-    if (root_hosts_str == NULL) {
-        _lsm_err_msg_set(err_msg, "BUG: No 'exp_root_hosts_str' in lsm_hash "
-                         "sim_exp");
-        return NULL;
-    }
-    rw_hosts_str = lsm_hash_string_get(sim_exp, "exp_rw_hosts_str");
-    if (rw_hosts_str == NULL) {
-        _lsm_err_msg_set(err_msg, "BUG: No 'exp_rw_hosts_str' in lsm_hash "
-                         "sim_exp");
-        return NULL;
-    }
-    ro_hosts_str = lsm_hash_string_get(sim_exp, "exp_ro_hosts_str");
-    if (ro_hosts_str == NULL) {
-        _lsm_err_msg_set(err_msg, "BUG: No 'exp_ro_hosts_str' in lsm_hash "
-                         "sim_exp");
-        return NULL;
-    }
-
-    root_hosts = _db_str_to_list(root_hosts_str);
+    root_hosts = _db_str_to_list(sim_exp->exp_root_hosts_str);
     if (root_hosts == NULL) {
         _lsm_err_msg_set(err_msg, "BUG: Failed to convert exp_root_hosts_str "
                          "to list");
         return NULL;
     }
-    rw_hosts = _db_str_to_list(rw_hosts_str);
+    rw_hosts = _db_str_to_list(sim_exp->exp_rw_hosts_str);
     if (rw_hosts == NULL) {
         _lsm_err_msg_set(err_msg, "BUG: Failed to convert exp_rw_hosts_str "
                          "to list");
         lsm_string_list_free(root_hosts);
         return NULL;
     }
-    ro_hosts = _db_str_to_list(ro_hosts_str);
+    ro_hosts = _db_str_to_list(sim_exp->exp_ro_hosts_str);
     if (ro_hosts == NULL) {
         _lsm_err_msg_set(err_msg, "BUG: Failed to convert exp_ro_hosts_str "
                          "to list");
@@ -113,13 +96,11 @@ static lsm_nfs_export *_sim_exp_to_lsm(char *err_msg, lsm_hash *sim_exp)
         return NULL;
     }
 
+    /* A stored -1 reads back as LSM_NFS_EXPORT_ANON_UID_GID_NA */
     lsm_nfs_obj = lsm_nfs_export_record_alloc
-        (lsm_hash_string_get(sim_exp, "lsm_exp_id"),
-         lsm_hash_string_get(sim_exp, "lsm_fs_id"),
-         lsm_hash_string_get(sim_exp, "exp_path"),
-         lsm_hash_string_get(sim_exp, "auth_type"),
-         root_hosts, rw_hosts, ro_hosts, anon_uid, anon_gid,
-         lsm_hash_string_get(sim_exp, "options"),
+        (sim_exp->lsm_exp_id, sim_exp->lsm_fs_id, sim_exp->exp_path,
+         sim_exp->auth_type, root_hosts, rw_hosts, ro_hosts,
+         sim_exp->anon_uid, sim_exp->anon_gid, sim_exp->options,
          plugin_data);
     lsm_string_list_free(root_hosts);
     lsm_string_list_free(rw_hosts);
@@ -155,7 +136,8 @@ int nfs_export_fs(lsm_plugin_ptr c, const char *fs_id, const char *export_path,
     sqlite3 *db = NULL;
     char err_msg[_LSM_ERR_MSG_LEN];
     lsm_hash *sim_fs = NULL;
-    lsm_hash *sim_exp = NULL;
+    struct _arena *arena = NULL;
+    struct _db_exp_row *sim_exp = NULL;
     uint64_t sim_fs_id = 0;
     uint64_t sim_exp_id = 0;
     char tmp_export_path[_BUFF_SIZE];
@@ -184,7 +166,9 @@ int nfs_export_fs(lsm_plugin_ptr c, const char *fs_id, const char *export_path,
                       root_list, rw_list, ro_list, anon_uid, anon_gid,
                       auth_type, options, &sim_exp_id), rc, out);
 
-    if (_db_sim_exp_of_sim_id(err_msg, db, sim_exp_id, &sim_exp)
+    arena = _arena_new();
+    _alloc_null_check(err_msg, arena, rc, out);
+    if (_db_exp_row_of_sim_id(err_msg, db, sim_exp_id, arena, &sim_exp)
         != LSM_ERR_OK) {
         rc = LSM_ERR_PLUGIN_BUG;
         _lsm_err_msg_set(err_msg,
@@ -203,8 +187,7 @@ int nfs_export_fs(lsm_plugin_ptr c, const char *fs_id, const char *export_path,
  out:
     if (sim_fs != NULL)
         lsm_hash_free(sim_fs);
-    if (sim_exp != NULL)
-        lsm_hash_free(sim_exp);
+    _arena_free(arena);
     if (rc != LSM_ERR_OK) {
         _db_sql_trans_rollback(db);
         if (exported != NULL)
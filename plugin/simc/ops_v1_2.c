@@ -53,7 +53,7 @@ int volume_raid_info(lsm_plugin_ptr c, lsm_volume *volume,
                           opt_io_size),
           rc, out);
     _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    _good(_db_sql_trans_begin_read(err_msg, db), rc, out);
 
     sim_vol_id = _db_lsm_id_to_sim_id(lsm_volume_id_get(volume));
     sim_p_id = _db_lsm_id_to_sim_id(lsm_volume_pool_id_get(volume));
@@ -125,7 +125,6 @@ int pool_member_info(lsm_plugin_ptr c, lsm_pool *pool,
     char err_msg[_LSM_ERR_MSG_LEN];
     lsm_hash *sim_p = NULL;
     uint64_t sim_p_id = 0;
-    char sql_cmd[_BUFF_SIZE];
     struct _vector *vec = NULL;
     lsm_hash *sim_disk = NULL;
     uint32_t i = 0;
@@ -136,7 +135,7 @@ int pool_member_info(lsm_plugin_ptr c, lsm_pool *pool,
                           member_type, member_ids),
           rc, out);
     _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    _good(_db_sql_trans_begin_read(err_msg, db), rc, out);
 
     sim_p_id = _db_lsm_id_to_sim_id(lsm_pool_id_get(pool));
     _good(_db_sim_pool_of_sim_id(err_msg, db, sim_p_id, &sim_p), rc, out);
@@ -162,10 +161,11 @@ int pool_member_info(lsm_plugin_ptr c, lsm_pool *pool,
 
         break;
     case LSM_POOL_MEMBER_TYPE_DISK:
-        _snprintf_buff(err_msg, rc, out, sql_cmd, "SELECT lsm_disk_id FROM "
-                       _DB_TABLE_DISKS_VIEW " WHERE owner_pool_id = %" PRIu64
-                       ";", sim_p_id);
-        _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+        _good(_db_sql_exec_bind(err_msg, db, "SELECT lsm_disk_id FROM "
+                                _DB_TABLE_DISKS_VIEW
+                                " WHERE owner_pool_id = ?;", &vec, "i",
+                                sim_p_id),
+              rc, out);
         *member_ids = lsm_string_list_alloc(_vector_size(vec));
         _alloc_null_check(err_msg, *member_ids, rc, out);
         _vector_for_each(vec, i, sim_disk) {
@@ -251,7 +251,8 @@ int volume_raid_create(lsm_plugin_ptr c, const char *name,
     uint64_t sim_pool_id = 0;
     uint64_t sim_vol_id = 0;
     lsm_hash *sim_disk = NULL;
-    lsm_hash *sim_vol = NULL;
+    struct _arena *arena = NULL;
+    struct _db_vol_row *sim_vol = NULL;
     lsm_hash *sim_pool = NULL;
     uint64_t *sim_disk_ids = NULL;
     uint64_t all_size = 0;
@@ -318,7 +319,10 @@ int volume_raid_create(lsm_plugin_ptr c, const char *name,
                           "is_hw_raid_vol", "1"),
           rc, out);
 
-    _good(_db_sim_vol_of_sim_id(err_msg, db, sim_vol_id, &sim_vol), rc, out);
+    arena = _arena_new();
+    _alloc_null_check(err_msg, arena, rc, out);
+    _good(_db_vol_row_of_sim_id(err_msg, db, sim_vol_id, arena, &sim_vol),
+          rc, out);
 
     *new_volume = _sim_vol_to_lsm(err_msg, sim_vol);
     if (*new_volume == NULL) {
@@ -333,8 +337,7 @@ int volume_raid_create(lsm_plugin_ptr c, const char *name,
         lsm_hash_free(sim_disk);
     if (sim_pool != NULL)
         lsm_hash_free(sim_pool);
-    if (sim_vol != NULL)
-        lsm_hash_free(sim_vol);
+    _arena_free(arena);
     free(sim_disk_ids);
     if (rc != LSM_ERR_OK) {
         if (new_volume != NULL)
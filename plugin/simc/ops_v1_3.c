@@ -30,31 +30,31 @@
 #include "db.h"
 #include "ops_v1_3.h"
 
-static lsm_battery *_sim_bat_to_lsm(char *err_msg, lsm_hash *sim_bat);
+static lsm_battery *_sim_bat_to_lsm(char *err_msg,
+                                    const struct _db_bat_row *sim_bat);
 static int _vol_cache_update(lsm_plugin_ptr c, lsm_volume *volume,
                              const char *key_name, uint32_t value);
 
+static const struct _db_search_key _bat_search_keys[] = {
+    {"id", "id", "lsm_bat_id"},
+    {NULL, NULL, NULL},
+};
+
 _xxx_list_func_gen(battery_list, lsm_battery, _sim_bat_to_lsm,
                    lsm_plug_battery_search_filter, _DB_TABLE_BATS_VIEW,
+                   _db_bat_row_desc, _bat_search_keys,
                    lsm_battery_record_array_free);
 
-static lsm_battery *_sim_bat_to_lsm(char *err_msg, lsm_hash *sim_bat)
+static lsm_battery *_sim_bat_to_lsm(char *err_msg,
+                                    const struct _db_bat_row *sim_bat)
 {
     const char *plugin_data = NULL;
     lsm_battery *lsm_bat = NULL;
-    uint64_t status = LSM_BATTERY_STATUS_UNKNOWN;
-    lsm_battery_type type = LSM_BATTERY_TYPE_UNKNOWN;
-
-    if ((_str_to_int(err_msg, lsm_hash_string_get(sim_bat, "type"),
-                     (int *) &type) != LSM_ERR_OK) ||
-        (_str_to_uint64(err_msg, lsm_hash_string_get(sim_bat, "status"),
-                        &status) != LSM_ERR_OK))
-        return NULL;
 
     lsm_bat = lsm_battery_record_alloc
-        (lsm_hash_string_get(sim_bat, "lsm_bat_id"),
-         lsm_hash_string_get(sim_bat, "name"),
-         type, status, _SYS_ID, plugin_data);
+        (sim_bat->lsm_bat_id, sim_bat->name,
+         (lsm_battery_type) sim_bat->type, sim_bat->status, _SYS_ID,
+         plugin_data);
 
     if (lsm_bat == NULL)
         _lsm_err_msg_set(err_msg, "No memory");
@@ -115,7 +115,7 @@ int volume_ident_led_on(lsm_plugin_ptr c, lsm_volume * volume, lsm_flag flags)
     _lsm_err_msg_clear(err_msg);
     _good(_check_null_ptr(err_msg, 1 /* argument count */, volume), rc, out);
     _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    _good(_db_sql_trans_begin_read(err_msg, db), rc, out);
 
     /* Do nothing but check the existence of volume */
     sim_vol_id = _db_lsm_id_to_sim_id(lsm_volume_id_get(volume));
@@ -141,7 +141,6 @@ int system_read_cache_pct_update(lsm_plugin_ptr c, lsm_system *system,
     int rc = LSM_ERR_OK;
     sqlite3 *db = NULL;
     char err_msg[_LSM_ERR_MSG_LEN];
-    char sql_cmd[_BUFF_SIZE];
 
     _UNUSED(flags);
     _lsm_err_msg_clear(err_msg);
@@ -155,12 +154,11 @@ int system_read_cache_pct_update(lsm_plugin_ptr c, lsm_system *system,
         goto out;
     }
 
-    _snprintf_buff(err_msg, rc, out, sql_cmd,
-                   "UPDATE " _DB_TABLE_SYS " SET read_cache_pct=%" PRIu32
-                   " WHERE id='" _SYS_ID "';", read_pct);
-
-    _good(_db_sql_exec(err_msg, db, sql_cmd,
-                       NULL /* no need to parse output */),
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "UPDATE " _DB_TABLE_SYS " SET read_cache_pct = ?"
+                            " WHERE id = '" _SYS_ID "';",
+                            NULL /* no need to parse output */, "i",
+                            (uint64_t) read_pct),
           rc, out);
 
     _good(_db_sql_trans_commit(err_msg, db), rc, out);
@@ -185,7 +183,6 @@ int volume_cache_info(lsm_plugin_ptr c, lsm_volume *volume,
     uint64_t sim_vol_id = 0;
     lsm_hash *sim_vol = NULL;
     sqlite3 *db = NULL;
-    char sql_cmd[_BUFF_SIZE];
     struct _vector *vec = NULL;
     bool battery_ok = false;
 
@@ -197,7 +194,7 @@ int volume_cache_info(lsm_plugin_ptr c, lsm_volume *volume,
                           physical_disk_cache),
           rc, out);
     _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    _good(_db_sql_trans_begin_read(err_msg, db), rc, out);
 
     sim_vol_id = _db_lsm_id_to_sim_id(lsm_volume_id_get(volume));
     _good(_db_sim_vol_of_sim_id(err_msg, db, sim_vol_id, &sim_vol), rc, out);
@@ -216,10 +213,11 @@ int volume_cache_info(lsm_plugin_ptr c, lsm_volume *volume,
           rc, out);
 
     /* Check whether has a battery in OK status */
-    _snprintf_buff(err_msg, rc, out, sql_cmd,
-                   "SELECT id from " _DB_TABLE_BATS " WHERE status = '%d';",
-                   LSM_BATTERY_STATUS_OK);
-    _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "SELECT id FROM " _DB_TABLE_BATS
+                            " WHERE status = ?;", &vec, "i",
+                            (uint64_t) LSM_BATTERY_STATUS_OK),
+          rc, out);
     if (_vector_size(vec) > 0)
         battery_ok = true;
 
@@ -34,49 +34,95 @@
 #define _VOLUME_ADMIN_STATE_ENABLE_STR                  "1"
 #define _VOLUME_ADMIN_STATE_DISABLE_STR                 "0"
 
-static lsm_disk *_sim_disk_to_lsm(char *err_msg, lsm_hash *sim_disk);
-lsm_access_group *_sim_ag_to_lsm(char *err_msg, lsm_hash *sim_ag);
-static lsm_target_port *_sim_tgt_to_lsm(char *err_msg, lsm_hash *sim_tgt);
+static lsm_disk *_sim_disk_to_lsm(char *err_msg,
+                                  const struct _db_disk_row *sim_disk);
+static lsm_target_port *_sim_tgt_to_lsm(char *err_msg,
+                                        const struct _db_tgt_row *sim_tgt);
 static int _volume_admin_state_change(lsm_plugin_ptr c, lsm_volume *v,
                                       const char *admin_state_str);
 
+static const struct _db_search_key _vol_search_keys[] = {
+    {"id", "id", "lsm_vol_id"},
+    {"pool_id", "pool_id", "lsm_pool_id"},
+    {NULL, NULL, NULL},
+};
+
 _xxx_list_func_gen(volume_list, lsm_volume, _sim_vol_to_lsm,
                    lsm_plug_volume_search_filter, _DB_TABLE_VOLS_VIEW,
+                   _db_vol_row_desc, _vol_search_keys,
                    lsm_volume_record_array_free);
 
+_xxx_list_page_func_gen(volume_list_page, lsm_volume, _sim_vol_to_lsm,
+                        lsm_plug_volume_search_filter, _DB_TABLE_VOLS_VIEW,
+                        _db_vol_row_desc, _vol_search_keys,
+                        lsm_volume_record_array_free);
+
+_xxx_list_in_func_gen(volume_list_in, lsm_volume, _sim_vol_to_lsm,
+                      lsm_plug_volume_search_filter_in, _DB_TABLE_VOLS_VIEW,
+                      _db_vol_row_desc, _vol_search_keys,
+                      lsm_volume_record_array_free);
+
+static const struct _db_search_key _disk_search_keys[] = {
+    {"id", "id", "lsm_disk_id"},
+    {NULL, NULL, NULL},
+};
+
 _xxx_list_func_gen(disk_list, lsm_disk, _sim_disk_to_lsm,
                    lsm_plug_disk_search_filter, _DB_TABLE_DISKS_VIEW,
+                   _db_disk_row_desc, _disk_search_keys,
                    lsm_disk_record_array_free);
 
+_xxx_list_page_func_gen(disk_list_page, lsm_disk, _sim_disk_to_lsm,
+                        lsm_plug_disk_search_filter, _DB_TABLE_DISKS_VIEW,
+                        _db_disk_row_desc, _disk_search_keys,
+                        lsm_disk_record_array_free);
+
+_xxx_list_in_func_gen(disk_list_in, lsm_disk, _sim_disk_to_lsm,
+                      lsm_plug_disk_search_filter_in, _DB_TABLE_DISKS_VIEW,
+                      _db_disk_row_desc, _disk_search_keys,
+                      lsm_disk_record_array_free);
+
+static const struct _db_search_key _ag_search_keys[] = {
+    {"id", "id", "lsm_ag_id"},
+    {NULL, NULL, NULL},
+};
+
 _xxx_list_func_gen(access_group_list, lsm_access_group, _sim_ag_to_lsm,
                    lsm_plug_access_group_search_filter, _DB_TABLE_AGS_VIEW,
+                   _db_ag_row_desc, _ag_search_keys,
                    lsm_access_group_record_array_free);
 
+_xxx_list_page_func_gen(access_group_list_page, lsm_access_group,
+                        _sim_ag_to_lsm, lsm_plug_access_group_search_filter,
+                        _DB_TABLE_AGS_VIEW, _db_ag_row_desc, _ag_search_keys,
+                        lsm_access_group_record_array_free);
+
+_xxx_list_in_func_gen(access_group_list_in, lsm_access_group, _sim_ag_to_lsm,
+                      lsm_plug_access_group_search_filter_in,
+                      _DB_TABLE_AGS_VIEW, _db_ag_row_desc, _ag_search_keys,
+                      lsm_access_group_record_array_free);
+
+static const struct _db_search_key _tgt_search_keys[] = {
+    {"id", "id", "lsm_tgt_id"},
+    {NULL, NULL, NULL},
+};
+
 _xxx_list_func_gen(target_port_list, lsm_target_port, _sim_tgt_to_lsm,
                    lsm_plug_target_port_search_filter, _DB_TABLE_TGTS_VIEW,
+                   _db_tgt_row_desc, _tgt_search_keys,
                    lsm_target_port_record_array_free);
 
-lsm_volume *_sim_vol_to_lsm(char *err_msg, lsm_hash *sim_vol)
+lsm_volume *_sim_vol_to_lsm(char *err_msg, const struct _db_vol_row *sim_vol)
 {
-    uint32_t admin_state = 0;
     const char *plugin_data = NULL;
-    uint64_t total_space = 0;
     lsm_volume *lsm_vol = NULL;
 
     assert(sim_vol != NULL);
 
-    if ((_str_to_uint32(err_msg, lsm_hash_string_get(sim_vol, "admin_state"),
-                        &admin_state) != LSM_ERR_OK) ||
-        (_str_to_uint64(err_msg, lsm_hash_string_get(sim_vol, "total_space"),
-                        &total_space) != LSM_ERR_OK))
-        return NULL;
-
     lsm_vol = lsm_volume_record_alloc
-        (lsm_hash_string_get(sim_vol, "lsm_vol_id"),
-         lsm_hash_string_get(sim_vol, "name"),
-         lsm_hash_string_get(sim_vol, "vpd83"),
-         _BLOCK_SIZE, total_space / _BLOCK_SIZE, admin_state, _SYS_ID,
-         lsm_hash_string_get(sim_vol, "lsm_pool_id"), plugin_data);
+        (sim_vol->lsm_vol_id, sim_vol->name, sim_vol->vpd83, _BLOCK_SIZE,
+         sim_vol->total_space / _BLOCK_SIZE, (uint32_t) sim_vol->admin_state,
+         _SYS_ID, sim_vol->lsm_pool_id, plugin_data);
 
     if (lsm_vol == NULL)
         _lsm_err_msg_set(err_msg, "No memory");
@@ -84,64 +130,44 @@ lsm_volume *_sim_vol_to_lsm(char *err_msg, lsm_hash *sim_vol)
     return lsm_vol;
 }
 
-static lsm_disk *_sim_disk_to_lsm(char *err_msg, lsm_hash *sim_disk)
+static lsm_disk *_sim_disk_to_lsm(char *err_msg,
+                                  const struct _db_disk_row *sim_disk)
 {
-    uint32_t disk_type_u32 = 0;
-    uint64_t total_space = 0;
-    uint64_t status = 0;
+    uint64_t status = sim_disk->status;
     lsm_disk *lsm_d = NULL;
-    int32_t rpm = LSM_DISK_RPM_UNKNOWN;
-    lsm_disk_link_type link_type = LSM_DISK_LINK_TYPE_UNKNOWN;
-
-    if ((_str_to_uint32(err_msg, lsm_hash_string_get(sim_disk, "disk_type"),
-                        &disk_type_u32) != LSM_ERR_OK) ||
-        (_str_to_uint64(err_msg, lsm_hash_string_get(sim_disk, "status"),
-                        &status) != LSM_ERR_OK) ||
-        (_str_to_int(err_msg, lsm_hash_string_get(sim_disk, "rpm"),
-                     (int *) &rpm) != LSM_ERR_OK) ||
-        (_str_to_int(err_msg, lsm_hash_string_get(sim_disk, "link_type"),
-                     (int *) &link_type) != LSM_ERR_OK) ||
-        (_str_to_uint64(err_msg, lsm_hash_string_get(sim_disk, "total_space"),
-                        &total_space) != LSM_ERR_OK))
-        return NULL;
 
-    if (strlen(lsm_hash_string_get(sim_disk, "role")) == 0)
+    if (strlen(sim_disk->role) == 0)
         status |= LSM_DISK_STATUS_FREE;
 
     lsm_d = lsm_disk_record_alloc
-        (lsm_hash_string_get(sim_disk, "lsm_disk_id"),
-         lsm_hash_string_get(sim_disk, "name"),
-         (lsm_disk_type) disk_type_u32,
-         _BLOCK_SIZE, total_space / _BLOCK_SIZE, status, _SYS_ID);
+        (sim_disk->lsm_disk_id, sim_disk->name,
+         (lsm_disk_type) sim_disk->disk_type,
+         _BLOCK_SIZE, sim_disk->total_space / _BLOCK_SIZE, status, _SYS_ID);
 
     if (lsm_d == NULL)
         _lsm_err_msg_set(err_msg, "No memory");
 
-    lsm_disk_rpm_set(lsm_d, rpm);
-    lsm_disk_link_type_set(lsm_d, link_type);
-    lsm_disk_vpd83_set(lsm_d, lsm_hash_string_get(sim_disk, "vpd83"));
-    lsm_disk_location_set(lsm_d, lsm_hash_string_get(sim_disk, "location"));
+    lsm_disk_rpm_set(lsm_d, (int32_t) sim_disk->rpm);
+    lsm_disk_link_type_set(lsm_d, (lsm_disk_link_type) sim_disk->link_type);
+    lsm_disk_vpd83_set(lsm_d, sim_disk->vpd83);
+    lsm_disk_location_set(lsm_d, sim_disk->location);
 
     return lsm_d;
 }
 
-static lsm_target_port *_sim_tgt_to_lsm(char *err_msg, lsm_hash *sim_tgt)
+static lsm_target_port *_sim_tgt_to_lsm(char *err_msg,
+                                        const struct _db_tgt_row *sim_tgt)
 {
-    lsm_target_port_type port_type = LSM_TARGET_PORT_TYPE_OTHER;
     const char *plugin_data = NULL;
     lsm_target_port *lsm_tgt = NULL;
 
-    if (_str_to_int(err_msg, lsm_hash_string_get(sim_tgt, "port_type"),
-                    (int *) &port_type) != LSM_ERR_OK)
-        return NULL;
-
     lsm_tgt = lsm_target_port_record_alloc
-        (lsm_hash_string_get(sim_tgt, "lsm_tgt_id"),
-         port_type,
-         lsm_hash_string_get(sim_tgt, "service_address"),
-         lsm_hash_string_get(sim_tgt, "network_address"),
-         lsm_hash_string_get(sim_tgt, "physical_address"),
-         lsm_hash_string_get(sim_tgt, "physical_name"),
+        (sim_tgt->lsm_tgt_id,
+         (lsm_target_port_type) sim_tgt->port_type,
+         sim_tgt->service_address,
+         sim_tgt->network_address,
+         sim_tgt->physical_address,
+         sim_tgt->physical_name,
          _SYS_ID, plugin_data);
 
     if (lsm_tgt == NULL)
@@ -150,34 +176,25 @@ static lsm_target_port *_sim_tgt_to_lsm(char *err_msg, lsm_hash *sim_tgt)
     return lsm_tgt;
 }
 
-lsm_access_group *_sim_ag_to_lsm(char *err_msg, lsm_hash *sim_ag)
+lsm_access_group *_sim_ag_to_lsm(char *err_msg,
+                                 const struct _db_ag_row *sim_ag)
 {
     const char *plugin_data = NULL;
-    lsm_access_group_init_type init_type = 0;
-    const char *init_ids_str = NULL;
     lsm_string_list *init_ids = NULL;
     lsm_access_group *lsm_ag = NULL;
 
     assert(sim_ag != NULL);
 
-    init_ids_str = lsm_hash_string_get(sim_ag, "init_ids_str");
-    if (init_ids_str == NULL) {
-        _lsm_err_msg_set(err_msg, "BUG: No 'init_ids_str' in lsm_hash sim_ag");
-        return NULL;
-    }
-    if (_str_to_int(err_msg, lsm_hash_string_get(sim_ag, "init_type"),
-                    (int *) &init_type) != LSM_ERR_OK)
-        return NULL;
-    init_ids = _db_str_to_list(init_ids_str);
+    init_ids = _db_str_to_list(sim_ag->init_ids_str);
     if (init_ids == NULL) {
         _lsm_err_msg_set(err_msg, "BUG: Failed to convert init_ids "
                          "str to list");
         return NULL;
     }
     lsm_ag = lsm_access_group_record_alloc
-        (lsm_hash_string_get(sim_ag, "lsm_ag_id"),
-         lsm_hash_string_get(sim_ag, "name"),
-         init_ids, init_type, _SYS_ID, plugin_data);
+        (sim_ag->lsm_ag_id, sim_ag->name, init_ids,
+         (lsm_access_group_init_type) sim_ag->init_type, _SYS_ID,
+         plugin_data);
     lsm_string_list_free(init_ids);
     if (lsm_ag == NULL) {
         _lsm_err_msg_set(err_msg, "No memory");
@@ -296,7 +313,6 @@ int volume_delete(lsm_plugin_ptr c, lsm_volume *volume, char **job,
     char err_msg[_LSM_ERR_MSG_LEN];
     lsm_hash *sim_vol = NULL;
     uint64_t sim_vol_id = 0;
-    char sql_cmd[_BUFF_SIZE];
     struct _vector *vec = NULL;
     struct _vector *vec_disks = NULL;
     lsm_hash *sim_disk = NULL;
@@ -314,11 +330,10 @@ int volume_delete(lsm_plugin_ptr c, lsm_volume *volume, char **job,
     /* Check volume existence */
     _good(_db_sim_vol_of_sim_id(err_msg, db, sim_vol_id, &sim_vol), rc, out);
     /* Check volume mask status */
-    _snprintf_buff(err_msg, rc, out, sql_cmd,
-                   "SELECT * FROM " _DB_TABLE_VOL_MASKS " WHERE vol_id=%"
-                   PRIu64 ";", sim_vol_id);
-
-    _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "SELECT * FROM " _DB_TABLE_VOL_MASKS
+                            " WHERE vol_id = ?;", &vec, "i", sim_vol_id),
+          rc, out);
     if (_vector_size(vec) != 0) {
         rc = LSM_ERR_IS_MASKED;
         _lsm_err_msg_set(err_msg, "Specified volume is masked to access group");
@@ -327,12 +342,11 @@ int volume_delete(lsm_plugin_ptr c, lsm_volume *volume, char **job,
     _db_sql_exec_vec_free(vec);
     vec = NULL;
     /* Check volume duplication status */
-    _snprintf_buff(err_msg, rc, out, sql_cmd,
-                   "SELECT * FROM " _DB_TABLE_VOL_REPS " WHERE src_vol_id = %"
-                   PRIu64 " AND dst_vol_id != %" PRIu64 ";", sim_vol_id,
-                   sim_vol_id);
-
-    _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "SELECT * FROM " _DB_TABLE_VOL_REPS
+                            " WHERE src_vol_id = ?1 AND dst_vol_id != ?1;",
+                            &vec, "i", sim_vol_id),
+          rc, out);
     if (_vector_size(vec) != 0) {
         rc = LSM_ERR_PLUGIN_BUG;
         /* We don't have error number for this yet */
@@ -342,12 +356,12 @@ int volume_delete(lsm_plugin_ptr c, lsm_volume *volume, char **job,
 
     if (strcmp(lsm_hash_string_get(sim_vol, "is_hw_raid_vol"), "1") == 0) {
         /* Reset disks' role */
-        _snprintf_buff(err_msg, rc, out, sql_cmd,
-                       "SELECT * FROM " _DB_TABLE_DISKS_VIEW
-                       " WHERE owner_pool_id=%"
-                       PRIu64 ";",
-                       _db_lsm_id_to_sim_id(lsm_volume_pool_id_get(volume)));
-        _good(_db_sql_exec(err_msg, db, sql_cmd, &vec_disks), rc, out);
+        _good(_db_sql_exec_bind(err_msg, db,
+                                "SELECT * FROM " _DB_TABLE_DISKS_VIEW
+                                " WHERE owner_pool_id = ?;", &vec_disks, "i",
+                                _db_lsm_id_to_sim_id(
+                                    lsm_volume_pool_id_get(volume))),
+              rc, out);
         _vector_for_each(vec_disks, i, sim_disk) {
             sim_disk_id = _db_lsm_id_to_sim_id
                 (lsm_hash_string_get(sim_disk, "lsm_disk_id"));
@@ -458,7 +472,6 @@ int volume_replicate_range(lsm_plugin_ptr c, lsm_replication_type rep_type,
     struct _vector *vec = NULL;
     char err_msg[_LSM_ERR_MSG_LEN];
     char rep_type_str[_BUFF_SIZE];
-    char sql_cmd[_BUFF_SIZE];
 
      _UNUSED(flags);
      _UNUSED(num_ranges);
@@ -482,11 +495,11 @@ int volume_replicate_range(lsm_plugin_ptr c, lsm_replication_type rep_type,
     /* Make sure specified destination volume is not a replicate destination of
      * other volume.
      */
-    _snprintf_buff(err_msg, rc, out, sql_cmd,
-                   "SELECT * FROM " _DB_TABLE_VOL_REPS
-                   " WHERE dst_vol_id=%s AND src_vol_id !=%s",
-                   dst_sim_vol_id_str, src_sim_vol_id_str);
-    _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "SELECT * FROM " _DB_TABLE_VOL_REPS
+                            " WHERE dst_vol_id = ? AND src_vol_id != ?;",
+                            &vec, "ii", dst_sim_vol_id, src_sim_vol_id),
+          rc, out);
     if (_vector_size(vec) > 0) {
         rc = LSM_ERR_PLUGIN_BUG;
         _lsm_err_msg_set(err_msg, "Destination volume is already a "
@@ -708,7 +721,8 @@ int access_group_create(lsm_plugin_ptr c, const char *name,
     uint64_t sim_ag_id = 0;
     char sim_ag_id_str[_BUFF_SIZE];
     char init_type_str[_BUFF_SIZE];
-    lsm_hash *sim_ag = NULL;
+    struct _arena *arena = NULL;
+    struct _db_ag_row *sim_ag = NULL;
     const char *sys_id = NULL;
 
      _UNUSED(flags);
@@ -759,7 +773,9 @@ int access_group_create(lsm_plugin_ptr c, const char *name,
         }
         goto out;
     }
-    rc = _db_sim_ag_of_sim_id(err_msg, db, sim_ag_id, &sim_ag);
+    arena = _arena_new();
+    _alloc_null_check(err_msg, arena, rc, out);
+    rc = _db_ag_row_of_sim_id(err_msg, db, sim_ag_id, arena, &sim_ag);
     if (rc == LSM_ERR_NOT_FOUND_ACCESS_GROUP) {
         rc = LSM_ERR_PLUGIN_BUG;
         _lsm_err_msg_set(err_msg, "Failed to find newly created access group");
@@ -776,8 +792,7 @@ int access_group_create(lsm_plugin_ptr c, const char *name,
     _good(_db_sql_trans_commit(err_msg, db), rc, out);
 
  out:
-    if (sim_ag != NULL)
-        lsm_hash_free(sim_ag);
+    _arena_free(arena);
 
     if (rc != LSM_ERR_OK) {
         _db_sql_trans_rollback(db);
@@ -796,7 +811,6 @@ int access_group_delete(lsm_plugin_ptr c, lsm_access_group *group,
     char err_msg[_LSM_ERR_MSG_LEN];
     lsm_hash *sim_ag = NULL;
     uint64_t sim_ag_id = 0;
-    char sql_cmd[_BUFF_SIZE];
     struct _vector *vec = NULL;
 
      _UNUSED(flags);
@@ -808,11 +822,10 @@ int access_group_delete(lsm_plugin_ptr c, lsm_access_group *group,
     /* Check access group existence */
     _good(_db_sim_ag_of_sim_id(err_msg, db, sim_ag_id, &sim_ag), rc, out);
     /* Check volume masking status */
-    _snprintf_buff(err_msg, rc, out, sql_cmd,
-                   "SELECT * FROM " _DB_TABLE_VOL_MASKS " WHERE ag_id = %"
-                   PRIu64 ";", sim_ag_id);
-
-    _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "SELECT * FROM " _DB_TABLE_VOL_MASKS
+                            " WHERE ag_id = ?;", &vec, "i", sim_ag_id),
+          rc, out);
     if (_vector_size(vec) != 0) {
         rc = LSM_ERR_IS_MASKED;
         _lsm_err_msg_set(err_msg, "Specified access group has masked volume");
@@ -844,10 +857,10 @@ int access_group_initiator_add(lsm_plugin_ptr c, lsm_access_group *access_group,
     sqlite3 *db = NULL;
     char err_msg[_LSM_ERR_MSG_LEN];
     uint64_t sim_ag_id = 0;
-    lsm_hash *sim_ag = NULL;
+    struct _arena *arena = NULL;
+    struct _db_ag_row *sim_ag = NULL;
     struct _vector *vec = NULL;
     char init_type_str[_BUFF_SIZE];
-    char sql_cmd_check_exist[_BUFF_SIZE];
     lsm_hash *sim_init = NULL;
     const char *sim_ag_id_str = NULL;
     const char *tmp_sim_ag_id_str = NULL;
@@ -868,11 +881,14 @@ int access_group_initiator_add(lsm_plugin_ptr c, lsm_access_group *access_group,
     sim_ag_id = _db_lsm_id_to_sim_id(lsm_access_group_id_get(access_group));
     sim_ag_id_str =
         _db_lsm_id_to_sim_id_str(lsm_access_group_id_get(access_group));
-    _good(_db_sim_ag_of_sim_id(err_msg, db, sim_ag_id, &sim_ag), rc, out);
-    _snprintf_buff(err_msg, rc, out, sql_cmd_check_exist,
-                   "SELECT * FROM " _DB_TABLE_INITS " WHERE id=\"%s\"",
-                   initiator_id);
-    _good(_db_sql_exec(err_msg, db, sql_cmd_check_exist, &vec), rc, out);
+    arena = _arena_new();
+    _alloc_null_check(err_msg, arena, rc, out);
+    _good(_db_ag_row_of_sim_id(err_msg, db, sim_ag_id, arena, &sim_ag),
+          rc, out);
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "SELECT * FROM " _DB_TABLE_INITS " WHERE id = ?;",
+                            &vec, "s", initiator_id),
+          rc, out);
     if (_vector_size(vec) == 1) {
         /* Since ID is defined as UNIQUE, we only get 1 item at most */
         sim_init = _vector_get(vec, 0);
@@ -903,8 +919,7 @@ int access_group_initiator_add(lsm_plugin_ptr c, lsm_access_group *access_group,
                        "init_type", init_type_str,
                        "owner_ag_id", sim_ag_id_str,
                        NULL), rc, out);
-    lsm_hash_free(sim_ag);
-    rc = _db_sim_ag_of_sim_id(err_msg, db, sim_ag_id, &sim_ag);
+    rc = _db_ag_row_of_sim_id(err_msg, db, sim_ag_id, arena, &sim_ag);
     if (rc == LSM_ERR_NOT_FOUND_ACCESS_GROUP) {
         rc = LSM_ERR_PLUGIN_BUG;
         _lsm_err_msg_set(err_msg, "BUG: Failed to find updated access group");
@@ -921,8 +936,7 @@ int access_group_initiator_add(lsm_plugin_ptr c, lsm_access_group *access_group,
     _good(_db_sql_trans_commit(err_msg, db), rc, out);
 
  out:
-    if (sim_ag != NULL)
-        lsm_hash_free(sim_ag);
+    _arena_free(arena);
 
     _db_sql_exec_vec_free(vec);
 
@@ -945,11 +959,9 @@ int access_group_initiator_delete(lsm_plugin_ptr c,
     int rc = LSM_ERR_OK;
     sqlite3 *db = NULL;
     char err_msg[_LSM_ERR_MSG_LEN];
-    char sql_cmd_check[_BUFF_SIZE];
-    char condition[_BUFF_SIZE];
     uint64_t sim_ag_id = 0;
-    const char *sim_ag_id_str = NULL;
-    lsm_hash *sim_ag = NULL;
+    struct _arena *arena = NULL;
+    struct _db_ag_row *sim_ag = NULL;
     struct _vector *vec = NULL;
 
      _UNUSED(flags);
@@ -968,15 +980,16 @@ int access_group_initiator_delete(lsm_plugin_ptr c,
     }
 
     sim_ag_id = _db_lsm_id_to_sim_id(lsm_access_group_id_get(access_group));
-    sim_ag_id_str =
-        _db_lsm_id_to_sim_id_str(lsm_access_group_id_get(access_group));
-    _good(_db_sim_ag_of_sim_id(err_msg, db, sim_ag_id, &sim_ag), rc, out);
+    arena = _arena_new();
+    _alloc_null_check(err_msg, arena, rc, out);
+    _good(_db_ag_row_of_sim_id(err_msg, db, sim_ag_id, arena, &sim_ag),
+          rc, out);
 
-    _snprintf_buff(err_msg, rc, out, sql_cmd_check,
-                   "SELECT * FROM " _DB_TABLE_INITS
-                   " WHERE id=\"%s\" AND owner_ag_id=\"%s\"",
-                   initiator_id, sim_ag_id_str);
-    _good(_db_sql_exec(err_msg, db, sql_cmd_check, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "SELECT * FROM " _DB_TABLE_INITS
+                            " WHERE id = ? AND owner_ag_id = ?;", &vec, "si",
+                            initiator_id, sim_ag_id),
+          rc, out);
     if (_vector_size(vec) == 0) {
         rc = LSM_ERR_NO_STATE_CHANGE;
         _lsm_err_msg_set(err_msg, "Specified initiator is not in "
@@ -985,10 +998,10 @@ int access_group_initiator_delete(lsm_plugin_ptr c,
     }
     _db_sql_exec_vec_free(vec);
     vec = NULL;
-    _snprintf_buff(err_msg, rc, out, sql_cmd_check,
-                   "SELECT * FROM " _DB_TABLE_INITS " WHERE owner_ag_id=\"%s\"",
-                   sim_ag_id_str);
-    _good(_db_sql_exec(err_msg, db, sql_cmd_check, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "SELECT * FROM " _DB_TABLE_INITS
+                            " WHERE owner_ag_id = ?;", &vec, "i", sim_ag_id),
+          rc, out);
     if (_vector_size(vec) == 1) {
         rc = LSM_ERR_LAST_INIT_IN_ACCESS_GROUP;
         _lsm_err_msg_set(err_msg, "Refused to remove the last initiator from "
@@ -996,13 +1009,12 @@ int access_group_initiator_delete(lsm_plugin_ptr c,
         goto out;
     }
 
-    _snprintf_buff(err_msg, rc, out, condition, "id=\"%s\"",
-                   initiator_id);
-    _good(_db_data_delete_condition(err_msg, db, _DB_TABLE_INITS, condition),
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "DELETE FROM " _DB_TABLE_INITS " WHERE id = ?;",
+                            NULL, "s", initiator_id),
           rc, out);
 
-    lsm_hash_free(sim_ag);
-    rc = _db_sim_ag_of_sim_id(err_msg, db, sim_ag_id, &sim_ag);
+    rc = _db_ag_row_of_sim_id(err_msg, db, sim_ag_id, arena, &sim_ag);
     if (rc == LSM_ERR_NOT_FOUND_ACCESS_GROUP) {
         rc = LSM_ERR_PLUGIN_BUG;
         _lsm_err_msg_set(err_msg, "BUG: Failed to find updated access group");
@@ -1018,8 +1030,7 @@ int access_group_initiator_delete(lsm_plugin_ptr c,
     _good(_db_sql_trans_commit(err_msg, db), rc, out);
 
  out:
-    if (sim_ag != NULL)
-        lsm_hash_free(sim_ag);
+    _arena_free(arena);
 
     _db_sql_exec_vec_free(vec);
 
@@ -1042,7 +1053,6 @@ int volume_mask(lsm_plugin_ptr c, lsm_access_group *group, lsm_volume *volume,
     uint64_t sim_ag_id = 0;
     sqlite3 *db = NULL;
     char err_msg[_LSM_ERR_MSG_LEN];
-    char sql_cmd_check_mask[_BUFF_SIZE];
     struct _vector *vec = NULL;
 
      _UNUSED(flags);
@@ -1059,13 +1069,11 @@ int volume_mask(lsm_plugin_ptr c, lsm_access_group *group, lsm_volume *volume,
     _good(_db_sim_vol_of_sim_id(err_msg, db, sim_vol_id, &sim_vol), rc, out);
     _good(_db_sim_ag_of_sim_id(err_msg, db, sim_ag_id, &sim_ag), rc, out);
 
-    _snprintf_buff(err_msg, rc, out, sql_cmd_check_mask,
-                   "SELECT * FROM " _DB_TABLE_VOL_MASKS
-                   " WHERE ag_id=%s AND vol_id=%s;",
-                   _db_lsm_id_to_sim_id_str(lsm_access_group_id_get(group)),
-                   _db_lsm_id_to_sim_id_str(lsm_volume_id_get(volume)));
-
-    _good(_db_sql_exec(err_msg, db, sql_cmd_check_mask, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "SELECT * FROM " _DB_TABLE_VOL_MASKS
+                            " WHERE ag_id = ? AND vol_id = ?;", &vec, "ii",
+                            sim_ag_id, sim_vol_id),
+          rc, out);
 
     if (_vector_size(vec) != 0) {
         rc = LSM_ERR_NO_STATE_CHANGE;
@@ -1110,9 +1118,7 @@ int volume_unmask(lsm_plugin_ptr c, lsm_access_group *group, lsm_volume *volume,
     uint64_t sim_ag_id = 0;
     sqlite3 *db = NULL;
     char err_msg[_LSM_ERR_MSG_LEN];
-    char condition[_BUFF_SIZE];
     struct _vector *vec = NULL;
-    char sql_cmd_check_mask[_BUFF_SIZE];
 
      _UNUSED(flags);
     _lsm_err_msg_clear(err_msg);
@@ -1128,14 +1134,11 @@ int volume_unmask(lsm_plugin_ptr c, lsm_access_group *group, lsm_volume *volume,
     _good(_db_sim_vol_of_sim_id(err_msg, db, sim_vol_id, &sim_vol), rc, out);
     _good(_db_sim_ag_of_sim_id(err_msg, db, sim_ag_id, &sim_ag), rc, out);
 
-    _snprintf_buff(err_msg, rc, out, condition, "ag_id=%s AND vol_id=%s",
-                   _db_lsm_id_to_sim_id_str(lsm_access_group_id_get(group)),
-                   _db_lsm_id_to_sim_id_str(lsm_volume_id_get(volume)));
-
-    _snprintf_buff(err_msg, rc, out, sql_cmd_check_mask, "SELECT * FROM "
-                   _DB_TABLE_VOL_MASKS " WHERE %s;", condition);
-
-    _good(_db_sql_exec(err_msg, db, sql_cmd_check_mask, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "SELECT * FROM " _DB_TABLE_VOL_MASKS
+                            " WHERE ag_id = ? AND vol_id = ?;", &vec, "ii",
+                            sim_ag_id, sim_vol_id),
+          rc, out);
 
     if (_vector_size(vec) == 0) {
         rc = LSM_ERR_NO_STATE_CHANGE;
@@ -1144,8 +1147,11 @@ int volume_unmask(lsm_plugin_ptr c, lsm_access_group *group, lsm_volume *volume,
         goto out;
     }
 
-    _good(_db_data_delete_condition(err_msg, db, _DB_TABLE_VOL_MASKS,
-                                    condition), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "DELETE FROM " _DB_TABLE_VOL_MASKS
+                            " WHERE ag_id = ? AND vol_id = ?;", NULL, "ii",
+                            sim_ag_id, sim_vol_id),
+          rc, out);
     _good(_db_sql_trans_commit(err_msg, db), rc, out);
 
  out:
@@ -1171,12 +1177,12 @@ int volumes_accessible_by_access_group(lsm_plugin_ptr c,
                                        lsm_flag flags)
 {
     int rc = LSM_ERR_OK;
-    lsm_hash *sim_ag = NULL;
+    struct _arena *arena = NULL;
+    struct _db_ag_row *sim_ag = NULL;
     uint64_t sim_ag_id = 0;
     sqlite3 *db = NULL;
     char err_msg[_LSM_ERR_MSG_LEN];
     struct _vector *vec = NULL;
-    char sql_cmd[_BUFF_SIZE];
 
      _UNUSED(flags);
     _lsm_err_msg_clear(err_msg);
@@ -1185,17 +1191,19 @@ int volumes_accessible_by_access_group(lsm_plugin_ptr c,
                           count),
           rc, out);
     _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    _good(_db_sql_trans_begin_read(err_msg, db), rc, out);
 
     sim_ag_id = _db_lsm_id_to_sim_id(lsm_access_group_id_get(group));
 
-    _good(_db_sim_ag_of_sim_id(err_msg, db, sim_ag_id, &sim_ag), rc, out);
-
-    _snprintf_buff(err_msg, rc, out, sql_cmd, "SELECT * FROM "
-                   _DB_TABLE_VOLS_VIEW_BY_AG " WHERE ag_id=%" PRIu64 ";",
-                   sim_ag_id);
+    arena = _arena_new();
+    _alloc_null_check(err_msg, arena, rc, out);
+    _good(_db_ag_row_of_sim_id(err_msg, db, sim_ag_id, arena, &sim_ag),
+          rc, out);
 
-    _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+    _good(_db_sql_exec_rows(err_msg, db, "SELECT * FROM "
+                            _DB_TABLE_VOLS_VIEW_BY_AG " WHERE ag_id = ?;",
+                            &_db_vol_row_desc, arena, &vec, "i", sim_ag_id),
+          rc, out);
 
     if (_vector_size(vec) == 0) {
         *count = 0;
@@ -1210,11 +1218,8 @@ int volumes_accessible_by_access_group(lsm_plugin_ptr c,
 
  out:
     _db_sql_trans_rollback(db);
-    if (sim_ag != NULL)
-        lsm_hash_free(sim_ag);
-
-    if (vec != NULL)
-        _db_sql_exec_vec_free(vec);
+    _vector_free(vec);
+    _arena_free(arena);
 
     if (rc != LSM_ERR_OK) {
         if (volumes != NULL)
@@ -1231,12 +1236,12 @@ int access_groups_granted_to_volume(lsm_plugin_ptr c, lsm_volume *volume,
                                     uint32_t *count, lsm_flag flags)
 {
     int rc = LSM_ERR_OK;
-    lsm_hash *sim_vol = NULL;
+    struct _arena *arena = NULL;
+    struct _db_vol_row *sim_vol = NULL;
     uint64_t sim_vol_id = 0;
     sqlite3 *db = NULL;
     char err_msg[_LSM_ERR_MSG_LEN];
     struct _vector *vec = NULL;
-    char sql_cmd[_BUFF_SIZE];
 
      _UNUSED(flags);
     _lsm_err_msg_clear(err_msg);
@@ -1245,17 +1250,19 @@ int access_groups_granted_to_volume(lsm_plugin_ptr c, lsm_volume *volume,
                           count),
           rc, out);
     _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    _good(_db_sql_trans_begin_read(err_msg, db), rc, out);
 
     sim_vol_id = _db_lsm_id_to_sim_id(lsm_volume_id_get(volume));
 
-    _good(_db_sim_vol_of_sim_id(err_msg, db, sim_vol_id, &sim_vol), rc, out);
-
-    _snprintf_buff(err_msg, rc, out, sql_cmd, "SELECT * FROM "
-                   _DB_TABLE_AGS_VIEW_BY_VOL " WHERE vol_id=%" PRIu64 ";",
-                   sim_vol_id);
+    arena = _arena_new();
+    _alloc_null_check(err_msg, arena, rc, out);
+    _good(_db_vol_row_of_sim_id(err_msg, db, sim_vol_id, arena, &sim_vol),
+          rc, out);
 
-    _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+    _good(_db_sql_exec_rows(err_msg, db, "SELECT * FROM "
+                            _DB_TABLE_AGS_VIEW_BY_VOL " WHERE vol_id = ?;",
+                            &_db_ag_row_desc, arena, &vec, "i", sim_vol_id),
+          rc, out);
 
     if (_vector_size(vec) == 0) {
         *count = 0;
@@ -1270,11 +1277,8 @@ int access_groups_granted_to_volume(lsm_plugin_ptr c, lsm_volume *volume,
 
  out:
     _db_sql_trans_rollback(db);
-    if (sim_vol != NULL)
-        lsm_hash_free(sim_vol);
-
-    if (vec != NULL)
-        _db_sql_exec_vec_free(vec);
+    _vector_free(vec);
+    _arena_free(arena);
 
     if (rc != LSM_ERR_OK) {
         if (groups != NULL)
@@ -1294,7 +1298,6 @@ int vol_child_depends(lsm_plugin_ptr c, lsm_volume *volume, uint8_t *yes,
     char err_msg[_LSM_ERR_MSG_LEN];
     lsm_hash *sim_vol = NULL;
     uint64_t sim_vol_id = 0;
-    char sql_cmd[_BUFF_SIZE];
     struct _vector *vec = NULL;
 
      _UNUSED(flags);
@@ -1303,17 +1306,16 @@ int vol_child_depends(lsm_plugin_ptr c, lsm_volume *volume, uint8_t *yes,
     _good(_check_null_ptr(err_msg, 2 /* argument count */, volume, yes),
           rc, out);
     _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    _good(_db_sql_trans_begin_read(err_msg, db), rc, out);
 
     sim_vol_id = _db_lsm_id_to_sim_id(lsm_volume_id_get(volume));
 
     _good(_db_sim_vol_of_sim_id(err_msg, db, sim_vol_id, &sim_vol), rc, out);
 
-    _snprintf_buff(err_msg, rc, out, sql_cmd, "SELECT * FROM "
-                   _DB_TABLE_VOL_REPS " WHERE src_vol_id = %" PRIu64 " AND "
-                   "dst_vol_id != %" PRIu64 ";", sim_vol_id, sim_vol_id);
-
-    _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db, "SELECT * FROM "
+                            _DB_TABLE_VOL_REPS " WHERE src_vol_id = ?1 AND "
+                            "dst_vol_id != ?1;", &vec, "i", sim_vol_id),
+          rc, out);
 
     if (_vector_size(vec) != 0)
         *yes = 1;
@@ -1341,9 +1343,7 @@ int vol_child_depends_rm(lsm_plugin_ptr c, lsm_volume *volume, char **job,
     char err_msg[_LSM_ERR_MSG_LEN];
     lsm_hash *sim_vol = NULL;
     uint64_t sim_vol_id = 0;
-    char sql_cmd[_BUFF_SIZE];
     struct _vector *vec = NULL;
-    char condition[_BUFF_SIZE];
 
      _UNUSED(flags);
     _lsm_err_msg_clear(err_msg);
@@ -1360,11 +1360,10 @@ int vol_child_depends_rm(lsm_plugin_ptr c, lsm_volume *volume, char **job,
 
     _good(_db_sim_vol_of_sim_id(err_msg, db, sim_vol_id, &sim_vol), rc, out);
 
-    _snprintf_buff(err_msg, rc, out, sql_cmd, "SELECT * FROM "
-                   _DB_TABLE_VOL_REPS " WHERE src_vol_id = %" PRIu64 " AND "
-                   "dst_vol_id != %" PRIu64 ";", sim_vol_id, sim_vol_id);
-
-    _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);
+    _good(_db_sql_exec_bind(err_msg, db, "SELECT * FROM "
+                            _DB_TABLE_VOL_REPS " WHERE src_vol_id = ?1 AND "
+                            "dst_vol_id != ?1;", &vec, "i", sim_vol_id),
+          rc, out);
 
     if (_vector_size(vec) == 0) {
         rc = LSM_ERR_NO_STATE_CHANGE;
@@ -1373,10 +1372,9 @@ int vol_child_depends_rm(lsm_plugin_ptr c, lsm_volume *volume, char **job,
         goto out;
     }
 
-    _snprintf_buff(err_msg, rc, out, condition, "src_vol_id=%" PRIu64,
-                   sim_vol_id);
-    _good(_db_data_delete_condition(err_msg, db, _DB_TABLE_VOL_REPS,
-                                    condition),
+    _good(_db_sql_exec_bind(err_msg, db,
+                            "DELETE FROM " _DB_TABLE_VOL_REPS
+                            " WHERE src_vol_id = ?;", NULL, "i", sim_vol_id),
           rc, out);
 
     _good(_job_create(err_msg, db, LSM_DATA_TYPE_NONE, _DB_SIM_ID_NONE, job),
@@ -24,14 +24,34 @@
 #include <stdint.h>
 #include <sqlite3.h>
 
+#include "db.h"
+
 int volume_list(lsm_plugin_ptr c, const char *search_key,
                 const char *search_val, lsm_volume **vol_array[],
                 uint32_t *count, lsm_flag flags);
 
+int volume_list_page(lsm_plugin_ptr c, const char *search_key,
+                     const char *search_val, const char *cursor,
+                     uint32_t limit, lsm_volume **vol_array[],
+                     uint32_t *count, char **next_cursor, lsm_flag flags);
+
+int volume_list_in(lsm_plugin_ptr c, const char *search_key,
+                   lsm_string_list *search_values, lsm_volume **vol_array[],
+                   uint32_t *count, lsm_flag flags);
+
 int disk_list(lsm_plugin_ptr c, const char *search_key,
               const char *search_value, lsm_disk **disk_array[],
               uint32_t *count, lsm_flag flags);
 
+int disk_list_page(lsm_plugin_ptr c, const char *search_key,
+                   const char *search_value, const char *cursor,
+                   uint32_t limit, lsm_disk **disk_array[],
+                   uint32_t *count, char **next_cursor, lsm_flag flags);
+
+int disk_list_in(lsm_plugin_ptr c, const char *search_key,
+                 lsm_string_list *search_values, lsm_disk **disk_array[],
+                 uint32_t *count, lsm_flag flags);
+
 int volume_create(lsm_plugin_ptr c, lsm_pool *pool, const char *volume_name,
                   uint64_t size, lsm_volume_provision_type provisioning,
                   lsm_volume **new_volume, char **job, lsm_flag flags);
@@ -70,6 +90,17 @@ int access_group_list(lsm_plugin_ptr c, const char *search_key,
                       const char *search_value, lsm_access_group **groups[],
                       uint32_t *count, lsm_flag flags);
 
+int access_group_list_page(lsm_plugin_ptr c, const char *search_key,
+                           const char *search_value, const char *cursor,
+                           uint32_t limit, lsm_access_group **groups[],
+                           uint32_t *count, char **next_cursor,
+                           lsm_flag flags);
+
+int access_group_list_in(lsm_plugin_ptr c, const char *search_key,
+                         lsm_string_list *search_values,
+                         lsm_access_group **groups[], uint32_t *count,
+                         lsm_flag flags);
+
 int access_group_create(lsm_plugin_ptr c, const char *name,
                         const char *initiator_id,
                         lsm_access_group_init_type init_type,
@@ -115,9 +146,10 @@ int target_port_list(lsm_plugin_ptr c, const char *search_key,
                      lsm_target_port **target_port_array[], uint32_t *count,
                      lsm_flag flags);
 
-lsm_volume *_sim_vol_to_lsm(char *err_msg, lsm_hash *sim_vol);
+lsm_volume *_sim_vol_to_lsm(char *err_msg, const struct _db_vol_row *sim_vol);
 
-lsm_access_group *_sim_ag_to_lsm(char *err_msg, lsm_hash *sim_ag);
+lsm_access_group *_sim_ag_to_lsm(char *err_msg,
+                                 const struct _db_ag_row *sim_ag);
 
 int _volume_create_internal(char *err_msg, sqlite3 *db, const char *name,
                             uint64_t size, uint64_t sim_pool_id);
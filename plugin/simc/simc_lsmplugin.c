@@ -124,6 +124,19 @@ static struct lsm_ops_v1_3 ops_v1_3 = {
     volume_read_cache_policy_update,
 };
 
+static struct lsm_ops_v1_6 ops_v1_6 = {
+    volume_list_page,
+    disk_list_page,
+    access_group_list_page,
+    fs_list_page,
+    nfs_list_page,
+    volume_list_in,
+    disk_list_in,
+    access_group_list_in,
+    fs_list_in,
+    nfs_list_in,
+};
+
 int plugin_register(lsm_plugin_ptr c, const char *uri, const char *password,
                     uint32_t timeout, lsm_flag flags)
 {
@@ -184,9 +197,12 @@ int plugin_register(lsm_plugin_ptr c, const char *uri, const char *password,
     pri_data->db = db;
     pri_data->timeout = timeout;
 
-    rc = lsm_register_plugin_v1_3(c, pri_data, &mgm_ops, &san_ops,
+    rc = lsm_register_plugin_v1_6(c, pri_data, &mgm_ops, &san_ops,
                                   &fs_ops, &nfs_ops, &ops_v1_2,
-                                  &ops_v1_3);
+                                  &ops_v1_3, &ops_v1_6);
+    if (rc == LSM_ERR_OK)
+        rc = lsm_plugin_batch_hooks_set(c, batch_begin, batch_end,
+                                        LSM_CLIENT_FLAG_RSVD);
 
  out:
     free(scheme);
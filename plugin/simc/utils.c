@@ -110,6 +110,25 @@ int _check_null_ptr(char *err_msg, int arg_count, ...)
     return rc;
 }
 
+int _cursor_to_sim_id(char *err_msg, const char *cursor, uint64_t *sim_id)
+{
+    const char *p = cursor;
+
+    assert(cursor != NULL);
+    assert(sim_id != NULL);
+
+    for (; *p != '\0'; ++p) {
+        if ((*p < '0') || (*p > '9'))
+            break;
+    }
+    if ((p == cursor) || (*p != '\0') || (p - cursor > 19)) {
+        _lsm_err_msg_set(err_msg, "Invalid cursor '%s'", cursor);
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+    *sim_id = strtoull(cursor, NULL, 10 /* base */);
+    return LSM_ERR_OK;
+}
+
 static int _str_to_ll(char *err_msg, const char *str, long long int *val)
 {
     int tmp_errno = 0;
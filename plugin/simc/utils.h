@@ -19,6 +19,7 @@
 #ifndef _SIMC_UTILS_H_
 #define _SIMC_UTILS_H_
 
+#include <inttypes.h>
 #include <openssl/md5.h>
 #include <stdbool.h>
 #include <sqlite3.h>
@@ -88,7 +89,7 @@ struct _simc_private_data {
     do { \
         uint64_t __i = 0; \
         lsm_xxx_type *__lsm_xxx = NULL; \
-        lsm_hash *__sim_xxx = NULL; \
+        const void *__sim_xxx = NULL; \
         *array = (lsm_xxx_type **) malloc(sizeof(lsm_xxx_type *) * \
                                           _vector_size(vec)); \
         _alloc_null_check(err_msg, *array, rc, out); \
@@ -105,22 +106,29 @@ struct _simc_private_data {
         } \
     } while(0)
 
+/*
+ * The rows are decoded as row_desc into an arena dropped once converted.
+ */
 #define _xxx_list_func_gen(func_name, rc_type, conv_func, filter_func, table, \
-                           lsm_xxx_array_free_func) \
+                           row_desc, search_keys, lsm_xxx_array_free_func) \
 int func_name(lsm_plugin_ptr c, const char *search_key, \
               const char *search_value, rc_type **array[], \
               uint32_t *count, lsm_flag flags) \
 { \
     int rc = LSM_ERR_OK; \
     struct _vector *vec = NULL; \
+    struct _arena *arena = NULL; \
     sqlite3 *db = NULL; \
     char err_msg[_LSM_ERR_MSG_LEN]; \
     _UNUSED(flags); \
     _lsm_err_msg_clear(err_msg); \
     _check_null_ptr(err_msg, 2 /* argument count */, array, count); \
     _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out); \
-    _good(_db_sql_trans_begin(err_msg, db), rc, out); \
-    _good(_db_sql_exec(err_msg, db, "SELECT * from " table ";", &vec), \
+    arena = _arena_new(); \
+    _alloc_null_check(err_msg, arena, rc, out); \
+    _good(_db_sql_trans_begin_read(err_msg, db), rc, out); \
+    _good(_db_sql_search(err_msg, db, table, search_keys, search_key, \
+                         search_value, &row_desc, arena, &vec), \
           rc, out); \
     if (_vector_size(vec) == 0) { \
         *array = NULL; \
@@ -131,7 +139,8 @@ int func_name(lsm_plugin_ptr c, const char *search_key, \
                           out); \
  out: \
     _db_sql_trans_rollback(db); \
-    _db_sql_exec_vec_free(vec); \
+    _vector_free(vec); \
+    _arena_free(arena); \
     if (rc != LSM_ERR_OK) { \
         if (*array != NULL) { \
             lsm_xxx_array_free_func(*array, *count); \
@@ -144,6 +153,134 @@ int func_name(lsm_plugin_ptr c, const char *search_key, \
     } \
     return rc; \
 }
+/*
+ * IN search variant of _xxx_list_func_gen().
+ */
+#define _xxx_list_in_func_gen(func_name, rc_type, conv_func, filter_in_func, \
+                              table, row_desc, search_keys, \
+                              lsm_xxx_array_free_func) \
+int func_name(lsm_plugin_ptr c, const char *search_key, \
+              lsm_string_list *search_values, rc_type **array[], \
+              uint32_t *count, lsm_flag flags) \
+{ \
+    int rc = LSM_ERR_OK; \
+    struct _vector *vec = NULL; \
+    struct _arena *arena = NULL; \
+    sqlite3 *db = NULL; \
+    char err_msg[_LSM_ERR_MSG_LEN]; \
+    _UNUSED(flags); \
+    _lsm_err_msg_clear(err_msg); \
+    rc = _check_null_ptr(err_msg, 4 /* argument count */, search_key, \
+                         search_values, array, count); \
+    if (rc != LSM_ERR_OK) { \
+        lsm_log_error_basic(c, rc, err_msg); \
+        return rc; \
+    } \
+    *array = NULL; \
+    *count = 0; \
+    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out); \
+    arena = _arena_new(); \
+    _alloc_null_check(err_msg, arena, rc, out); \
+    _good(_db_sql_trans_begin_read(err_msg, db), rc, out); \
+    _good(_db_sql_search_in(err_msg, db, table, search_keys, search_key, \
+                            search_values, &row_desc, arena, &vec), \
+          rc, out); \
+    if (_vector_size(vec) == 0) \
+        goto out; \
+    _vec_to_lsm_xxx_array(err_msg, vec, rc_type, conv_func, array, count, rc, \
+                          out); \
+ out: \
+    if (db != NULL) \
+        _db_sql_trans_rollback(db); \
+    _vector_free(vec); \
+    _arena_free(arena); \
+    if (rc != LSM_ERR_OK) { \
+        if (*array != NULL) { \
+            lsm_xxx_array_free_func(*array, *count); \
+            *array = NULL; \
+            *count = 0; \
+        } \
+        lsm_log_error_basic(c, rc, err_msg); \
+    } else if (*array != NULL) { \
+        filter_in_func(search_key, search_values, *array, count); \
+    } \
+    return rc; \
+}
+
+/*
+ * Page variant of _xxx_list_func_gen().  The cursor handed to the client is
+ * the integer id of the last row returned, so the next page starts right
+ * after it whatever got created or deleted in between.
+ */
+#define _xxx_list_page_func_gen(func_name, rc_type, conv_func, filter_func, \
+                                table, row_desc, search_keys, \
+                                lsm_xxx_array_free_func) \
+int func_name(lsm_plugin_ptr c, const char *search_key, \
+              const char *search_value, const char *cursor, uint32_t limit, \
+              rc_type **array[], uint32_t *count, char **next_cursor, \
+              lsm_flag flags) \
+{ \
+    int rc = LSM_ERR_OK; \
+    struct _vector *vec = NULL; \
+    struct _arena *arena = NULL; \
+    sqlite3 *db = NULL; \
+    uint64_t after_sim_id = _DB_SIM_ID_NONE; \
+    char last_id[_BUFF_SIZE]; \
+    char err_msg[_LSM_ERR_MSG_LEN]; \
+    _UNUSED(flags); \
+    _lsm_err_msg_clear(err_msg); \
+    rc = _check_null_ptr(err_msg, 3 /* argument count */, array, count, \
+                         next_cursor); \
+    if ((rc == LSM_ERR_OK) && (limit == 0)) { \
+        rc = LSM_ERR_INVALID_ARGUMENT; \
+        _lsm_err_msg_set(err_msg, "Page limit should be greater than 0"); \
+    } \
+    if (rc != LSM_ERR_OK) { \
+        lsm_log_error_basic(c, rc, err_msg); \
+        return rc; \
+    } \
+    *array = NULL; \
+    *count = 0; \
+    *next_cursor = NULL; \
+    if (cursor != NULL) \
+        _good(_cursor_to_sim_id(err_msg, cursor, &after_sim_id), rc, out); \
+    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out); \
+    arena = _arena_new(); \
+    _alloc_null_check(err_msg, arena, rc, out); \
+    _good(_db_sql_trans_begin_read(err_msg, db), rc, out); \
+    _good(_db_sql_search_page(err_msg, db, table, search_keys, search_key, \
+                              search_value, after_sim_id, limit, &row_desc, \
+                              arena, &vec), \
+          rc, out); \
+    if (_vector_size(vec) == 0) \
+        goto out; \
+    if (_vector_size(vec) == limit) { \
+        _snprintf_buff(err_msg, rc, out, last_id, "%" PRIu64, \
+                       _db_row_sim_id(_vector_get(vec, limit - 1))); \
+        *next_cursor = strdup(last_id); \
+        _alloc_null_check(err_msg, *next_cursor, rc, out); \
+    } \
+    _vec_to_lsm_xxx_array(err_msg, vec, rc_type, conv_func, array, count, rc, \
+                          out); \
+ out: \
+    if (db != NULL) \
+        _db_sql_trans_rollback(db); \
+    _vector_free(vec); \
+    _arena_free(arena); \
+    if (rc != LSM_ERR_OK) { \
+        if (*array != NULL) { \
+            lsm_xxx_array_free_func(*array, *count); \
+            *array = NULL; \
+            *count = 0; \
+        } \
+        free(*next_cursor); \
+        *next_cursor = NULL; \
+        lsm_log_error_basic(c, rc, err_msg); \
+    } else if (*array != NULL) { \
+        filter_func(search_key, search_value, *array, count); \
+    } \
+    return rc; \
+}
 int _get_db_from_plugin_ptr(char *err_msg, lsm_plugin_ptr c, sqlite3 **db);
 
 /*
@@ -163,6 +300,12 @@ int _str_to_uint32(char *err_msg, const char *str, uint32_t *val);
 
 int _str_to_uint64(char *err_msg, const char *str, uint64_t *val);
 
+/*
+ * Parse a list page cursor made by _xxx_list_page_func_gen() back into the
+ * sim id it was built from.
+ */
+int _cursor_to_sim_id(char *err_msg, const char *cursor, uint64_t *sim_id);
+
 int _check_null_ptr(char *err_msg, int arg_count, ...);
 
 /*
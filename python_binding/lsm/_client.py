@@ -91,7 +91,9 @@ def __start(self, uri, password, timeout, flags=0):
         """
         Instruct the plug-in to get ready
         """
-        self._tp.rpc('plugin_register', _del_self(locals()))
+        params = _del_self(locals())
+        self._tp.protocol_set(self._tp.rpc('plugin_register', params,
+                                           self._tp.protocol_offer()))
 
     # Checks to see if any unix domain sockets exist in the base directory
     # and opens a socket to one to see if the server is actually there.
@@ -394,6 +396,24 @@ def volumes(self, search_key=None, search_value=None, flags=FLAG_RSVD):
         _check_search_key(search_key, Volume.SUPPORTED_SEARCH_KEYS)
         return self._tp.rpc('volumes', _del_self(locals()))
 
+    # Returns one page of volume objects
+    # @param    self            The this pointer
+    # @param    search_key      Search key to use
+    # @param    search_value    Search value
+    # @param    cursor          None for the first page, else the next_cursor
+    #                           returned with the previous page
+    # @param    limit           Maximum number of objects in this page
+    # @param    flags           Reserved for future use, must be zero.
+    # @returns [objects, next_cursor], next_cursor is None on the last page
+    @_return_requires([Volume], six.string_types[0])
+    def volumes_page(self, search_key=None, search_value=None, cursor=None,
+                     limit=100, flags=FLAG_RSVD):
+        """
+        Returns one page of volume objects and the cursor of the next page
+        """
+        _check_search_key(search_key, Volume.SUPPORTED_SEARCH_KEYS)
+        return self._tp.rpc('volumes_page', _del_self(locals()))
+
     # Creates a volume
     # @param    self            The this pointer
     # @param    pool            The pool object to allocate storage from
@@ -549,6 +569,24 @@ def disks(self, search_key=None, search_value=None, flags=FLAG_RSVD):
         _check_search_key(search_key, Disk.SUPPORTED_SEARCH_KEYS)
         return self._tp.rpc('disks', _del_self(locals()))
 
+    # Returns one page of disk objects
+    # @param    self            The this pointer
+    # @param    search_key      Search key to use
+    # @param    search_value    Search value
+    # @param    cursor          None for the first page, else the next_cursor
+    #                           returned with the previous page
+    # @param    limit           Maximum number of objects in this page
+    # @param    flags           Reserved for future use, must be zero.
+    # @returns [objects, next_cursor], next_cursor is None on the last page
+    @_return_requires([Disk], six.string_types[0])
+    def disks_page(self, search_key=None, search_value=None, cursor=None,
+                   limit=100, flags=FLAG_RSVD):
+        """
+        Returns one page of disk objects and the cursor of the next page
+        """
+        _check_search_key(search_key, Disk.SUPPORTED_SEARCH_KEYS)
+        return self._tp.rpc('disks_page', _del_self(locals()))
+
     # Access control for allowing an access group to access a volume
     # @param    self            The this pointer
     # @param    access_group    The access group
@@ -590,6 +628,25 @@ def access_groups(self, search_key=None, search_value=None,
         _check_search_key(search_key, AccessGroup.SUPPORTED_SEARCH_KEYS)
         return self._tp.rpc('access_groups', _del_self(locals()))
 
+    # Returns one page of access group objects
+    # @param    self            The this pointer
+    # @param    search_key      Search key to use
+    # @param    search_value    Search value
+    # @param    cursor          None for the first page, else the next_cursor
+    #                           returned with the previous page
+    # @param    limit           Maximum number of objects in this page
+    # @param    flags           Reserved for future use, must be zero.
+    # @returns [objects, next_cursor], next_cursor is None on the last page
+    @_return_requires([AccessGroup], six.string_types[0])
+    def access_groups_page(self, search_key=None, search_value=None,
+                           cursor=None, limit=100, flags=FLAG_RSVD):
+        """
+        Returns one page of access group objects and the cursor of the next
+        page
+        """
+        _check_search_key(search_key, AccessGroup.SUPPORTED_SEARCH_KEYS)
+        return self._tp.rpc('access_groups_page', _del_self(locals()))
+
     # Creates an access a group with the specified initiator in it.
     # @param    self                The this pointer
     # @param    name                The initiator group name
@@ -733,6 +790,24 @@ def fs(self, search_key=None, search_value=None, flags=FLAG_RSVD):
         _check_search_key(search_key, FileSystem.SUPPORTED_SEARCH_KEYS)
         return self._tp.rpc('fs', _del_self(locals()))
 
+    # Returns one page of file system objects
+    # @param    self            The this pointer
+    # @param    search_key      Search key to use
+    # @param    search_value    Search value
+    # @param    cursor          None for the first page, else the next_cursor
+    #                           returned with the previous page
+    # @param    limit           Maximum number of objects in this page
+    # @param    flags           Reserved for future use, must be zero.
+    # @returns [objects, next_cursor], next_cursor is None on the last page
+    @_return_requires([FileSystem], six.string_types[0])
+    def fs_page(self, search_key=None, search_value=None, cursor=None,
+                limit=100, flags=FLAG_RSVD):
+        """
+        Returns one page of file system objects and the cursor of the next page
+        """
+        _check_search_key(search_key, FileSystem.SUPPORTED_SEARCH_KEYS)
+        return self._tp.rpc('fs_page', _del_self(locals()))
+
     # Deletes a file system
     # @param    self    The this pointer
     # @param    fs      The file system to delete
@@ -964,6 +1039,24 @@ def exports(self, search_key=None, search_value=None, flags=FLAG_RSVD):
         _check_search_key(search_key, NfsExport.SUPPORTED_SEARCH_KEYS)
         return self._tp.rpc('exports', _del_self(locals()))
 
+    # Returns one page of NFS export objects
+    # @param    self            The this pointer
+    # @param    search_key      Search key to use
+    # @param    search_value    Search value
+    # @param    cursor          None for the first page, else the next_cursor
+    #                           returned with the previous page
+    # @param    limit           Maximum number of objects in this page
+    # @param    flags           Reserved for future use, must be zero.
+    # @returns [objects, next_cursor], next_cursor is None on the last page
+    @_return_requires([NfsExport], six.string_types[0])
+    def exports_page(self, search_key=None, search_value=None, cursor=None,
+                     limit=100, flags=FLAG_RSVD):
+        """
+        Returns one page of NFS export objects and the cursor of the next page
+        """
+        _check_search_key(search_key, NfsExport.SUPPORTED_SEARCH_KEYS)
+        return self._tp.rpc('exports_page', _del_self(locals()))
+
     # Exports a FS as specified in the export.
     # @param    self            The this pointer
     # @param    fs_id           The FS ID to export
@@ -14,10 +14,13 @@
 #
 # Author: tasleson
 
+import os
 import socket
+import struct
 import traceback
 import sys
-from lsm import LsmError, error, ErrorNumber
+import time
+from lsm import LsmError, error, ErrorNumber, JobStatus
 from lsm.lsmcli import cmd_line_wrapper
 import six
 
@@ -52,11 +55,39 @@ def _is_number(val):
         except ValueError:
             return False
 
+    @staticmethod
+    def _worker_client_wait(ctl_fd):
+        """
+        Plug-in processes lsmd starts ahead of time get a control socket
+        instead of the client connection, which gets passed over it once a
+        client connects.  Returns the client connection, None if lsmd went
+        away instead.
+        """
+        ctl = socket.fromfd(ctl_fd, socket.AF_UNIX, socket.SOCK_STREAM)
+        os.close(ctl_fd)
+        try:
+            int_size = struct.calcsize('i')
+            msg, anc, flags, addr = ctl.recvmsg(
+                1, socket.CMSG_SPACE(int_size))
+            for level, kind, data in anc:
+                if level == socket.SOL_SOCKET and \
+                        kind == socket.SCM_RIGHTS:
+                    return struct.unpack('i', data[:int_size])[0]
+        finally:
+            ctl.close()
+        return None
+
     def __init__(self, plugin, args):
         self.cmdline = False
         if len(args) == 2 and PluginRunner._is_number(args[1]):
             try:
                 fd = int(args[1])
+                if os.environ.pop('LSM_PLUGIN_WORKER', None):
+                    fd = PluginRunner._worker_client_wait(fd)
+                    if fd is None:
+                        # lsmd shut down or reloaded before handing us a
+                        # client
+                        sys.exit(0)
                 self.tp = TransPort(
                     socket.fromfd(fd, socket.AF_UNIX, socket.SOCK_STREAM))
 
@@ -80,6 +111,124 @@ def __init__(self, plugin, args):
             self.cmdline = True
             cmd_line_wrapper(plugin)
 
+    def _batch(self, requests, flags=0):
+        """
+        Default handling of a batch, the requests are run one after the
+        other and each one gets its own result or error.
+        """
+        results = []
+        for req in requests:
+            try:
+                method = req.get('method')
+                params = req.get('params')
+                if method in ('batch', 'plugin_register',
+                              'plugin_unregister') or \
+                        not isinstance(params, dict):
+                    raise LsmError(ErrorNumber.TRANSPORT_INVALID_ARG,
+                                   "Invalid request in batch")
+                if not hasattr(self.plugin, method):
+                    raise LsmError(ErrorNumber.NO_SUPPORT,
+                                   "Unsupported operation")
+                results.append(
+                    dict(result=getattr(self.plugin, method)(**params)))
+            except LsmError as lsm_err:
+                results.append(dict(error=dict(code=lsm_err.code,
+                                               message=lsm_err.msg,
+                                               data=lsm_err.data)))
+        return results
+
+    # Paged list methods and the full list method they fall back to.
+    _PAGE_METHODS = {'volumes_page': 'volumes',
+                     'disks_page': 'disks',
+                     'access_groups_page': 'access_groups',
+                     'fs_page': 'fs',
+                     'exports_page': 'exports'}
+
+    def _list_page(self, method, search_key=None, search_value=None,
+                   cursor=None, limit=0, flags=0):
+        """
+        Default handling of a paged list, the full list is fetched and
+        sliced, the cursor being the offset of the next page.
+        """
+        list_method = PluginRunner._PAGE_METHODS[method]
+        if not hasattr(self.plugin, list_method):
+            raise LsmError(ErrorNumber.NO_SUPPORT, "Unsupported operation")
+        try:
+            start = 0 if cursor is None else int(cursor)
+        except ValueError:
+            start = -1
+        if start < 0 or not isinstance(limit, six.integer_types) or \
+                limit <= 0:
+            raise LsmError(ErrorNumber.INVALID_ARGUMENT,
+                           "Invalid cursor or limit")
+
+        items = getattr(self.plugin, list_method)(
+            search_key=search_key, search_value=search_value, flags=flags)
+        next_cursor = None
+        if start + limit < len(items):
+            next_cursor = str(start + limit)
+        return [items[start:start + limit], next_cursor]
+
+    _LIST_METHODS = ('volumes', 'disks', 'access_groups', 'fs', 'exports')
+
+    def _list(self, method, search_key=None, search_value=None, fields=None,
+              flags=0):
+        """
+        List call with what plug-ins are not asked to handle: a list of
+        search values to match any of, or the fields to return.
+        """
+        if isinstance(search_value, list):
+            values = set(search_value)
+            items = [i for i in getattr(self.plugin, method)(flags=flags)
+                     if getattr(i, search_key, None) in values]
+        else:
+            items = getattr(self.plugin, method)(
+                search_key=search_key, search_value=search_value, flags=flags)
+        if fields is not None:
+            items = PluginRunner._project(items, fields)
+        return items
+
+    # Job checks of a wait start often and back off, in seconds.
+    _JOB_WAIT_POLL_MIN = 0.01
+    _JOB_WAIT_POLL_MAX = 1.0
+
+    def _job_wait(self, job_ids, timeout, flags=0):
+        """
+        Default handling of a job wait, checks on the jobs with a growing
+        interval until one is no longer in progress or timeout (ms) passed.
+        Returns [index, status, percent] of that job.
+        """
+        if not hasattr(self.plugin, 'job_status'):
+            raise LsmError(ErrorNumber.NO_SUPPORT, "Unsupported operation")
+        if not isinstance(job_ids, list) or len(job_ids) == 0:
+            raise LsmError(ErrorNumber.TRANSPORT_INVALID_ARG,
+                           "Invalid job ids")
+
+        deadline = time.time() + timeout / 1000.0
+        interval = PluginRunner._JOB_WAIT_POLL_MIN
+        while True:
+            for i, job_id in enumerate(job_ids):
+                (status, percent, data) = self.plugin.job_status(job_id,
+                                                                 flags)
+                if status != JobStatus.INPROGRESS:
+                    return [i, status, percent]
+
+            remaining = deadline - time.time()
+            if remaining <= 0:
+                raise LsmError(ErrorNumber.TIMEOUT, "Job still in progress")
+            time.sleep(min(interval, remaining))
+            interval = min(interval * 2, PluginRunner._JOB_WAIT_POLL_MAX)
+
+    @staticmethod
+    def _project(items, fields):
+        """
+        Keep only the requested fields of listed objects, the class and id
+        are always kept.
+        """
+        keep = set(fields) | set(('class', 'id'))
+        return [dict((k, v) for (k, v) in i._to_dict().items() if k in keep)
+                for i in items]
+
     def run(self):
         # Don't need to invoke this when running stand alone as a cmdline
         if self.cmdline:
@@ -99,9 +248,27 @@ def run(self):
                     msg_id = msg['id']
                     params = msg['params']
 
+                    # The transport protocol is negotiated by us, the plug-in
+                    # never sees it.
+                    protocol = msg.get('protocol')
+
                     # Check to see if this plug-in implements this operation
                     # if not return the expected error.
-                    if hasattr(self.plugin, method):
+                    if method == 'batch' and \
+                            not hasattr(self.plugin, method):
+                        result = self._batch(**params)
+                    elif method == 'job_wait' and \
+                            not hasattr(self.plugin, method):
+                        result = self._job_wait(**params)
+                    elif method in PluginRunner._PAGE_METHODS and \
+                            not hasattr(self.plugin, method):
+                        result = self._list_page(method, **params)
+                    elif method in PluginRunner._LIST_METHODS and params \
+                            and hasattr(self.plugin, method) and \
+                            ('fields' in params or
+                             isinstance(params.get('search_value'), list)):
+                        result = self._list(method, **params)
+                    elif hasattr(self.plugin, method):
                         if params is None:
                             result = getattr(self.plugin, method)()
                         else:
@@ -111,9 +278,13 @@ def run(self):
                         raise LsmError(ErrorNumber.NO_SUPPORT,
                                        "Unsupported operation")
 
-                    self.tp.send_resp(result)
+                    if method == 'plugin_register':
+                        result = self.tp.protocol_select(protocol)
+
+                    self.tp.send_resp(result, msg_id)
 
                     if method == 'plugin_register':
+                        self.tp.protocol_set(result)
                         need_shutdown = True
 
                     if method == 'plugin_unregister':
@@ -17,6 +17,7 @@
 import json
 import socket
 import string
+import struct
 import os
 import unittest
 import threading
@@ -25,6 +26,54 @@
 from lsm._common import SocketEOF as _SocketEOF
 from lsm._data import DataDecoder as _DataDecoder
 from lsm._data import DataEncoder as _DataEncoder
+from lsm._data import IData as _IData
+
+try:
+    import msgpack
+    # Need raw=False to get str back when unpacking
+    _HAS_MSGPACK = msgpack.version >= (0, 5, 2)
+except ImportError:
+    _HAS_MSGPACK = False
+
+# Compact json on the wire, set LSM_DEBUG_JSON to get it indented instead.
+_DEBUG_JSON = 'LSM_DEBUG_JSON' in os.environ
+
+
+def _json_dumps(obj):
+    if _DEBUG_JSON:
+        return json.dumps(obj, cls=_DataEncoder, indent=2)
+    return json.dumps(obj, cls=_DataEncoder, separators=(',', ':'))
+
+
+def _msgpack_default(obj):
+    return _DataEncoder().default(obj)
+
+
+def _msgpack_object_hook(d):
+    if 'class' in d:
+        return _IData._factory(d)
+    return d
+
+
+# Extension type the C side uses for numbers msgpack can't hold, as text
+_MSGPACK_EXT_NUMBER = 1
+
+
+def _msgpack_ext_hook(code, data):
+    if code == _MSGPACK_EXT_NUMBER:
+        return json.loads(data.decode('utf-8'))
+    raise ValueError('Unexpected msgpack extension type %d' % code)
+
+
+def _encodings():
+    """
+    Payload encodings we can use, most preferred first.  Debugging wants
+    something readable on the wire.
+    """
+    if _HAS_MSGPACK and not _DEBUG_JSON:
+        return ['msgpack', 'json']
+    return ['json']
+
 
 class TransPort(object):
     """
@@ -35,12 +84,24 @@ class TransPort(object):
     <Zero padded 10 digit number [1..2**32] for the length followed by
     valid json.
 
+    That is protocol version 1, which every connection starts out with.  A
+    client offers version 2 in a 'protocol' member of the plugin_register
+    request, next to 'method', 'id' and 'params' where plug-in runners which
+    predate it don't look.  If the plug-in returns what it agreed to, both
+    switch to a 4 byte network byte order length followed by the payload in
+    the agreed encoding (json or msgpack) once the plugin_register response
+    has been sent.
+
     Notes:
     id field (json-rpc) is present but currently not being used.
     This is available to be expanded on later.
     """
 
     HDR_LEN = 10
+    HDR_BIN_LEN = 4
+
+    PROTOCOL_V1 = 1
+    PROTOCOL_V2 = 2
 
     def _read_all(self, l):
         """
@@ -51,28 +112,52 @@ def _read_all(self, l):
         if l < 1:
             raise ValueError("Trying to read less than 1 byte!")
 
-        data = bytearray()
-        while len(data) < l:
-            r = self.s.recv(l - len(data))
+        # Sized once and read straight into
+        data = bytearray(l)
+        view = memoryview(data)
+        got = 0
+        while got < l:
+            r = self.s.recv_into(view[got:], l - got)
             if not r:
                 raise _SocketEOF()
-            data += r
+            got += r
 
-        return data.decode("utf-8")
+        return data
 
     def _send_msg(self, msg):
         """
-        Sends the json formatted message by pre-appending the length
+        Sends the encoded message by pre-appending the length
         first.
         """
 
         if msg is None or len(msg) < 1:
             raise ValueError("Msg argument empty")
 
+        if self.version == TransPort.PROTOCOL_V2:
+            hdr = struct.pack('>I', len(msg))
+        else:
+            hdr = str.zfill(str(len(msg)), self.HDR_LEN).encode('utf-8')
+
         # Note: Don't catch io exceptions at this level!
-        s = str.zfill(str(len(msg)), self.HDR_LEN) + msg
         # common.Info("SEND: ", msg)
-        self.s.sendall(bytes(s.encode('utf-8')))
+        if hasattr(self.s, 'sendmsg'):
+            self._send_all([hdr, msg])
+        else:
+            self.s.sendall(hdr + msg)
+
+    def _send_all(self, bufs):
+        """
+        Writes the buffers out with sendmsg, saving joining them first.
+        """
+        bufs = [memoryview(b) for b in bufs]
+        while bufs:
+            sent = self.s.sendmsg(bufs)
+            # Step over what went out, a short write can stop in any of them
+            while bufs and sent >= len(bufs[0]):
+                sent -= len(bufs[0])
+                bufs.pop(0)
+            if bufs:
+                bufs[0] = bufs[0][sent:]
 
     def _recv_msg(self):
         """
@@ -80,8 +165,12 @@ def _recv_msg(self):
         bytes of the message.
         """
         try:
-            l = self._read_all(self.HDR_LEN)
-            msg = self._read_all(int(l))
+            if self.version == TransPort.PROTOCOL_V2:
+                l = struct.unpack('>I', bytes(
+                    self._read_all(self.HDR_BIN_LEN)))[0]
+            else:
+                l = int(self._read_all(self.HDR_LEN).decode('utf-8'))
+            msg = self._read_all(l)
             # common.Info("RECV: ", msg)
         except socket.error as e:
             raise LsmError(ErrorNumber.TRANSPORT_COMMUNICATION,
@@ -89,8 +178,24 @@ def _recv_msg(self):
                            str(e))
         return msg
 
+    def _encode(self, obj):
+        if self.encoding == 'msgpack':
+            return msgpack.packb(obj, default=_msgpack_default,
+                                 use_bin_type=True)
+        return _json_dumps(obj).encode('utf-8')
+
+    def _decode(self, data):
+        if self.encoding == 'msgpack':
+            return msgpack.unpackb(data, raw=False,
+                                   object_hook=_msgpack_object_hook,
+                                   ext_hook=_msgpack_ext_hook)
+        return json.loads(data.decode('utf-8'), cls=_DataDecoder)
+
     def __init__(self, socket_descriptor):
         self.s = socket_descriptor
+        self.version = TransPort.PROTOCOL_V1
+        self.encoding = 'json'
+        self._next_id = 1
 
     @staticmethod
     def get_socket(path):
@@ -122,16 +227,53 @@ def close(self):
         """
         self.s.close()
 
-    def send_req(self, method, args):
+    @staticmethod
+    def protocol_offer():
+        """
+        Client side, what we can speak.  Sent as the 'protocol' member of the
+        plugin_register request.
+        """
+        return {'version': TransPort.PROTOCOL_V2, 'encodings': _encodings()}
+
+    @staticmethod
+    def protocol_select(offer):
+        """
+        Plug-in side, picks the protocol to use from the client's offer and
+        returns it, None to stay with version 1.  To be sent back as the
+        plugin_register result, then passed to protocol_set().
+        """
+        try:
+            # Version is the highest the client speaks, we only go up to 2
+            if offer['version'] >= TransPort.PROTOCOL_V2:
+                for e in offer['encodings']:
+                    if e in _encodings():
+                        return {'version': TransPort.PROTOCOL_V2,
+                                'encoding': e}
+        except (TypeError, KeyError):
+            pass
+        return None
+
+    def protocol_set(self, agreed):
+        """
+        Switches to the agreed protocol, None keeps version 1.
+        """
+        if isinstance(agreed, dict) and \
+                agreed.get('version') == TransPort.PROTOCOL_V2 and \
+                agreed.get('encoding') in _encodings():
+            self.version = TransPort.PROTOCOL_V2
+            self.encoding = agreed['encoding']
+
+    def send_req(self, method, args, msg_id=100, protocol=None):
         """
         Sends a request given a method and arguments.
         Note: arguments must be in the form that can be automatically
         serialized to json
         """
         try:
-            msg = {'method': method, 'id': 100, 'params': args}
-            data = json.dumps(msg, cls=_DataEncoder)
-            self._send_msg(data)
+            msg = {'method': method, 'id': msg_id, 'params': args}
+            if protocol is not None:
+                msg['protocol'] = protocol
+            self._send_msg(self._encode(msg))
         except socket.error as se:
             raise LsmError(ErrorNumber.TRANSPORT_COMMUNICATION,
                            "Error while sending a message to the plug-in",
@@ -144,15 +286,21 @@ def read_req(self):
         data = self._recv_msg()
         if len(data):
             # common.Info(str(data))
-            return json.loads(data, cls=_DataDecoder)
+            return self._decode(data)
 
-    def rpc(self, method, args):
+    def rpc(self, method, args, protocol=None):
         """
         Sends a request and waits for a response.
         """
-        self.send_req(method, args)
-        (reply, msg_id) = self.read_resp()
-        assert msg_id == 100
+        # Plug-ins echo request ids from protocol version 2 on
+        msg_id = 100
+        if self.version == TransPort.PROTOCOL_V2:
+            msg_id = self._next_id
+            self._next_id = self._next_id % 0x7FFFFFFF + 1
+
+        self.send_req(method, args, msg_id, protocol)
+        (reply, reply_id) = self.read_resp()
+        assert reply_id == msg_id
         return reply
 
     def send_error(self, msg_id, error_code, msg, data=None):
@@ -161,18 +309,18 @@ def send_error(self, msg_id, error_code, msg, data=None):
         """
         e = {'id': msg_id, 'error': {'code': error_code, 'message': msg,
                                      'data': data}}
-        self._send_msg(json.dumps(e, cls=_DataEncoder))
+        self._send_msg(self._encode(e))
 
     def send_resp(self, result, msg_id=100):
         """
         Used to transmit a response
         """
         r = {'id': msg_id, 'result': result}
-        self._send_msg(json.dumps(r, cls=_DataEncoder))
+        self._send_msg(self._encode(r))
 
     def read_resp(self):
         data = self._recv_msg()
-        resp = json.loads(data, cls=_DataDecoder)
+        resp = self._decode(data)
 
         if 'result' in resp:
             return resp['result'], resp['id']
@@ -181,6 +329,13 @@ def read_resp(self):
             raise LsmError(**e)
 
 
+def _old_register(uri, password, timeout, flags=0):
+    """
+    plugin_register of a plug-in, which knows nothing about the protocol.
+    """
+    return None
+
+
 def _server(s):
     """
     Test echo server for test case.
@@ -197,10 +352,17 @@ def _server(s):
                     msg['id'],
                     msg['params']['errorcode'],
                     msg['params']['errormsg'])
+            elif msg['method'] == 'plugin_register':
+                # What a plug-in runner which predates the negotiation does
+                srv.send_resp(_old_register(**msg['params']), msg['id'])
+            elif msg['method'] == 'protocol':
+                agreed = srv.protocol_select(msg.get('protocol'))
+                srv.send_resp(agreed, msg['id'])
+                srv.protocol_set(agreed)
             else:
-                srv.send_resp(msg['params'])
+                srv.send_resp(msg['params'], msg['id'])
             msg = srv.read_req()
-        srv.send_resp(msg['params'])
+        srv.send_resp(msg['params'], msg['id'])
     finally:
         s.close()
 
@@ -224,6 +386,55 @@ def test_simple(self):
             self.assertTrue(msg_id == 100)
             self.assertTrue(reply == t)
 
+    def test_protocol_v2(self):
+        for e in _encodings():
+            offer = TransPort.protocol_offer()
+            offer['encodings'] = [e]
+            agreed = self.client.rpc('protocol', None, offer)
+            self.assertTrue(agreed == {'version': TransPort.PROTOCOL_V2,
+                                       'encoding': e})
+            self.client.protocol_set(agreed)
+            self.assertTrue(self.client.encoding == e)
+
+            self.test_simple()
+            self.test_exceptions()
+
+    def test_request_ids(self):
+        agreed = self.client.rpc('protocol', None,
+                                 TransPort.protocol_offer())
+        self.client.protocol_set(agreed)
+
+        # Responses carry the id of their request
+        for msg_id in (7, 100, 0x7FFFFFFF):
+            self.client.send_req('test', 'x', msg_id)
+            reply, reply_id = self.client.read_resp()
+            self.assertTrue(reply_id == msg_id)
+
+        self.assertTrue(self.client.rpc('test', 'y') == 'y')
+        self.assertTrue(self.client.rpc('test', 'z') == 'z')
+
+    def test_protocol_v1_fallback(self):
+        self.assertTrue(TransPort.protocol_select(None) is None)
+        self.assertTrue(TransPort.protocol_select(
+            {'version': TransPort.PROTOCOL_V1, 'encodings': ['json']}) is None)
+        self.assertTrue(TransPort.protocol_select(
+            {'version': TransPort.PROTOCOL_V2, 'encodings': ['xml']}) is None)
+
+        self.client.protocol_set(None)
+        self.assertTrue(self.client.version == TransPort.PROTOCOL_V1)
+        self.test_simple()
+
+    def test_protocol_old_runner(self):
+        params = {'uri': 'sim://', 'password': None, 'timeout': 30000,
+                  'flags': 0}
+        agreed = self.client.rpc('plugin_register', params,
+                                 TransPort.protocol_offer())
+        self.assertTrue(agreed is None)
+
+        self.client.protocol_set(agreed)
+        self.assertTrue(self.client.version == TransPort.PROTOCOL_V1)
+        self.test_simple()
+
     def test_exceptions(self):
 
         e_msg = 'Test error message'
@@ -27,6 +27,13 @@
 #include <stdint.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <arpa/inet.h>
+#include <sqlite3.h>
 #include <libstoragemgmt/libstoragemgmt.h>
 #include <libstoragemgmt/libstoragemgmt_plug_interface.h>
 
@@ -44,6 +51,7 @@ static int is_simc_plugin = 0;
 #define VALID_BUT_NOT_EXIST_VPD83 "5000000000000000"
 #define NOT_EXIST_SD_PATH "/dev/sdazzzzzzzzzzz"
 #define _URI_BUFF_SIZE 128
+#define _UNUSED(x) (void)(x)
 
 lsm_connect *c = NULL;
 
@@ -2079,6 +2087,186 @@ START_TEST(test_plugin_info)
 }
 END_TEST
 
+START_TEST(test_connect_pool)
+{
+    char uri[_URI_BUFF_SIZE];
+    lsm_connect_pool *pool = NULL;
+    lsm_connect *c1 = NULL;
+    lsm_connect *c2 = NULL;
+    lsm_connect *c3 = NULL;
+    lsm_error_ptr e = NULL;
+    lsm_system **systems = NULL;
+    uint32_t count = 0;
+    int rc = 0;
+
+    plugin_to_use(uri);
+
+    rc = lsm_connect_pool_create(NULL, NULL, 2, &pool, 30000, &e,
+                                 LSM_CLIENT_FLAG_RSVD);
+    fail_unless(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    rc = lsm_connect_pool_create(uri, NULL, 0, &pool, 30000, &e,
+                                 LSM_CLIENT_FLAG_RSVD);
+    fail_unless(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    rc = lsm_connect_pool_create(uri, NULL, 2, &pool, 30000, &e,
+                                 LSM_CLIENT_FLAG_RSVD);
+    fail_unless(LSM_ERR_OK == rc, "rc = %d (%s)", rc, error(e));
+
+    rc = lsm_connect_pool_get(NULL, &c1, 0, &e, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    /* Pool is sized for two connections */
+    rc = lsm_connect_pool_get(pool, &c1, 0, &e, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(LSM_ERR_OK == rc, "rc = %d (%s)", rc, error(e));
+
+    rc = lsm_connect_pool_get(pool, &c2, 0, &e, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(LSM_ERR_OK == rc, "rc = %d (%s)", rc, error(e));
+    fail_unless(c1 != c2);
+
+    rc = lsm_connect_pool_get(pool, &c3, 100, &e, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(LSM_ERR_TIMEOUT == rc, "rc = %d", rc);
+
+    G(rc, lsm_system_list, c1, &systems, &count, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_system_record_array_free, systems, count);
+
+    /* Connections still handed out */
+    rc = lsm_connect_pool_free(pool, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    /* Only connections of the pool can be returned to it */
+    rc = lsm_connect_pool_put(pool, c, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    G(rc, lsm_connect_pool_put, pool, c1, LSM_CLIENT_FLAG_RSVD);
+
+    /* Returned connection is handed out again */
+    G(rc, lsm_connect_pool_get, pool, &c3, 0, &e, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(c1 == c3);
+
+    G(rc, lsm_system_list, c3, &systems, &count, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_system_record_array_free, systems, count);
+
+    /* Closing a pooled connection makes room for a new one */
+    G(rc, lsm_connect_close, c2, LSM_CLIENT_FLAG_RSVD);
+    c2 = NULL;
+    G(rc, lsm_connect_pool_get, pool, &c2, 0, &e, LSM_CLIENT_FLAG_RSVD);
+
+    G(rc, lsm_connect_pool_put, pool, c2, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_connect_pool_put, pool, c3, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_connect_pool_free, pool, LSM_CLIENT_FLAG_RSVD);
+}
+END_TEST
+
+START_TEST(test_batch)
+{
+    lsm_batch *batch = NULL;
+    lsm_pool *pool = get_test_pool(c);
+    lsm_system *system = get_system(c);
+    lsm_access_group *group = NULL;
+    lsm_volume *vols[2] = {NULL, NULL};
+    lsm_volume **volumes = NULL;
+    lsm_error_ptr e = NULL;
+    uint32_t v_count = 0;
+    uint32_t i = 0;
+    char *job = NULL;
+    int rc = 0;
+
+    fail_unless(pool != NULL);
+
+    batch = lsm_batch_alloc();
+    fail_unless(batch != NULL);
+
+    rc = lsm_batch_run(c, NULL, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    rc = lsm_batch_volume_create(batch, pool, NULL, 20000000,
+                                 LSM_VOLUME_PROVISION_DEFAULT,
+                                 LSM_CLIENT_FLAG_RSVD);
+    fail_unless(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    /* No result before the batch ran */
+    rc = lsm_batch_result_get(batch, 0, &job, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    G(rc, lsm_access_group_create, c, "test_batch", ISCSI_HOST[0],
+      LSM_ACCESS_GROUP_INIT_TYPE_ISCSI_IQN, system, &group,
+      LSM_CLIENT_FLAG_RSVD);
+
+    G(rc, lsm_batch_volume_create, batch, pool, "batch_vol_0", 20000000,
+      LSM_VOLUME_PROVISION_DEFAULT, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_batch_volume_create, batch, pool, "batch_vol_1", 20000000,
+      LSM_VOLUME_PROVISION_DEFAULT, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(lsm_batch_size(batch) == 2);
+
+    G(rc, lsm_batch_run, c, batch, LSM_CLIENT_FLAG_RSVD);
+
+    for (i = 0; i < 2; ++i) {
+        rc = lsm_batch_result_get(batch, i, &job, LSM_CLIENT_FLAG_RSVD);
+        if (LSM_ERR_JOB_STARTED == rc) {
+            vols[i] = wait_for_job_vol(c, &job);
+        } else {
+            fail_unless(LSM_ERR_OK == rc, "rc = %d", rc);
+            G(rc, lsm_batch_volume_get, batch, i, &vols[i],
+              LSM_CLIENT_FLAG_RSVD);
+        }
+        fail_unless(vols[i] != NULL);
+    }
+
+    rc = lsm_batch_result_get(batch, 2, &job, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+    G(rc, lsm_batch_free, batch);
+
+    /* The second mask fails on its own, the others still happen */
+    batch = lsm_batch_alloc();
+    fail_unless(batch != NULL);
+    G(rc, lsm_batch_volume_mask, batch, group, vols[0], LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_batch_volume_mask, batch, group, vols[0], LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_batch_volume_mask, batch, group, vols[1], LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_batch_run, c, batch, LSM_CLIENT_FLAG_RSVD);
+
+    G(rc, lsm_batch_result_get, batch, 0, &job, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(lsm_batch_error_get(batch, 0) == NULL);
+
+    rc = lsm_batch_result_get(batch, 1, &job, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(LSM_ERR_NO_STATE_CHANGE == rc, "rc = %d", rc);
+    e = lsm_batch_error_get(batch, 1);
+    fail_unless(e != NULL);
+    fail_unless(lsm_error_number_get(e) == LSM_ERR_NO_STATE_CHANGE);
+    G(rc, lsm_error_free, e);
+
+    G(rc, lsm_batch_result_get, batch, 2, &job, LSM_CLIENT_FLAG_RSVD);
+
+    /* Only volume creations have a volume */
+    rc = lsm_batch_volume_get(batch, 0, &vols[0], LSM_CLIENT_FLAG_RSVD);
+    fail_unless(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+    G(rc, lsm_batch_free, batch);
+
+    G(rc, lsm_volumes_accessible_by_access_group, c, group, &volumes,
+      &v_count, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(v_count == 2, "v_count = %d", v_count);
+    G(rc, lsm_volume_record_array_free, volumes, v_count);
+
+    batch = lsm_batch_alloc();
+    fail_unless(batch != NULL);
+    G(rc, lsm_batch_volume_unmask, batch, group, vols[0],
+      LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_batch_volume_unmask, batch, group, vols[1],
+      LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_batch_run, c, batch, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_batch_result_get, batch, 0, &job, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_batch_result_get, batch, 1, &job, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_batch_free, batch);
+
+    G(rc, lsm_access_group_delete, c, group, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_access_group_record_free, group);
+    G(rc, lsm_volume_record_free, vols[0]);
+    G(rc, lsm_volume_record_free, vols[1]);
+    G(rc, lsm_pool_record_free, pool);
+    G(rc, lsm_system_record_free, system);
+}
+END_TEST
+
 START_TEST(test_system_fw_version)
 {
     const char *fw_ver = NULL;
@@ -2528,121 +2716,1310 @@ START_TEST(test_uri_parse)
                         "%s", lsm_hash_string_get(qp, "namespace"));
         }
 
-        free(scheme);
-        scheme = NULL;
-        free(user);
-        user = NULL;
-        free(server);
-        server = NULL;
-        G(rc, lsm_hash_free, qp);
-        qp = NULL;
+        free(scheme);
+        scheme = NULL;
+        free(user);
+        user = NULL;
+        free(server);
+        server = NULL;
+        G(rc, lsm_hash_free, qp);
+        qp = NULL;
+    }
+}
+END_TEST
+
+START_TEST(test_search_pools)
+{
+    int rc;
+    lsm_pool **pools = NULL;
+    uint32_t poolCount = 0;
+
+    G(rc, lsm_pool_list, c, NULL, NULL, &pools, &poolCount, LSM_CLIENT_FLAG_RSVD);
+
+    if( LSM_ERR_OK == rc && poolCount ) {
+        lsm_pool **search_pools = NULL;
+        uint32_t search_count = 0;
+
+        G(rc, lsm_pool_list, c, "id", lsm_pool_id_get(pools[0]), &search_pools,
+                    &search_count, LSM_CLIENT_FLAG_RSVD);
+
+        fail_unless(search_count == 1, "Expecting 1 pool, got %d", search_count);
+
+        G(rc, lsm_pool_record_array_free, search_pools, search_count);
+
+        /* Search for non-existent pool*/
+        search_pools = NULL;
+        search_count = 0;
+
+        G(rc, lsm_pool_list, c, "id", "non-existent-id", &search_pools,
+                    &search_count, LSM_CLIENT_FLAG_RSVD);
+        fail_unless(search_count == 0, "Expecting no pools! %d", search_count);
+
+        /* Search which results in all pools */
+        G(rc, lsm_pool_list, c, "system_id", lsm_pool_system_id_get(pools[0]),
+                    &search_pools,
+                    &search_count, LSM_CLIENT_FLAG_RSVD);
+
+        fail_unless(search_count == poolCount, "Expecting %d pools, got %d",
+                                poolCount, search_count);
+
+        G(rc, lsm_pool_record_array_free, search_pools, search_count);
+        search_pools = NULL;
+        search_count = 0;
+
+
+        G(rc, lsm_pool_record_array_free, pools, poolCount);
+        pools = NULL;
+        poolCount = 0;
+    }
+
+}
+END_TEST
+
+START_TEST(test_search_volumes)
+{
+    int rc;
+    lsm_volume **volumes = NULL;
+    uint32_t volume_count = 0;
+
+    lsm_pool *pool = get_test_pool(c);
+
+    // Make some volumes to we can actually filter
+    create_volumes(c, pool, 10);
+
+    G(rc, lsm_volume_list, c, NULL, NULL, &volumes, &volume_count,
+            LSM_CLIENT_FLAG_RSVD);
+
+    fail_unless(volume_count > 0, "We are expecting some volumes!");
+
+    if( LSM_ERR_OK == rc && volume_count ) {
+        lsm_volume **search_volume = NULL;
+        uint32_t search_count = 0;
+
+        G(rc, lsm_volume_list, c, "id", lsm_volume_id_get(volumes[0]),
+                    &search_volume,
+                    &search_count, LSM_CLIENT_FLAG_RSVD);
+
+        fail_unless(search_count == 1, "Expecting 1 pool, got %d", search_count);
+
+        G(rc, lsm_volume_record_array_free, search_volume, search_count);
+        search_volume = NULL;
+        search_count = 0;
+
+        /* Search for non-existent */
+        G(rc, lsm_volume_list, c, "id", "non-existent-id", &search_volume,
+                    &search_count, LSM_CLIENT_FLAG_RSVD);
+        fail_unless(search_count == 0, "Expecting no volumes! %d", search_count);
+
+        /* Id of another kind of object */
+        G(rc, lsm_volume_list, c, "id", lsm_pool_id_get(pool), &search_volume,
+                    &search_count, LSM_CLIENT_FLAG_RSVD);
+        fail_unless(search_count == 0, "Expecting no volumes! %d", search_count);
+
+        /* Search by pool */
+        uint32_t i = 0;
+        uint32_t pool_volume_count = 0;
+        for (i = 0; i < volume_count; ++i) {
+            if (strcmp(lsm_volume_pool_id_get(volumes[i]),
+                       lsm_pool_id_get(pool)) == 0) {
+                pool_volume_count++;
+            }
+        }
+
+        G(rc, lsm_volume_list, c, "pool_id", lsm_pool_id_get(pool),
+                    &search_volume, &search_count, LSM_CLIENT_FLAG_RSVD);
+        fail_unless(search_count == pool_volume_count,
+                    "Expecting %d volumes, got %d", pool_volume_count,
+                    search_count);
+
+        for (i = 0; i < search_count; ++i) {
+            fail_unless(strcmp(lsm_volume_pool_id_get(search_volume[i]),
+                               lsm_pool_id_get(pool)) == 0);
+        }
+
+        G(rc, lsm_volume_record_array_free, search_volume, search_count);
+        search_volume = NULL;
+        search_count = 0;
+
+        /* Search which results in all volumes */
+        G(rc, lsm_volume_list, c, "system_id",
+                    lsm_volume_system_id_get(volumes[0]),
+                    &search_volume,
+                    &search_count, LSM_CLIENT_FLAG_RSVD);
+
+        fail_unless(search_count == volume_count, "Expecting %d volumes, got %d",
+                                volume_count, search_count);
+
+        G(rc, lsm_volume_record_array_free, search_volume, search_count);
+        search_volume = NULL;
+        search_count = 0;
+
+        G(rc, lsm_volume_record_array_free, volumes, volume_count);
+        volumes = NULL;
+        volume_count = 0;
+    }
+
+    G(rc, lsm_pool_record_free, pool);
+    pool = NULL;
+}
+END_TEST
+
+START_TEST(test_list_page)
+{
+    int rc;
+    lsm_volume **volumes = NULL;
+    uint32_t volume_count = 0;
+    lsm_volume **page = NULL;
+    uint32_t page_count = 0;
+    char *cursor = NULL;
+    char *next_cursor = NULL;
+    uint32_t *seen = NULL;
+    uint32_t total = 0;
+    uint32_t pages = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+
+    lsm_pool *pool = get_test_pool(c);
+
+    create_volumes(c, pool, 7);
+
+    G(rc, lsm_volume_list, c, NULL, NULL, &volumes, &volume_count,
+            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(volume_count >= 7, "Expecting at least 7 volumes, got %d",
+                volume_count);
+
+    seen = (uint32_t *)calloc(volume_count, sizeof(uint32_t));
+    fail_unless(seen != NULL);
+
+    /* Walk all the volumes three at a time */
+    do {
+        G(rc, lsm_volume_list_page, c, NULL, NULL, cursor, 3, &page,
+                &page_count, &next_cursor, LSM_CLIENT_FLAG_RSVD);
+        fail_unless(page_count <= 3, "Page of %d volumes", page_count);
+        fail_unless(next_cursor == NULL || page_count == 3,
+                    "Short page of %d volumes before the last", page_count);
+
+        for (i = 0; i < page_count; ++i) {
+            for (j = 0; j < volume_count; ++j) {
+                if (strcmp(lsm_volume_id_get(page[i]),
+                           lsm_volume_id_get(volumes[j])) == 0) {
+                    seen[j]++;
+                    break;
+                }
+            }
+            fail_unless(j < volume_count, "Unknown volume %s",
+                        lsm_volume_id_get(page[i]));
+        }
+        total += page_count;
+        pages++;
+
+        G(rc, lsm_volume_record_array_free, page, page_count);
+        page = NULL;
+        page_count = 0;
+        free(cursor);
+        cursor = next_cursor;
+        next_cursor = NULL;
+    } while (cursor != NULL && pages <= volume_count);
+
+    fail_unless(cursor == NULL, "Paging did not end");
+    fail_unless(total == volume_count, "Expecting %d volumes, got %d",
+                volume_count, total);
+    for (j = 0; j < volume_count; ++j)
+        fail_unless(seen[j] == 1, "Volume %s listed %d times",
+                    lsm_volume_id_get(volumes[j]), seen[j]);
+
+    /* Search keys still apply */
+    G(rc, lsm_volume_list_page, c, "id", lsm_volume_id_get(volumes[0]), NULL,
+            10, &page, &page_count, &next_cursor, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(page_count == 1, "Expecting 1 volume, got %d", page_count);
+    fail_unless(next_cursor == NULL);
+    G(rc, lsm_volume_record_array_free, page, page_count);
+    page = NULL;
+    page_count = 0;
+
+    /* Pages are full until the last, the search applies before the limit */
+    G(rc, lsm_volume_list_page, c, "system_id",
+            lsm_volume_system_id_get(volumes[0]), NULL, 3, &page,
+            &page_count, &next_cursor, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(page_count == 3, "Expecting 3 volumes, got %d", page_count);
+    fail_unless(next_cursor != NULL);
+    G(rc, lsm_volume_record_array_free, page, page_count);
+    page = NULL;
+    page_count = 0;
+    free(next_cursor);
+    next_cursor = NULL;
+
+    G(rc, lsm_volume_list_page, c, "system_id", "not-a-system", NULL, 3,
+            &page, &page_count, &next_cursor, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(page_count == 0, "Expecting no volume, got %d", page_count);
+    fail_unless(next_cursor == NULL, "Empty page with a next cursor");
+
+    rc = lsm_volume_list_page(c, NULL, NULL, NULL, 0, &page, &page_count,
+                              &next_cursor, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_INVALID_ARGUMENT, "rc = %d", rc);
+
+    rc = lsm_volume_list_page(c, NULL, NULL, "not-a-cursor", 3, &page,
+                              &page_count, &next_cursor,
+                              LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_INVALID_ARGUMENT, "rc = %d", rc);
+    fail_unless(page == NULL && page_count == 0 && next_cursor == NULL);
+
+    free(seen);
+    G(rc, lsm_volume_record_array_free, volumes, volume_count);
+    G(rc, lsm_pool_record_free, pool);
+    pool = NULL;
+}
+END_TEST
+
+START_TEST(test_list_fields)
+{
+    int rc;
+    lsm_volume **volumes = NULL;
+    uint32_t volume_count = 0;
+    lsm_volume **projected = NULL;
+    uint32_t projected_count = 0;
+    lsm_disk **disks = NULL;
+    uint32_t disk_count = 0;
+    lsm_disk **projected_disks = NULL;
+    uint32_t projected_disk_count = 0;
+    lsm_string_list *fields = NULL;
+    uint32_t i = 0;
+
+    lsm_pool *pool = get_test_pool(c);
+
+    create_volumes(c, pool, 3);
+
+    G(rc, lsm_volume_list, c, NULL, NULL, &volumes, &volume_count,
+            LSM_CLIENT_FLAG_RSVD);
+
+    fields = lsm_string_list_alloc(0);
+    fail_unless(fields != NULL);
+    G(rc, lsm_string_list_append, fields, "name");
+    G(rc, lsm_string_list_append, fields, "num_of_blocks");
+
+    G(rc, lsm_volume_list_fields, c, NULL, NULL, fields, &projected,
+            &projected_count, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(projected_count == volume_count, "Expecting %d volumes, got %d",
+                volume_count, projected_count);
+
+    for (i = 0; i < projected_count; ++i) {
+        fail_unless(strcmp(lsm_volume_id_get(projected[i]),
+                           lsm_volume_id_get(volumes[i])) == 0);
+        fail_unless(strcmp(lsm_volume_name_get(projected[i]),
+                           lsm_volume_name_get(volumes[i])) == 0);
+        fail_unless(lsm_volume_number_of_blocks_get(projected[i]) ==
+                    lsm_volume_number_of_blocks_get(volumes[i]));
+        fail_unless(lsm_volume_pool_id_get(projected[i]) == NULL);
+        fail_unless(lsm_volume_system_id_get(projected[i]) == NULL);
+        fail_unless(lsm_volume_block_size_get(projected[i]) == 0);
+    }
+    G(rc, lsm_volume_record_array_free, projected, projected_count);
+    projected = NULL;
+    projected_count = 0;
+
+    G(rc, lsm_disk_list, c, NULL, NULL, &disks, &disk_count,
+            LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_disk_list_fields, c, NULL, NULL, fields, &projected_disks,
+            &projected_disk_count, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(projected_disk_count == disk_count);
+    for (i = 0; i < projected_disk_count; ++i) {
+        fail_unless(strcmp(lsm_disk_name_get(projected_disks[i]),
+                           lsm_disk_name_get(disks[i])) == 0);
+        fail_unless(lsm_disk_system_id_get(projected_disks[i]) == NULL);
+    }
+    G(rc, lsm_disk_record_array_free, projected_disks, projected_disk_count);
+    G(rc, lsm_disk_record_array_free, disks, disk_count);
+
+    G(rc, lsm_string_list_append, fields, "no_such_field");
+    rc = lsm_volume_list_fields(c, NULL, NULL, fields, &projected,
+                                &projected_count, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_INVALID_ARGUMENT, "rc = %d", rc);
+
+    G(rc, lsm_string_list_free, fields);
+    G(rc, lsm_volume_record_array_free, volumes, volume_count);
+    G(rc, lsm_pool_record_free, pool);
+    pool = NULL;
+}
+END_TEST
+
+START_TEST(test_list_in)
+{
+    int rc;
+    lsm_volume **volumes = NULL;
+    uint32_t volume_count = 0;
+    lsm_volume **found = NULL;
+    uint32_t found_count = 0;
+    lsm_disk **disks = NULL;
+    uint32_t disk_count = 0;
+    lsm_string_list *values = NULL;
+    uint32_t i = 0;
+    uint32_t j = 0;
+
+    lsm_pool *pool = get_test_pool(c);
+
+    create_volumes(c, pool, 5);
+
+    G(rc, lsm_volume_list, c, NULL, NULL, &volumes, &volume_count,
+            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(volume_count >= 5, "Expecting at least 5 volumes, got %d",
+                volume_count);
+
+    values = lsm_string_list_alloc(0);
+    fail_unless(values != NULL);
+    G(rc, lsm_string_list_append, values, lsm_volume_id_get(volumes[0]));
+    G(rc, lsm_string_list_append, values, lsm_volume_id_get(volumes[2]));
+    G(rc, lsm_string_list_append, values, lsm_volume_id_get(volumes[4]));
+    G(rc, lsm_string_list_append, values, "non-existent-id");
+    G(rc, lsm_string_list_append, values, lsm_pool_id_get(pool));
+
+    G(rc, lsm_volume_list_in, c, "id", values, &found, &found_count,
+            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(found_count == 3, "Expecting 3 volumes, got %d", found_count);
+
+    for (i = 0; i < found_count; ++i) {
+        for (j = 0; j < 3; ++j) {
+            if (strcmp(lsm_volume_id_get(found[i]),
+                       lsm_string_list_elem_get(values, j)) == 0) {
+                break;
+            }
+        }
+        fail_unless(j < 3, "Unexpected volume %s",
+                    lsm_volume_id_get(found[i]));
+    }
+    G(rc, lsm_volume_record_array_free, found, found_count);
+    found = NULL;
+    found_count = 0;
+
+    /* Any volume of the pool */
+    G(rc, lsm_string_list_free, values);
+    values = lsm_string_list_alloc(0);
+    fail_unless(values != NULL);
+    G(rc, lsm_string_list_append, values, lsm_pool_id_get(pool));
+    G(rc, lsm_string_list_append, values, "non-existent-id");
+
+    G(rc, lsm_volume_list_in, c, "pool_id", values, &found, &found_count,
+            LSM_CLIENT_FLAG_RSVD);
+    for (i = 0, j = 0; i < volume_count; ++i) {
+        if (strcmp(lsm_volume_pool_id_get(volumes[i]),
+                   lsm_pool_id_get(pool)) == 0) {
+            j++;
+        }
+    }
+    fail_unless(found_count == j, "Expecting %d volumes, got %d", j,
+                found_count);
+    G(rc, lsm_volume_record_array_free, found, found_count);
+    found = NULL;
+    found_count = 0;
+
+    rc = lsm_volume_list_in(c, "name", values, &found, &found_count,
+                            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_UNSUPPORTED_SEARCH_KEY, "rc = %d", rc);
+
+    rc = lsm_volume_list_in(c, NULL, values, &found, &found_count,
+                            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_INVALID_ARGUMENT, "rc = %d", rc);
+
+    G(rc, lsm_string_list_free, values);
+
+    G(rc, lsm_disk_list, c, NULL, NULL, &disks, &disk_count,
+            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(disk_count >= 2);
+
+    values = lsm_string_list_alloc(0);
+    fail_unless(values != NULL);
+    G(rc, lsm_string_list_append, values, lsm_disk_id_get(disks[0]));
+    G(rc, lsm_string_list_append, values, lsm_disk_id_get(disks[1]));
+    G(rc, lsm_disk_record_array_free, disks, disk_count);
+    disks = NULL;
+    disk_count = 0;
+
+    G(rc, lsm_disk_list_in, c, "id", values, &disks, &disk_count,
+            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(disk_count == 2, "Expecting 2 disks, got %d", disk_count);
+    G(rc, lsm_disk_record_array_free, disks, disk_count);
+
+    G(rc, lsm_string_list_free, values);
+    G(rc, lsm_volume_record_array_free, volumes, volume_count);
+    G(rc, lsm_pool_record_free, pool);
+    pool = NULL;
+}
+END_TEST
+
+struct async_result {
+    int calls;
+    int rc;
+    uint32_t count;
+};
+
+static void async_systems_done(lsm_connect *conn, int rc,
+                               lsm_system *systems[], uint32_t count,
+                               void *user_data)
+{
+    struct async_result *r = (struct async_result *)user_data;
+
+    fail_unless(conn == c);
+    r->calls++;
+    r->rc = rc;
+    r->count = count;
+    if (LSM_ERR_OK == rc) {
+        lsm_system_record_array_free(systems, count);
+    }
+}
+
+static void async_pools_done(lsm_connect *conn, int rc, lsm_pool *pools[],
+                             uint32_t count, void *user_data)
+{
+    struct async_result *r = (struct async_result *)user_data;
+
+    fail_unless(conn == c);
+    r->calls++;
+    r->rc = rc;
+    r->count = count;
+    if (LSM_ERR_OK == rc) {
+        lsm_pool_record_array_free(pools, count);
+    }
+}
+
+static void async_volumes_done(lsm_connect *conn, int rc,
+                               lsm_volume *volumes[], uint32_t count,
+                               void *user_data)
+{
+    struct async_result *r = (struct async_result *)user_data;
+
+    fail_unless(conn == c);
+    r->calls++;
+    r->rc = rc;
+    r->count = count;
+    if (LSM_ERR_OK == rc) {
+        lsm_volume_record_array_free(volumes, count);
+    }
+}
+
+static void async_disks_done(lsm_connect *conn, int rc, lsm_disk *disks[],
+                             uint32_t count, void *user_data)
+{
+    struct async_result *r = (struct async_result *)user_data;
+
+    fail_unless(conn == c);
+    r->calls++;
+    r->rc = rc;
+    r->count = count;
+    if (LSM_ERR_OK == rc) {
+        lsm_disk_record_array_free(disks, count);
+    }
+}
+
+/* Drives the connection the way an event loop would */
+static void async_wait(lsm_connect *conn)
+{
+    int rc;
+    int fd = -1;
+    uint32_t outstanding = 0;
+    int polls = 0;
+
+    G(rc, lsm_connect_fd_get, conn, &fd, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(fd >= 0);
+
+    G(rc, lsm_connect_process, conn, &outstanding, LSM_CLIENT_FLAG_RSVD);
+    while (outstanding) {
+        struct pollfd pfd;
+
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        fail_unless(poll(&pfd, 1, 30000) == 1, "No response in time");
+        fail_unless(++polls < 10000);
+
+        G(rc, lsm_connect_process, conn, &outstanding,
+                LSM_CLIENT_FLAG_RSVD);
+    }
+}
+
+START_TEST(test_async)
+{
+    int rc;
+    uint32_t i = 0;
+    lsm_system **systems = NULL;
+    uint32_t system_count = 0;
+    lsm_volume **volumes = NULL;
+    uint32_t volume_count = 0;
+    lsm_disk **disks = NULL;
+    uint32_t disk_count = 0;
+    uint32_t outstanding = 1;
+    struct async_result sys_r = {0, -1, 0};
+    struct async_result pool_r = {0, -1, 0};
+    struct async_result vol_r[4];
+    struct async_result disk_r = {0, -1, 0};
+    struct async_result missing_r = {0, -1, 0};
+
+    lsm_pool *pool = get_test_pool(c);
+
+    create_volumes(c, pool, 3);
+
+    G(rc, lsm_system_list, c, &systems, &system_count, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_volume_list, c, NULL, NULL, &volumes, &volume_count,
+            LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_disk_list, c, NULL, NULL, &disks, &disk_count,
+            LSM_CLIENT_FLAG_RSVD);
+
+    /* Nothing outstanding, nothing to do */
+    G(rc, lsm_connect_process, c, &outstanding, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(outstanding == 0);
+
+    /* Several requests in flight on the one connection */
+    G(rc, lsm_system_list_async, c, async_systems_done, &sys_r,
+            LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_pool_list_async, c, "id", lsm_pool_id_get(pool),
+            async_pools_done, &pool_r, LSM_CLIENT_FLAG_RSVD);
+    for (i = 0; i < sizeof(vol_r) / sizeof(vol_r[0]); ++i) {
+        vol_r[i].calls = 0;
+        vol_r[i].rc = -1;
+        vol_r[i].count = 0;
+        G(rc, lsm_volume_list_async, c, NULL, NULL, async_volumes_done,
+                &vol_r[i], LSM_CLIENT_FLAG_RSVD);
+    }
+    G(rc, lsm_disk_list_async, c, NULL, NULL, async_disks_done, &disk_r,
+            LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_volume_list_async, c, "id", "non-existent-id",
+            async_volumes_done, &missing_r, LSM_CLIENT_FLAG_RSVD);
+
+    G(rc, lsm_connect_process, c, &outstanding, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(outstanding <= 8, "outstanding = %d", outstanding);
+
+    async_wait(c);
+
+    fail_unless(sys_r.calls == 1 && sys_r.rc == LSM_ERR_OK);
+    fail_unless(sys_r.count == system_count);
+    fail_unless(pool_r.calls == 1 && pool_r.rc == LSM_ERR_OK);
+    fail_unless(pool_r.count == 1);
+    for (i = 0; i < sizeof(vol_r) / sizeof(vol_r[0]); ++i) {
+        fail_unless(vol_r[i].calls == 1 && vol_r[i].rc == LSM_ERR_OK);
+        fail_unless(vol_r[i].count == volume_count, "%d != %d",
+                    vol_r[i].count, volume_count);
+    }
+    fail_unless(disk_r.calls == 1 && disk_r.rc == LSM_ERR_OK);
+    fail_unless(disk_r.count == disk_count);
+    fail_unless(missing_r.calls == 1 && missing_r.rc == LSM_ERR_OK);
+    fail_unless(missing_r.count == 0);
+
+    /* Blocking calls in between keep the responses they read on the way */
+    sys_r.calls = 0;
+    G(rc, lsm_system_list_async, c, async_systems_done, &sys_r,
+            LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_system_record_array_free, systems, system_count);
+    G(rc, lsm_system_list, c, &systems, &system_count, LSM_CLIENT_FLAG_RSVD);
+    async_wait(c);
+    fail_unless(sys_r.calls == 1 && sys_r.rc == LSM_ERR_OK);
+
+    rc = lsm_pool_list_async(c, "name", "x", async_pools_done, &pool_r,
+                             LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_UNSUPPORTED_SEARCH_KEY, "rc = %d", rc);
+
+    rc = lsm_volume_list_async(c, NULL, NULL, NULL, NULL,
+                               LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_INVALID_ARGUMENT, "rc = %d", rc);
+
+    rc = lsm_connect_fd_get(c, NULL, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_INVALID_ARGUMENT, "rc = %d", rc);
+
+    G(rc, lsm_system_record_array_free, systems, system_count);
+    G(rc, lsm_volume_record_array_free, volumes, volume_count);
+    G(rc, lsm_disk_record_array_free, disks, disk_count);
+    G(rc, lsm_pool_record_free, pool);
+    pool = NULL;
+}
+END_TEST
+
+START_TEST(test_job_wait)
+{
+    int rc;
+    uint32_t i = 0;
+    uint32_t index = 0;
+    uint32_t started = 0;
+    lsm_job_status status;
+    uint8_t pc = 0;
+    lsm_volume *vol = NULL;
+    char *jobs[2] = {NULL, NULL};
+    lsm_string_list *job_ids = NULL;
+
+    lsm_pool *pool = get_test_pool(c);
+
+    for (i = 0; i < 2; ++i) {
+        char name[32];
+
+        snprintf(name, sizeof(name), "job wait %d", i);
+        rc = lsm_volume_create(c, pool, name, 20000000,
+                               LSM_VOLUME_PROVISION_DEFAULT, &vol, &jobs[i],
+                               LSM_CLIENT_FLAG_RSVD);
+        fail_unless(rc == LSM_ERR_OK || rc == LSM_ERR_JOB_STARTED,
+                    "lsm_volume_create %d (%s)", rc,
+                    error(lsm_error_last_get(c)));
+        if (LSM_ERR_OK == rc) {
+            G(rc, lsm_volume_record_free, vol);
+            vol = NULL;
+        } else {
+            started++;
+        }
+    }
+
+    if (started == 2) {
+        job_ids = lsm_string_list_alloc(0);
+        fail_unless(job_ids != NULL);
+        G(rc, lsm_string_list_append, job_ids, jobs[0]);
+        G(rc, lsm_string_list_append, job_ids, jobs[1]);
+
+        /* Waits for the first one, then the other */
+        G(rc, lsm_job_wait_any, c, job_ids, 30000, &index, &status, &pc,
+                LSM_CLIENT_FLAG_RSVD);
+        fail_unless(index < 2, "index = %d", index);
+        fail_unless(status == LSM_JOB_COMPLETE && pc == 100);
+
+        G(rc, lsm_job_wait, c, jobs[1 - index], 30000, &status, &pc,
+                LSM_CLIENT_FLAG_RSVD);
+        fail_unless(status == LSM_JOB_COMPLETE && pc == 100);
+
+        /* The data is still there for the status call */
+        for (i = 0; i < 2; ++i) {
+            G(rc, lsm_job_wait, c, jobs[i], 0, &status, &pc,
+                    LSM_CLIENT_FLAG_RSVD);
+            G(rc, lsm_job_status_volume_get, c, jobs[i], &status, &pc, &vol,
+                    LSM_CLIENT_FLAG_RSVD);
+            fail_unless(status == LSM_JOB_COMPLETE && vol != NULL);
+            G(rc, lsm_volume_record_free, vol);
+            vol = NULL;
+            G(rc, lsm_job_free, c, &jobs[i], LSM_CLIENT_FLAG_RSVD);
+        }
+
+        rc = lsm_job_wait(c, "non-existent-job", 100, &status, &pc,
+                          LSM_CLIENT_FLAG_RSVD);
+        fail_unless(rc == LSM_ERR_NOT_FOUND_JOB, "rc = %d", rc);
+
+        G(rc, lsm_string_list_free, job_ids);
+    } else {
+        for (i = 0; i < 2; ++i) {
+            if (jobs[i]) {
+                vol = wait_for_job_vol(c, &jobs[i]);
+                G(rc, lsm_volume_record_free, vol);
+                vol = NULL;
+            }
+        }
+    }
+
+    job_ids = lsm_string_list_alloc(0);
+    fail_unless(job_ids != NULL);
+    rc = lsm_job_wait_any(c, job_ids, 100, &index, &status, &pc,
+                          LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_INVALID_ARGUMENT, "rc = %d", rc);
+    G(rc, lsm_string_list_free, job_ids);
+
+    rc = lsm_job_wait(c, NULL, 100, &status, &pc, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_INVALID_ARGUMENT, "rc = %d", rc);
+
+    G(rc, lsm_pool_record_free, pool);
+    pool = NULL;
+}
+END_TEST
+
+START_TEST(test_cache)
+{
+    int rc;
+    uint32_t count = 0;
+    uint32_t again = 0;
+    uint32_t sys_count = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    lsm_pool **pools = NULL;
+    lsm_pool **pools_again = NULL;
+    lsm_system **sys = NULL;
+    lsm_storage_capabilities *cap = NULL;
+    lsm_volume *vol = NULL;
+    char *job = NULL;
+
+    G(rc, lsm_connect_cache_stats_get, c, &hits, &misses,
+            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(hits == 0 && misses == 0);
+
+    G(rc, lsm_connect_cache_ttl_set, c, LSM_CACHE_POOLS, 60000,
+            LSM_CLIENT_FLAG_RSVD);
+
+    /* Second call is answered from the cache */
+    G(rc, lsm_pool_list, c, NULL, NULL, &pools, &count, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_pool_list, c, NULL, NULL, &pools_again, &again,
+            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(count > 0 && count == again, "%d != %d", count, again);
+    G(rc, lsm_pool_record_array_free, pools_again, again);
+    pools_again = NULL;
+
+    G(rc, lsm_connect_cache_stats_get, c, &hits, &misses,
+            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(hits == 1 && misses == 1, "hits %d, misses %d", (int)hits,
+                (int)misses);
+
+    /* A call which changes the storage empties it */
+    rc = lsm_volume_create(c, pools[0], "cache test", 20000000,
+                           LSM_VOLUME_PROVISION_DEFAULT, &vol, &job,
+                           LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_OK || rc == LSM_ERR_JOB_STARTED,
+                "lsm_volume_create %d (%s)", rc,
+                error(lsm_error_last_get(c)));
+    if (LSM_ERR_JOB_STARTED == rc) {
+        vol = wait_for_job_vol(c, &job);
+    }
+    G(rc, lsm_volume_record_free, vol);
+    vol = NULL;
+
+    G(rc, lsm_pool_list, c, NULL, NULL, &pools_again, &again,
+            LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_pool_record_array_free, pools_again, again);
+    pools_again = NULL;
+    G(rc, lsm_connect_cache_stats_get, c, &hits, &misses,
+            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(hits == 1 && misses == 2, "hits %d, misses %d", (int)hits,
+                (int)misses);
+
+    /* So does clearing it */
+    G(rc, lsm_connect_cache_clear, c, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_pool_list, c, NULL, NULL, &pools_again, &again,
+            LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_pool_record_array_free, pools_again, again);
+    pools_again = NULL;
+    G(rc, lsm_connect_cache_stats_get, c, &hits, &misses,
+            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(hits == 1 && misses == 3, "hits %d, misses %d", (int)hits,
+                (int)misses);
+
+    /* Other classes are not cached until enabled */
+    G(rc, lsm_system_list, c, &sys, &sys_count, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(sys_count > 0);
+    G(rc, lsm_connect_cache_stats_get, c, &hits, &misses,
+            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(hits == 1 && misses == 3, "hits %d, misses %d", (int)hits,
+                (int)misses);
+
+    G(rc, lsm_connect_cache_ttl_set, c, LSM_CACHE_CAPABILITIES, 60000,
+            LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_capabilities, c, sys[0], &cap, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_capability_record_free, cap);
+    cap = NULL;
+    G(rc, lsm_capabilities, c, sys[0], &cap, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(lsm_capability_supported(cap, LSM_CAP_VOLUMES) != 0);
+    G(rc, lsm_capability_record_free, cap);
+    cap = NULL;
+    G(rc, lsm_connect_cache_stats_get, c, &hits, &misses,
+            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(hits == 2 && misses == 4, "hits %d, misses %d", (int)hits,
+                (int)misses);
+
+    /* A time to live of 0 turns it off again */
+    G(rc, lsm_connect_cache_ttl_set, c, LSM_CACHE_POOLS, 0,
+            LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_pool_list, c, NULL, NULL, &pools_again, &again,
+            LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_pool_record_array_free, pools_again, again);
+    pools_again = NULL;
+    G(rc, lsm_connect_cache_stats_get, c, &hits, &misses,
+            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(hits == 2 && misses == 4, "hits %d, misses %d", (int)hits,
+                (int)misses);
+
+    rc = lsm_connect_cache_ttl_set(c, (lsm_cache_class)99, 1000,
+                                   LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_INVALID_ARGUMENT, "rc = %d", rc);
+
+    rc = lsm_connect_cache_stats_get(c, NULL, &misses, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_INVALID_ARGUMENT, "rc = %d", rc);
+
+    rc = lsm_connect_cache_clear(NULL, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_INVALID_ARGUMENT, "rc = %d", rc);
+
+    G(rc, lsm_system_record_array_free, sys, sys_count);
+    G(rc, lsm_pool_record_array_free, pools, count);
+}
+END_TEST
+
+/*
+ * Stub plug-ins run in a child which accepts a single connection on a unix
+ * socket named after the plug-in, in a directory of its own.
+ */
+typedef void (*stub_plugin_fn)(int listen_fd, int arg);
+
+struct stub_plugin {
+    char dir[32];
+    struct sockaddr_un addr;
+    pid_t pid;
+};
+
+/*
+ * Starts fn(listen_fd, arg) as plug-in "name" and connects to it.  The
+ * stub is expected to _exit(0) once the connection is closed.
+ */
+static lsm_connect *stub_plugin_connect(struct stub_plugin *stub,
+                                        const char *name, stub_plugin_fn fn,
+                                        int arg)
+{
+    int rc;
+    int fd;
+    lsm_connect *conn = NULL;
+    lsm_error_ptr e = NULL;
+    char uri[64];
+    char *uds_path = getenv("LSM_UDS_PATH");
+
+    snprintf(stub->dir, sizeof(stub->dir), "/tmp/lsm_%s_XXXXXX", name);
+    fail_unless(mkdtemp(stub->dir) != NULL);
+    if (uds_path) {
+        uds_path = strdup(uds_path);
+        fail_unless(uds_path != NULL);
+    }
+
+    memset(&stub->addr, 0, sizeof(stub->addr));
+    stub->addr.sun_family = AF_UNIX;
+    snprintf(stub->addr.sun_path, sizeof(stub->addr.sun_path), "%s/%s",
+             stub->dir, name);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    fail_unless(fd >= 0);
+    fail_unless(bind(fd, (struct sockaddr *) &stub->addr,
+                     sizeof(stub->addr)) == 0);
+    fail_unless(listen(fd, 1) == 0);
+
+    stub->pid = fork();
+    fail_unless(stub->pid >= 0);
+    if (!stub->pid) {
+        fn(fd, arg);
+        _exit(0);
+    }
+    close(fd);
+
+    snprintf(uri, sizeof(uri), "%s://", name);
+    setenv("LSM_UDS_PATH", stub->dir, 1);
+    rc = lsm_connect_password(uri, NULL, &conn, 30000, &e,
+                              LSM_CLIENT_FLAG_RSVD);
+    if (uds_path) {
+        setenv("LSM_UDS_PATH", uds_path, 1);
+    } else {
+        unsetenv("LSM_UDS_PATH");
+    }
+    free(uds_path);
+    fail_unless(rc == LSM_ERR_OK, "rc = %d", rc);
+    return conn;
+}
+
+/*
+ * Waits for a stub plug-in, whose connection has been closed, to exit
+ * cleanly and removes its socket.
+ */
+static void stub_plugin_wait(struct stub_plugin *stub)
+{
+    int status = 0;
+
+    fail_unless(waitpid(stub->pid, &status, 0) == stub->pid);
+    fail_unless(WIFEXITED(status) && WEXITSTATUS(status) == 0,
+                "Plug-in exit status %d", status);
+    unlink(stub->addr.sun_path);
+    rmdir(stub->dir);
+}
+
+/*
+ * Reads a message as framed with protocol version 1 or, when binary, as
+ * negotiated for version 2.
+ */
+static char *stall_recv(int fd, int binary)
+{
+    char hdr[11];
+    size_t hdr_len = (binary) ? 4 : 10;
+    size_t len = 0;
+    char *msg = NULL;
+
+    memset(hdr, 0, sizeof(hdr));
+    if (recv(fd, hdr, hdr_len, MSG_WAITALL) != (ssize_t) hdr_len) {
+        return NULL;
+    }
+
+    if (binary) {
+        uint32_t n = 0;
+        memcpy(&n, hdr, 4);
+        len = ntohl(n);
+    } else {
+        len = strtoul(hdr, NULL, 10);
+    }
+
+    msg = (char *) calloc(1, len + 1);
+    if (msg && recv(fd, msg, len, MSG_WAITALL) != (ssize_t) len) {
+        free(msg);
+        msg = NULL;
+    }
+    return msg;
+}
+
+/*
+ * Returns -1 once the client has gone away, which it may do at any time
+ * after a timeout.
+ */
+static int stall_send(int fd, int binary, const char *msg)
+{
+    char hdr[21];               /* Room for any %zu */
+    size_t hdr_len = 10;
+
+    if (binary) {
+        uint32_t n = htonl(strlen(msg));
+        memcpy(hdr, &n, 4);
+        hdr_len = 4;
+    } else {
+        snprintf(hdr, sizeof(hdr), "%010zu", strlen(msg));
+    }
+
+    if (send(fd, hdr, hdr_len, MSG_NOSIGNAL) != (ssize_t) hdr_len ||
+        send(fd, msg, strlen(msg), MSG_NOSIGNAL) != (ssize_t) strlen(msg)) {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Plug-in stand-in for test_io_timeout, speaks just enough of the protocol
+ * to register.  Answers "systems" a second late with protocol version 2,
+ * never with version 1, everything else at once.
+ */
+static void stalled_plugin(int listen_fd, int v2)
+{
+    int fd = accept(listen_fd, NULL, NULL);
+    int binary = 0;
+    char *req = NULL;
+    char resp[128];
+
+    while (fd >= 0 && (req = stall_recv(fd, binary)) != NULL) {
+        const char *id_str = strstr(req, "\"id\":");
+        int id = (id_str) ? atoi(id_str + 5) : 100;
+        const char *result = "null";
+
+        if (strstr(req, "\"plugin_register\"")) {
+            if (v2) {
+                result = "{\"encoding\":\"json\",\"version\":2}";
+            }
+        } else if (strstr(req, "\"systems\"")) {
+            if (!v2) {
+                free(req);
+                continue;
+            }
+            sleep(1);
+            result = "[]";
+        } else if (strstr(req, "\"time_out_get\"")) {
+            result = "1234";
+        }
+
+        snprintf(resp, sizeof(resp), "{\"id\":%d,\"result\":%s}", id, result);
+        if (stall_send(fd, binary, resp) != 0) {
+            free(req);
+            break;
+        }
+
+        if (strstr(req, "\"plugin_register\"")) {
+            binary = v2;
+        } else if (strstr(req, "\"plugin_unregister\"")) {
+            free(req);
+            break;
+        }
+        free(req);
     }
+    _exit(0);
 }
-END_TEST
 
-START_TEST(test_search_pools)
+START_TEST(test_io_timeout)
 {
     int rc;
-    lsm_pool **pools = NULL;
-    uint32_t poolCount = 0;
+    int v2 = 0;
+    uint32_t count = 0;
+    uint32_t timeout = 0;
+    lsm_system **sys = NULL;
+    lsm_connect *stalled = NULL;
+    struct stub_plugin stub;
 
-    G(rc, lsm_pool_list, c, NULL, NULL, &pools, &poolCount, LSM_CLIENT_FLAG_RSVD);
+    for (v2 = 0; v2 < 2; ++v2) {
+        time_t start;
 
-    if( LSM_ERR_OK == rc && poolCount ) {
-        lsm_pool **search_pools = NULL;
-        uint32_t search_count = 0;
+        stalled = stub_plugin_connect(&stub, "stall", stalled_plugin, v2);
 
-        G(rc, lsm_pool_list, c, "id", lsm_pool_id_get(pools[0]), &search_pools,
-                    &search_count, LSM_CLIENT_FLAG_RSVD);
+        G(rc, lsm_connect_io_timeout_get, stalled, &timeout,
+                LSM_CLIENT_FLAG_RSVD);
+        fail_unless(timeout == 0);
+        G(rc, lsm_connect_io_timeout_set, stalled, 300,
+                LSM_CLIENT_FLAG_RSVD);
 
-        fail_unless(search_count == 1, "Expecting 1 pool, got %d", search_count);
+        start = time(NULL);
+        rc = lsm_system_list(stalled, &sys, &count, LSM_CLIENT_FLAG_RSVD);
+        fail_unless(rc == LSM_ERR_TIMEOUT, "rc = %d", rc);
+        fail_unless(time(NULL) - start < 5);
 
-        G(rc, lsm_pool_record_array_free, search_pools, search_count);
+        /* A longer wait for this call, the late answer is dropped */
+        G(rc, lsm_connect_call_timeout_set, stalled, 10000,
+                LSM_CLIENT_FLAG_RSVD);
+        rc = lsm_connect_timeout_get(stalled, &timeout,
+                                     LSM_CLIENT_FLAG_RSVD);
+        if (v2) {
+            fail_unless(rc == LSM_ERR_OK, "rc = %d", rc);
+            fail_unless(timeout == 1234, "timeout = %d", timeout);
+        } else {
+            /* The stream is out of step without request ids */
+            fail_unless(rc == LSM_ERR_TRANSPORT_COMMUNICATION, "rc = %d",
+                        rc);
+        }
 
-        /* Search for non-existent pool*/
-        search_pools = NULL;
-        search_count = 0;
+        G(rc, lsm_connect_io_timeout_get, stalled, &timeout,
+                LSM_CLIENT_FLAG_RSVD);
+        fail_unless(timeout == 300);
 
-        G(rc, lsm_pool_list, c, "id", "non-existent-id", &search_pools,
-                    &search_count, LSM_CLIENT_FLAG_RSVD);
-        fail_unless(search_count == 0, "Expecting no pools! %d", search_count);
+        rc = lsm_connect_close(stalled, LSM_CLIENT_FLAG_RSVD);
+        fail_unless(rc == ((v2) ? LSM_ERR_OK :
+                           LSM_ERR_TRANSPORT_COMMUNICATION), "rc = %d", rc);
+        stalled = NULL;
 
-        /* Search which results in all pools */
-        G(rc, lsm_pool_list, c, "system_id", lsm_pool_system_id_get(pools[0]),
-                    &search_pools,
-                    &search_count, LSM_CLIENT_FLAG_RSVD);
+        stub_plugin_wait(&stub);
+    }
 
-        fail_unless(search_count == poolCount, "Expecting %d pools, got %d",
-                                poolCount, search_count);
+    rc = lsm_connect_io_timeout_set(NULL, 300, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_INVALID_ARGUMENT, "rc = %d", rc);
 
-        G(rc, lsm_pool_record_array_free, search_pools, search_count);
-        search_pools = NULL;
-        search_count = 0;
+    rc = lsm_connect_io_timeout_get(c, NULL, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_INVALID_ARGUMENT, "rc = %d", rc);
+
+    rc = lsm_connect_call_timeout_set(NULL, 300, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_INVALID_ARGUMENT, "rc = %d", rc);
+}
+END_TEST
 
+/*
+ * Plug-in stand-in for test_list_in_old_plugin, one which predates protocol
+ * version 2 and sets of search values.  Has volumes "vol1" and "vol2".
+ */
+static void old_plugin(int listen_fd, int arg)
+{
+    int fd = accept(listen_fd, NULL, NULL);
+    char *req = NULL;
+    char resp[512];
+
+    _UNUSED(arg);
+    while (fd >= 0 && (req = stall_recv(fd, 0)) != NULL) {
+        const char *id_str = strstr(req, "\"id\":");
+        const char *value = strstr(req, "\"search_value\":");
+        int id = (id_str) ? atoi(id_str + 5) : 100;
+        char vol_id[16] = "";
+
+        if (value) {
+            sscanf(value + 15, "\"%15[^\"]\"", vol_id);
+        }
 
-        G(rc, lsm_pool_record_array_free, pools, poolCount);
-        pools = NULL;
-        poolCount = 0;
-    }
+        if (strstr(req, "\"volumes\"") && value && value[15] == '[') {
+            snprintf(resp, sizeof(resp), "{\"id\":%d,\"error\":{\"code\":%d,"
+                     "\"message\":\"Bad search_value\",\"data\":null}}", id,
+                     LSM_ERR_TRANSPORT_INVALID_ARG);
+        } else if (strstr(req, "\"volumes\"") &&
+                   (!strcmp(vol_id, "vol1") || !strcmp(vol_id, "vol2"))) {
+            snprintf(resp, sizeof(resp), "{\"id\":%d,\"result\":[{"
+                     "\"class\":\"Volume\",\"id\":\"%s\",\"name\":\"%s\","
+                     "\"vpd83\":\"600508b1001c9b2d57e4fa2ad0e04f1d\","
+                     "\"block_size\":512,\"num_of_blocks\":8,"
+                     "\"admin_state\":1,\"system_id\":\"sys\","
+                     "\"pool_id\":\"pool\",\"plugin_data\":null}]}", id,
+                     vol_id, vol_id);
+        } else if (strstr(req, "\"volumes\"")) {
+            snprintf(resp, sizeof(resp), "{\"id\":%d,\"result\":[]}", id);
+        } else {
+            snprintf(resp, sizeof(resp), "{\"id\":%d,\"result\":null}", id);
+        }
 
+        if (stall_send(fd, 0, resp) != 0 ||
+            strstr(req, "\"plugin_unregister\"")) {
+            free(req);
+            break;
+        }
+        free(req);
+    }
+    _exit(0);
 }
-END_TEST
 
-START_TEST(test_search_volumes)
+START_TEST(test_list_in_old_plugin)
 {
     int rc;
-    lsm_volume **volumes = NULL;
-    uint32_t volume_count = 0;
+    uint32_t count = 0;
+    lsm_volume **vols = NULL;
+    lsm_string_list *values = NULL;
+    lsm_connect *old = NULL;
+    struct stub_plugin stub;
+
+    old = stub_plugin_connect(&stub, "old", old_plugin, 0);
+
+    /* One search per distinct value */
+    values = lsm_string_list_alloc(0);
+    fail_unless(values != NULL);
+    lsm_string_list_append(values, "vol2");
+    lsm_string_list_append(values, "vol1");
+    lsm_string_list_append(values, "vol2");
+    lsm_string_list_append(values, "vol3");
+
+    rc = lsm_volume_list_in(old, "id", values, &vols, &count,
+                            LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_OK, "rc = %d", rc);
+    fail_unless(count == 2, "count = %d", count);
+    fail_unless(strcmp(lsm_volume_id_get(vols[0]), "vol2") == 0);
+    fail_unless(strcmp(lsm_volume_id_get(vols[1]), "vol1") == 0);
+    fail_unless(lsm_error_last_get(old) == NULL);
 
-    lsm_pool *pool = get_test_pool(c);
+    lsm_volume_record_array_free(vols, count);
+    lsm_string_list_free(values);
 
-    // Make some volumes to we can actually filter
-    create_volumes(c, pool, 10);
+    rc = lsm_connect_close(old, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_OK, "rc = %d", rc);
 
-    G(rc, lsm_volume_list, c, NULL, NULL, &volumes, &volume_count,
-            LSM_CLIENT_FLAG_RSVD);
+    stub_plugin_wait(&stub);
+}
+END_TEST
 
-    fail_unless(volume_count > 0, "We are expecting some volumes!");
+#define THREADED_REQUESTS       4
 
-    if( LSM_ERR_OK == rc && volume_count ) {
-        lsm_volume **search_volume = NULL;
-        uint32_t search_count = 0;
+/*
+ * Volume list of the plug-in run by test_threaded_plugin().  Looking up
+ * "vol<n>" takes longer the smaller n is, so with handler threads the
+ * responses come back in reverse order.
+ */
+static int threaded_vol_list(lsm_plugin_ptr c, const char *search_key,
+                             const char *search_value,
+                             lsm_volume **vol_array[], uint32_t *count,
+                             lsm_flag flags)
+{
+    int n = (search_value) ? atoi(search_value + 3) : 0;
 
-        G(rc, lsm_volume_list, c, "id", lsm_volume_id_get(volumes[0]),
-                    &search_volume,
-                    &search_count, LSM_CLIENT_FLAG_RSVD);
+    _UNUSED(c);
+    _UNUSED(search_key);
+    _UNUSED(flags);
+    usleep((THREADED_REQUESTS - n) * 100000);
 
-        fail_unless(search_count == 1, "Expecting 1 pool, got %d", search_count);
+    *vol_array = lsm_volume_record_array_alloc(1);
+    if (!*vol_array) {
+        return LSM_ERR_NO_MEMORY;
+    }
+    (*vol_array)[0] = lsm_volume_record_alloc(search_value, search_value,
+                                              VPD83_TO_SEARCH, 512, 8, 1,
+                                              "sys", "pool", NULL);
+    if (!(*vol_array)[0]) {
+        lsm_volume_record_array_free(*vol_array, 1);
+        *vol_array = NULL;
+        return LSM_ERR_NO_MEMORY;
+    }
+    *count = 1;
+    return LSM_ERR_OK;
+}
 
-        G(rc, lsm_volume_record_array_free, search_volume, search_count);
-        search_volume = NULL;
-        search_count = 0;
+static int threaded_reg(lsm_plugin_ptr c, const char *uri,
+                        const char *password, uint32_t timeout,
+                        lsm_flag flags)
+{
+    static struct lsm_mgmt_ops_v1 mgm_ops;
+    static struct lsm_san_ops_v1 san_ops;
+    int rc = lsm_plugin_thread_count_set(c, THREADED_REQUESTS,
+                                         LSM_CLIENT_FLAG_RSVD);
+
+    _UNUSED(uri);
+    _UNUSED(password);
+    _UNUSED(timeout);
+    _UNUSED(flags);
+    if (LSM_ERR_OK == rc) {
+        san_ops.vol_get = threaded_vol_list;
+        rc = lsm_register_plugin_v1(c, NULL, &mgm_ops, &san_ops, NULL, NULL);
+    }
+    return rc;
+}
 
-        /* Search for non-existent */
-        G(rc, lsm_volume_list, c, "id", "non-existent-id", &search_volume,
-                    &search_count, LSM_CLIENT_FLAG_RSVD);
-        fail_unless(search_count == 0, "Expecting no volumes! %d", search_count);
+static int threaded_unreg(lsm_plugin_ptr c, lsm_flag flags)
+{
+    _UNUSED(c);
+    _UNUSED(flags);
+    return LSM_ERR_OK;
+}
 
-        /* Search which results in all volumes */
-        G(rc, lsm_volume_list, c, "system_id",
-                    lsm_volume_system_id_get(volumes[0]),
-                    &search_volume,
-                    &search_count, LSM_CLIENT_FLAG_RSVD);
+static void threaded_plugin(int listen_fd, int arg)
+{
+    int fd = accept(listen_fd, NULL, NULL);
+    char fd_str[16];
+    char name[] = "threaded";
+    char *argv[] = { name, fd_str, NULL };
+
+    _UNUSED(arg);
+    snprintf(fd_str, sizeof(fd_str), "%d", fd);
+    _exit((fd >= 0) ? lsm_plugin_init_v1(2, argv, threaded_reg,
+                                         threaded_unreg, "Threaded test",
+                                         "0.1") : 1);
+}
 
-        fail_unless(search_count == volume_count, "Expecting %d volumes, got %d",
-                                volume_count, search_count);
+struct threaded_result {
+    char id[16];
+    int rc;
+    int order;                  /* Of the response, from 1 */
+};
 
-        G(rc, lsm_volume_record_array_free, search_volume, search_count);
-        search_volume = NULL;
-        search_count = 0;
+static int threaded_responses = 0;
 
-        G(rc, lsm_volume_record_array_free, volumes, volume_count);
-        volumes = NULL;
-        volume_count = 0;
+static void threaded_volumes_done(lsm_connect *conn, int rc,
+                                  lsm_volume *volumes[], uint32_t count,
+                                  void *user_data)
+{
+    struct threaded_result *r = (struct threaded_result *)user_data;
+
+    _UNUSED(conn);
+    r->rc = rc;
+    r->order = ++threaded_responses;
+    if (LSM_ERR_OK == rc) {
+        /* The response is the one to this request */
+        if (count != 1 || strcmp(lsm_volume_id_get(volumes[0]), r->id) != 0) {
+            r->rc = LSM_ERR_LIB_BUG;
+        }
+        lsm_volume_record_array_free(volumes, count);
     }
+}
 
-    G(rc, lsm_pool_record_free, pool);
-    pool = NULL;
+START_TEST(test_threaded_plugin)
+{
+    int rc;
+    int i;
+    lsm_connect *threaded = NULL;
+    struct stub_plugin stub;
+    struct threaded_result results[THREADED_REQUESTS];
+    struct timespec start;
+    struct timespec end;
+    long elapsed_ms = 0;
+
+    threaded = stub_plugin_connect(&stub, "threaded", threaded_plugin, 0);
+
+    /* All in flight at once, the first sent takes the longest */
+    threaded_responses = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < THREADED_REQUESTS; ++i) {
+        snprintf(results[i].id, sizeof(results[i].id), "vol%d", i);
+        results[i].rc = -1;
+        results[i].order = 0;
+        rc = lsm_volume_list_async(threaded, "id", results[i].id,
+                                   threaded_volumes_done, &results[i],
+                                   LSM_CLIENT_FLAG_RSVD);
+        fail_unless(rc == LSM_ERR_OK, "rc = %d", rc);
+    }
+    async_wait(threaded);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    elapsed_ms = (end.tv_sec - start.tv_sec) * 1000 +
+                 (end.tv_nsec - start.tv_nsec) / 1000000;
+    fail_unless(elapsed_ms < 900, "Requests handled one at a time, %ld ms",
+                elapsed_ms);
+
+    for (i = 0; i < THREADED_REQUESTS; ++i) {
+        fail_unless(results[i].rc == LSM_ERR_OK, "%s: rc = %d",
+                    results[i].id, results[i].rc);
+        fail_unless(results[i].order == THREADED_REQUESTS - i,
+                    "%s: response %d", results[i].id, results[i].order);
+    }
+
+    rc = lsm_connect_close(threaded, LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_OK, "rc = %d", rc);
+
+    stub_plugin_wait(&stub);
 }
 END_TEST
 
@@ -4072,6 +5449,487 @@ START_TEST(test_local_disk_link_speed_get)
 }
 END_TEST
 
+/*
+ * Text expected in the query plan of simc view lookups.
+ */
+static const char *SIMC_QUERY_PLANS[][2] = {
+    {"SELECT * FROM volumes_by_ag_view WHERE ag_id = 1;",
+     "vol_masks_ag_id_idx"},
+    {"SELECT * FROM ags_by_vol_view WHERE vol_id = 1;",
+     "vol_masks_vol_id_idx"},
+    {"SELECT * FROM ags_by_vol_view WHERE vol_id = 1;",
+     "inits_owner_ag_id_idx"},
+    {"SELECT * FROM pools_view WHERE id = 1;",
+     "pool_usage USING INTEGER PRIMARY KEY"},
+};
+
+/* Indexes which simc state files of _DB_VERSION 4.1 did not have */
+static const char *SIMC_DB_INDEXES[] = {
+    "vol_masks_ag_id_idx", "vol_masks_vol_id_idx", "inits_owner_ag_id_idx",
+    "disks_owner_pool_id_idx", "volumes_pool_id_idx", "fss_pool_id_idx",
+    "pools_parent_pool_id_idx",
+};
+
+/* State file version string written by simc _DB_VERSION 4.1 */
+#define SIMC_DB_VERSION_4_1 \
+    "LSM_SIMULATOR_DATA_4.1_895a074a5b216322121b5f76bc831927"
+
+/* Triggers keeping the pool_usage counters, added by simc _DB_VERSION 4.2 */
+static const char *SIMC_DB_TRIGGERS[] = {
+    "pool_usage_pool_insert", "pool_usage_pool_update",
+    "pool_usage_pool_delete", "pool_usage_disk_insert",
+    "pool_usage_disk_update", "pool_usage_disk_delete",
+    "pool_usage_vol_insert", "pool_usage_vol_update", "pool_usage_vol_delete",
+    "pool_usage_fs_insert", "pool_usage_fs_update", "pool_usage_fs_delete",
+};
+
+/* pools_view of simc _DB_VERSION 4.1, which summed up space on each read */
+#define SIMC_POOLS_VIEW_4_1 \
+    "CREATE VIEW pools_view AS\n" \
+    "    SELECT\n" \
+    "        pool0.id,\n" \
+    "            'POOL_ID_' || \n" \
+    "                SUBSTR('00000' || pool0.id, -5, 5)\n" \
+    "        lsm_pool_id,\n" \
+    "        pool0.name,\n" \
+    "        pool0.status,\n" \
+    "        pool0.status_info,\n" \
+    "        pool0.element_type,\n" \
+    "        pool0.unsupported_actions,\n" \
+    "        pool0.raid_type,\n" \
+    "        pool0.member_type,\n" \
+    "        pool0.parent_pool_id,\n" \
+    "            'POOL_ID_' || \n" \
+    "                SUBSTR('00000' || pool0.parent_pool_id, -5, 5)\n" \
+    "        parent_lsm_pool_id,\n" \
+    "        pool0.strip_size,\n" \
+    "        pool1.total_space total_space,\n" \
+    "        pool1.total_space -\n" \
+    "        pool2.vol_consumed_size  -\n" \
+    "        pool3.fs_consumed_size -\n" \
+    "        pool4.sub_pool_consumed_size free_space,\n" \
+    "        pool1.data_disk_count,\n" \
+    "        pool5.disk_count\n" \
+    "    FROM\n" \
+    "        pools pool0\n" \
+    "            LEFT JOIN (\n" \
+    "                SELECT\n" \
+    "                    pool.id,\n" \
+    "                        ifnull(pool.total_space,\n" \
+    "                            ifnull(SUM(disk.total_space), 0))\n" \
+    "                    total_space,\n" \
+    "                    COUNT(disk.id) data_disk_count\n" \
+    "                FROM pools pool\n" \
+    "                    LEFT JOIN disks disk\n" \
+    "                        ON pool.id = disk.owner_pool_id AND\n" \
+    "                            disk.role = 'DATA'\n" \
+    "                GROUP BY\n" \
+    "                    pool.id\n" \
+    "            ) pool1 ON pool0.id = pool1.id\n" \
+    "            LEFT JOIN (\n" \
+    "                SELECT\n" \
+    "                    pool.id,\n" \
+    "                        ifnull(SUM(volume.consumed_size), 0)\n" \
+    "                    vol_consumed_size\n" \
+    "                FROM pools pool\n" \
+    "                    LEFT JOIN volumes volume\n" \
+    "                        ON volume.pool_id = pool.id\n" \
+    "                GROUP BY\n" \
+    "                    pool.id\n" \
+    "            ) pool2 ON pool0.id = pool2.id\n" \
+    "            LEFT JOIN (\n" \
+    "                SELECT\n" \
+    "                    pool.id,\n" \
+    "                        ifnull(SUM(fs.consumed_size), 0)\n" \
+    "                    fs_consumed_size\n" \
+    "                FROM pools pool\n" \
+    "                    LEFT JOIN fss fs\n" \
+    "                        ON fs.pool_id = pool.id\n" \
+    "                GROUP BY\n" \
+    "                    pool.id\n" \
+    "            ) pool3 ON pool0.id = pool3.id\n" \
+    "            LEFT JOIN (\n" \
+    "                SELECT\n" \
+    "                    pool.id,\n" \
+    "                        ifnull(SUM(sub_pool.total_space), 0)\n" \
+    "                    sub_pool_consumed_size\n" \
+    "                FROM pools pool\n" \
+    "                    LEFT JOIN pools sub_pool\n" \
+    "                        ON sub_pool.parent_pool_id = pool.id\n" \
+    "                GROUP BY\n" \
+    "                    pool.id\n" \
+    "            ) pool4 ON pool0.id = pool4.id\n" \
+    "            LEFT JOIN (\n" \
+    "            SELECT\n" \
+    "                pool.id,\n" \
+    "                COUNT(disk.id) disk_count\n" \
+    "            FROM pools pool\n" \
+    "                LEFT JOIN disks disk\n" \
+    "                    ON pool.id = disk.owner_pool_id\n" \
+    "            GROUP BY\n" \
+    "                pool.id\n" \
+    "            ) pool5 ON pool0.id = pool5.id\n" \
+    "    GROUP BY\n" \
+    "         pool0.id;\n"
+
+#define SIMC_POOLS_MAX          16
+
+static lsm_connect *simc_state_connect(const char *state_file)
+{
+    char uri[_URI_BUFF_SIZE * 2];
+    lsm_connect *simc = NULL;
+    lsm_error_ptr e = NULL;
+    int rc = LSM_ERR_OK;
+
+    snprintf(uri, sizeof(uri), "simc://localhost/?statefile=%s", state_file);
+
+    rc = lsm_connect_password(uri, NULL, &simc, 30000, &e,
+                              LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_OK, "Failed to open %s: %d %s", uri, rc,
+                error(e));
+    return simc;
+}
+
+/*
+ * Free space of each pool of the simc state file, by pool id order.
+ */
+static uint32_t simc_state_free_space(const char *state_file,
+                                      uint64_t free_space[SIMC_POOLS_MAX])
+{
+    lsm_connect *simc = simc_state_connect(state_file);
+    lsm_pool **pools = NULL;
+    uint32_t count = 0;
+    uint32_t i = 0;
+    int rc = LSM_ERR_OK;
+
+    rc = lsm_pool_list(simc, NULL, NULL, &pools, &count,
+                       LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_OK, "lsm_pool_list(): %d %s", rc,
+                error(lsm_error_last_get(simc)));
+    fail_unless(count > 0 && count <= SIMC_POOLS_MAX, "count = %d", count);
+    for (; i < count; ++i)
+        free_space[i] = lsm_pool_free_space_get(pools[i]);
+
+    lsm_pool_record_array_free(pools, count);
+    lsm_connect_close(simc, LSM_CLIENT_FLAG_RSVD);
+    return count;
+}
+
+/*
+ * Create a volume and a file system, for their pools to have space used.
+ */
+static void simc_state_fill(const char *state_file)
+{
+    lsm_connect *simc = simc_state_connect(state_file);
+    lsm_pool **pools = NULL;
+    lsm_volume *vol = NULL;
+    lsm_fs *fs = NULL;
+    char *job = NULL;
+    uint32_t count = 0;
+    uint32_t i = 0;
+    int rc = LSM_ERR_OK;
+
+    G(rc, lsm_pool_list, simc, NULL, NULL, &pools, &count,
+      LSM_CLIENT_FLAG_RSVD);
+
+    for (; i < count; ++i) {
+        uint64_t type = lsm_pool_element_type_get(pools[i]);
+
+        if (!vol && (type & LSM_POOL_ELEMENT_TYPE_VOLUME)) {
+            rc = lsm_volume_create(simc, pools[i], "upgrade_vol", 20000000,
+                                   LSM_VOLUME_PROVISION_DEFAULT, &vol, &job,
+                                   LSM_CLIENT_FLAG_RSVD);
+            if (LSM_ERR_JOB_STARTED == rc) {
+                vol = wait_for_job_vol(simc, &job);
+            } else {
+                fail_unless(rc == LSM_ERR_OK, "rc = %d", rc);
+            }
+        }
+
+        if (!fs && (type & LSM_POOL_ELEMENT_TYPE_FS)) {
+            rc = lsm_fs_create(simc, pools[i], "upgrade_fs", 50000000, &fs,
+                               &job, LSM_CLIENT_FLAG_RSVD);
+            if (LSM_ERR_JOB_STARTED == rc) {
+                fs = wait_for_job_fs(simc, &job);
+            } else {
+                fail_unless(rc == LSM_ERR_OK, "rc = %d", rc);
+            }
+        }
+    }
+    fail_unless(vol != NULL && fs != NULL);
+
+    lsm_volume_record_free(vol);
+    lsm_fs_record_free(fs);
+    lsm_pool_record_array_free(pools, count);
+    lsm_connect_close(simc, LSM_CLIENT_FLAG_RSVD);
+}
+
+static void simc_query_plans_check(sqlite3 *db)
+{
+    char sql[256];
+    sqlite3_stmt *stmt = NULL;
+    const char *detail = NULL;
+    uint32_t i = 0;
+    int found = 0;
+
+    for (; i < sizeof(SIMC_QUERY_PLANS)/sizeof(SIMC_QUERY_PLANS[0]); ++i) {
+        snprintf(sql, sizeof(sql), "EXPLAIN QUERY PLAN %s",
+                 SIMC_QUERY_PLANS[i][0]);
+        fail_unless(sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK,
+                    "Failed to prepare '%s': %s", sql, sqlite3_errmsg(db));
+
+        found = 0;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            detail = (const char *) sqlite3_column_text(stmt, 3);
+            if ((detail != NULL) &&
+                (strstr(detail, SIMC_QUERY_PLANS[i][1]) != NULL))
+                found = 1;
+        }
+        sqlite3_finalize(stmt);
+        fail_unless(found == 1, "Query plan of '%s' does not use %s",
+                    SIMC_QUERY_PLANS[i][0], SIMC_QUERY_PLANS[i][1]);
+    }
+}
+
+START_TEST(test_simc_db_upgrade)
+{
+    const char *rundir = getenv("LSM_TEST_RUNDIR");
+    char name[32];
+    char state_file[_URI_BUFF_SIZE];
+    char sql[128];
+    sqlite3 *db = NULL;
+    sqlite3_stmt *stmt = NULL;
+    const char *version = NULL;
+    uint64_t free_space[SIMC_POOLS_MAX];
+    uint64_t upgraded_free_space[SIMC_POOLS_MAX];
+    uint32_t count = 0;
+    uint32_t i = 0;
+
+    if (is_simc_plugin == 0)
+        return;
+
+    fail_unless(rundir != NULL, "Missing LSM_TEST_RUNDIR");
+    generate_random(name, sizeof(name)/sizeof(name[0]));
+    snprintf(state_file, sizeof(state_file), "%s/lsm_sim_%s", rundir, name);
+
+    /* New state file, with space used in some pools */
+    simc_state_fill(state_file);
+    count = simc_state_free_space(state_file, free_space);
+    fail_unless(sqlite3_open(state_file, &db) == SQLITE_OK);
+    simc_query_plans_check(db);
+
+    /* Turn it back into a 4.1 state file, which had no index, no pool usage
+     * counters and summed up space in pools_view */
+    for (i = 0; i < sizeof(SIMC_DB_INDEXES)/sizeof(SIMC_DB_INDEXES[0]); ++i) {
+        snprintf(sql, sizeof(sql), "DROP INDEX IF EXISTS %s;",
+                 SIMC_DB_INDEXES[i]);
+        fail_unless(sqlite3_exec(db, sql, NULL, NULL, NULL) == SQLITE_OK);
+    }
+    for (i = 0; i < sizeof(SIMC_DB_TRIGGERS)/sizeof(SIMC_DB_TRIGGERS[0]);
+         ++i) {
+        snprintf(sql, sizeof(sql), "DROP TRIGGER %s;", SIMC_DB_TRIGGERS[i]);
+        fail_unless(sqlite3_exec(db, sql, NULL, NULL, NULL) == SQLITE_OK,
+                    "%s", sqlite3_errmsg(db));
+    }
+    fail_unless(sqlite3_exec(db, "DROP TABLE pool_usage;"
+                             "DROP VIEW pools_view;"
+                             SIMC_POOLS_VIEW_4_1,
+                             NULL, NULL, NULL) == SQLITE_OK,
+                "%s", sqlite3_errmsg(db));
+    fail_unless(sqlite3_exec(db, "UPDATE systems SET version = '"
+                             SIMC_DB_VERSION_4_1 "';",
+                             NULL, NULL, NULL) == SQLITE_OK);
+
+    /* Which has the space used the way 4.1 worked it out */
+    fail_unless(sqlite3_prepare_v2(db, "SELECT free_space FROM pools_view "
+                                   "ORDER BY id;", -1, &stmt,
+                                   NULL) == SQLITE_OK);
+    for (i = 0; sqlite3_step(stmt) == SQLITE_ROW; ++i) {
+        fail_unless(i < count);
+        fail_unless((uint64_t) sqlite3_column_int64(stmt, 0) ==
+                    free_space[i], "Pool %d free space of 4.1 differs", i);
+    }
+    fail_unless(i == count);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    /* Should be upgraded in place when opened, filling the counters in */
+    fail_unless(simc_state_free_space(state_file, upgraded_free_space) ==
+                count);
+    for (i = 0; i < count; ++i) {
+        fail_unless(upgraded_free_space[i] == free_space[i],
+                    "Pool %d free space changed by upgrade: %" PRIu64
+                    " != %" PRIu64, i, upgraded_free_space[i],
+                    free_space[i]);
+    }
+
+    fail_unless(sqlite3_open(state_file, &db) == SQLITE_OK);
+    simc_query_plans_check(db);
+
+    fail_unless(sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM sqlite_master "
+                                   "WHERE type = 'trigger' AND "
+                                   "name LIKE 'pool_usage_%';", -1, &stmt,
+                                   NULL) == SQLITE_OK);
+    fail_unless(sqlite3_step(stmt) == SQLITE_ROW);
+    fail_unless((size_t) sqlite3_column_int(stmt, 0) ==
+                sizeof(SIMC_DB_TRIGGERS)/sizeof(SIMC_DB_TRIGGERS[0]),
+                "Pool usage triggers not restored");
+    sqlite3_finalize(stmt);
+
+    fail_unless(sqlite3_prepare_v2(db, "SELECT version FROM systems;", -1,
+                                   &stmt, NULL) == SQLITE_OK);
+    fail_unless(sqlite3_step(stmt) == SQLITE_ROW);
+    version = (const char *) sqlite3_column_text(stmt, 0);
+    fail_unless(version != NULL &&
+                strcmp(version, SIMC_DB_VERSION_4_1) != 0,
+                "State file version not upgraded: %s", version);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    unlink(state_file);
+}
+END_TEST
+
+#define SIMC_READERS            4
+#define SIMC_READER_LISTS       200
+
+/*
+ * Child process of test_simc_concurrent_list(): list volumes and pools
+ * through uri with a short database lock timeout.  Exit code is the
+ * number of failed lists.
+ */
+static void simc_reader(const char *uri)
+{
+    lsm_connect *reader = NULL;
+    lsm_error_ptr e = NULL;
+    lsm_volume **vols = NULL;
+    lsm_pool **pools = NULL;
+    uint32_t count = 0;
+    int failed = 0;
+    int rc = LSM_ERR_OK;
+    int i = 0;
+
+    if (lsm_connect_password(uri, NULL, &reader, 30000, &e,
+                             LSM_CLIENT_FLAG_RSVD) != LSM_ERR_OK) {
+        printf("Reader failed to connect: %s\n", error(e));
+        _exit(SIMC_READER_LISTS);
+    }
+    rc = lsm_connect_timeout_set(reader, 50, LSM_CLIENT_FLAG_RSVD);
+    if (rc != LSM_ERR_OK)
+        _exit(SIMC_READER_LISTS);
+
+    for (; i < SIMC_READER_LISTS; ++i) {
+        if (i % 2)
+            rc = lsm_volume_list(reader, NULL, NULL, &vols, &count,
+                                 LSM_CLIENT_FLAG_RSVD);
+        else
+            rc = lsm_pool_list(reader, NULL, NULL, &pools, &count,
+                               LSM_CLIENT_FLAG_RSVD);
+        if (rc == LSM_ERR_OK) {
+            if (i % 2)
+                lsm_volume_record_array_free(vols, count);
+            else
+                lsm_pool_record_array_free(pools, count);
+            vols = NULL;
+            pools = NULL;
+        } else {
+            printf("Reader list failed: %d %s\n", rc,
+                   error(lsm_error_last_get(reader)));
+            ++failed;
+        }
+    }
+
+    lsm_connect_close(reader, LSM_CLIENT_FLAG_RSVD);
+    _exit(failed);
+}
+
+/*
+ * Several simc plug-in processes listing one state file while another
+ * one keeps creating and deleting access groups in it.  Readers should not
+ * queue behind the writer or each other, so none of their lists may run
+ * into the 50ms database lock timeout.  Also prints the list and write
+ * rates as a benchmark.
+ */
+START_TEST(test_simc_concurrent_list)
+{
+    const char *rundir = getenv("LSM_TEST_RUNDIR");
+    char name[32];
+    char uri[_URI_BUFF_SIZE * 2];
+    lsm_connect *writer = NULL;
+    lsm_error_ptr e = NULL;
+    lsm_system *system = NULL;
+    lsm_access_group *ag = NULL;
+    pid_t pids[SIMC_READERS];
+    struct timespec start;
+    struct timespec end;
+    double elapsed = 0;
+    int status = 0;
+    int done = 0;
+    int writes = 0;
+    int rc = LSM_ERR_OK;
+    int i = 0;
+
+    if (is_simc_plugin == 0)
+        return;
+
+    fail_unless(rundir != NULL, "Missing LSM_TEST_RUNDIR");
+    generate_random(name, sizeof(name)/sizeof(name[0]));
+    snprintf(uri, sizeof(uri), "simc://localhost/?statefile=%s/lsm_sim_%s",
+             rundir, name);
+
+    rc = lsm_connect_password(uri, NULL, &writer, 30000, &e,
+                              LSM_CLIENT_FLAG_RSVD);
+    fail_unless(rc == LSM_ERR_OK, "Failed to open %s: %d %s", uri, rc,
+                error(e));
+    system = get_system(writer);
+    fail_unless(system != NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < SIMC_READERS; ++i) {
+        pids[i] = fork();
+        fail_unless(pids[i] >= 0);
+        if (!pids[i])
+            simc_reader(uri);
+    }
+
+    /* Keep writing until every reader is done */
+    while (done < SIMC_READERS) {
+        generate_random(name, sizeof(name)/sizeof(name[0]));
+        rc = lsm_access_group_create(writer, name, ISCSI_HOST[0],
+                                     LSM_ACCESS_GROUP_INIT_TYPE_ISCSI_IQN,
+                                     system, &ag, LSM_CLIENT_FLAG_RSVD);
+        fail_unless(rc == LSM_ERR_OK, "lsm_access_group_create(): %d %s",
+                    rc, error(lsm_error_last_get(writer)));
+        rc = lsm_access_group_delete(writer, ag, LSM_CLIENT_FLAG_RSVD);
+        fail_unless(rc == LSM_ERR_OK, "lsm_access_group_delete(): %d %s",
+                    rc, error(lsm_error_last_get(writer)));
+        lsm_access_group_record_free(ag);
+        ag = NULL;
+        ++writes;
+
+        for (i = 0; i < SIMC_READERS; ++i) {
+            if ((pids[i] == 0) || (waitpid(pids[i], &status, WNOHANG) == 0))
+                continue;
+            fail_unless(WIFEXITED(status) && WEXITSTATUS(status) == 0,
+                        "%d lists failed in reader %d", WEXITSTATUS(status),
+                        i);
+            pids[i] = 0;
+            ++done;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    elapsed = (end.tv_sec - start.tv_sec) +
+              (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("simc: %d readers, %d lists in %.3f seconds, %.1f lists/s, "
+           "%d access groups created and deleted meanwhile\n", SIMC_READERS,
+           SIMC_READERS * SIMC_READER_LISTS, elapsed,
+           SIMC_READERS * SIMC_READER_LISTS / elapsed, writes);
+
+    lsm_system_record_free(system);
+    lsm_connect_close(writer, LSM_CLIENT_FLAG_RSVD);
+}
+END_TEST
+
 Suite * lsm_suite(void)
 {
     Suite *s = suite_create("libStorageMgmt");
@@ -4086,6 +5944,15 @@ Suite * lsm_suite(void)
     tcase_add_test(basic, test_search_access_groups);
     tcase_add_test(basic, test_search_disks);
     tcase_add_test(basic, test_search_volumes);
+    tcase_add_test(basic, test_list_page);
+    tcase_add_test(basic, test_list_fields);
+    tcase_add_test(basic, test_list_in);
+    tcase_add_test(basic, test_async);
+    tcase_add_test(basic, test_job_wait);
+    tcase_add_test(basic, test_cache);
+    tcase_add_test(basic, test_io_timeout);
+    tcase_add_test(basic, test_list_in_old_plugin);
+    tcase_add_test(basic, test_threaded_plugin);
     tcase_add_test(basic, test_search_pools);
 
     tcase_add_test(basic, test_uri_parse);
@@ -4097,6 +5964,8 @@ Suite * lsm_suite(void)
     tcase_add_test(basic, test_disk_location);
     tcase_add_test(basic, test_disk_rpm_and_link_type);
     tcase_add_test(basic, test_plugin_info);
+    tcase_add_test(basic, test_connect_pool);
+    tcase_add_test(basic, test_batch);
     tcase_add_test(basic, test_system_fw_version);
     tcase_add_test(basic, test_system_mode);
     tcase_add_test(basic, test_get_available_plugins);
@@ -4135,6 +6004,8 @@ Suite * lsm_suite(void)
     tcase_add_test(basic, test_local_disk_fault_led);
     tcase_add_test(basic, test_local_disk_led_status_get);
     tcase_add_test(basic, test_local_disk_link_speed_get);
+    tcase_add_test(basic, test_simc_db_upgrade);
+    tcase_add_test(basic, test_simc_concurrent_list);
 
     suite_add_tcase(s, basic);
     return s;